@@ -15,7 +15,7 @@ PlasmaExtras.Representation {
 
     property var detailSnapshots: []
     property var detailSummaryData: ({})
-    property var detailDailyCosts: []
+    property var detailComparison: ({})
     property string detailProviderLabel: ""
 
     property var compareSeriesData: []
@@ -59,7 +59,7 @@ PlasmaExtras.Representation {
 
             PlasmaComponents.ToolButton {
                 icon.name: "view-refresh"
-                onClicked: root.refreshAll()
+                onClicked: root.refreshAll(true)
                 PlasmaComponents.ToolTip { text: i18n("Refresh all providers") }
             }
 
@@ -660,7 +660,7 @@ PlasmaExtras.Representation {
                             Layout.fillWidth: true
                             Layout.margins: Kirigami.Units.smallSpacing
                             summaryData: fullRoot.detailSummaryData
-                            dailyCosts: fullRoot.detailDailyCosts
+                            comparison: fullRoot.detailComparison
                             provider: fullRoot.detailProviderLabel
                         }
                     }
@@ -955,7 +955,10 @@ PlasmaExtras.Representation {
             { text: i18n("Cost"), value: "cost" },
             { text: i18n("Tokens"), value: "tokens" },
             { text: i18n("Requests"), value: "requests" },
-            { text: i18n("Rate Limit Used"), value: "rateLimitUsed" }
+            { text: i18n("Rate Limit Used"), value: "rateLimitUsed" },
+            { text: i18n("Tokens / Minute"), value: "tokensPerMinute" },
+            { text: i18n("Requests / Minute"), value: "requestsPerMinute" },
+            { text: i18n("Cost / Hour"), value: "costPerHour" }
         ];
     }
 
@@ -1031,14 +1034,17 @@ PlasmaExtras.Representation {
             if (providerDbName === "") {
                 fullRoot.detailSnapshots = [];
                 fullRoot.detailSummaryData = ({})
-                fullRoot.detailDailyCosts = [];
+                fullRoot.detailComparison = ({});
                 return;
             }
 
             fullRoot.detailProviderLabel = historyProviderCombo.currentText;
             fullRoot.detailSnapshots = root.usageDb.getSnapshots(providerDbName, from, to);
             fullRoot.detailSummaryData = root.usageDb.getSummary(providerDbName, from, to);
-            fullRoot.detailDailyCosts = root.usageDb.getDailyCosts(providerDbName, from, to);
+            // Same-length window immediately before the selected range
+            var previousFrom = new Date(from.getTime() - (to.getTime() - from.getTime()));
+            fullRoot.detailComparison = root.usageDb.comparePeriods([providerDbName], "cost",
+                                                                    from, to, previousFrom, from, 24 * 60);
         } finally {
             fullRoot.historyLoading = false;
         }
@@ -1126,7 +1132,8 @@ PlasmaExtras.Representation {
 
     function formatCompareValue(value) {
         var metric = currentCompareMetric();
-        if (metric === "cost") return "$" + value.toFixed(value < 1 ? 4 : 2);
+        if (metric === "cost" || metric === "costPerHour") return "$" + value.toFixed(value < 1 ? 4 : 2);
+        if (metric === "requestsPerMinute" && value < 10) return value.toFixed(1);
         if (metric === "percentUsed" || metric === "rateLimitUsed") return Math.round(value) + "%";
         if (value >= 1000000) return (value / 1000000).toFixed(1) + "M";
         if (value >= 1000) return (value / 1000).toFixed(1) + "K";
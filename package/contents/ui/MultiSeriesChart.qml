@@ -449,10 +449,13 @@ Item {
     }
 
     function formatMetricValue(value) {
-        if (metric === "cost") {
+        if (metric === "cost" || metric === "costPerHour") {
             return "$" + value.toFixed(value < 1 ? 4 : 2);
         }
-        if (metric === "tokens") {
+        if (metric === "requestsPerMinute") {
+            return value < 10 ? value.toFixed(1) : Math.round(value).toString();
+        }
+        if (metric === "tokens" || metric === "tokensPerMinute") {
             if (value >= 1000000) return (value / 1000000).toFixed(1) + "M";
             if (value >= 1000) return (value / 1000).toFixed(1) + "K";
             return Math.round(value).toString();
@@ -470,6 +473,9 @@ Item {
             case "tokens": return i18n("Tokens");
             case "requests": return i18n("Requests");
             case "rateLimitUsed": return i18n("Rate Limit Used");
+            case "tokensPerMinute": return i18n("Tokens / Minute");
+            case "requestsPerMinute": return i18n("Requests / Minute");
+            case "costPerHour": return i18n("Cost / Hour");
             case "percentUsed": return i18n("Percent Used");
             case "usageCount": return i18n("Usage Count");
             case "remaining": return i18n("Remaining");
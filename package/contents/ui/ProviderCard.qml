@@ -154,12 +154,14 @@ ColumnLayout {
                     text: {
                         if (!card.backend) return i18n("N/A");
                         if (card.backend.loading) return i18n("Loading...");
+                        if (card.backend.circuitOpen) return i18n("Paused");
                         if (card.backend.error) return i18n("Error");
                         if (card.backend.connected) return i18n("Connected");
                         return i18n("Disconnected");
                     }
                     color: {
                         if (!card.backend) return Kirigami.Theme.disabledTextColor;
+                        if (card.backend.circuitOpen) return Kirigami.Theme.neutralTextColor;
                         if (card.backend.error) return Kirigami.Theme.negativeTextColor;
                         if (card.backend.connected) return Kirigami.Theme.positiveTextColor;
                         return Kirigami.Theme.disabledTextColor;
@@ -201,7 +203,7 @@ ColumnLayout {
             // Error message (expandable)
             ColumnLayout {
                 Layout.fillWidth: true
-                visible: !card.collapsed && (card.backend?.error ?? "") !== ""
+                visible: !card.collapsed && ((card.backend?.error ?? "") !== "" || (card.backend?.circuitOpen ?? false))
                 spacing: Kirigami.Units.smallSpacing / 2
 
                 RowLayout {
@@ -224,7 +226,9 @@ ColumnLayout {
                         display: PlasmaComponents.AbstractButton.IconOnly
                         PlasmaComponents.ToolTip { text: i18n("Retry") }
                         onClicked: {
-                            if (card.backend) card.backend.refresh();
+                            if (!card.backend) return;
+                            card.backend.resetCircuit();
+                            card.backend.requestRefresh(true);
                         }
                     }
 
@@ -238,6 +242,17 @@ ColumnLayout {
                     }
                 }
 
+                // Circuit breaker: refreshes paused after repeated failures
+                PlasmaComponents.Label {
+                    Layout.fillWidth: true
+                    visible: card.backend?.circuitOpen ?? false
+                    text: i18n("Paused after repeated failures, next attempt at %1",
+                               Qt.formatTime(card.backend?.circuitRetryAt ?? new Date(), "hh:mm"))
+                    color: Kirigami.Theme.neutralTextColor
+                    font.pointSize: Kirigami.Theme.smallFont.pointSize
+                    wrapMode: Text.WordWrap
+                }
+
                 // Expanded error details
                 PlasmaComponents.Label {
                     Layout.fillWidth: true
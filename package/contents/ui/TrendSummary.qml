@@ -9,13 +9,14 @@ import "Utils.js" as Utils
  *
  * summaryData: QVariantMap with keys: totalCost, avgDailyCost, maxDailyCost,
  *              totalRequests, peakTokenUsage, snapshotCount
- * dailyCosts:  QVariantList of QVariantMap with keys: date, totalCost, maxDailyCost
+ * comparison:  QVariantMap from UsageDatabase.comparePeriods() for the cost
+ *              metric, current range against the equally long range before it
  */
 Item {
     id: trendRoot
 
     property var summaryData: ({})
-    property var dailyCosts: []
+    property var comparison: ({})
     property string provider: ""
 
     implicitHeight: summaryGrid.implicitHeight
@@ -120,10 +121,10 @@ Item {
             font.pointSize: Kirigami.Theme.smallFont.pointSize
             opacity: 0.7
             Layout.alignment: Qt.AlignRight
-            visible: dailyCosts && dailyCosts.length >= 3
+            visible: hasComparison()
         }
         RowLayout {
-            visible: dailyCosts && dailyCosts.length >= 3
+            visible: hasComparison()
             spacing: Kirigami.Units.smallSpacing
 
             // Arrow indicating direction
@@ -141,9 +142,10 @@ Item {
                 elide: Text.ElideRight
                 text: {
                     var dir = trendDirection();
-                    if (dir > 0) return i18n("Costs increasing");
-                    if (dir < 0) return i18n("Costs decreasing");
-                    return i18n("Costs stable");
+                    var pct = Math.abs(comparison.deltaPercent || 0).toFixed(1);
+                    if (dir > 0) return i18n("Costs up %1% vs previous period", pct);
+                    if (dir < 0) return i18n("Costs down %1% vs previous period", pct);
+                    return i18n("Costs stable vs previous period");
                 }
                 font.pointSize: Kirigami.Theme.smallFont.pointSize
                 color: trendDirection() > 0 ? Kirigami.Theme.negativeTextColor
@@ -159,31 +161,21 @@ Item {
         return Utils.formatNumber(val);
     }
 
+    function hasComparison() {
+        return comparison && (comparison.previousTotal || 0) > 0;
+    }
+
     /**
-     * Simple trend detection: compare average of first half vs second half of daily costs.
+     * Trend from the period-over-period cost delta computed in SQL.
      * Returns: 1 (increasing), -1 (decreasing), 0 (stable)
      */
     function trendDirection() {
-        if (!dailyCosts || dailyCosts.length < 3) return 0;
-
-        var mid = Math.floor(dailyCosts.length / 2);
-        var firstHalfSum = 0;
-        var secondHalfSum = 0;
-
-        for (var i = 0; i < mid; i++) {
-            firstHalfSum += (dailyCosts[i].totalCost || 0);
-        }
-        for (var j = mid; j < dailyCosts.length; j++) {
-            secondHalfSum += (dailyCosts[j].totalCost || 0);
-        }
-
-        var firstAvg = firstHalfSum / mid;
-        var secondAvg = secondHalfSum / (dailyCosts.length - mid);
+        if (!hasComparison()) return 0;
 
         // 10% threshold for significance
-        var threshold = Math.max(firstAvg, 0.001) * 0.1;
-        if (secondAvg > firstAvg + threshold) return 1;
-        if (secondAvg < firstAvg - threshold) return -1;
+        var delta = comparison.deltaPercent || 0;
+        if (delta > 10) return 1;
+        if (delta < -10) return -1;
         return 0;
     }
 }
@@ -9,13 +9,17 @@ KCM.SimpleKCM {
     id: historyPage
 
     property alias cfg_historyEnabled: historySwitch.checked
+    property alias cfg_historyRecordLatency: latencyCheck.checked
     property alias cfg_historyRetentionDays: retentionSlider.value
+    property alias cfg_historyBackupIntervalHours: backupIntervalSpin.value
+    property alias cfg_historyBackupKeepCount: backupKeepSpin.value
 
     // Database reference for size display
     UsageDatabase {
         id: historyDb
         enabled: plasmoid.configuration.historyEnabled
         retentionDays: plasmoid.configuration.historyRetentionDays
+        backupKeepCount: plasmoid.configuration.historyBackupKeepCount
     }
 
     Kirigami.FormLayout {
@@ -36,6 +40,13 @@ KCM.SimpleKCM {
             Layout.fillWidth: true
         }
 
+        QQC2.CheckBox {
+            id: latencyCheck
+            text: i18n("Record request latency")
+            enabled: historySwitch.checked
+            checked: plasmoid.configuration.historyRecordLatency
+        }
+
         Kirigami.Separator {
             Kirigami.FormData.isSection: true
             Kirigami.FormData.label: i18n("Data Retention")
@@ -119,6 +130,77 @@ KCM.SimpleKCM {
             }
         }
 
+        // Databases from before incremental vacuum need one full rewrite
+        QQC2.Button {
+            id: compactButton
+            property bool pending: historyDb.needsVacuumConversion()
+            visible: pending
+            text: i18n("Compact Database")
+            icon.name: "package-reduce"
+            enabled: historySwitch.checked
+            QQC2.ToolTip.text: i18n("Rewrites the database once so that space freed by pruning is returned to the disk in the background. This may take a moment on large histories.")
+            QQC2.ToolTip.visible: hovered
+            QQC2.ToolTip.delay: 500
+            onClicked: {
+                historyDb.convertToIncrementalVacuum();
+                pending = historyDb.needsVacuumConversion();
+                dbSizeRefreshTimer.restart();
+            }
+        }
+
+        Kirigami.Separator {
+            Kirigami.FormData.isSection: true
+            Kirigami.FormData.label: i18n("Backups")
+        }
+
+        QQC2.SpinBox {
+            id: backupIntervalSpin
+            Kirigami.FormData.label: i18n("Back up every:")
+            enabled: historySwitch.checked
+            from: 0
+            to: 720
+            value: plasmoid.configuration.historyBackupIntervalHours
+            textFromValue: function(value) {
+                return value === 0 ? i18n("Never") : i18np("%1 hour", "%1 hours", value);
+            }
+        }
+
+        QQC2.SpinBox {
+            id: backupKeepSpin
+            Kirigami.FormData.label: i18n("Keep backups:")
+            enabled: historySwitch.checked && backupIntervalSpin.value > 0
+            from: 1
+            to: 100
+            value: plasmoid.configuration.historyBackupKeepCount
+        }
+
+        QQC2.Button {
+            text: historyDb.backupRunning
+                ? i18n("Backing Up… %1%", Math.round(historyDb.backupProgress * 100))
+                : i18n("Back Up Now")
+            icon.name: "document-save"
+            enabled: historySwitch.checked && !historyDb.backupRunning
+            onClicked: historyDb.backupNow()
+        }
+
+        QQC2.Label {
+            id: backupStatusLabel
+            visible: text.length > 0
+            font.pointSize: Kirigami.Theme.smallFont.pointSize
+            opacity: 0.6
+            wrapMode: Text.WordWrap
+            Layout.fillWidth: true
+
+            Connections {
+                target: historyDb
+                function onBackupFinished(success, path, bytes, bytesPerSecond, error) {
+                    backupStatusLabel.text = success
+                        ? i18n("Saved %1 to %2 (%3/s)", formatBytes(bytes), path, formatBytes(Math.round(bytesPerSecond)))
+                        : i18n("Backup failed: %1", error);
+                }
+            }
+        }
+
         // Invisible timer to refresh the db size after pruning
         Timer {
             id: dbSizeRefreshTimer
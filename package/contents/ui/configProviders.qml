@@ -70,6 +70,9 @@ KCM.SimpleKCM {
     property string cfg_googleveoTier: "paid"
     property alias cfg_googleveoCustomBaseUrl: googleveoBaseUrlField.text
 
+    property alias cfg_meteringProxyEnabled: meteringProxySwitch.checked
+    property alias cfg_meteringProxyPort: meteringProxyPortSpin.value
+
     // Track whether the user has actually edited each key field
     property bool openaiKeyDirty: false
     property bool anthropicKeyDirty: false
@@ -1507,5 +1510,40 @@ KCM.SimpleKCM {
             wrapMode: Text.WordWrap
             Layout.fillWidth: true
         }
+
+        // ══════════════════════════════════════════════
+        // ── Metering Proxy ──
+        // ══════════════════════════════════════════════
+
+        Kirigami.Separator {
+            Kirigami.FormData.isSection: true
+            Kirigami.FormData.label: i18n("Metering Proxy")
+        }
+
+        QQC2.Switch {
+            id: meteringProxySwitch
+            Kirigami.FormData.label: i18n("Enable:")
+            checked: plasmoid.configuration.meteringProxyEnabled
+        }
+
+        QQC2.SpinBox {
+            id: meteringProxyPortSpin
+            Kirigami.FormData.label: i18n("Port:")
+            enabled: meteringProxySwitch.checked
+            from: 1024
+            to: 65535
+            value: plasmoid.configuration.meteringProxyPort
+            textFromValue: function(value) { return String(value); }
+            valueFromText: function(text) { return parseInt(text, 10); }
+        }
+
+        QQC2.Label {
+            text: i18n("Counts the exact tokens and cost of every request your own tools send through it. Point them at:\nOPENAI_BASE_URL=http://127.0.0.1:%1/openai/v1\nANTHROPIC_BASE_URL=http://127.0.0.1:%1/anthropic",
+                       meteringProxyPortSpin.value)
+            font.pointSize: Kirigami.Theme.smallFont.pointSize
+            opacity: 0.6
+            wrapMode: Text.WordWrap
+            Layout.fillWidth: true
+        }
     }
 }
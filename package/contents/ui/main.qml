@@ -80,6 +80,15 @@ PlasmoidItem {
         id: usageDatabase
         enabled: plasmoid.configuration.historyEnabled
         retentionDays: plasmoid.configuration.historyRetentionDays
+        backupIntervalHours: plasmoid.configuration.historyEnabled ? plasmoid.configuration.historyBackupIntervalHours : 0
+        backupKeepCount: plasmoid.configuration.historyBackupKeepCount
+    }
+
+    // Prune, ANALYZE, WAL checkpoint and vacuum in small slices while idle
+    MaintenanceScheduler {
+        id: maintenanceScheduler
+        database: usageDatabase
+        idle: !root.expanded && !root.anyProviderLoading
     }
 
     // ── C++ Provider Backends ──
@@ -89,6 +98,8 @@ PlasmoidItem {
         model: plasmoid.configuration.openaiModel
         projectId: plasmoid.configuration.openaiProjectId
         customBaseUrl: plasmoid.configuration.openaiCustomBaseUrl
+        // Closed billing days come from the local ledger instead of the API
+        ledger: usageDatabase
         dailyBudget: plasmoid.configuration.openaiDailyBudget / 100.0
         monthlyBudget: plasmoid.configuration.openaiMonthlyBudget / 100.0
         budgetWarningPercent: plasmoid.configuration.budgetWarningPercent
@@ -201,6 +212,19 @@ PlasmoidItem {
         customBaseUrl: plasmoid.configuration.loofiServerUrl
     }
 
+    // Local proxy that meters requests of the user's own OpenAI / Anthropic tools
+    UsageProxy {
+        id: usageProxy
+        enabled: plasmoid.configuration.meteringProxyEnabled
+        port: plasmoid.configuration.meteringProxyPort
+        database: usageDatabase
+
+        Component.onCompleted: {
+            setBackend("openai", openaiBackend);
+            setBackend("anthropic", anthropicBackend);
+        }
+    }
+
     // ── Subscription Tool Monitors ──
 
     // Browser cookie extractor for sync
@@ -210,15 +234,6 @@ PlasmoidItem {
         selectedFirefoxProfile: plasmoid.configuration.browserSyncProfile
     }
 
-    // Browser sync timer
-    Timer {
-        id: browserSyncTimer
-        interval: Math.max(60, plasmoid.configuration.browserSyncInterval) * 1000
-        running: plasmoid.configuration.browserSyncEnabled
-        repeat: true
-        onTriggered: performBrowserSync()
-    }
-
     ClaudeCodeMonitor {
         id: claudeCodeMonitor
         enabled: plasmoid.configuration.claudeCodeEnabled
@@ -383,152 +398,54 @@ PlasmoidItem {
     compactRepresentation: CompactRepresentation {}
     fullRepresentation: FullRepresentation {}
 
-    // ── Refresh Timers ──
+    // ── Refresh Scheduling ──
 
     // Helper to get effective interval for a provider (0 = use global)
     function effectiveInterval(providerInterval) {
         return (providerInterval > 0 ? providerInterval : plasmoid.configuration.refreshInterval) * 1000;
     }
 
-    function canRefreshBackend(backend, requiresApiKey) {
-        return backend && (!requiresApiKey || backend.hasApiKey());
-    }
-
-    // Per-provider refresh timers
-    Timer {
-        id: openaiRefreshTimer
-        interval: effectiveInterval(plasmoid.configuration.openaiRefreshInterval)
-        running: plasmoid.configuration.openaiEnabled
-        repeat: true
-        onTriggered: {
-            if (canRefreshBackend(openaiBackend, true)) openaiBackend.refresh();
-        }
-    }
-    Timer {
-        id: anthropicRefreshTimer
-        interval: effectiveInterval(plasmoid.configuration.anthropicRefreshInterval)
-        running: plasmoid.configuration.anthropicEnabled
-        repeat: true
-        onTriggered: {
-            if (canRefreshBackend(anthropicBackend, true)) anthropicBackend.refresh();
-        }
-    }
-    Timer {
-        id: googleRefreshTimer
-        interval: effectiveInterval(plasmoid.configuration.googleRefreshInterval)
-        running: plasmoid.configuration.googleEnabled
-        repeat: true
-        onTriggered: {
-            if (canRefreshBackend(googleBackend, true)) googleBackend.refresh();
-        }
-    }
-    Timer {
-        id: mistralRefreshTimer
-        interval: effectiveInterval(plasmoid.configuration.mistralRefreshInterval)
-        running: plasmoid.configuration.mistralEnabled
-        repeat: true
-        onTriggered: {
-            if (canRefreshBackend(mistralBackend, true)) mistralBackend.refresh();
-        }
-    }
-    Timer {
-        id: deepseekRefreshTimer
-        interval: effectiveInterval(plasmoid.configuration.deepseekRefreshInterval)
-        running: plasmoid.configuration.deepseekEnabled
-        repeat: true
-        onTriggered: {
-            if (canRefreshBackend(deepseekBackend, true)) deepseekBackend.refresh();
-        }
-    }
-    Timer {
-        id: groqRefreshTimer
-        interval: effectiveInterval(plasmoid.configuration.groqRefreshInterval)
-        running: plasmoid.configuration.groqEnabled
-        repeat: true
-        onTriggered: {
-            if (canRefreshBackend(groqBackend, true)) groqBackend.refresh();
-        }
-    }
-    Timer {
-        id: xaiRefreshTimer
-        interval: effectiveInterval(plasmoid.configuration.xaiRefreshInterval)
-        running: plasmoid.configuration.xaiEnabled
-        repeat: true
-        onTriggered: {
-            if (canRefreshBackend(xaiBackend, true)) xaiBackend.refresh();
-        }
-    }
-    Timer {
-        id: openrouterRefreshTimer
-        interval: effectiveInterval(plasmoid.configuration.openrouterRefreshInterval)
-        running: plasmoid.configuration.openrouterEnabled
-        repeat: true
-        onTriggered: {
-            if (canRefreshBackend(openrouterBackend, true)) openrouterBackend.refresh();
-        }
-    }
-    Timer {
-        id: togetherRefreshTimer
-        interval: effectiveInterval(plasmoid.configuration.togetherRefreshInterval)
-        running: plasmoid.configuration.togetherEnabled
-        repeat: true
-        onTriggered: {
-            if (canRefreshBackend(togetherBackend, true)) togetherBackend.refresh();
-        }
-    }
-    Timer {
-        id: cohereRefreshTimer
-        interval: effectiveInterval(plasmoid.configuration.cohereRefreshInterval)
-        running: plasmoid.configuration.cohereEnabled
-        repeat: true
-        onTriggered: {
-            if (canRefreshBackend(cohereBackend, true)) cohereBackend.refresh();
-        }
-    }
-    Timer {
-        id: googleveoRefreshTimer
-        interval: effectiveInterval(plasmoid.configuration.googleveoRefreshInterval)
-        running: plasmoid.configuration.googleveoEnabled
-        repeat: true
-        onTriggered: {
-            if (canRefreshBackend(googleveoBackend, true)) googleveoBackend.refresh();
-        }
-    }
-    Timer {
-        id: azureRefreshTimer
-        interval: effectiveInterval(plasmoid.configuration.azureRefreshInterval)
-        running: plasmoid.configuration.azureEnabled
-        repeat: true
-        onTriggered: {
-            if (canRefreshBackend(azureBackend, true)) azureBackend.refresh();
-        }
-    }
-    Timer {
-        id: loofiRefreshTimer
-        interval: effectiveInterval(plasmoid.configuration.loofiRefreshInterval)
-        running: plasmoid.configuration.loofiEnabled
-        repeat: true
-        onTriggered: {
-            if (canRefreshBackend(loofiBackend, false)) loofiBackend.refresh();
+    // One scheduler drives every provider refresh plus the browser-sync and
+    // Copilot org tasks; the entries binding re-evaluates on config changes.
+    // Battery / metered-connection state slows all polling down; while
+    // offline it pauses, and reconnecting refreshes in a staggered wave
+    SystemStateMonitor {
+        id: systemState
+    }
+
+    RefreshScheduler {
+        id: refreshScheduler
+        systemState: systemState
+        entries: {
+            var list = [];
+            for (var i = 0; i < root.allProviders.length; i++) {
+                var p = root.allProviders[i];
+                list.push({
+                    name: p.dbName,
+                    backend: p.backend,
+                    intervalMs: effectiveInterval(plasmoid.configuration[p.configKey + "RefreshInterval"]),
+                    enabled: p.enabled,
+                    requiresApiKey: p.requiresApiKey !== false
+                });
+            }
+            list.push({
+                name: "browserSync",
+                intervalMs: Math.max(60, plasmoid.configuration.browserSyncInterval) * 1000,
+                enabled: plasmoid.configuration.browserSyncEnabled
+            });
+            // Copilot org metrics refresh (runs once every hour)
+            list.push({
+                name: "copilotOrgMetrics",
+                intervalMs: 60 * 60 * 1000,
+                enabled: plasmoid.configuration.copilotEnabled && copilotMonitor.githubToken !== "" && copilotMonitor.orgName !== ""
+            });
+            return list;
         }
-    }
 
-    // Daily prune timer (runs once every 24h)
-    Timer {
-        id: pruneTimer
-        interval: 24 * 60 * 60 * 1000 // 24 hours
-        running: true
-        repeat: true
-        onTriggered: usageDatabase.pruneOldData()
-    }
-
-    // Copilot org metrics refresh (runs once every hour)
-    Timer {
-        id: copilotOrgTimer
-        interval: 60 * 60 * 1000 // 1 hour
-        running: plasmoid.configuration.copilotEnabled && copilotMonitor.githubToken !== "" && copilotMonitor.orgName !== ""
-        repeat: true
-        onTriggered: copilotMonitor.fetchOrgMetrics()
+        onTaskDue: function(name) {
+            if (name === "browserSync") performBrowserSync();
+            else if (name === "copilotOrgMetrics") copilotMonitor.fetchOrgMetrics();
+        }
     }
 
     // ── Context Menu Actions ──
@@ -537,7 +454,7 @@ PlasmoidItem {
         PlasmaCore.Action {
             text: i18n("Refresh All")
             icon.name: "view-refresh"
-            onTriggered: root.refreshAll()
+            onTriggered: root.refreshAll(true)
         }
     ]
 
@@ -581,6 +498,13 @@ PlasmoidItem {
         return count;
     }
 
+    readonly property bool anyProviderLoading: {
+        for (var i = 0; i < allProviders.length; i++) {
+            if (allProviders[i].enabled && allProviders[i].backend.loading) return true;
+        }
+        return false;
+    }
+
     readonly property double totalCost: {
         var total = 0;
         for (var i = 0; i < allProviders.length; i++) {
@@ -607,13 +531,17 @@ PlasmoidItem {
         return value.toString();
     }
 
-    function refreshAll() {
-        for (var i = 0; i < allProviders.length; i++) {
-            var provider = allProviders[i];
-            if (provider.enabled && canRefreshBackend(provider.backend, provider.requiresApiKey !== false)) {
-                allProviders[i].backend.refresh();
+    function refreshAll(explicit) {
+        // A refresh the user asked for fetches every endpoint, including
+        // those whose TTL has not run out yet
+        if (explicit) {
+            for (var i = 0; i < allProviders.length; i++) {
+                if (allProviders[i].enabled) allProviders[i].backend.invalidateEndpoints();
             }
         }
+        // Goes through the scheduler so startup and "Refresh All" respect
+        // its concurrency cap; it skips disabled providers and missing keys.
+        refreshScheduler.refreshAll();
     }
 
     function loadApiKeys() {
@@ -643,6 +571,9 @@ PlasmoidItem {
             backend.rateLimitTokens,
             backend.rateLimitTokensRemaining
         );
+        if (plasmoid.configuration.historyRecordLatency) {
+            usageDatabase.recordNetworkStats(providerName, backend.networkStats());
+        }
     }
 
     // Connect common signal handlers for all providers (avoids 7× copy-paste)
@@ -873,8 +804,6 @@ PlasmoidItem {
         }
         // Eagerly initialize database (avoids blocking on first write)
         usageDatabase.init();
-        // Initial prune of old data
-        usageDatabase.pruneOldData();
         // Initial browser sync after a short delay
         if (plasmoid.configuration.browserSyncEnabled) {
             initialSyncTimer.start();
@@ -921,9 +850,8 @@ PlasmoidItem {
         function onAzureDeploymentIdChanged() { azureBackend.deploymentId = plasmoid.configuration.azureDeploymentId; }
 
         function onRefreshIntervalChanged() {
-            // The per-provider Timer declarations use declarative bindings
-            // on effectiveInterval(), so they auto-update when the global
-            // refreshInterval changes.  No imperative re-assignment needed.
+            // refreshScheduler.entries binds to effectiveInterval(), so the
+            // schedule picks up the new global refreshInterval by itself.
         }
 
         // Subscription tool config changes
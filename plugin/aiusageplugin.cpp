@@ -14,7 +14,13 @@
 #include "togetherprovider.h"
 #include "cohereprovider.h"
 #include "googleveoprovider.h"
+#include "provideraccountgroup.h"
 #include "usagedatabase.h"
+#include "usageproxy.h"
+#include "snapshotcursor.h"
+#include "maintenancescheduler.h"
+#include "refreshscheduler.h"
+#include "systemstatemonitor.h"
 #include "clipboardhelper.h"
 #include "updatechecker.h"
 #include "subscriptiontoolbackend.h"
@@ -23,6 +29,7 @@
 #include "copilotmonitor.h"
 #include "browsercookieextractor.h"
 #include "loofiserverprovider.h"
+#include "sharednetworkmanager.h"
 
 #include <QQmlEngine>
 #include <QJSEngine>
@@ -36,6 +43,14 @@ void AiUsagePlugin::registerTypes(const char *uri)
             return new AppInfo();
         });
 
+    // The shared network manager is process-wide; QML only observes it
+    qmlRegisterSingletonType<SharedNetworkManager>(uri, 1, 0, "NetworkStats",
+        [](QQmlEngine *, QJSEngine *) -> QObject * {
+            SharedNetworkManager *manager = SharedNetworkManager::instance();
+            QQmlEngine::setObjectOwnership(manager, QQmlEngine::CppOwnership);
+            return manager;
+        });
+
     // Register C++ types for use in QML
     qmlRegisterType<SecretsManager>(uri, 1, 0, "SecretsManager");
     qmlRegisterType<OpenAIProvider>(uri, 1, 0, "OpenAIProvider");
@@ -50,7 +65,12 @@ void AiUsagePlugin::registerTypes(const char *uri)
     qmlRegisterType<TogetherProvider>(uri, 1, 0, "TogetherProvider");
     qmlRegisterType<CohereProvider>(uri, 1, 0, "CohereProvider");
     qmlRegisterType<GoogleVeoProvider>(uri, 1, 0, "GoogleVeoProvider");
+    qmlRegisterType<ProviderAccountGroup>(uri, 1, 0, "ProviderAccountGroup");
     qmlRegisterType<UsageDatabase>(uri, 1, 0, "UsageDatabase");
+    qmlRegisterType<UsageProxy>(uri, 1, 0, "UsageProxy");
+    qmlRegisterType<MaintenanceScheduler>(uri, 1, 0, "MaintenanceScheduler");
+    qmlRegisterType<RefreshScheduler>(uri, 1, 0, "RefreshScheduler");
+    qmlRegisterType<SystemStateMonitor>(uri, 1, 0, "SystemStateMonitor");
     qmlRegisterType<ClipboardHelper>(uri, 1, 0, "ClipboardHelper");
     qmlRegisterType<UpdateChecker>(uri, 1, 0, "UpdateChecker");
 
@@ -70,4 +90,6 @@ void AiUsagePlugin::registerTypes(const char *uri)
         QStringLiteral("ProviderBackend is abstract; use a specific provider type."));
     qmlRegisterUncreatableType<SubscriptionToolBackend>(uri, 1, 0, "SubscriptionToolBackend",
         QStringLiteral("SubscriptionToolBackend is abstract; use a specific monitor type."));
+    qmlRegisterUncreatableType<SnapshotCursor>(uri, 1, 0, "SnapshotCursor",
+        QStringLiteral("SnapshotCursor is created by UsageDatabase.openSnapshotCursor()."));
 }
@@ -6,17 +6,6 @@
 AnthropicProvider::AnthropicProvider(QObject *parent)
     : ProviderBackend(parent)
 {
-    // Register model pricing ($ per 1M tokens) — Anthropic pricing as of 2026
-    registerModelPricing(QStringLiteral("claude-sonnet-4-20250514"), 3.0, 15.0);
-    registerModelPricing(QStringLiteral("claude-opus-4-20250514"), 15.0, 75.0);
-    registerModelPricing(QStringLiteral("claude-haiku-4-20250514"), 0.80, 4.0);
-    registerModelPricing(QStringLiteral("claude-3-7-sonnet"), 3.0, 15.0);
-    registerModelPricing(QStringLiteral("claude-3-5-sonnet"), 3.0, 15.0);
-    registerModelPricing(QStringLiteral("claude-3-5-sonnet-20241022"), 3.0, 15.0);
-    registerModelPricing(QStringLiteral("claude-3-5-haiku"), 0.80, 4.0);
-    registerModelPricing(QStringLiteral("claude-3-5-haiku-20241022"), 0.80, 4.0);
-    registerModelPricing(QStringLiteral("claude-3-opus"), 15.0, 75.0);
-    registerModelPricing(QStringLiteral("claude-3-haiku"), 0.25, 1.25);
 }
 
 QString AnthropicProvider::model() const { return m_model; }
@@ -36,7 +25,8 @@ void AnthropicProvider::refresh()
         return;
     }
 
-    beginRefresh();
+    if (!beginRefresh())
+        return;
     setLoading(true);
     clearError();
     fetchRateLimits();
@@ -124,6 +114,11 @@ void AnthropicProvider::onCountTokensReply(QNetworkReply *reply)
         setRateLimitTokensRemaining(tokenRemaining);
     }
 
+    QString tokenReset = QString::fromUtf8(reply->rawHeader("anthropic-ratelimit-tokens-reset"));
+    if (tokenReset.isEmpty())
+        tokenReset = QString::fromUtf8(reply->rawHeader("anthropic-ratelimit-input-tokens-reset"));
+    observeRateLimits(reqLimit, reqRemaining, reqReset, tokenLimit, tokenRemaining, tokenReset);
+
     if (!reqReset.isEmpty()) {
         // Parse RFC 3339 timestamp to a readable time
         QDateTime resetDt = QDateTime::fromString(reqReset, Qt::ISODate);
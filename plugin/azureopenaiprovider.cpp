@@ -1,4 +1,5 @@
 #include "azureopenaiprovider.h"
+#include "costmicros.h"
 
 #include <KLocalizedString>
 #include <QDebug>
@@ -11,13 +12,6 @@
 AzureOpenAIProvider::AzureOpenAIProvider(QObject *parent)
     : ProviderBackend(parent)
 {
-    // Approximate Azure OpenAI pricing parity with OpenAI list pricing (2026 baseline).
-    registerModelPricing(QStringLiteral("gpt-4o"), 2.50, 10.00);
-    registerModelPricing(QStringLiteral("gpt-4o-mini"), 0.15, 0.60);
-    registerModelPricing(QStringLiteral("gpt-4.1"), 2.00, 8.00);
-    registerModelPricing(QStringLiteral("gpt-4.1-mini"), 0.40, 1.60);
-    registerModelPricing(QStringLiteral("o3"), 2.00, 8.00);
-    registerModelPricing(QStringLiteral("o4-mini"), 1.10, 4.40);
 }
 
 QString AzureOpenAIProvider::model() const
@@ -103,13 +97,45 @@ void AzureOpenAIProvider::refresh()
         return;
     }
 
-    beginRefresh();
+    if (!beginRefresh())
+        return;
     setLoading(true);
     clearError();
 
+    // Deployment limits are only reported on inference calls, so the model
+    // list and HEAD strategies have nothing to offer here
+    for (ProbeStrategy strategy : probeOrder()) {
+        const bool answeredLocally = (strategy == ProbeStrategy::CachedHeaders && hasFreshRateLimitHeaders())
+            || (strategy == ProbeStrategy::Predicted && rateLimitModelPredictsNoChange());
+        if (answeredLocally) {
+            recordProbe(strategy);
+            setLoading(false);
+            updateLastRefreshed();
+            Q_EMIT dataUpdated();
+            return;
+        }
+        if (strategy == ProbeStrategy::ChatCompletion) {
+            sendCompletionProbe();
+            return;
+        }
+    }
+
+    // No applicable strategy configured: keep the limits we already have
+    setLoading(false);
+    updateLastRefreshed();
+    Q_EMIT dataUpdated();
+}
+
+QList<ProviderBackend::ProbeStrategy> AzureOpenAIProvider::defaultProbeOrder() const
+{
+    return {ProbeStrategy::CachedHeaders, ProbeStrategy::ChatCompletion};
+}
+
+void AzureOpenAIProvider::sendCompletionProbe()
+{
     QUrl url = completionUrl();
     QNetworkRequest request(url);
-    request.setTransferTimeout(REQUEST_TIMEOUT_MS);
+    request.setTransferTimeout(requestTimeoutMs(url));
     request.setRawHeader("Content-Type", "application/json");
     request.setRawHeader("api-key", apiKey().toUtf8());
 
@@ -130,6 +156,7 @@ void AzureOpenAIProvider::refresh()
 
     m_lastRequestBody = QJsonDocument(payload).toJson(QJsonDocument::Compact);
 
+    startProbeTimer();
     int gen = currentGeneration();
     QNetworkReply *reply = networkManager()->post(request, m_lastRequestBody);
     trackReply(reply);
@@ -148,7 +175,7 @@ void AzureOpenAIProvider::onCompletionReply(QNetworkReply *reply)
     if (reply->error() != QNetworkReply::NoError) {
         const int httpStatus = reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
 
-        if (isRetryableStatus(httpStatus)) {
+        if (shouldRetry(reply)) {
             retryRequest(reply, reply->url(), m_lastRequestBody,
                          [this](QNetworkReply *r) { onCompletionReply(r); });
             return;
@@ -189,6 +216,8 @@ void AzureOpenAIProvider::onCompletionReply(QNetworkReply *reply)
     const QJsonObject root = doc.object();
     const ProviderBackend::NormalizedUsageCost normalized =
         ProviderBackend::normalizeUsageCost(ProviderBackend::ProviderId::AzureOpenAI, root);
+    const qint64 inputBefore = m_sessionInputTokens;
+    const qint64 outputBefore = m_sessionOutputTokens;
 
     if (normalized.parsed) {
         m_sessionInputTokens += normalized.inputTokens;
@@ -213,24 +242,33 @@ void AzureOpenAIProvider::onCompletionReply(QNetworkReply *reply)
     setOutputTokens(m_sessionOutputTokens);
     setRequestCount(m_sessionRequestCount);
 
+    // What this probe itself cost
+    recordProbe(ProbeStrategy::ChatCompletion,
+                normalized.parsed && normalized.cost > 0.0
+                    ? CostMicros::fromDollars(normalized.cost)
+                    : estimatedCostMicros(m_model, m_sessionInputTokens - inputBefore,
+                                          m_sessionOutputTokens - outputBefore));
+
     if (normalized.parsed && normalized.cost > 0.0) {
-        m_sessionTotalCost += normalized.cost;
-        setCost(m_sessionTotalCost);
+        // Accumulate in micro-dollars so long sessions cannot drift
+        const qint64 costMicros = CostMicros::fromDollars(normalized.cost);
+        m_sessionTotalCostMicros += costMicros;
+        setCostMicros(m_sessionTotalCostMicros);
 
         if (normalized.dailyCost > 0.0) {
-            m_sessionDailyCost += normalized.dailyCost;
+            m_sessionDailyCostMicros += CostMicros::fromDollars(normalized.dailyCost);
         } else {
-            m_sessionDailyCost += normalized.cost;
+            m_sessionDailyCostMicros += costMicros;
         }
 
         if (normalized.monthlyCost > 0.0) {
-            m_sessionMonthlyCost += normalized.monthlyCost;
+            m_sessionMonthlyCostMicros += CostMicros::fromDollars(normalized.monthlyCost);
         } else {
-            m_sessionMonthlyCost += normalized.cost;
+            m_sessionMonthlyCostMicros += costMicros;
         }
 
-        setDailyCost(m_sessionDailyCost);
-        setMonthlyCost(m_sessionMonthlyCost);
+        setDailyCostMicros(m_sessionDailyCostMicros);
+        setMonthlyCostMicros(m_sessionMonthlyCostMicros);
     } else {
         updateEstimatedCost(m_model);
     }
@@ -11,7 +11,9 @@
  *
  * Notes:
  * - Authentication uses `api-key` header (not Bearer token)
- * - Rate limit headers are parsed from x-ratelimit-*
+ * - Rate limit headers are parsed from x-ratelimit-*; deployments only
+ *   report them on completions, so the probe order is cached headers,
+ *   then a one-token completion
  * - Usage tokens are parsed from the completion response body
  * - Cost is estimated from token usage via model pricing table
  */
@@ -40,6 +42,9 @@ public:
 
     Q_INVOKABLE void refresh() override;
 
+protected:
+    QList<ProbeStrategy> defaultProbeOrder() const override;
+
 Q_SIGNALS:
     void modelChanged();
     void deploymentIdChanged();
@@ -49,6 +54,7 @@ private Q_SLOTS:
     void onCompletionReply(QNetworkReply *reply);
 
 private:
+    void sendCompletionProbe();
     QString endpointBaseUrl() const;
     QUrl completionUrl() const;
 
@@ -60,11 +66,9 @@ private:
     qint64 m_sessionInputTokens = 0;
     qint64 m_sessionOutputTokens = 0;
     int m_sessionRequestCount = 0;
-    double m_sessionTotalCost = 0.0;
-    double m_sessionDailyCost = 0.0;
-    double m_sessionMonthlyCost = 0.0;
-
-    static constexpr int REQUEST_TIMEOUT_MS = 30000;
+    qint64 m_sessionTotalCostMicros = 0;
+    qint64 m_sessionDailyCostMicros = 0;
+    qint64 m_sessionMonthlyCostMicros = 0;
 };
 
 #endif // AZUREOPENAIPROVIDER_H
@@ -0,0 +1,54 @@
+#ifndef COSTMICROS_H
+#define COSTMICROS_H
+
+#include <QString>
+#include <QtGlobal>
+
+#include <cmath>
+
+/**
+ * Fixed-point cost amounts in micro-dollars (1 USD = 1,000,000).
+ *
+ * Costs are kept as qint64 everywhere they are stored, summed or compared,
+ * so repeated accumulation cannot drift and SQLite can aggregate them with
+ * integer SUM/MAX. Conversion to double happens only where a value leaves
+ * C++ (QML properties, chart points, signal arguments).
+ */
+namespace CostMicros {
+
+constexpr qint64 PER_DOLLAR = 1000000;
+
+/// Round a dollar amount from an API payload or QML to micro-dollars.
+inline qint64 fromDollars(double dollars)
+{
+    if (!std::isfinite(dollars))
+        return 0;
+    return qRound64(dollars * PER_DOLLAR);
+}
+
+inline double toDollars(qint64 micros)
+{
+    return static_cast<double>(micros) / PER_DOLLAR;
+}
+
+/// Exact decimal representation with six fractional digits, e.g. "-1.250000".
+inline QString toDecimalString(qint64 micros)
+{
+    const bool negative = micros < 0;
+    // Work on the unsigned magnitude so INT64_MIN cannot overflow
+    const quint64 magnitude = negative ? 0 - static_cast<quint64>(micros) : static_cast<quint64>(micros);
+    return QStringLiteral("%1%2.%3")
+        .arg(negative ? QStringLiteral("-") : QString())
+        .arg(magnitude / PER_DOLLAR)
+        .arg(magnitude % PER_DOLLAR, 6, 10, QLatin1Char('0'));
+}
+
+/// True when amount is at least percent% of limit, compared without rounding.
+inline bool reachesPercent(qint64 amount, qint64 limit, int percent)
+{
+    return amount * 100 >= limit * percent;
+}
+
+} // namespace CostMicros
+
+#endif // COSTMICROS_H
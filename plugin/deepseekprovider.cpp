@@ -1,5 +1,4 @@
 #include "deepseekprovider.h"
-#include <KLocalizedString>
 #include <QNetworkRequest>
 #include <QDebug>
 
@@ -9,28 +8,16 @@ DeepSeekProvider::DeepSeekProvider(QObject *parent)
     // Set default model
     setModel(QStringLiteral("deepseek-chat"));
 
-    // Register model pricing ($ per 1M tokens) — DeepSeek pricing as of 2026
-    registerModelPricing(QStringLiteral("deepseek-chat"), 0.14, 0.28);
-    registerModelPricing(QStringLiteral("deepseek-coder"), 0.14, 0.28);
-    registerModelPricing(QStringLiteral("deepseek-reasoner"), 0.55, 2.19);
+    // The balance only moves as fast as spending does
+    declareEndpoint(QStringLiteral("balance"), BALANCE_TTL_MS);
 }
 
 double DeepSeekProvider::balance() const { return m_balance; }
 
-void DeepSeekProvider::refresh()
+void DeepSeekProvider::fetchAdditionalData()
 {
-    if (!hasApiKey()) {
-        setError(i18n("No API key configured"));
-        setConnected(false);
-        return;
-    }
-
-    // Call parent's refresh which sets loading, clears error,
-    // resets pending count, and kicks off chat completion request
-    OpenAICompatibleProvider::refresh();
-
-    // Additionally fetch the balance (adds to pending count)
-    fetchBalance();
+    if (endpointDue(QStringLiteral("balance")))
+        fetchBalance();
 }
 
 void DeepSeekProvider::fetchBalance()
@@ -38,11 +25,11 @@ void DeepSeekProvider::fetchBalance()
     // DeepSeek has a balance endpoint
     QUrl url(QStringLiteral("%1/user/balance").arg(effectiveBaseUrl(defaultBaseUrl())));
 
-    QNetworkRequest request = createRequest(url);
+    QNetworkRequest request = createCachedRequest(url);
 
     addPendingRequest();
     int gen = currentGeneration();
-    QNetworkReply *reply = networkManager()->get(request);
+    QNetworkReply *reply = sendGet(request);
     trackReply(reply);
     connect(reply, &QNetworkReply::finished, this, [this, reply, gen]() {
         if (!isCurrentGeneration(gen)) { reply->deleteLater(); return; }
@@ -62,8 +49,7 @@ void DeepSeekProvider::onBalanceReply(QNetworkReply *reply)
         return;
     }
 
-    QByteArray data = reply->readAll();
-    QJsonDocument doc = QJsonDocument::fromJson(data);
+    QJsonDocument doc = readJsonReply(reply);
     if (!doc.isNull()) {
         QJsonObject root = doc.object();
         // DeepSeek balance response: { "is_available": true, "balance_infos": [...] }
@@ -89,6 +75,7 @@ void DeepSeekProvider::onBalanceReply(QNetworkReply *reply)
         // Store remaining balance separately — this is NOT spending
         m_balance = totalBalance;
         Q_EMIT balanceChanged();
+        markEndpointFresh(QStringLiteral("balance"));
     }
 
     onAllRequestsDone();
@@ -9,7 +9,8 @@
  * Uses OpenAI-compatible API at api.deepseek.com.
  * - Rate limit info from response headers (x-ratelimit-*)
  * - Usage data from chat completion response body
- * - Balance from GET /user/balance endpoint
+ * - Balance from GET /user/balance endpoint, at most every 15 minutes
+ *   (endpoint "balance")
  *
  * Models: deepseek-chat, deepseek-reasoner
  */
@@ -27,13 +28,12 @@ public:
 
     double balance() const;
 
-    Q_INVOKABLE void refresh() override;
-
 Q_SIGNALS:
     void balanceChanged();
 
 protected:
     const char *defaultBaseUrl() const override { return BASE_URL; }
+    void fetchAdditionalData() override;
 
 private Q_SLOTS:
     void onBalanceReply(QNetworkReply *reply);
@@ -43,6 +43,8 @@ private:
 
     double m_balance = 0.0;
 
+    static constexpr qint64 BALANCE_TTL_MS = 15 * 60 * 1000;
+
     static constexpr const char *BASE_URL = "https://api.deepseek.com";
 };
 
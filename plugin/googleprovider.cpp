@@ -7,14 +7,6 @@
 GoogleProvider::GoogleProvider(QObject *parent)
     : ProviderBackend(parent)
 {
-    // Register model pricing ($ per 1M tokens) — Google Gemini pricing as of 2026
-    // Free tier models are $0; paid tier prices listed here
-    registerModelPricing(QStringLiteral("gemini-2.5-pro"), 1.25, 10.0);
-    registerModelPricing(QStringLiteral("gemini-2.5-flash"), 0.15, 0.60);
-    registerModelPricing(QStringLiteral("gemini-2.0-flash"), 0.10, 0.40);
-    registerModelPricing(QStringLiteral("gemini-2.0-flash-lite"), 0.075, 0.30);
-    registerModelPricing(QStringLiteral("gemini-1.5-pro"), 1.25, 5.0);
-    registerModelPricing(QStringLiteral("gemini-1.5-flash"), 0.075, 0.30);
 }
 
 QString GoogleProvider::model() const { return m_model; }
@@ -43,7 +35,8 @@ void GoogleProvider::refresh()
         return;
     }
 
-    beginRefresh();
+    if (!beginRefresh())
+        return;
     setLoading(true);
     clearError();
     fetchStatus();
@@ -45,13 +45,8 @@ double modelCostPerSecond(const QString &model)
 GoogleVeoProvider::GoogleVeoProvider(QObject *parent)
     : ProviderBackend(parent)
 {
-    // Veo pricing — per-video cost mapped to per-1M-token equivalents
-    // for the cost estimation framework.
-    // Veo 3: ~$0.50/sec generated video
-    // Veo 2: ~$0.35/sec generated video
-    // We register token-based placeholders; actual cost depends on video duration.
-    registerModelPricing(QStringLiteral("veo-3"), 50.0, 50.0);
-    registerModelPricing(QStringLiteral("veo-2"), 35.0, 35.0);
+    // Model metadata is static; re-check connectivity only occasionally
+    declareEndpoint(QStringLiteral("model-info"), MODEL_INFO_TTL_MS);
 }
 
 QString GoogleVeoProvider::model() const { return m_model; }
@@ -59,6 +54,7 @@ void GoogleVeoProvider::setModel(const QString &model)
 {
     if (m_model != model) {
         m_model = model;
+        invalidateEndpoints();
         Q_EMIT modelChanged();
     }
 }
@@ -68,6 +64,7 @@ void GoogleVeoProvider::setTier(const QString &tier)
 {
     if (m_tier != tier) {
         m_tier = tier;
+        invalidateEndpoints();
         Q_EMIT tierChanged();
     }
 }
@@ -80,7 +77,14 @@ void GoogleVeoProvider::refresh()
         return;
     }
 
-    beginRefresh();
+    // Nothing to fetch; the previous answer still stands and is reported again
+    if (!endpointDue(QStringLiteral("model-info"))) {
+        Q_EMIT dataUpdated();
+        return;
+    }
+
+    if (!beginRefresh())
+        return;
     setLoading(true);
     clearError();
     fetchModelInfo();
@@ -101,7 +105,7 @@ void GoogleVeoProvider::fetchModelInfo()
     request.setRawHeader("Authorization", QByteArray());
 
     int gen = currentGeneration();
-    QNetworkReply *reply = networkManager()->get(request);
+    QNetworkReply *reply = sendGet(request);
     trackReply(reply);
     connect(reply, &QNetworkReply::finished, this, [this, reply, gen]() {
         if (!isCurrentGeneration(gen)) { reply->deleteLater(); return; }
@@ -176,8 +180,8 @@ void GoogleVeoProvider::onModelInfoReply(QNetworkReply *reply)
             } else {
                 setCost(0.0);
                 updateEstimatedCost(m_model);
-                setDailyCost(cost());
-                setMonthlyCost(cost());
+                setDailyCostMicros(costMicros());
+                setMonthlyCostMicros(costMicros());
             }
         }
     } else {
@@ -191,6 +195,7 @@ void GoogleVeoProvider::onModelInfoReply(QNetworkReply *reply)
     }
 
     setConnected(true);
+    markEndpointFresh(QStringLiteral("model-info"));
     setLoading(false);
     updateLastRefreshed();
     Q_EMIT dataUpdated();
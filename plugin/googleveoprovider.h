@@ -11,7 +11,10 @@
  *
  * Similar to GoogleProvider but tracks Veo video-generation models.
  * Uses a lightweight GET /v1beta/models/{model} call to verify
- * API key validity and connectivity.
+ * API key validity and connectivity. The model metadata does not change
+ * between polls, so the call is repeated at most hourly (endpoint
+ * "model-info"); refreshes in between report the previous values again.
+ * An explicit requestRefresh(true) checks right away.
  *
  * Rate limits are applied from known Google documentation values.
  *
@@ -52,6 +55,8 @@ private:
     QString m_model = QStringLiteral("veo-3");
     QString m_tier = QStringLiteral("paid");
 
+    static constexpr qint64 MODEL_INFO_TTL_MS = 60 * 60 * 1000;
+
     static constexpr const char *BASE_URL = "https://generativelanguage.googleapis.com/v1beta";
 };
 
@@ -28,7 +28,8 @@ QString LoofiServerProvider::serverUrl() const
 
 void LoofiServerProvider::refresh()
 {
-    beginRefresh();
+    if (!beginRefresh())
+        return;
     setLoading(true);
     clearError();
 
@@ -42,7 +43,7 @@ void LoofiServerProvider::refresh()
     }
 
     const int gen = currentGeneration();
-    QNetworkReply *reply = networkManager()->get(req);
+    QNetworkReply *reply = sendGet(req);
     trackReply(reply);
 
     connect(reply, &QNetworkReply::finished, this, [this, reply, gen]() {
@@ -0,0 +1,234 @@
+#include "maintenancescheduler.h"
+#include "usagedatabase.h"
+
+#include <QDebug>
+#include <QElapsedTimer>
+
+#include <limits>
+
+MaintenanceScheduler::MaintenanceScheduler(QObject *parent)
+    : QObject(parent)
+{
+    m_dueTimer.setSingleShot(true);
+    connect(&m_dueTimer, &QTimer::timeout, this, &MaintenanceScheduler::onDueTimeout);
+
+    m_sliceTimer.setSingleShot(true);
+    m_sliceTimer.setInterval(SLICE_GAP_MS);
+    connect(&m_sliceTimer, &QTimer::timeout, this, &MaintenanceScheduler::runSlice);
+}
+
+// ── Properties ──
+
+UsageDatabase *MaintenanceScheduler::database() const { return m_database; }
+void MaintenanceScheduler::setDatabase(UsageDatabase *database)
+{
+    if (m_database == database)
+        return;
+
+    m_database = database;
+    Q_EMIT databaseChanged();
+
+    if (m_database && !m_running && !m_dueTimer.isActive()) {
+        scheduleNextPass(STARTUP_DELAY_MS);
+    }
+}
+
+bool MaintenanceScheduler::isIdle() const { return m_idle; }
+void MaintenanceScheduler::setIdle(bool idle)
+{
+    if (m_idle == idle)
+        return;
+
+    m_idle = idle;
+    Q_EMIT idleChanged();
+
+    if (m_idle) {
+        scheduleSlice();
+    } else {
+        // The current slice (if any) has already finished; just stop the next one.
+        m_sliceTimer.stop();
+    }
+}
+
+int MaintenanceScheduler::intervalHours() const { return m_intervalHours; }
+void MaintenanceScheduler::setIntervalHours(int hours)
+{
+    hours = qBound(1, hours, 24 * 7);
+    if (m_intervalHours == hours)
+        return;
+
+    m_intervalHours = hours;
+    Q_EMIT intervalHoursChanged();
+
+    if (!m_running && m_lastRun.isValid()) {
+        const qint64 elapsedMs = m_lastRun.msecsTo(QDateTime::currentDateTimeUtc());
+        scheduleNextPass(qint64(m_intervalHours) * 3600 * 1000 - elapsedMs);
+    }
+}
+
+int MaintenanceScheduler::sliceBudgetMs() const { return m_sliceBudgetMs; }
+void MaintenanceScheduler::setSliceBudgetMs(int ms)
+{
+    ms = qBound(1, ms, 1000);
+    if (m_sliceBudgetMs != ms) {
+        m_sliceBudgetMs = ms;
+        Q_EMIT sliceBudgetMsChanged();
+    }
+}
+
+bool MaintenanceScheduler::isRunning() const { return m_running; }
+QDateTime MaintenanceScheduler::lastRun() const { return m_lastRun; }
+QVariantList MaintenanceScheduler::lastReport() const { return m_lastReport; }
+
+void MaintenanceScheduler::runNow()
+{
+    m_dueTimer.stop();
+    onDueTimeout();
+}
+
+// ── Scheduling ──
+
+QString MaintenanceScheduler::taskName(Task task)
+{
+    switch (task) {
+    case Task::Prune:
+        return QStringLiteral("prune");
+    case Task::Optimize:
+        return QStringLiteral("optimize");
+    case Task::Checkpoint:
+        return QStringLiteral("checkpoint");
+    case Task::Vacuum:
+        return QStringLiteral("vacuum");
+    case Task::Done:
+        break;
+    }
+    return QString();
+}
+
+void MaintenanceScheduler::scheduleNextPass(qint64 delayMs)
+{
+    // QTimer takes an int; clamp so long intervals cannot overflow.
+    m_dueTimer.start(int(qBound<qint64>(0, delayMs, std::numeric_limits<int>::max())));
+}
+
+void MaintenanceScheduler::onDueTimeout()
+{
+    if (m_running)
+        return;
+
+    m_task = Task::Prune;
+    for (TaskStats &stats : m_stats) {
+        stats = TaskStats();
+    }
+    setRunning(true);
+    scheduleSlice();
+}
+
+void MaintenanceScheduler::scheduleSlice()
+{
+    if (m_running && m_idle && !m_sliceTimer.isActive()) {
+        m_sliceTimer.start();
+    }
+}
+
+void MaintenanceScheduler::runSlice()
+{
+    if (!m_running || !m_idle)
+        return;
+
+    if (!m_database) {
+        qWarning() << "MaintenanceScheduler: No database set, skipping maintenance";
+        m_task = Task::Done;
+        finishPass();
+        return;
+    }
+
+    QElapsedTimer budget;
+    budget.start();
+
+    // Keep stepping until the budget is spent. A single step may overrun
+    // (e.g. PRAGMA optimize), but never starts once the budget is gone.
+    bool touched[static_cast<int>(Task::Done)] = {};
+    while (m_task != Task::Done && !budget.hasExpired(m_sliceBudgetMs)) {
+        TaskStats &stats = m_stats[static_cast<int>(m_task)];
+        touched[static_cast<int>(m_task)] = true;
+
+        QElapsedTimer stepTimer;
+        stepTimer.start();
+        const bool taskFinished = runStep(m_task, stats);
+        stats.durationMs += stepTimer.elapsed();
+
+        if (taskFinished) {
+            m_task = static_cast<Task>(static_cast<int>(m_task) + 1);
+        }
+    }
+
+    for (int i = 0; i < static_cast<int>(Task::Done); ++i) {
+        if (touched[i])
+            ++m_stats[i].slices;
+    }
+
+    if (m_task == Task::Done) {
+        finishPass();
+    } else {
+        scheduleSlice();
+    }
+}
+
+bool MaintenanceScheduler::runStep(Task task, TaskStats &stats)
+{
+    switch (task) {
+    case Task::Prune: {
+        bool more = false;
+        stats.rows += m_database->pruneOldDataBatch(PRUNE_BATCH_ROWS, &more);
+        return !more;
+    }
+    case Task::Optimize:
+        m_database->optimize();
+        return true;
+    case Task::Checkpoint:
+        m_database->checkpointWal();
+        return true;
+    case Task::Vacuum: {
+        // Left alone until the user runs the one-time conversion
+        if (m_database->needsVacuumConversion())
+            return true;
+        const int remaining = m_database->incrementalVacuum(VACUUM_BATCH_PAGES);
+        stats.rows = qMax(0, remaining);
+        return remaining <= 0;
+    }
+    case Task::Done:
+        break;
+    }
+    return true;
+}
+
+void MaintenanceScheduler::finishPass()
+{
+    m_sliceTimer.stop();
+
+    QVariantList report;
+    for (int i = 0; i < static_cast<int>(Task::Done); ++i) {
+        QVariantMap entry;
+        entry[QStringLiteral("task")] = taskName(static_cast<Task>(i));
+        entry[QStringLiteral("durationMs")] = m_stats[i].durationMs;
+        entry[QStringLiteral("slices")] = m_stats[i].slices;
+        entry[QStringLiteral("rows")] = m_stats[i].rows;
+        report.append(entry);
+    }
+
+    m_lastRun = QDateTime::currentDateTimeUtc();
+    m_lastReport = report;
+    setRunning(false);
+    scheduleNextPass(qint64(m_intervalHours) * 3600 * 1000);
+
+    Q_EMIT maintenanceFinished(m_lastReport);
+}
+
+void MaintenanceScheduler::setRunning(bool running)
+{
+    if (m_running != running) {
+        m_running = running;
+        Q_EMIT runningChanged();
+    }
+}
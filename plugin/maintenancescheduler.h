@@ -0,0 +1,124 @@
+#ifndef MAINTENANCESCHEDULER_H
+#define MAINTENANCESCHEDULER_H
+
+#include <QObject>
+#include <QDateTime>
+#include <QPointer>
+#include <QTimer>
+#include <QVariantList>
+
+#include "usagedatabase.h"
+
+/**
+ * Runs periodic database housekeeping (prune, PRAGMA optimize, WAL
+ * checkpoint, incremental vacuum) in short time-budgeted slices.
+ *
+ * Slices only run while `idle` is true, so QML binds it to "popup closed
+ * and no refresh in flight". A pass that is interrupted resumes where it
+ * stopped the next time the applet becomes idle. Databases created before
+ * incremental auto-vacuum skip the vacuum task until the user runs
+ * UsageDatabase::convertToIncrementalVacuum().
+ *
+ * Usage from QML:
+ *   MaintenanceScheduler {
+ *       database: usageDatabase
+ *       idle: !root.expanded && !root.anyProviderLoading
+ *       onMaintenanceFinished: (report) => { ... }
+ *   }
+ */
+class MaintenanceScheduler : public QObject
+{
+    Q_OBJECT
+    Q_PROPERTY(UsageDatabase *database READ database WRITE setDatabase NOTIFY databaseChanged)
+    Q_PROPERTY(bool idle READ isIdle WRITE setIdle NOTIFY idleChanged)
+    Q_PROPERTY(int intervalHours READ intervalHours WRITE setIntervalHours NOTIFY intervalHoursChanged)
+    Q_PROPERTY(int sliceBudgetMs READ sliceBudgetMs WRITE setSliceBudgetMs NOTIFY sliceBudgetMsChanged)
+    Q_PROPERTY(bool running READ isRunning NOTIFY runningChanged)
+    Q_PROPERTY(QDateTime lastRun READ lastRun NOTIFY maintenanceFinished)
+    Q_PROPERTY(QVariantList lastReport READ lastReport NOTIFY maintenanceFinished)
+
+public:
+    explicit MaintenanceScheduler(QObject *parent = nullptr);
+
+    UsageDatabase *database() const;
+    void setDatabase(UsageDatabase *database);
+
+    bool isIdle() const;
+    void setIdle(bool idle);
+
+    int intervalHours() const;
+    void setIntervalHours(int hours);
+
+    int sliceBudgetMs() const;
+    void setSliceBudgetMs(int ms);
+
+    /// True while a maintenance pass is started but not yet finished.
+    bool isRunning() const;
+
+    QDateTime lastRun() const;
+
+    /**
+     * One entry per task of the last finished pass:
+     * { task, durationMs, slices, rows }. `rows` is rows pruned for
+     * "prune" and free pages left for "vacuum".
+     */
+    QVariantList lastReport() const;
+
+    /// Start a pass at the next idle moment, regardless of the interval.
+    Q_INVOKABLE void runNow();
+
+Q_SIGNALS:
+    void databaseChanged();
+    void idleChanged();
+    void intervalHoursChanged();
+    void sliceBudgetMsChanged();
+    void runningChanged();
+    void maintenanceFinished(const QVariantList &report);
+
+private:
+    enum class Task {
+        Prune = 0,
+        Optimize,
+        Checkpoint,
+        Vacuum,
+        Done
+    };
+
+    struct TaskStats {
+        qint64 durationMs = 0;
+        int slices = 0;
+        qint64 rows = 0;
+    };
+
+    static QString taskName(Task task);
+
+    void onDueTimeout();
+    void scheduleNextPass(qint64 delayMs);
+    void scheduleSlice();
+    void runSlice();
+    bool runStep(Task task, TaskStats &stats);
+    void finishPass();
+    void setRunning(bool running);
+
+    QPointer<UsageDatabase> m_database;
+    QTimer m_dueTimer;
+    QTimer m_sliceTimer;
+
+    bool m_idle = false;
+    bool m_running = false;
+    int m_intervalHours = 24;
+    int m_sliceBudgetMs = 25;
+
+    Task m_task = Task::Done;
+    TaskStats m_stats[static_cast<int>(Task::Done)];
+
+    QDateTime m_lastRun;
+    QVariantList m_lastReport;
+
+    static constexpr int STARTUP_DELAY_MS = 2 * 60 * 1000; // first pass 2 minutes after load
+    static constexpr int SLICE_GAP_MS = 50;                // yield to the event loop between slices
+    static constexpr int PRUNE_BATCH_ROWS = 500;
+    static constexpr int VACUUM_BATCH_PAGES = 64;
+};
+
+#endif // MAINTENANCESCHEDULER_H
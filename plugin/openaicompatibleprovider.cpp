@@ -25,16 +25,111 @@ void OpenAICompatibleProvider::refresh()
         return;
     }
 
-    beginRefresh();
+    if (!beginRefresh())
+        return;
     setLoading(true);
     clearError();
     m_pendingRequests = 0;
-    fetchRateLimits();
+
+    // The probe chain holds one pending request until it settles, so a
+    // probe answered from cached headers cannot finish the cycle before
+    // the additional requests are counted
+    m_probeQueue = probeOrder();
+    addPendingRequest();
+    fetchAdditionalData();
+    runNextProbe();
+}
+
+QList<ProviderBackend::ProbeStrategy> OpenAICompatibleProvider::defaultProbeOrder() const
+{
+    return {ProbeStrategy::Models, ProbeStrategy::Head,
+            ProbeStrategy::CachedHeaders, ProbeStrategy::ChatCompletion};
+}
+
+// --- Rate limit probing ---
+
+void OpenAICompatibleProvider::runNextProbe()
+{
+    while (!m_probeQueue.isEmpty()) {
+        const ProbeStrategy strategy = m_probeQueue.takeFirst();
+        switch (strategy) {
+        case ProbeStrategy::Models:
+        case ProbeStrategy::Head:
+            sendMetadataProbe(strategy);
+            return;
+        case ProbeStrategy::CachedHeaders:
+            if (hasFreshRateLimitHeaders()) {
+                recordProbe(strategy);
+                finishProbe();
+                return;
+            }
+            break;
+        case ProbeStrategy::Predicted:
+            if (rateLimitModelPredictsNoChange()) {
+                recordProbe(strategy);
+                finishProbe();
+                return;
+            }
+            break;
+        case ProbeStrategy::ChatCompletion:
+            fetchRateLimits();
+            return;
+        }
+    }
+
+    // Every strategy declined: keep the limits we already have
+    finishProbe();
+}
+
+void OpenAICompatibleProvider::finishProbe()
+{
+    decrementPendingRequest();
+    onAllRequestsDone();
+}
+
+void OpenAICompatibleProvider::sendMetadataProbe(ProbeStrategy strategy)
+{
+    QUrl url(QStringLiteral("%1/models").arg(effectiveBaseUrl(defaultBaseUrl())));
+    QNetworkRequest request = createRequest(url);
+
+    startProbeTimer();
+    int gen = currentGeneration();
+    QNetworkReply *reply = strategy == ProbeStrategy::Head
+        ? networkManager()->head(request)
+        : sendGet(request);
+    trackReply(reply);
+    connect(reply, &QNetworkReply::finished, this, [this, reply, gen, strategy]() {
+        if (!isCurrentGeneration(gen)) { reply->deleteLater(); return; }
+        onMetadataProbeFinished(reply, strategy);
+    });
+}
+
+void OpenAICompatibleProvider::onMetadataProbeFinished(QNetworkReply *reply, ProbeStrategy strategy)
+{
+    reply->deleteLater();
+    int httpStatus = reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
+
+    if (hasRateLimitHeaders(reply)) {
+        parseRateLimitHeaders(reply);
+        recordProbe(strategy);
+        setConnected(true);
+        finishProbe();
+        return;
+    }
+
+    // The server answered without limits, refused the method, or refused
+    // the key for this endpoint (restricted keys may still complete), so
+    // this endpoint will not tell us; transient failures get another chance
+    if (httpStatus > 0 && !isRetryableStatus(httpStatus)) {
+        markProbeUnsupported(strategy);
+    }
+    runNextProbe();
 }
 
 void OpenAICompatibleProvider::fetchRateLimits()
 {
-    // Use minimal chat completion to read rate limit headers
+    // Last resort: a minimal chat completion, which is billed and counts
+    // against the very quota we are monitoring
     QUrl url(QStringLiteral("%1/chat/completions").arg(effectiveBaseUrl(defaultBaseUrl())));
 
     QNetworkRequest request = createRequest(url);
@@ -53,7 +148,7 @@ void OpenAICompatibleProvider::fetchRateLimits()
     QByteArray body = QJsonDocument(payload).toJson(QJsonDocument::Compact);
     m_lastRequestBody = body;
 
-    addPendingRequest();
+    startProbeTimer();
     int gen = currentGeneration();
     QNetworkReply *reply = networkManager()->post(request, body);
     trackReply(reply);
@@ -69,8 +164,9 @@ void OpenAICompatibleProvider::parseRateLimitHeaders(QNetworkReply *reply)
     ProviderBackend::parseRateLimitHeaders(reply, "x-ratelimit-");
 }
 
-void OpenAICompatibleProvider::parseUsageBody(QNetworkReply *reply)
+qint64 OpenAICompatibleProvider::parseUsageBody(QNetworkReply *reply)
 {
+    qint64 costMicros = 0;
     QByteArray data = reply->readAll();
     QJsonDocument doc = QJsonDocument::fromJson(data);
     if (!doc.isNull()) {
@@ -88,8 +184,10 @@ void OpenAICompatibleProvider::parseUsageBody(QNetworkReply *reply)
             setInputTokens(m_sessionInputTokens);
             setOutputTokens(m_sessionOutputTokens);
             setRequestCount(m_sessionRequestCount);
+            costMicros = estimatedCostMicros(m_model, promptTokens, completionTokens);
         }
     }
+    return costMicros;
 }
 
 void OpenAICompatibleProvider::onCompletionFinished(QNetworkReply *reply)
@@ -100,7 +198,7 @@ void OpenAICompatibleProvider::onCompletionFinished(QNetworkReply *reply)
         int httpStatus = reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
 
         // Retry transient errors (retryRequest takes ownership of reply)
-        if (isRetryableStatus(httpStatus)) {
+        if (shouldRetry(reply)) {
             addPendingRequest(); // re-increment since retry is pending
             retryRequest(reply, reply->url(), m_lastRequestBody,
                          [this](QNetworkReply *r) { onCompletionFinished(r); });
@@ -113,6 +211,7 @@ void OpenAICompatibleProvider::onCompletionFinished(QNetworkReply *reply)
             setError(i18n("Rate limited"));
             // Still parse headers on 429
             parseRateLimitHeaders(reply);
+            recordProbe(ProbeStrategy::ChatCompletion);
         } else {
             setError(i18n("API error: %1 (HTTP %2)",
                          reply->errorString(),
@@ -127,7 +226,7 @@ void OpenAICompatibleProvider::onCompletionFinished(QNetworkReply *reply)
         }
     } else {
         parseRateLimitHeaders(reply);
-        parseUsageBody(reply);
+        recordProbe(ProbeStrategy::ChatCompletion, parseUsageBody(reply));
         reply->deleteLater();
         setConnected(true);
 
@@ -10,13 +10,16 @@
  * Base class for OpenAI-compatible provider backends.
  *
  * Handles the common pattern of:
- * - POST /chat/completions with max_tokens=1 to read rate limit headers
+ * - Reading rate limit headers through the probe order: GET /models,
+ *   HEAD /models, recently cached headers, and only then a POST
+ *   /chat/completions with max_tokens=1
  * - Parsing x-ratelimit-* response headers
  * - Parsing usage object from response body (tokens)
  * - Session-level token tracking (accumulated within one app session)
  *
  * Subclasses must provide: name(), iconName(), defaultModel(), baseUrl()
- * Subclasses can override refresh() to add extra API calls (e.g., balance endpoint)
+ * Subclasses can override fetchAdditionalData() to add extra API calls
+ * (e.g., balance endpoint)
  */
 class OpenAICompatibleProvider : public ProviderBackend
 {
@@ -46,18 +49,31 @@ protected:
     /// Called when all pending requests are done (for multi-request providers)
     virtual void onAllRequestsDone();
 
+    /// Start extra requests for this refresh (e.g. a balance endpoint),
+    /// registered with addPendingRequest(). Runs once per refresh cycle,
+    /// before the rate-limit probe, and never for a coalesced refresh().
+    virtual void fetchAdditionalData() {}
+
+    /// Default probe order: GET /models, HEAD /models, cached, chat.
+    QList<ProbeStrategy> defaultProbeOrder() const override;
+
     /// Increment/decrement pending request counter (for subclasses like DeepSeek)
     void addPendingRequest();
     bool decrementPendingRequest();
 
 private:
+    void runNextProbe();
+    void finishProbe();
+    void sendMetadataProbe(ProbeStrategy strategy);
+    void onMetadataProbeFinished(QNetworkReply *reply, ProbeStrategy strategy);
     void fetchRateLimits();
     void parseRateLimitHeaders(QNetworkReply *reply);
-    void parseUsageBody(QNetworkReply *reply);
+    qint64 parseUsageBody(QNetworkReply *reply);
 
     QString m_model;
     int m_pendingRequests = 0;
     QByteArray m_lastRequestBody; // stored for retry support
+    QList<ProbeStrategy> m_probeQueue; // strategies left to try this refresh
 
     // Session-level token tracking (accumulated across refreshes within one session)
     qint64 m_sessionInputTokens = 0;
@@ -1,5 +1,7 @@
 #include "openaiprovider.h"
+#include "costmicros.h"
 #include <KLocalizedString>
+#include <QCryptographicHash>
 #include <QNetworkRequest>
 #include <QUrlQuery>
 #include <QDateTime>
@@ -9,6 +11,11 @@
 OpenAIProvider::OpenAIProvider(QObject *parent)
     : ProviderBackend(parent)
 {
+    // Today's usage and costs move with every request; the month-to-date
+    // total only needs to follow along loosely
+    declareEndpoint(QStringLiteral("usage"), 0);
+    declareEndpoint(QStringLiteral("costs"), 0);
+    declareEndpoint(QStringLiteral("monthly-costs"), MONTHLY_COSTS_TTL_MS);
 }
 
 QString OpenAIProvider::projectId() const { return m_projectId; }
@@ -16,6 +23,7 @@ void OpenAIProvider::setProjectId(const QString &id)
 {
     if (m_projectId != id) {
         m_projectId = id;
+        invalidateEndpoints();
         Q_EMIT projectIdChanged();
     }
 }
@@ -25,10 +33,33 @@ void OpenAIProvider::setModel(const QString &model)
 {
     if (m_model != model) {
         m_model = model;
+        invalidateEndpoints();
         Q_EMIT modelChanged();
     }
 }
 
+int OpenAIProvider::maxPagesInFlight() const { return m_maxPagesInFlight; }
+void OpenAIProvider::setMaxPagesInFlight(int pages)
+{
+    pages = qBound(1, pages, 16);
+    if (m_maxPagesInFlight != pages) {
+        m_maxPagesInFlight = pages;
+        Q_EMIT maxPagesInFlightChanged();
+    }
+}
+
+int OpenAIProvider::pagesFetched() const { return m_pagesFetched; }
+
+UsageDatabase *OpenAIProvider::ledger() const { return m_ledger; }
+void OpenAIProvider::setLedger(UsageDatabase *ledger)
+{
+    if (m_ledger != ledger) {
+        m_ledger = ledger;
+        invalidateEndpoints();
+        Q_EMIT ledgerChanged();
+    }
+}
+
 void OpenAIProvider::refresh()
 {
     if (!hasApiKey()) {
@@ -37,14 +68,39 @@ void OpenAIProvider::refresh()
         return;
     }
 
-    beginRefresh();
+    if (!beginRefresh())
+        return;
     setLoading(true);
     clearError();
     m_pendingRequests = 0;
+    m_pagesFetched = 0;
+
+    if (usesLedger()) {
+        if (endpointDue(QStringLiteral("usage"))) {
+            QUrlQuery usageGroups;
+            usageGroups.addQueryItem(QStringLiteral("group_by"), QStringLiteral("project_id"));
+            usageGroups.addQueryItem(QStringLiteral("group_by"), QStringLiteral("model"));
+            fetchLedger(UsageFeed, QStringLiteral("usage"), QStringLiteral("/organization/usage/completions"), usageGroups);
+        }
+        // The ledger's cost rows give both today's and the month's total
+        if (endpointDue(QStringLiteral("costs"))) {
+            QUrlQuery costGroups;
+            costGroups.addQueryItem(QStringLiteral("group_by"), QStringLiteral("project_id"));
+            costGroups.addQueryItem(QStringLiteral("group_by"), QStringLiteral("line_item"));
+            fetchLedger(MonthlyCostsFeed, QStringLiteral("costs"), QStringLiteral("/organization/costs"), costGroups);
+        }
+    } else {
+        if (endpointDue(QStringLiteral("usage")))
+            fetchUsage();
+        if (endpointDue(QStringLiteral("costs")))
+            fetchCosts();
+        if (endpointDue(QStringLiteral("monthly-costs")))
+            fetchMonthlyCosts();
+    }
 
-    fetchUsage();
-    fetchCosts();
-    fetchMonthlyCosts();
+    // Everything was still fresh
+    if (m_pendingRequests == 0)
+        checkAllDone();
 }
 
 void OpenAIProvider::fetchUsage()
@@ -53,32 +109,17 @@ void OpenAIProvider::fetchUsage()
     QDateTime now = QDateTime::currentDateTimeUtc();
     QDateTime dayAgo = now.addDays(-1);
 
-    QUrl url(QStringLiteral("%1/organization/usage/completions").arg(effectiveBaseUrl(BASE_URL)));
-    QUrlQuery query;
-    query.addQueryItem(QStringLiteral("start_time"), QString::number(dayAgo.toSecsSinceEpoch()));
-    query.addQueryItem(QStringLiteral("end_time"), QString::number(now.toSecsSinceEpoch()));
-    query.addQueryItem(QStringLiteral("bucket_width"), QStringLiteral("1d"));
-
-    // Add filters
+    QUrlQuery filters;
     if (!m_model.isEmpty()) {
-        query.addQueryItem(QStringLiteral("models"), m_model);
+        filters.addQueryItem(QStringLiteral("models"), m_model);
     }
     if (!m_projectId.isEmpty()) {
-        query.addQueryItem(QStringLiteral("project_ids"), m_projectId);
+        filters.addQueryItem(QStringLiteral("project_ids"), m_projectId);
     }
 
-    url.setQuery(query);
-
-    QNetworkRequest request = createRequest(url);
-
-    m_pendingRequests++;
-    int gen = currentGeneration();
-    QNetworkReply *reply = networkManager()->get(request);
-    trackReply(reply);
-    connect(reply, &QNetworkReply::finished, this, [this, reply, gen]() {
-        if (!isCurrentGeneration(gen)) { reply->deleteLater(); return; }
-        onUsageReply(reply);
-    });
+    // The query window moves every poll; key the cache by endpoint instead
+    startFeed(UsageFeed, QStringLiteral("usage"), QStringLiteral("/organization/usage/completions"), QStringLiteral("usage"),
+              dayAgo.toSecsSinceEpoch(), now.toSecsSinceEpoch(), filters);
 }
 
 void OpenAIProvider::fetchCosts()
@@ -86,222 +127,362 @@ void OpenAIProvider::fetchCosts()
     QDateTime now = QDateTime::currentDateTimeUtc();
     QDateTime dayAgo = now.addDays(-1);
 
-    QUrl url(QStringLiteral("%1/organization/costs").arg(effectiveBaseUrl(BASE_URL)));
-    QUrlQuery query;
-    query.addQueryItem(QStringLiteral("start_time"), QString::number(dayAgo.toSecsSinceEpoch()));
-    query.addQueryItem(QStringLiteral("end_time"), QString::number(now.toSecsSinceEpoch()));
-    query.addQueryItem(QStringLiteral("bucket_width"), QStringLiteral("1d"));
-
+    QUrlQuery filters;
     if (!m_projectId.isEmpty()) {
-        query.addQueryItem(QStringLiteral("project_ids"), m_projectId);
+        filters.addQueryItem(QStringLiteral("project_ids"), m_projectId);
     }
 
-    url.setQuery(query);
-
-    QNetworkRequest request = createRequest(url);
-
-    m_pendingRequests++;
-    int gen = currentGeneration();
-    QNetworkReply *reply = networkManager()->get(request);
-    trackReply(reply);
-    connect(reply, &QNetworkReply::finished, this, [this, reply, gen]() {
-        if (!isCurrentGeneration(gen)) { reply->deleteLater(); return; }
-        onCostsReply(reply);
-    });
+    startFeed(DailyCostsFeed, QStringLiteral("costs"), QStringLiteral("/organization/costs"), QStringLiteral("costs-daily"),
+              dayAgo.toSecsSinceEpoch(), now.toSecsSinceEpoch(), filters);
 }
 
-void OpenAIProvider::onUsageReply(QNetworkReply *reply)
+void OpenAIProvider::fetchMonthlyCosts()
 {
-    m_pendingRequests--;
-
-    if (reply->error() != QNetworkReply::NoError) {
-        int httpStatus = reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
-
-        // Retry transient errors (retryRequest takes ownership of reply)
-        if (isRetryableStatus(httpStatus)) {
-            m_pendingRequests++; // re-increment since retry is pending
-            retryRequest(reply, reply->url(), QByteArray(),
-                         [this](QNetworkReply *r) { onUsageReply(r); });
-            return;
-        }
-
-        reply->deleteLater();
+    // Query costs from the start of the current month
+    QDateTime now = QDateTime::currentDateTimeUtc();
+    QDate today = now.date();
+    QDate monthStart(today.year(), today.month(), 1);
+    QDateTime monthStartDt(monthStart.startOfDay(QTimeZone::UTC));
 
-        if (httpStatus == 401 || httpStatus == 403) {
-            setError(i18n("Authentication failed. Ensure you're using an Admin API key."));
-        } else {
-            setError(i18n("Usage API error: %1 (HTTP %2)",
-                         reply->errorString(),
-                         QString::number(httpStatus)));
-        }
-        checkAllDone();
-        return;
+    QUrlQuery filters;
+    if (!m_projectId.isEmpty()) {
+        filters.addQueryItem(QStringLiteral("project_ids"), m_projectId);
     }
 
-    reply->deleteLater();
+    startFeed(MonthlyCostsFeed, QStringLiteral("monthly-costs"), QStringLiteral("/organization/costs"), QStringLiteral("costs-monthly"),
+              monthStartDt.toSecsSinceEpoch(), now.toSecsSinceEpoch(), filters);
+}
 
-    // Parse rate limit headers from the response
-    parseRateLimitHeaders(reply);
+// --- Billing Ledger ---
 
-    // Parse JSON body
-    QByteArray data = reply->readAll();
-    QJsonDocument doc = QJsonDocument::fromJson(data);
-    if (doc.isNull()) {
-        setError(i18n("Failed to parse usage response"));
-        checkAllDone();
-        return;
-    }
-
-    QJsonObject root = doc.object();
-    QJsonArray buckets = root.value(QStringLiteral("data")).toArray();
+bool OpenAIProvider::usesLedger() const
+{
+    return m_ledger && m_ledger->isEnabled();
+}
 
-    qint64 totalInput = 0;
-    qint64 totalOutput = 0;
-    int totalRequests = 0;
+QString OpenAIProvider::ledgerAccount() const
+{
+    // Rows belong to the organisation behind the key; never store the key
+    const QByteArray identity = (effectiveBaseUrl(BASE_URL) + QLatin1Char('\n') + apiKey()).toUtf8();
+    return QString::fromLatin1(QCryptographicHash::hash(identity, QCryptographicHash::Sha256).toHex().left(16));
+}
 
-    for (const QJsonValue &bucket : buckets) {
-        QJsonArray results = bucket.toObject().value(QStringLiteral("result")).toArray();
-        for (const QJsonValue &result : results) {
-            QJsonObject r = result.toObject();
-            totalInput += r.value(QStringLiteral("input_tokens")).toInteger(0);
-            totalOutput += r.value(QStringLiteral("output_tokens")).toInteger(0);
-            totalRequests += r.value(QStringLiteral("num_model_requests")).toInt(0);
-        }
+void OpenAIProvider::fetchLedger(Feed feed, const QString &source, const QString &path, const QUrlQuery &groupBy)
+{
+    // Day buckets are aligned to start_time, so start at a UTC midnight:
+    // the first day after the closed-through mark, or the month start
+    const QDateTime now = QDateTime::currentDateTimeUtc();
+    const QDate today = now.date();
+    QDate from(today.year(), today.month(), 1);
+
+    const QDate closed = m_ledger->ledgerClosedThrough(name(), ledgerAccount(), source);
+    if (closed.isValid() && closed >= from) {
+        from = qMin(closed.addDays(1), today);
     }
 
-    setInputTokens(totalInput);
-    setOutputTokens(totalOutput);
-    setRequestCount(totalRequests);
-    setConnected(true);
+    startFeed(feed, source, path, QStringLiteral("ledger-") + source,
+              from.startOfDay(QTimeZone::UTC).toSecsSinceEpoch(), now.toSecsSinceEpoch(), groupBy);
 
-    checkAllDone();
+    PagedFeed &paged = m_feeds[feed];
+    paged.ledgerSource = source;
+    paged.ledgerFrom = from;
 }
 
-void OpenAIProvider::onCostsReply(QNetworkReply *reply)
+void OpenAIProvider::commitLedgerFeed(Feed feed)
 {
-    m_pendingRequests--;
-
-    if (reply->error() != QNetworkReply::NoError) {
-        int httpStatus = reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
+    PagedFeed &paged = m_feeds[feed];
+    if (!m_ledger) {
+        return;
+    }
 
-        // Retry transient errors (retryRequest takes ownership of reply)
-        if (isRetryableStatus(httpStatus)) {
-            m_pendingRequests++; // re-increment since retry is pending
-            retryRequest(reply, reply->url(), QByteArray(),
-                         [this](QNetworkReply *r) { onCostsReply(r); });
-            return;
-        }
+    // A day is final once it ended more than the settle time ago
+    const QDateTime now = QDateTime::currentDateTimeUtc();
+    const QDate today = now.date();
+    const QDate closedThrough = now.addSecs(-LEDGER_SETTLE_SECS).date().addDays(-1);
+    const QString account = ledgerAccount();
 
-        // Non-fatal: usage data may still be available
-        qWarning() << "AI Usage Monitor: OpenAI costs API error:" << reply->errorString();
-        reply->deleteLater();
-        checkAllDone();
+    if (!m_ledger->writeLedger(name(), account, paged.ledgerSource, paged.ledgerFrom, today,
+                               paged.ledgerEntries, closedThrough)) {
+        qWarning() << "AI Usage Monitor: OpenAI ledger not updated, keeping previous totals";
         return;
     }
 
-    QByteArray data = reply->readAll();
-    reply->deleteLater();
-    QJsonDocument doc = QJsonDocument::fromJson(data);
-    if (doc.isNull()) {
-        checkAllDone();
+    if (feed == UsageFeed) {
+        const UsageDatabase::LedgerTotals day = m_ledger->ledgerTotals(name(), account, paged.ledgerSource,
+                                                                       today, today, m_projectId, m_model);
+        setInputTokens(day.inputTokens);
+        setOutputTokens(day.outputTokens);
+        setRequestCount(static_cast<int>(day.requests));
+        setConnected(true);
+        markEndpointFresh(paged.endpoint);
         return;
     }
 
-    QJsonObject root = doc.object();
-    QJsonArray buckets = root.value(QStringLiteral("data")).toArray();
+    const QDate monthStart(today.year(), today.month(), 1);
+    const UsageDatabase::LedgerTotals day = m_ledger->ledgerTotals(name(), account, paged.ledgerSource,
+                                                                   today, today, m_projectId);
+    const UsageDatabase::LedgerTotals month = m_ledger->ledgerTotals(name(), account, paged.ledgerSource,
+                                                                     monthStart, today, m_projectId);
+    setCostMicros(day.costMicros);
+    setDailyCostMicros(day.costMicros);
+    setMonthlyCostMicros(month.costMicros);
+    markEndpointFresh(paged.endpoint);
+}
 
-    double totalCost = 0.0;
-    for (const QJsonValue &bucket : buckets) {
-        QJsonArray results = bucket.toObject().value(QStringLiteral("result")).toArray();
-        for (const QJsonValue &result : results) {
-            QJsonObject r = result.toObject();
-            // Cost is in cents, convert to dollars
-            totalCost += r.value(QStringLiteral("amount")).toDouble(0.0);
-        }
-    }
+// --- Paginated Feeds ---
 
-    double costDollars = totalCost / 100.0; // API returns cents
-    setCost(costDollars);
-    setDailyCost(costDollars); // 24h window = daily cost
-    checkAllDone();
+void OpenAIProvider::startFeed(Feed feed, const QString &endpoint, const QString &path,
+                               const QString &cacheKey, qint64 start, qint64 end, const QUrlQuery &filters)
+{
+    PagedFeed &paged = m_feeds[feed];
+    paged = PagedFeed();
+    paged.endpoint = endpoint;
+    paged.path = path;
+    paged.cacheKey = cacheKey;
+    paged.filters = filters;
+    paged.filters.addQueryItem(QStringLiteral("bucket_width"), QStringLiteral("1d"));
+    paged.filters.addQueryItem(QStringLiteral("limit"), QString::number(PAGE_BUCKET_LIMIT));
+    paged.end = end;
+
+    PageWindow window;
+    window.start = start;
+    window.end = end;
+    window.first = true;
+    paged.queued.append(window);
+
+    m_pendingRequests++;
+    sendQueuedPages(feed);
 }
 
-void OpenAIProvider::fetchMonthlyCosts()
+void OpenAIProvider::sendQueuedPages(Feed feed)
 {
-    // Query costs from the start of the current month
-    QDateTime now = QDateTime::currentDateTimeUtc();
-    QDate today = now.date();
-    QDate monthStart(today.year(), today.month(), 1);
-    QDateTime monthStartDt(monthStart.startOfDay(QTimeZone::UTC));
+    PagedFeed &paged = m_feeds[feed];
+    while (!paged.failed && !paged.queued.isEmpty() && paged.inFlight < m_maxPagesInFlight) {
+        sendPage(feed, paged.queued.takeFirst());
+    }
+}
 
-    QUrl url(QStringLiteral("%1/organization/costs").arg(effectiveBaseUrl(BASE_URL)));
-    QUrlQuery query;
-    query.addQueryItem(QStringLiteral("start_time"), QString::number(monthStartDt.toSecsSinceEpoch()));
-    query.addQueryItem(QStringLiteral("end_time"), QString::number(now.toSecsSinceEpoch()));
-    query.addQueryItem(QStringLiteral("bucket_width"), QStringLiteral("1d"));
+void OpenAIProvider::sendPage(Feed feed, const PageWindow &window)
+{
+    PagedFeed &paged = m_feeds[feed];
 
-    if (!m_projectId.isEmpty()) {
-        query.addQueryItem(QStringLiteral("project_ids"), m_projectId);
+    QUrl url(effectiveBaseUrl(BASE_URL) + paged.path);
+    QUrlQuery query;
+    query.addQueryItem(QStringLiteral("start_time"), QString::number(window.start));
+    query.addQueryItem(QStringLiteral("end_time"), QString::number(window.end));
+    for (const auto &item : paged.filters.queryItems()) {
+        query.addQueryItem(item.first, item.second);
+    }
+    if (!window.cursor.isEmpty()) {
+        query.addQueryItem(QStringLiteral("page"), window.cursor);
     }
-
     url.setQuery(query);
 
-    QNetworkRequest request = createRequest(url);
+    // Only the opening request is stable enough to revalidate; follow-up
+    // windows and cursors change from one poll to the next
+    QNetworkRequest request = window.first ? createCachedRequest(url, paged.cacheKey)
+                                           : createRequest(url);
 
-    m_pendingRequests++;
+    paged.inFlight++;
     int gen = currentGeneration();
-    QNetworkReply *reply = networkManager()->get(request);
+    QNetworkReply *reply = sendGet(request);
     trackReply(reply);
-    connect(reply, &QNetworkReply::finished, this, [this, reply, gen]() {
+    connect(reply, &QNetworkReply::finished, this, [this, reply, gen, feed, window]() {
         if (!isCurrentGeneration(gen)) { reply->deleteLater(); return; }
-        onMonthlyCostsReply(reply);
+        onPageReply(feed, window, reply);
     });
 }
 
-void OpenAIProvider::onMonthlyCostsReply(QNetworkReply *reply)
+void OpenAIProvider::onPageReply(Feed feed, const PageWindow &window, QNetworkReply *reply)
 {
-    m_pendingRequests--;
+    PagedFeed &paged = m_feeds[feed];
+    paged.inFlight--;
 
     if (reply->error() != QNetworkReply::NoError) {
         int httpStatus = reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
 
         // Retry transient errors (retryRequest takes ownership of reply)
-        if (isRetryableStatus(httpStatus)) {
-            m_pendingRequests++; // re-increment since retry is pending
+        if (shouldRetry(reply)) {
+            paged.inFlight++; // re-increment since retry is pending
             retryRequest(reply, reply->url(), QByteArray(),
-                         [this](QNetworkReply *r) { onMonthlyCostsReply(r); });
+                         [this, feed, window](QNetworkReply *r) { onPageReply(feed, window, r); });
             return;
         }
 
-        // Non-fatal: daily cost data may still be available
-        qWarning() << "AI Usage Monitor: OpenAI monthly costs API error:" << reply->errorString();
         reply->deleteLater();
-        checkAllDone();
+        paged.failed = true;
+        paged.queued.clear();
+
+        if (feed == UsageFeed) {
+            if (httpStatus == 401 || httpStatus == 403) {
+                setError(i18n("Authentication failed. Ensure you're using an Admin API key."));
+            } else {
+                setError(i18n("Usage API error: %1 (HTTP %2)",
+                             reply->errorString(),
+                             QString::number(httpStatus)));
+            }
+        } else {
+            // Non-fatal: usage data may still be available
+            qWarning() << "AI Usage Monitor: OpenAI costs API error:" << reply->errorString();
+        }
+        finishFeedIfDone(feed);
         return;
     }
 
-    QByteArray data = reply->readAll();
     reply->deleteLater();
-    QJsonDocument doc = QJsonDocument::fromJson(data);
+
+    // Parse rate limit headers from the response
+    if (feed == UsageFeed) {
+        parseRateLimitHeaders(reply);
+    }
+
+    // Parse JSON body (a 304 reuses the previous one)
+    QJsonDocument doc = readJsonReply(reply);
     if (doc.isNull()) {
-        checkAllDone();
+        paged.failed = true;
+        paged.queued.clear();
+        if (feed == UsageFeed) {
+            setError(i18n("Failed to parse usage response"));
+        }
+        finishFeedIfDone(feed);
         return;
     }
 
-    QJsonObject root = doc.object();
-    QJsonArray buckets = root.value(QStringLiteral("data")).toArray();
+    const QJsonObject root = doc.object();
+    const QJsonArray buckets = root.value(QStringLiteral("data")).toArray();
+    mergeBuckets(paged, buckets);
+    paged.pages++;
+    m_pagesFetched++;
 
-    double totalCost = 0.0;
+    if (!paged.failed) {
+        queueFollowUps(paged, window, root, buckets);
+        sendQueuedPages(feed);
+    }
+    finishFeedIfDone(feed);
+}
+
+void OpenAIProvider::mergeBuckets(PagedFeed &paged, const QJsonArray &buckets)
+{
     for (const QJsonValue &bucket : buckets) {
-        QJsonArray results = bucket.toObject().value(QStringLiteral("result")).toArray();
+        const QJsonObject b = bucket.toObject();
+
+        // Windows never overlap, but a cursor that repeats a bucket must
+        // not count it twice
+        const qint64 bucketStart = b.value(QStringLiteral("start_time")).toInteger(0);
+        if (bucketStart > 0) {
+            if (paged.seenBuckets.contains(bucketStart)) {
+                continue;
+            }
+            paged.seenBuckets.insert(bucketStart);
+        }
+
+        const QDate day = QDateTime::fromSecsSinceEpoch(bucketStart, QTimeZone::UTC).date();
+        const QJsonArray results = b.value(QStringLiteral("result")).toArray();
         for (const QJsonValue &result : results) {
             QJsonObject r = result.toObject();
-            totalCost += r.value(QStringLiteral("amount")).toDouble(0.0);
+            const qint64 input = r.value(QStringLiteral("input_tokens")).toInteger(0);
+            const qint64 output = r.value(QStringLiteral("output_tokens")).toInteger(0);
+            const int requests = r.value(QStringLiteral("num_model_requests")).toInt(0);
+            // Cost is in cents; round each line item once, then sum exactly
+            const qint64 cost = CostMicros::fromDollars(r.value(QStringLiteral("amount")).toDouble(0.0) / 100.0);
+
+            paged.inputTokens += input;
+            paged.outputTokens += output;
+            paged.requests += requests;
+            paged.costMicros += cost;
+
+            // Ledger rows need the bucket's day; costs group by line item
+            if (!paged.ledgerSource.isEmpty() && bucketStart > 0) {
+                UsageDatabase::LedgerEntry entry;
+                entry.day = day;
+                entry.project = r.value(QStringLiteral("project_id")).toString();
+                entry.model = r.value(QStringLiteral("model")).toString(
+                    r.value(QStringLiteral("line_item")).toString());
+                entry.inputTokens = input;
+                entry.outputTokens = output;
+                entry.requests = requests;
+                entry.costMicros = cost;
+                paged.ledgerEntries.append(entry);
+            }
         }
     }
+}
+
+void OpenAIProvider::queueFollowUps(PagedFeed &paged, const PageWindow &window,
+                                    const QJsonObject &root, const QJsonArray &buckets)
+{
+    const QString nextPage = root.value(QStringLiteral("next_page")).toString();
+    if (!root.value(QStringLiteral("has_more")).toBool() || nextPage.isEmpty()) {
+        return;
+    }
 
-    double costDollars = totalCost / 100.0; // API returns cents
-    setMonthlyCost(costDollars);
+    const int budget = MAX_PAGES_PER_FEED - paged.pages - paged.inFlight - paged.queued.size();
+    if (budget <= 0) {
+        qWarning() << "AI Usage Monitor: OpenAI" << paged.path << "still has more pages after"
+                   << paged.pages << "- totals are truncated";
+        return;
+    }
+
+    // The opening page shows how much time one page covers: split the rest
+    // of the range into windows of that span and fetch them side by side
+    if (window.first) {
+        qint64 covered = 0;
+        for (const QJsonValue &bucket : buckets) {
+            covered = qMax(covered, bucket.toObject().value(QStringLiteral("end_time")).toInteger(0));
+        }
+
+        const qint64 span = covered - window.start;
+        if (covered > window.start && covered < window.end
+            && (window.end - covered + span - 1) / span <= budget) {
+            for (qint64 start = covered; start < window.end; start += span) {
+                PageWindow next;
+                next.start = start;
+                next.end = qMin(start + span, window.end);
+                paged.queued.append(next);
+            }
+            return;
+        }
+    }
+
+    // Otherwise keep walking this window's cursor
+    PageWindow next = window;
+    next.cursor = nextPage;
+    next.first = false;
+    paged.queued.append(next);
+}
+
+void OpenAIProvider::finishFeedIfDone(Feed feed)
+{
+    PagedFeed &paged = m_feeds[feed];
+    if (paged.inFlight > 0 || !paged.queued.isEmpty()) {
+        return;
+    }
+
+    // Partial totals would under-report; keep the previous values instead
+    if (!paged.failed && !paged.ledgerSource.isEmpty()) {
+        commitLedgerFeed(feed);
+    } else if (!paged.failed) {
+        switch (feed) {
+        case UsageFeed:
+            setInputTokens(paged.inputTokens);
+            setOutputTokens(paged.outputTokens);
+            setRequestCount(paged.requests);
+            setConnected(true);
+            break;
+        case DailyCostsFeed:
+            setCostMicros(paged.costMicros);
+            setDailyCostMicros(paged.costMicros); // 24h window = daily cost
+            break;
+        case MonthlyCostsFeed:
+            setMonthlyCostMicros(paged.costMicros);
+            break;
+        case FeedCount:
+            break;
+        }
+        markEndpointFresh(paged.endpoint);
+    }
+
+    m_pendingRequests--;
     checkAllDone();
 }
 
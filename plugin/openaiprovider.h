@@ -2,9 +2,14 @@
 #define OPENAIPROVIDER_H
 
 #include "providerbackend.h"
+#include "usagedatabase.h"
 #include <QJsonDocument>
 #include <QJsonObject>
 #include <QJsonArray>
+#include <QList>
+#include <QPointer>
+#include <QSet>
+#include <QUrlQuery>
 
 /**
  * OpenAI provider backend.
@@ -15,6 +20,29 @@
  * - Rate limit headers from responses
  *
  * Requires an Admin API key for usage/costs endpoints.
+ *
+ * Both endpoints are paginated (`has_more` / `next_page`). Each of the
+ * three queries (usage, daily costs, monthly costs) is a feed: when its
+ * first page reports more data, the rest of its time range is split into
+ * windows of the span that page covered and those windows are fetched
+ * concurrently, at most `maxPagesInFlight` per feed, each following its
+ * own cursor. Pages are summed as they arrive (buckets seen twice are
+ * skipped) and a feed's totals are published once its last page is in;
+ * a feed with a failed page keeps the previous totals instead of showing
+ * truncated ones.
+ *
+ * With a `ledger` database set, closed UTC days are not fetched again.
+ * Usage and costs are requested per project and model from the day after
+ * the ledger's closed-through mark, written to the ledger, and the shown
+ * values are local sums: tokens, requests and daily cost for the current
+ * UTC day, monthly cost for the month to date. The model and project
+ * filters then apply to the ledger rows instead of the request.
+ *
+ * Endpoints: "usage" and "costs" are fetched on every refresh,
+ * "monthly-costs" at most every 30 minutes (see endpointTtls).
+ *
+ * Usage from QML:
+ *   OpenAIProvider { ledger: usageDatabase }
  */
 class OpenAIProvider : public ProviderBackend
 {
@@ -22,6 +50,9 @@ class OpenAIProvider : public ProviderBackend
 
     Q_PROPERTY(QString projectId READ projectId WRITE setProjectId NOTIFY projectIdChanged)
     Q_PROPERTY(QString model READ model WRITE setModel NOTIFY modelChanged)
+    Q_PROPERTY(int maxPagesInFlight READ maxPagesInFlight WRITE setMaxPagesInFlight NOTIFY maxPagesInFlightChanged)
+    Q_PROPERTY(int pagesFetched READ pagesFetched NOTIFY dataUpdated)
+    Q_PROPERTY(UsageDatabase *ledger READ ledger WRITE setLedger NOTIFY ledgerChanged)
 
 public:
     explicit OpenAIProvider(QObject *parent = nullptr);
@@ -35,28 +66,88 @@ public:
     QString model() const;
     void setModel(const QString &model);
 
+    int maxPagesInFlight() const;
+    void setMaxPagesInFlight(int pages);
+
+    /// Pages received in the last refresh, across all feeds.
+    int pagesFetched() const;
+
+    UsageDatabase *ledger() const;
+    void setLedger(UsageDatabase *ledger);
+
     Q_INVOKABLE void refresh() override;
 
 Q_SIGNALS:
     void projectIdChanged();
     void modelChanged();
-
-private Q_SLOTS:
-    void onUsageReply(QNetworkReply *reply);
-    void onCostsReply(QNetworkReply *reply);
-    void onMonthlyCostsReply(QNetworkReply *reply);
+    void maxPagesInFlightChanged();
+    void ledgerChanged();
 
 private:
+    enum Feed { UsageFeed, DailyCostsFeed, MonthlyCostsFeed, FeedCount };
+
+    /// Slice of a feed's time range; `cursor` is the next_page token once
+    /// the window has been started.
+    struct PageWindow {
+        qint64 start = 0;
+        qint64 end = 0;
+        QString cursor;
+        bool first = false; // the feed's opening request
+    };
+
+    struct PagedFeed {
+        QString endpoint;     // declared endpoint name, for freshness
+        QString path;         // e.g. "/organization/costs"
+        QString cacheKey;     // for the opening request only
+        QUrlQuery filters;    // bucket_width, limit, models, project_ids
+        qint64 end = 0;
+        QList<PageWindow> queued;
+        QSet<qint64> seenBuckets;
+        int inFlight = 0;
+        int pages = 0;
+        bool failed = false;
+
+        QString ledgerSource; // "usage" / "costs"; empty when not ledger-backed
+        QDate ledgerFrom;
+        QList<UsageDatabase::LedgerEntry> ledgerEntries;
+
+        qint64 inputTokens = 0;
+        qint64 outputTokens = 0;
+        int requests = 0;
+        qint64 costMicros = 0;
+    };
+
     void fetchUsage();
     void fetchCosts();
     void fetchMonthlyCosts();
+    void fetchLedger(Feed feed, const QString &source, const QString &path, const QUrlQuery &groupBy);
+    void commitLedgerFeed(Feed feed);
+    bool usesLedger() const;
+    QString ledgerAccount() const;
+    void startFeed(Feed feed, const QString &endpoint, const QString &path,
+                   const QString &cacheKey, qint64 start, qint64 end, const QUrlQuery &filters);
+    void sendQueuedPages(Feed feed);
+    void sendPage(Feed feed, const PageWindow &window);
+    void onPageReply(Feed feed, const PageWindow &window, QNetworkReply *reply);
+    void mergeBuckets(PagedFeed &paged, const QJsonArray &buckets);
+    void queueFollowUps(PagedFeed &paged, const PageWindow &window,
+                        const QJsonObject &root, const QJsonArray &buckets);
+    void finishFeedIfDone(Feed feed);
     void checkAllDone();
 
     QString m_projectId;
     QString m_model = QStringLiteral("gpt-4o");
     int m_pendingRequests = 0;
+    int m_maxPagesInFlight = 4;
+    int m_pagesFetched = 0;
+    PagedFeed m_feeds[FeedCount];
+    QPointer<UsageDatabase> m_ledger;
 
     static constexpr const char *BASE_URL = "https://api.openai.com/v1";
+    static constexpr int PAGE_BUCKET_LIMIT = 31;   // 1d buckets per page (API maximum)
+    static constexpr int MAX_PAGES_PER_FEED = 64;  // runaway-cursor guard
+    static constexpr qint64 MONTHLY_COSTS_TTL_MS = 30 * 60 * 1000;
+    static constexpr qint64 LEDGER_SETTLE_SECS = 2 * 60 * 60; // late records for a closed day
 };
 
 #endif // OPENAIPROVIDER_H
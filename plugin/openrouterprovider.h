@@ -9,7 +9,8 @@
  * Uses OpenAI-compatible API at openrouter.ai/api/v1.
  * - Rate limit info from response headers (x-ratelimit-*)
  * - Usage data from chat completion response body
- * - Credits balance from GET /api/v1/auth/key endpoint
+ * - Credits balance from GET /api/v1/auth/key endpoint, at most every
+ *   15 minutes (endpoint "credits")
  *
  * OpenRouter is a unified gateway to 600+ models from multiple providers.
  * Users select their model on the OpenRouter dashboard; we track the
@@ -32,13 +33,16 @@ public:
 
     double credits() const;
 
-    Q_INVOKABLE void refresh() override;
-
 Q_SIGNALS:
     void creditsChanged();
 
 protected:
     const char *defaultBaseUrl() const override { return BASE_URL; }
+    void fetchAdditionalData() override;
+
+    /// GET /models is a public, unauthenticated catalog of several hundred
+    /// models; only HEAD it.
+    QList<ProbeStrategy> defaultProbeOrder() const override;
 
 private Q_SLOTS:
     void onCreditsReply(QNetworkReply *reply);
@@ -48,6 +52,8 @@ private:
 
     double m_credits = 0.0;
 
+    static constexpr qint64 CREDITS_TTL_MS = 15 * 60 * 1000;
+
     static constexpr const char *BASE_URL = "https://openrouter.ai/api/v1";
 };
 
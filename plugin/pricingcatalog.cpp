@@ -0,0 +1,299 @@
+#include "pricingcatalog.h"
+
+#include <QDebug>
+#include <QFile>
+#include <QJsonDocument>
+#include <QJsonValue>
+#include <QStandardPaths>
+
+#include <algorithm>
+
+namespace {
+
+struct BuiltinPrice {
+    const char *provider;
+    const char *model;
+    double inputPerMToken;
+    double outputPerMToken;
+    double cacheReadPerMToken = -1.0; // below 0: the provider's cache ratio
+};
+
+// $ per 1M tokens, list prices as of 2026
+constexpr BuiltinPrice BUILTIN_PRICES[] = {
+    // Undated family prefixes cover every snapshot and point release
+    {"Anthropic", "claude-sonnet-4", 3.0, 15.0},
+    {"Anthropic", "claude-opus-4", 15.0, 75.0},
+    {"Anthropic", "claude-opus-4-5", 5.0, 25.0},
+    {"Anthropic", "claude-haiku-4", 1.0, 5.0},
+    {"Anthropic", "claude-3-7-sonnet", 3.0, 15.0},
+    {"Anthropic", "claude-3-5-sonnet", 3.0, 15.0},
+    {"Anthropic", "claude-3-5-haiku", 0.80, 4.0},
+    {"Anthropic", "claude-3-opus", 15.0, 75.0},
+    {"Anthropic", "claude-3-haiku", 0.25, 1.25},
+
+    // Azure OpenAI: parity with OpenAI list pricing
+    {"Azure OpenAI", "gpt-4o", 2.50, 10.00},
+    {"Azure OpenAI", "gpt-4o-mini", 0.15, 0.60},
+    {"Azure OpenAI", "gpt-4.1", 2.00, 8.00},
+    {"Azure OpenAI", "gpt-4.1-mini", 0.40, 1.60},
+    {"Azure OpenAI", "o3", 2.00, 8.00},
+    {"Azure OpenAI", "o4-mini", 1.10, 4.40},
+
+    {"Cohere", "command-a-03-2025", 2.50, 10.00},
+    {"Cohere", "command-r-plus-08-2024", 2.50, 10.00},
+    {"Cohere", "command-r-plus", 3.00, 15.00},
+    {"Cohere", "command-r-08-2024", 0.15, 0.60},
+    {"Cohere", "command-r", 0.50, 1.50},
+    {"Cohere", "command-light", 0.30, 0.60},
+    {"Cohere", "command", 1.00, 2.00},
+
+    {"DeepSeek", "deepseek-chat", 0.14, 0.28},
+    {"DeepSeek", "deepseek-coder", 0.14, 0.28},
+    {"DeepSeek", "deepseek-reasoner", 0.55, 2.19},
+
+    // Gemini: paid tier; the free tier is $0
+    {"Google Gemini", "gemini-2.5-pro", 1.25, 10.0},
+    {"Google Gemini", "gemini-2.5-flash", 0.15, 0.60},
+    {"Google Gemini", "gemini-2.0-flash", 0.10, 0.40},
+    {"Google Gemini", "gemini-2.0-flash-lite", 0.075, 0.30},
+    {"Google Gemini", "gemini-1.5-pro", 1.25, 5.0},
+    {"Google Gemini", "gemini-1.5-flash", 0.075, 0.30},
+
+    // Veo bills per generated second (~$0.50 Veo 3, ~$0.35 Veo 2); these are
+    // token-based placeholders for the estimation framework
+    {"Google Veo", "veo-3", 50.0, 50.0},
+    {"Google Veo", "veo-2", 35.0, 35.0},
+
+    {"Groq", "llama-3.3-70b-versatile", 0.59, 0.79},
+    {"Groq", "llama-3.1-70b-versatile", 0.59, 0.79},
+    {"Groq", "llama-3.1-8b-instant", 0.05, 0.08},
+    {"Groq", "mixtral-8x7b-32768", 0.24, 0.24},
+    {"Groq", "gemma2-9b-it", 0.20, 0.20},
+
+    // "-latest" aliases resolve through prefix matching
+    {"Mistral AI", "mistral-large", 2.0, 6.0},
+    {"Mistral AI", "mistral-medium", 2.7, 8.1},
+    {"Mistral AI", "mistral-small", 0.2, 0.6},
+    {"Mistral AI", "codestral", 0.3, 0.9},
+    {"Mistral AI", "open-mistral-nemo", 0.15, 0.15},
+    {"Mistral AI", "pixtral", 0.15, 0.15},
+
+    // Cached input is 0.5× for gpt-4o / o1 / o3-mini, less for newer models
+    {"OpenAI", "gpt-4o", 2.50, 10.00},
+    {"OpenAI", "gpt-4o-mini", 0.15, 0.60},
+    {"OpenAI", "gpt-4.1", 2.00, 8.00, 0.50},
+    {"OpenAI", "gpt-4.1-mini", 0.40, 1.60, 0.10},
+    {"OpenAI", "gpt-4.1-nano", 0.10, 0.40, 0.025},
+    {"OpenAI", "gpt-5", 1.25, 10.00, 0.125},
+    {"OpenAI", "gpt-5-mini", 0.25, 2.00, 0.025},
+    {"OpenAI", "gpt-5-nano", 0.05, 0.40, 0.005},
+    {"OpenAI", "o1", 15.00, 60.00},
+    {"OpenAI", "o1-mini", 1.10, 4.40},
+    {"OpenAI", "o3", 2.00, 8.00, 0.50},
+    {"OpenAI", "o3-mini", 1.10, 4.40},
+    {"OpenAI", "o4-mini", 1.10, 4.40, 0.275},
+
+    // OpenRouter adds a small margin; these are approximate pass-through prices
+    {"OpenRouter", "openai/gpt-4o", 2.50, 10.00},
+    {"OpenRouter", "openai/gpt-4o-mini", 0.15, 0.60},
+    {"OpenRouter", "openai/gpt-4.1", 2.00, 8.00},
+    {"OpenRouter", "openai/gpt-4.1-mini", 0.40, 1.60},
+    {"OpenRouter", "openai/gpt-4.1-nano", 0.10, 0.40},
+    {"OpenRouter", "openai/o3", 2.00, 8.00},
+    {"OpenRouter", "openai/o3-mini", 1.10, 4.40},
+    {"OpenRouter", "openai/o4-mini", 1.10, 4.40},
+    {"OpenRouter", "anthropic/claude-sonnet-4", 3.00, 15.00},
+    {"OpenRouter", "anthropic/claude-opus-4", 15.00, 75.00},
+    {"OpenRouter", "anthropic/claude-3.5-haiku", 0.80, 4.00},
+    {"OpenRouter", "google/gemini-2.5-pro", 1.25, 10.00},
+    {"OpenRouter", "google/gemini-2.5-flash", 0.15, 0.60},
+    {"OpenRouter", "google/gemini-2.0-flash", 0.10, 0.40},
+    {"OpenRouter", "meta-llama/llama-3.3-70b-instruct", 0.39, 0.39},
+    {"OpenRouter", "meta-llama/llama-4-maverick", 0.20, 0.60},
+    {"OpenRouter", "meta-llama/llama-4-scout", 0.15, 0.35},
+    {"OpenRouter", "deepseek/deepseek-chat-v3", 0.14, 0.28},
+    {"OpenRouter", "deepseek/deepseek-r1", 0.55, 2.19},
+    {"OpenRouter", "mistralai/mistral-large", 2.00, 6.00},
+    {"OpenRouter", "qwen/qwen-2.5-72b-instruct", 0.36, 0.36},
+    {"OpenRouter", "x-ai/grok-3", 3.00, 15.00},
+    {"OpenRouter", "x-ai/grok-3-mini", 0.30, 0.50},
+
+    {"Together AI", "meta-llama/Llama-3.3-70B-Instruct-Turbo", 0.88, 0.88},
+    {"Together AI", "meta-llama/Meta-Llama-3.1-8B-Instruct-Turbo", 0.18, 0.18},
+    {"Together AI", "meta-llama/Meta-Llama-3.1-70B-Instruct-Turbo", 0.88, 0.88},
+    {"Together AI", "meta-llama/Meta-Llama-3.1-405B-Instruct-Turbo", 3.50, 3.50},
+    {"Together AI", "meta-llama/Llama-4-Maverick-17B-128E-Instruct-FP8", 0.27, 0.85},
+    {"Together AI", "meta-llama/Llama-4-Scout-17B-16E-Instruct", 0.18, 0.30},
+    {"Together AI", "Qwen/Qwen2.5-72B-Instruct-Turbo", 1.20, 1.20},
+    {"Together AI", "Qwen/Qwen2.5-7B-Instruct-Turbo", 0.30, 0.30},
+    {"Together AI", "deepseek-ai/DeepSeek-V3", 0.90, 0.90},
+    {"Together AI", "deepseek-ai/DeepSeek-R1", 3.00, 7.00},
+    {"Together AI", "mistralai/Mixtral-8x7B-Instruct-v0.1", 0.60, 0.60},
+    {"Together AI", "google/gemma-2-27b-it", 0.80, 0.80},
+
+    {"xAI", "grok-3", 3.0, 15.0},
+    {"xAI", "grok-3-mini", 0.30, 0.50},
+    {"xAI", "grok-2", 2.0, 10.0},
+    {"xAI", "grok-2-mini", 2.0, 10.0},
+};
+
+struct CacheRatio {
+    const char *provider;
+    double read;
+    double write;
+};
+
+// Prompt-cache rates relative to the input rate. OpenAI-style APIs only
+// report cache reads; writes are billed as plain input.
+constexpr CacheRatio CACHE_RATIOS[] = {
+    {"Anthropic", 0.10, 1.25},
+    {"Azure OpenAI", 0.50, 1.0},
+    {"OpenAI", 0.50, 1.0},
+};
+
+PricingCatalog loadInstance()
+{
+    PricingCatalog catalog = PricingCatalog::builtin();
+
+    QFile file(PricingCatalog::overridePath());
+    if (!file.exists())
+        return catalog;
+    if (!file.open(QIODevice::ReadOnly)) {
+        qWarning() << "PricingCatalog: cannot read" << file.fileName() << file.errorString();
+        return catalog;
+    }
+
+    QJsonParseError parseError;
+    const QJsonDocument doc = QJsonDocument::fromJson(file.readAll(), &parseError);
+    if (!doc.isObject()) {
+        qWarning() << "PricingCatalog: ignoring" << file.fileName() << "-" << parseError.errorString();
+        return catalog;
+    }
+
+    const int applied = catalog.applyOverrides(doc.object());
+    qDebug() << "PricingCatalog: applied" << applied << "price overrides from" << file.fileName();
+    return catalog;
+}
+
+} // namespace
+
+// ── Construction ──
+
+const PricingCatalog &PricingCatalog::instance()
+{
+    // Built once, thread-safely, and never modified afterwards
+    static const PricingCatalog catalog = loadInstance();
+    return catalog;
+}
+
+PricingCatalog PricingCatalog::builtin()
+{
+    PricingCatalog catalog;
+    for (const BuiltinPrice &entry : BUILTIN_PRICES) {
+        const QString provider = QString::fromLatin1(entry.provider);
+        Price price = withCacheRates(provider, entry.inputPerMToken, entry.outputPerMToken);
+        if (entry.cacheReadPerMToken >= 0.0)
+            price.cacheReadPerMToken = entry.cacheReadPerMToken;
+        catalog.insert(provider, QString::fromLatin1(entry.model), price);
+    }
+    return catalog;
+}
+
+PricingCatalog::Price PricingCatalog::withCacheRates(const QString &provider, double inputPerMToken, double outputPerMToken)
+{
+    double read = 1.0;
+    double write = 1.0;
+    for (const CacheRatio &ratio : CACHE_RATIOS) {
+        if (provider == QLatin1String(ratio.provider)) {
+            read = ratio.read;
+            write = ratio.write;
+            break;
+        }
+    }
+    return Price{inputPerMToken, outputPerMToken, inputPerMToken * read, inputPerMToken * write};
+}
+
+QString PricingCatalog::overridePath()
+{
+    return QStandardPaths::writableLocation(QStandardPaths::GenericDataLocation)
+           + QStringLiteral("/plasma-ai-usage-monitor/pricing.json");
+}
+
+void PricingCatalog::insert(const QString &provider, const QString &model, Price price)
+{
+    QList<Entry> &table = m_tables[provider];
+    const auto it = std::lower_bound(table.begin(), table.end(), model,
+                                     [](const Entry &entry, const QString &key) { return entry.model < key; });
+    if (it != table.end() && it->model == model)
+        it->price = price;
+    else
+        table.insert(it, Entry{model, price});
+}
+
+int PricingCatalog::applyOverrides(const QJsonObject &overrides)
+{
+    int applied = 0;
+    for (auto provider = overrides.constBegin(); provider != overrides.constEnd(); ++provider) {
+        const QJsonObject models = provider.value().toObject();
+        for (auto model = models.constBegin(); model != models.constEnd(); ++model) {
+            const QJsonObject price = model.value().toObject();
+            const QJsonValue input = price.value(QStringLiteral("input"));
+            const QJsonValue output = price.value(QStringLiteral("output"));
+            if (model.key().isEmpty() || !input.isDouble() || !output.isDouble()
+                || input.toDouble() < 0.0 || output.toDouble() < 0.0) {
+                qWarning() << "PricingCatalog: skipping malformed price for" << provider.key() << model.key();
+                continue;
+            }
+            Price entry = withCacheRates(provider.key(), input.toDouble(), output.toDouble());
+            const double cacheRead = price.value(QStringLiteral("cache_read")).toDouble(entry.cacheReadPerMToken);
+            const double cacheWrite = price.value(QStringLiteral("cache_write")).toDouble(entry.cacheWritePerMToken);
+            entry.cacheReadPerMToken = qMax(0.0, cacheRead);
+            entry.cacheWritePerMToken = qMax(0.0, cacheWrite);
+            insert(provider.key(), model.key(), entry);
+            ++applied;
+        }
+    }
+    return applied;
+}
+
+// ── Lookup ──
+
+const PricingCatalog::Price *PricingCatalog::find(const QString &provider, QStringView model) const
+{
+    const auto tableIt = m_tables.constFind(provider);
+    if (tableIt == m_tables.constEnd())
+        return nullptr;
+    const QList<Entry> &table = *tableIt;
+
+    // Every key that is a prefix of `probe` sorts at or before it, and so
+    // does everything between such a key and `probe`. So the greatest key
+    // not after `probe` is either the answer or shares with `probe` a
+    // common prefix that still contains every candidate; shrink and repeat.
+    QStringView probe = model;
+    while (!probe.isEmpty()) {
+        auto it = std::upper_bound(table.cbegin(), table.cend(), probe,
+                                   [](QStringView key, const Entry &entry) { return key < QStringView(entry.model); });
+        if (it == table.cbegin())
+            return nullptr;
+        --it;
+
+        const QStringView key(it->model);
+        if (probe.startsWith(key))
+            return &it->price;
+
+        qsizetype common = 0;
+        const qsizetype limit = qMin(key.size(), probe.size());
+        while (common < limit && key[common] == probe[common])
+            ++common;
+        probe = probe.left(common);
+    }
+    return nullptr;
+}
+
+int PricingCatalog::size() const
+{
+    int count = 0;
+    for (const QList<Entry> &table : m_tables)
+        count += table.size();
+    return count;
+}
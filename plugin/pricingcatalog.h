@@ -0,0 +1,75 @@
+#ifndef PRICINGCATALOG_H
+#define PRICINGCATALOG_H
+
+#include <QHash>
+#include <QJsonObject>
+#include <QList>
+#include <QString>
+#include <QStringView>
+
+/**
+ * Read-only model pricing shared by every provider backend.
+ *
+ * The built-in prices are a constexpr table compiled into the plugin; on
+ * first use they are sorted into one table per provider and merged with
+ * the optional override file
+ * `$XDG_DATA_HOME/plasma-ai-usage-monitor/pricing.json`:
+ *
+ *   { "Mistral AI": { "mistral-large": { "input": 2.0, "output": 6.0 } } }
+ *
+ * Provider keys are ProviderBackend::name(); prices are dollars per
+ * million tokens. An override replaces the built-in entry of the same
+ * model and may add new ones. Optional "cache_read" and "cache_write"
+ * rates default to the provider's ratio to "input" (see withCacheRates()).
+ *
+ * Lookups return the entry whose model name is the longest prefix of the
+ * requested one ("mistral-large-2411" → "mistral-large"), independent of
+ * insertion or hash order.
+ */
+class PricingCatalog
+{
+public:
+    struct Price {
+        double inputPerMToken = 0.0;      // $ per 1M input tokens
+        double outputPerMToken = 0.0;     // $ per 1M output tokens
+        double cacheReadPerMToken = 0.0;  // $ per 1M input tokens read from the prompt cache
+        double cacheWritePerMToken = 0.0; // $ per 1M input tokens written to the prompt cache
+    };
+
+    /// The process-wide catalog: built-in prices plus the override file.
+    static const PricingCatalog &instance();
+
+    /// Only the compiled-in prices.
+    static PricingCatalog builtin();
+
+    /// A price whose cache rates follow the provider's published ratio to
+    /// the input rate (Anthropic reads 0.1×, writes 1.25×); providers
+    /// without prompt caching bill cached tokens as plain input.
+    static Price withCacheRates(const QString &provider, double inputPerMToken, double outputPerMToken);
+
+    /// Path of the JSON override file read by instance().
+    static QString overridePath();
+
+    /// Add or replace one entry. Only used while building a catalog.
+    void insert(const QString &provider, const QString &model, Price price);
+
+    /// Apply an override document (see class comment). Malformed entries are
+    /// skipped with a warning; returns the number of entries applied.
+    int applyOverrides(const QJsonObject &overrides);
+
+    /// Longest-prefix match of `model` among the provider's entries.
+    const Price *find(const QString &provider, QStringView model) const;
+
+    /// Number of entries across all providers.
+    int size() const;
+
+private:
+    struct Entry {
+        QString model;
+        Price price;
+    };
+
+    QHash<QString, QList<Entry>> m_tables; // per provider, sorted by model
+};
+
+#endif // PRICINGCATALOG_H
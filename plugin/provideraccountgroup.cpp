@@ -0,0 +1,457 @@
+#include "provideraccountgroup.h"
+#include "anthropicprovider.h"
+#include "azureopenaiprovider.h"
+#include "cohereprovider.h"
+#include "deepseekprovider.h"
+#include "googleprovider.h"
+#include "googleveoprovider.h"
+#include "groqprovider.h"
+#include "mistralprovider.h"
+#include "openaiprovider.h"
+#include "openrouterprovider.h"
+#include "togetherprovider.h"
+#include "xaiprovider.h"
+
+#include <KLocalizedString>
+#include <QDebug>
+#include <QSet>
+
+#include <limits>
+#include <memory>
+#include <utility>
+
+ProviderAccountGroup::ProviderAccountGroup(QObject *parent)
+    : ProviderBackend(parent)
+    , m_name(QStringLiteral("Unknown"))
+    , m_iconName(QStringLiteral("globe"))
+{
+}
+
+QString ProviderAccountGroup::name() const { return m_name; }
+QString ProviderAccountGroup::iconName() const { return m_iconName; }
+
+ProviderBackend *ProviderAccountGroup::createBackend(ProviderId providerId, QObject *parent)
+{
+    switch (providerId) {
+    case ProviderId::OpenAI: return new OpenAIProvider(parent);
+    case ProviderId::Anthropic: return new AnthropicProvider(parent);
+    case ProviderId::Google: return new GoogleProvider(parent);
+    case ProviderId::Mistral: return new MistralProvider(parent);
+    case ProviderId::DeepSeek: return new DeepSeekProvider(parent);
+    case ProviderId::Groq: return new GroqProvider(parent);
+    case ProviderId::XAI: return new XAIProvider(parent);
+    case ProviderId::OpenRouter: return new OpenRouterProvider(parent);
+    case ProviderId::Together: return new TogetherProvider(parent);
+    case ProviderId::Cohere: return new CohereProvider(parent);
+    case ProviderId::GoogleVeo: return new GoogleVeoProvider(parent);
+    case ProviderId::AzureOpenAI: return new AzureOpenAIProvider(parent);
+    case ProviderId::Unknown:
+    default:
+        return nullptr;
+    }
+}
+
+// ── Configuration ──
+
+QString ProviderAccountGroup::providerKey() const { return providerKeyFromId(m_providerId); }
+void ProviderAccountGroup::setProviderKey(const QString &providerKey)
+{
+    const ProviderId providerId = providerIdFromKey(providerKey);
+    if (providerId == m_providerId)
+        return;
+    if (providerId == ProviderId::Unknown)
+        qWarning() << "ProviderAccountGroup: unknown provider" << providerKey;
+
+    m_providerId = providerId;
+    if (const std::unique_ptr<ProviderBackend> probe(createBackend(providerId)); probe) {
+        m_name = probe->name();
+        m_iconName = probe->iconName();
+    }
+
+    // Every backend is of the old type: rebuild them all
+    for (const Account &account : std::exchange(m_accounts, {}))
+        releaseAccount(account);
+    setAccounts(m_configuredAccounts);
+}
+
+QVariantList ProviderAccountGroup::accounts() const { return m_configuredAccounts; }
+
+void ProviderAccountGroup::setAccounts(const QVariantList &accounts)
+{
+    m_configuredAccounts = accounts;
+    QList<Account> previous = std::exchange(m_accounts, {});
+    QSet<QString> seen;
+
+    for (const QVariant &entry : accounts) {
+        const QVariantMap map = entry.toMap();
+        Account account;
+        account.id = map.value(QStringLiteral("id")).toString().trimmed();
+        if (account.id.isEmpty() || seen.contains(account.id)) {
+            qWarning() << "ProviderAccountGroup:" << m_name << "- skipping account without a unique id";
+            continue;
+        }
+        seen.insert(account.id);
+
+        account.label = map.value(QStringLiteral("label")).toString();
+        if (account.label.isEmpty())
+            account.label = account.id;
+        account.enabled = map.value(QStringLiteral("enabled"), true).toBool();
+
+        // Each account needs its own wallet slot; default to one per id
+        QString slot = map.value(QStringLiteral("authKeySlot")).toString().trimmed();
+        if (slot.isEmpty())
+            slot = defaultAuthKeySlotForProvider(m_providerId) + QLatin1Char('_') + account.id;
+        account.config = makeProviderConfig(providerKey(),
+                                            map.value(QStringLiteral("baseUrl")).toString(),
+                                            map.value(QStringLiteral("model")).toString(),
+                                            map.value(QStringLiteral("deploymentId")).toString(),
+                                            QString(), slot);
+
+        // Keep the backend (and its key, caches and figures) if nothing it
+        // was built from has changed
+        for (qsizetype i = 0; i < previous.size(); ++i) {
+            const Account &old = previous.at(i);
+            if (old.id == account.id && old.config.baseUrl == account.config.baseUrl
+                && old.config.modelId == account.config.modelId
+                && old.config.deploymentId == account.config.deploymentId
+                && old.config.authKeySlot == account.config.authKeySlot) {
+                account.backend = old.backend;
+                account.inFlight = old.inFlight;
+                previous.removeAt(i);
+                break;
+            }
+        }
+        if (!account.backend)
+            account.backend = createAccountBackend(account);
+
+        m_accounts.append(account);
+    }
+
+    for (const Account &old : std::as_const(previous))
+        releaseAccount(old);
+    m_pending.removeIf([this](const QString &id) { return !findAccount(id); });
+
+    Q_EMIT accountsChanged();
+
+    // Removed accounts may have been the last ones this cycle waited for
+    if (isLoading())
+        startPendingAccounts();
+}
+
+int ProviderAccountGroup::accountCount() const { return m_accounts.size(); }
+
+int ProviderAccountGroup::connectedAccounts() const
+{
+    int connected = 0;
+    for (const Account &account : m_accounts) {
+        if (account.enabled && account.backend && account.backend->isConnected())
+            ++connected;
+    }
+    return connected;
+}
+
+int ProviderAccountGroup::maxConcurrentAccounts() const { return m_maxConcurrentAccounts; }
+void ProviderAccountGroup::setMaxConcurrentAccounts(int accounts)
+{
+    accounts = qBound(1, accounts, MAX_CONCURRENT_ACCOUNTS);
+    if (m_maxConcurrentAccounts == accounts)
+        return;
+
+    m_maxConcurrentAccounts = accounts;
+    Q_EMIT accountsChanged();
+    if (isLoading())
+        startPendingAccounts();
+}
+
+UsageDatabase *ProviderAccountGroup::database() const { return m_database; }
+void ProviderAccountGroup::setDatabase(UsageDatabase *database)
+{
+    if (m_database == database)
+        return;
+
+    m_database = database;
+    for (const Account &account : std::as_const(m_accounts)) {
+        if (account.backend)
+            applyDatabase(account.backend);
+    }
+    Q_EMIT databaseChanged();
+}
+
+void ProviderAccountGroup::setAccountKey(const QString &accountId, const QString &key)
+{
+    if (key.isEmpty())
+        m_keys.remove(accountId);
+    else
+        m_keys.insert(accountId, key);
+
+    if (Account *account = findAccount(accountId); account && account->backend)
+        account->backend->setApiKey(key);
+}
+
+ProviderAccountGroup::Account *ProviderAccountGroup::findAccount(const QString &accountId)
+{
+    for (Account &account : m_accounts) {
+        if (account.id == accountId)
+            return &account;
+    }
+    return nullptr;
+}
+
+const ProviderAccountGroup::Account *ProviderAccountGroup::findAccount(const QString &accountId) const
+{
+    for (const Account &account : m_accounts) {
+        if (account.id == accountId)
+            return &account;
+    }
+    return nullptr;
+}
+
+void ProviderAccountGroup::releaseAccount(const Account &account)
+{
+    if (account.inFlight)
+        --m_inFlight;
+    if (account.backend) {
+        // Deferred: the backend may be the sender of the current signal
+        account.backend->disconnect(this);
+        account.backend->deleteLater();
+    }
+}
+
+ProviderBackend *ProviderAccountGroup::createAccountBackend(const Account &account)
+{
+    ProviderBackend *backend = createBackend(m_providerId, this);
+    if (!backend)
+        return nullptr;
+
+    if (!account.config.baseUrl.isEmpty())
+        backend->setCustomBaseUrl(account.config.baseUrl);
+    // Only some provider types have these; setProperty() is a no-op elsewhere
+    if (!account.config.modelId.isEmpty())
+        backend->setProperty("model", account.config.modelId);
+    if (!account.config.deploymentId.isEmpty())
+        backend->setProperty("deploymentId", account.config.deploymentId);
+    if (m_keys.contains(account.id))
+        backend->setApiKey(m_keys.value(account.id));
+    applyDatabase(backend);
+
+    const QString id = account.id;
+    connect(backend, &ProviderBackend::loadingChanged, this, [this, id]() {
+        onAccountLoadingChanged(id);
+    });
+    connect(backend, &ProviderBackend::quotaWarning, this, [this, id](const QString &, int percentUsed) {
+        const Account *account = findAccount(id);
+        Q_EMIT quotaWarning(QStringLiteral("%1 (%2)").arg(m_name, account ? account->label : id), percentUsed);
+    });
+    return backend;
+}
+
+void ProviderAccountGroup::applyDatabase(ProviderBackend *backend) const
+{
+    // Ledger rows are keyed by the account's key, so accounts can share it
+    if (backend->metaObject()->indexOfProperty("ledger") >= 0)
+        backend->setProperty("ledger", QVariant::fromValue(m_database.data()));
+}
+
+// ── Status ──
+
+QVariantList ProviderAccountGroup::accountStatus() const
+{
+    QVariantList list;
+    for (const Account &account : m_accounts) {
+        QVariantMap status{
+            {QStringLiteral("id"), account.id},
+            {QStringLiteral("label"), account.label},
+            {QStringLiteral("authKeySlot"), account.config.authKeySlot},
+            {QStringLiteral("enabled"), account.enabled},
+        };
+        if (const ProviderBackend *backend = account.backend) {
+            status.insert(QStringLiteral("hasKey"), backend->hasApiKey());
+            status.insert(QStringLiteral("connected"), backend->isConnected());
+            status.insert(QStringLiteral("loading"), backend->isLoading());
+            status.insert(QStringLiteral("error"), backend->errorString());
+            status.insert(QStringLiteral("inputTokens"), backend->inputTokens());
+            status.insert(QStringLiteral("outputTokens"), backend->outputTokens());
+            status.insert(QStringLiteral("requestCount"), backend->requestCount());
+            status.insert(QStringLiteral("cost"), backend->cost());
+            status.insert(QStringLiteral("dailyCost"), backend->dailyCost());
+            status.insert(QStringLiteral("monthlyCost"), backend->monthlyCost());
+            status.insert(QStringLiteral("costMicros"), backend->costMicros());
+            status.insert(QStringLiteral("dailyCostMicros"), backend->dailyCostMicros());
+            status.insert(QStringLiteral("monthlyCostMicros"), backend->monthlyCostMicros());
+            status.insert(QStringLiteral("rateLimitRequests"), backend->rateLimitRequests());
+            status.insert(QStringLiteral("rateLimitRequestsRemaining"), backend->rateLimitRequestsRemaining());
+            status.insert(QStringLiteral("rateLimitTokens"), backend->rateLimitTokens());
+            status.insert(QStringLiteral("rateLimitTokensRemaining"), backend->rateLimitTokensRemaining());
+            status.insert(QStringLiteral("rateLimitResetTime"), backend->rateLimitResetTime());
+            status.insert(QStringLiteral("lastRefreshed"), backend->lastRefreshed());
+        }
+        list.append(status);
+    }
+    return list;
+}
+
+ProviderBackend *ProviderAccountGroup::accountBackend(const QString &accountId) const
+{
+    const Account *account = findAccount(accountId);
+    return account ? account->backend.data() : nullptr;
+}
+
+// ── Refresh ──
+
+void ProviderAccountGroup::refresh()
+{
+    QStringList due;
+    for (const Account &account : std::as_const(m_accounts)) {
+        if (account.enabled && account.backend && account.backend->hasApiKey())
+            due.append(account.id);
+    }
+    if (due.isEmpty()) {
+        setError(i18n("No API key configured"));
+        setConnected(false);
+        return;
+    }
+
+    if (!beginRefresh())
+        return;
+    setLoading(true);
+    clearError();
+
+    m_pending = due;
+    startPendingAccounts();
+}
+
+void ProviderAccountGroup::abortRefresh()
+{
+    // Accounts leave the cycle first, so their loadingChanged() starts
+    // nothing new
+    m_pending.clear();
+    for (const Account &account : std::as_const(m_accounts)) {
+        if (account.backend && account.backend->isLoading())
+            account.backend->abortRefresh();
+    }
+    ProviderBackend::abortRefresh();
+}
+
+void ProviderAccountGroup::startPendingAccounts()
+{
+    while (m_inFlight < m_maxConcurrentAccounts && !m_pending.isEmpty()) {
+        Account *account = findAccount(m_pending.takeFirst());
+        // An account still busy from an aborted cycle already counts
+        if (!account || !account->backend || account->inFlight)
+            continue;
+
+        account->backend->refresh();
+        if (account->backend->isLoading()) {
+            account->inFlight = true;
+            ++m_inFlight;
+        }
+    }
+
+    if (m_inFlight == 0 && m_pending.isEmpty() && isLoading())
+        finishRefresh();
+}
+
+void ProviderAccountGroup::onAccountLoadingChanged(const QString &accountId)
+{
+    Account *account = findAccount(accountId);
+    if (!account || !account->inFlight || !account->backend || account->backend->isLoading())
+        return;
+
+    account->inFlight = false;
+    --m_inFlight;
+
+    // Deferred: the account emits dataUpdated() after clearing loading
+    QMetaObject::invokeMethod(this, [this]() {
+        if (isLoading())
+            startPendingAccounts();
+    }, Qt::QueuedConnection);
+}
+
+void ProviderAccountGroup::finishRefresh()
+{
+    qint64 inputTokens = 0;
+    qint64 outputTokens = 0;
+    qint64 requests = 0;
+    qint64 costMicros = 0;
+    qint64 dailyCostMicros = 0;
+    qint64 monthlyCostMicros = 0;
+    bool estimatedCost = false;
+    int connected = 0;
+    int failed = 0;
+    QString firstError;
+
+    // The account with the least headroom sets the group's rate limits
+    const ProviderBackend *tightestRequests = nullptr;
+    const ProviderBackend *tightestTokens = nullptr;
+    const auto headroom = [](int remaining, int limit) { return double(remaining) / limit; };
+
+    for (const Account &account : std::as_const(m_accounts)) {
+        const ProviderBackend *backend = account.backend;
+        if (!account.enabled || !backend || !backend->hasApiKey())
+            continue;
+
+        if (!backend->errorString().isEmpty()) {
+            ++failed;
+            if (firstError.isEmpty())
+                firstError = QStringLiteral("%1: %2").arg(account.label, backend->errorString());
+        }
+        if (!backend->isConnected())
+            continue;
+
+        ++connected;
+        inputTokens += backend->inputTokens();
+        outputTokens += backend->outputTokens();
+        requests += backend->requestCount();
+        costMicros += backend->costMicros();
+        // One estimated share makes the whole total an estimate
+        estimatedCost = estimatedCost || (backend->isEstimatedCost() && backend->costMicros() > 0);
+        dailyCostMicros += backend->dailyCostMicros();
+        monthlyCostMicros += backend->monthlyCostMicros();
+
+        if (backend->rateLimitRequests() > 0
+            && (!tightestRequests
+                || headroom(backend->rateLimitRequestsRemaining(), backend->rateLimitRequests())
+                       < headroom(tightestRequests->rateLimitRequestsRemaining(), tightestRequests->rateLimitRequests()))) {
+            tightestRequests = backend;
+        }
+        if (backend->rateLimitTokens() > 0
+            && (!tightestTokens
+                || headroom(backend->rateLimitTokensRemaining(), backend->rateLimitTokens())
+                       < headroom(tightestTokens->rateLimitTokensRemaining(), tightestTokens->rateLimitTokens()))) {
+            tightestTokens = backend;
+        }
+    }
+
+    setInputTokens(inputTokens);
+    setOutputTokens(outputTokens);
+    setRequestCount(int(qMin<qint64>(requests, std::numeric_limits<int>::max())));
+    setCostMicros(costMicros, estimatedCost);
+    setDailyCostMicros(dailyCostMicros);
+    setMonthlyCostMicros(monthlyCostMicros);
+
+    setRateLimitRequests(tightestRequests ? tightestRequests->rateLimitRequests() : 0);
+    setRateLimitRequestsRemaining(tightestRequests ? tightestRequests->rateLimitRequestsRemaining() : 0);
+    setRateLimitTokens(tightestTokens ? tightestTokens->rateLimitTokens() : 0);
+    setRateLimitTokensRemaining(tightestTokens ? tightestTokens->rateLimitTokensRemaining() : 0);
+    const ProviderBackend *resetSource = tightestRequests ? tightestRequests : tightestTokens;
+    setRateLimitResetTime(resetSource ? resetSource->rateLimitResetTime() : QString());
+
+    if (failed > 0)
+        setError(i18np("%1 account failed. %2", "%1 accounts failed. %2", failed, firstError));
+
+    setConnected(connected > 0);
+    setLoading(false);
+    if (connected > 0)
+        updateLastRefreshed();
+
+    if (m_database && connected > 0) {
+        QVariantList answered;
+        for (const QVariant &status : accountStatus()) {
+            const QVariantMap map = status.toMap();
+            if (map.value(QStringLiteral("enabled")).toBool() && map.value(QStringLiteral("connected")).toBool())
+                answered.append(map);
+        }
+        m_database->recordAccountSnapshots(m_name, answered);
+    }
+    Q_EMIT dataUpdated();
+}
@@ -0,0 +1,140 @@
+#ifndef PROVIDERACCOUNTGROUP_H
+#define PROVIDERACCOUNTGROUP_H
+
+#include "providerbackend.h"
+#include "usagedatabase.h"
+
+#include <QHash>
+#include <QList>
+#include <QPointer>
+
+/**
+ * One provider polled through several accounts (API keys).
+ *
+ * Set `providerKey` once (e.g. "openai", see providerIdFromKey()), then
+ * `accounts` to a list of maps:
+ *
+ *   { id: "team-a", label: "Team A", authKeySlot: "openai_team_a",
+ *     baseUrl: "", model: "", deploymentId: "", enabled: true }
+ *
+ * Each account gets its own backend of the provider's type, configured
+ * through makeProviderConfig(); only `id` is required and unique. Keys are
+ * handed over per account with setAccountKey(), typically after reading
+ * `authKeySlot` from the wallet.
+ *
+ * refresh() polls the enabled accounts that have a key, at most
+ * `maxConcurrentAccounts` at a time; every request still goes through the
+ * shared network manager and its per-host connection limit. Once all of
+ * them have answered, the group's own figures become the aggregate:
+ * tokens, requests and costs are summed over connected accounts, and the
+ * rate limits are those of the account with the least headroom, so quota
+ * warnings fire as soon as any key runs low. Budgets set on the group apply
+ * to the summed costs. accountStatus() lists each account's own figures.
+ *
+ * With a `database`, each completed cycle records the connected accounts'
+ * figures with UsageDatabase::recordAccountSnapshots(), and account
+ * backends that keep a billing ledger (OpenAI) get it as their `ledger`.
+ *
+ * Usage from QML:
+ *   ProviderAccountGroup {
+ *       providerKey: "openai"
+ *       database: usageDatabase
+ *       accounts: [{ id: "team-a" }, { id: "team-b" }]
+ *   }
+ */
+class ProviderAccountGroup : public ProviderBackend
+{
+    Q_OBJECT
+
+    Q_PROPERTY(QString providerKey READ providerKey WRITE setProviderKey NOTIFY accountsChanged)
+    Q_PROPERTY(QVariantList accounts READ accounts WRITE setAccounts NOTIFY accountsChanged)
+    Q_PROPERTY(int accountCount READ accountCount NOTIFY accountsChanged)
+    Q_PROPERTY(int connectedAccounts READ connectedAccounts NOTIFY dataUpdated)
+    Q_PROPERTY(int maxConcurrentAccounts READ maxConcurrentAccounts WRITE setMaxConcurrentAccounts NOTIFY accountsChanged)
+    Q_PROPERTY(UsageDatabase *database READ database WRITE setDatabase NOTIFY databaseChanged)
+
+public:
+    explicit ProviderAccountGroup(QObject *parent = nullptr);
+
+    QString name() const override;
+    QString iconName() const override;
+
+    QString providerKey() const;
+    /// Provider type of every account. Changing it recreates all accounts.
+    void setProviderKey(const QString &providerKey);
+
+    QVariantList accounts() const;
+    /// Replace the account list. Accounts whose id and configuration are
+    /// unchanged keep their backend, key and figures.
+    void setAccounts(const QVariantList &accounts);
+
+    int accountCount() const;
+    int connectedAccounts() const;
+
+    int maxConcurrentAccounts() const;
+    void setMaxConcurrentAccounts(int accounts);
+
+    UsageDatabase *database() const;
+    void setDatabase(UsageDatabase *database);
+
+    /// Set or clear the API key of one account.
+    Q_INVOKABLE void setAccountKey(const QString &accountId, const QString &key);
+
+    /**
+     * One entry per account, in configuration order: { id, label,
+     * authKeySlot, enabled, hasKey, connected, loading, error, inputTokens,
+     * outputTokens, requestCount, cost, dailyCost, monthlyCost, costMicros,
+     * dailyCostMicros, monthlyCostMicros, rateLimitRequests,
+     * rateLimitRequestsRemaining, rateLimitTokens, rateLimitTokensRemaining,
+     * rateLimitResetTime, lastRefreshed }. Suitable for
+     * UsageDatabase::recordAccountSnapshots().
+     */
+    Q_INVOKABLE QVariantList accountStatus() const;
+
+    /// The backend polling one account, or null.
+    Q_INVOKABLE ProviderBackend *accountBackend(const QString &accountId) const;
+
+    /// A backend of the given provider type, or null for Unknown.
+    static ProviderBackend *createBackend(ProviderId providerId, QObject *parent = nullptr);
+
+    Q_INVOKABLE void refresh() override;
+    void abortRefresh() override;
+
+Q_SIGNALS:
+    void accountsChanged();
+    void databaseChanged();
+
+private:
+    struct Account {
+        QString id;
+        QString label;
+        ProviderConfig config;
+        bool enabled = true;
+        bool inFlight = false; // counted in m_inFlight
+        QPointer<ProviderBackend> backend;
+    };
+
+    Account *findAccount(const QString &accountId);
+    const Account *findAccount(const QString &accountId) const;
+    ProviderBackend *createAccountBackend(const Account &account);
+    void releaseAccount(const Account &account);
+    void applyDatabase(ProviderBackend *backend) const;
+    void startPendingAccounts();
+    void onAccountLoadingChanged(const QString &accountId);
+    void finishRefresh();
+
+    ProviderId m_providerId = ProviderId::Unknown;
+    QString m_name;
+    QString m_iconName;
+    QVariantList m_configuredAccounts; // as set, before defaults
+    QList<Account> m_accounts;
+    QHash<QString, QString> m_keys; // account id -> API key; survives setAccounts()
+    QStringList m_pending;          // account ids still to be polled this cycle
+    int m_inFlight = 0;
+    int m_maxConcurrentAccounts = 4;
+    QPointer<UsageDatabase> m_database;
+
+    static constexpr int MAX_CONCURRENT_ACCOUNTS = 32;
+};
+
+#endif // PROVIDERACCOUNTGROUP_H
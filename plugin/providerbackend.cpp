@@ -1,7 +1,16 @@
 #include "providerbackend.h"
+#include "costmicros.h"
+#include "sharednetworkmanager.h"
 #include <QDate>
+#include <QDebug>
+#include <QPointer>
 #include <QUrl>
 #include <QRandomGenerator>
+#include <QVariantMap>
+#include <algorithm>
+#include <iterator>
+#include <memory>
+#include <utility>
 
 namespace {
 ProviderBackend::NormalizedUsageCost normalizeOpenAiLikeUsage(const QJsonObject &payload)
@@ -13,13 +22,21 @@ ProviderBackend::NormalizedUsageCost normalizeOpenAiLikeUsage(const QJsonObject
         return normalized;
     }
 
-    const qint64 promptTokens = usage.value(QStringLiteral("prompt_tokens")).toInteger(0);
-    const qint64 completionTokens = usage.value(QStringLiteral("completion_tokens")).toInteger(0);
+    // Chat completions report prompt/completion tokens, the Responses API input/output
+    const qint64 promptTokens = usage.value(QStringLiteral("prompt_tokens"))
+                                    .toInteger(usage.value(QStringLiteral("input_tokens")).toInteger(0));
+    const qint64 completionTokens = usage.value(QStringLiteral("completion_tokens"))
+                                        .toInteger(usage.value(QStringLiteral("output_tokens")).toInteger(0));
     const qint64 totalTokens = usage.value(QStringLiteral("total_tokens")).toInteger(promptTokens + completionTokens);
 
+    // Cached prompt tokens are part of the prompt count, billed at a discount
+    const QJsonObject details = usage.value(QStringLiteral("prompt_tokens_details"))
+                                    .toObject(usage.value(QStringLiteral("input_tokens_details")).toObject());
+
     normalized.parsed = true;
     normalized.inputTokens = promptTokens;
     normalized.outputTokens = completionTokens > 0 ? completionTokens : qMax<qint64>(0, totalTokens - promptTokens);
+    normalized.cacheReadTokens = qBound<qint64>(0, details.value(QStringLiteral("cached_tokens")).toInteger(0), promptTokens);
     normalized.requestCount = 1;
 
     const QJsonObject cost = payload.value(QStringLiteral("cost")).toObject();
@@ -38,15 +55,50 @@ ProviderBackend::NormalizedUsageCost normalizeOpenAiLikeUsage(const QJsonObject
 
     return normalized;
 }
+
+ProviderBackend::NormalizedUsageCost normalizeAnthropicUsage(const QJsonObject &payload)
+{
+    ProviderBackend::NormalizedUsageCost normalized;
+
+    const QJsonObject usage = payload.value(QStringLiteral("usage")).toObject();
+    if (usage.isEmpty()) {
+        return normalized;
+    }
+
+    // Cache writes and reads are input tokens billed at their own rates;
+    // they are counted with the rest of the input and priced separately
+    normalized.parsed = true;
+    normalized.cacheWriteTokens = usage.value(QStringLiteral("cache_creation_input_tokens")).toInteger(0);
+    normalized.cacheReadTokens = usage.value(QStringLiteral("cache_read_input_tokens")).toInteger(0);
+    normalized.inputTokens = usage.value(QStringLiteral("input_tokens")).toInteger(0)
+        + normalized.cacheWriteTokens + normalized.cacheReadTokens;
+    normalized.outputTokens = usage.value(QStringLiteral("output_tokens")).toInteger(0);
+    normalized.requestCount = 1;
+    return normalized;
+}
 } // namespace
 
 ProviderBackend::ProviderBackend(QObject *parent)
     : QObject(parent)
-    , m_networkManager(new QNetworkAccessManager(this))
+    , m_networkManager(SharedNetworkManager::instance())
 {
+    connect(this, &ProviderBackend::dataUpdated, this, &ProviderBackend::onDataUpdatedForCadence);
+    connect(this, &ProviderBackend::budgetChanged, this, &ProviderBackend::updateCadence);
 }
 
-ProviderBackend::~ProviderBackend() = default;
+ProviderBackend::~ProviderBackend()
+{
+    // Replies belong to the shared network manager and would otherwise run
+    // on after this backend is gone; detach them before cancelling so no
+    // handler runs against a half-destroyed object.
+    const QList<QNetworkReply *> replies = std::exchange(m_activeReplies, {});
+    for (QNetworkReply *reply : replies) {
+        reply->disconnect(this);
+        if (reply->isRunning())
+            reply->abort();
+        reply->deleteLater();
+    }
+}
 
 ProviderBackend::ProviderId ProviderBackend::providerIdFromKey(const QString &providerKey)
 {
@@ -138,6 +190,7 @@ ProviderBackend::NormalizedUsageCost ProviderBackend::normalizeUsageCost(Provide
     case ProviderId::AzureOpenAI:
         return normalizeOpenAiLikeUsage(payload);
     case ProviderId::Anthropic:
+        return normalizeAnthropicUsage(payload);
     case ProviderId::Google:
     case ProviderId::Unknown:
     default:
@@ -175,6 +228,20 @@ void ProviderBackend::setLoading(bool loading)
     if (m_loading != loading) {
         m_loading = loading;
         Q_EMIT loadingChanged();
+
+        if (!loading && m_refreshQueued) {
+            // Deferred so the finished cycle's handlers unwind first
+            m_refreshQueued = false;
+            Q_EMIT refreshStatsChanged();
+            QTimer::singleShot(0, this, [this]() {
+                if (m_loading)
+                    return;
+                // Queued by an explicit request: what just finished may
+                // have marked endpoints fresh again
+                invalidateEndpoints();
+                refresh();
+            });
+        }
     }
 }
 
@@ -201,52 +268,93 @@ qint64 ProviderBackend::inputTokens() const { return m_inputTokens; }
 qint64 ProviderBackend::outputTokens() const { return m_outputTokens; }
 qint64 ProviderBackend::totalTokens() const { return m_inputTokens + m_outputTokens; }
 int ProviderBackend::requestCount() const { return m_requestCount; }
-double ProviderBackend::cost() const { return m_cost; }
+double ProviderBackend::cost() const { return CostMicros::toDollars(m_costMicros); }
+qint64 ProviderBackend::costMicros() const { return m_costMicros; }
 bool ProviderBackend::isEstimatedCost() const { return m_isEstimatedCost; }
 
 void ProviderBackend::setInputTokens(qint64 tokens) { m_inputTokens = tokens; }
 void ProviderBackend::setOutputTokens(qint64 tokens) { m_outputTokens = tokens; }
 void ProviderBackend::setRequestCount(int count) { m_requestCount = count; }
-void ProviderBackend::setCost(double cost) {
-    m_cost = cost;
-    m_isEstimatedCost = false;
+void ProviderBackend::setCost(double cost) { setCostMicros(CostMicros::fromDollars(cost)); }
+void ProviderBackend::setCostMicros(qint64 micros, bool estimated) {
+    m_costMicros = micros;
+    m_isEstimatedCost = estimated;
     checkBudgetLimits();
 }
 
+// --- Metered Usage ---
+
+qint64 ProviderBackend::meteredInputTokens() const { return m_meteredInputTokens; }
+qint64 ProviderBackend::meteredOutputTokens() const { return m_meteredOutputTokens; }
+int ProviderBackend::meteredRequests() const { return m_meteredRequests; }
+double ProviderBackend::meteredCost() const { return CostMicros::toDollars(m_meteredCostMicros); }
+qint64 ProviderBackend::meteredCostMicros() const { return m_meteredCostMicros; }
+
+qint64 ProviderBackend::addMeteredUsage(const QString &model, const NormalizedUsageCost &usage)
+{
+    if (!usage.parsed)
+        return 0;
+
+    const qint64 costMicros = usage.cost > 0.0
+        ? CostMicros::fromDollars(usage.cost)
+        : estimatedCostMicros(model, usage.inputTokens, usage.outputTokens,
+                              usage.cacheReadTokens, usage.cacheWriteTokens);
+
+    m_meteredInputTokens += usage.inputTokens;
+    m_meteredOutputTokens += usage.outputTokens;
+    m_meteredRequests += qMax(1, usage.requestCount);
+    m_meteredCostMicros += costMicros;
+    Q_EMIT meteredUsageChanged();
+    return costMicros;
+}
+
+void ProviderBackend::resetMeteredUsage()
+{
+    m_meteredInputTokens = 0;
+    m_meteredOutputTokens = 0;
+    m_meteredRequests = 0;
+    m_meteredCostMicros = 0;
+    Q_EMIT meteredUsageChanged();
+}
+
 // --- Budget ---
 
-double ProviderBackend::dailyBudget() const { return m_dailyBudget; }
-double ProviderBackend::monthlyBudget() const { return m_monthlyBudget; }
-double ProviderBackend::dailyCost() const { return m_dailyCost; }
-double ProviderBackend::monthlyCost() const { return m_monthlyCost; }
+double ProviderBackend::dailyBudget() const { return CostMicros::toDollars(m_dailyBudgetMicros); }
+double ProviderBackend::monthlyBudget() const { return CostMicros::toDollars(m_monthlyBudgetMicros); }
+double ProviderBackend::dailyCost() const { return CostMicros::toDollars(m_dailyCostMicros); }
+double ProviderBackend::monthlyCost() const { return CostMicros::toDollars(m_monthlyCostMicros); }
+qint64 ProviderBackend::dailyCostMicros() const { return m_dailyCostMicros; }
+qint64 ProviderBackend::monthlyCostMicros() const { return m_monthlyCostMicros; }
 
 double ProviderBackend::estimatedMonthlyCost() const
 {
-    if (m_dailyCost <= 0 && m_monthlyCost <= 0) return 0.0;
+    if (m_dailyCostMicros <= 0 && m_monthlyCostMicros <= 0) return 0.0;
     int dayOfMonth = QDate::currentDate().day();
     int daysInMonth = QDate::currentDate().daysInMonth();
     if (dayOfMonth == 0) return 0.0;
 
     // If we have real monthly cost data (e.g. OpenAI billing API), project it
-    if (m_monthlyCost > 0) {
-        return (m_monthlyCost / dayOfMonth) * daysInMonth;
+    if (m_monthlyCostMicros > 0) {
+        return CostMicros::toDollars(m_monthlyCostMicros * daysInMonth / dayOfMonth);
     }
     // Fallback for estimated-cost providers: project daily cost to full month
-    return m_dailyCost * daysInMonth;
+    return CostMicros::toDollars(m_dailyCostMicros * daysInMonth);
 }
 
 void ProviderBackend::setDailyBudget(double budget)
 {
-    if (m_dailyBudget != budget) {
-        m_dailyBudget = budget;
+    const qint64 micros = CostMicros::fromDollars(budget);
+    if (m_dailyBudgetMicros != micros) {
+        m_dailyBudgetMicros = micros;
         Q_EMIT budgetChanged();
     }
 }
 
 void ProviderBackend::setMonthlyBudget(double budget)
 {
-    if (m_monthlyBudget != budget) {
-        m_monthlyBudget = budget;
+    const qint64 micros = CostMicros::fromDollars(budget);
+    if (m_monthlyBudgetMicros != micros) {
+        m_monthlyBudgetMicros = micros;
         Q_EMIT budgetChanged();
     }
 }
@@ -260,46 +368,51 @@ void ProviderBackend::setBudgetWarningPercent(int percent)
     }
 }
 
-void ProviderBackend::setDailyCost(double cost) {
-    m_dailyCost = cost;
+void ProviderBackend::setDailyCost(double cost) { setDailyCostMicros(CostMicros::fromDollars(cost)); }
+void ProviderBackend::setMonthlyCost(double cost) { setMonthlyCostMicros(CostMicros::fromDollars(cost)); }
+void ProviderBackend::setDailyCostMicros(qint64 micros) {
+    m_dailyCostMicros = micros;
     checkBudgetLimits();
 }
-void ProviderBackend::setMonthlyCost(double cost) {
-    m_monthlyCost = cost;
+void ProviderBackend::setMonthlyCostMicros(qint64 micros) {
+    m_monthlyCostMicros = micros;
     checkBudgetLimits();
 }
 
 void ProviderBackend::checkBudgetLimits()
 {
-    double warningFraction = m_budgetWarningPercent / 100.0;
+    // All comparisons are exact integer arithmetic on micro-dollars, so a
+    // cost of exactly N% of the budget always reaches the N% threshold.
 
     // Daily budget checks
-    if (m_dailyBudget > 0) {
-        if (m_dailyCost >= m_dailyBudget && !m_dailyExceededEmitted) {
+    if (m_dailyBudgetMicros > 0) {
+        if (m_dailyCostMicros >= m_dailyBudgetMicros && !m_dailyExceededEmitted) {
             m_dailyExceededEmitted = true;
-            Q_EMIT budgetExceeded(name(), QStringLiteral("daily"), m_dailyCost, m_dailyBudget);
-        } else if (m_dailyCost >= m_dailyBudget * warningFraction && !m_dailyWarningEmitted) {
+            Q_EMIT budgetExceeded(name(), QStringLiteral("daily"), dailyCost(), dailyBudget());
+        } else if (CostMicros::reachesPercent(m_dailyCostMicros, m_dailyBudgetMicros, m_budgetWarningPercent)
+                   && !m_dailyWarningEmitted) {
             m_dailyWarningEmitted = true;
-            Q_EMIT budgetWarning(name(), QStringLiteral("daily"), m_dailyCost, m_dailyBudget);
+            Q_EMIT budgetWarning(name(), QStringLiteral("daily"), dailyCost(), dailyBudget());
         }
         // Reset flags when cost drops (new billing period)
-        if (m_dailyCost < m_dailyBudget * warningFraction) {
+        if (!CostMicros::reachesPercent(m_dailyCostMicros, m_dailyBudgetMicros, m_budgetWarningPercent)) {
             m_dailyWarningEmitted = false;
             m_dailyExceededEmitted = false;
         }
     }
 
     // Monthly budget checks
-    if (m_monthlyBudget > 0) {
-        if (m_monthlyCost >= m_monthlyBudget && !m_monthlyExceededEmitted) {
+    if (m_monthlyBudgetMicros > 0) {
+        if (m_monthlyCostMicros >= m_monthlyBudgetMicros && !m_monthlyExceededEmitted) {
             m_monthlyExceededEmitted = true;
-            Q_EMIT budgetExceeded(name(), QStringLiteral("monthly"), m_monthlyCost, m_monthlyBudget);
-        } else if (m_monthlyCost >= m_monthlyBudget * warningFraction && !m_monthlyWarningEmitted) {
+            Q_EMIT budgetExceeded(name(), QStringLiteral("monthly"), monthlyCost(), monthlyBudget());
+        } else if (CostMicros::reachesPercent(m_monthlyCostMicros, m_monthlyBudgetMicros, m_budgetWarningPercent)
+                   && !m_monthlyWarningEmitted) {
             m_monthlyWarningEmitted = true;
-            Q_EMIT budgetWarning(name(), QStringLiteral("monthly"), m_monthlyCost, m_monthlyBudget);
+            Q_EMIT budgetWarning(name(), QStringLiteral("monthly"), monthlyCost(), monthlyBudget());
         }
         // Reset flags when cost drops (new billing period)
-        if (m_monthlyCost < m_monthlyBudget * warningFraction) {
+        if (!CostMicros::reachesPercent(m_monthlyCostMicros, m_monthlyBudgetMicros, m_budgetWarningPercent)) {
             m_monthlyWarningEmitted = false;
             m_monthlyExceededEmitted = false;
         }
@@ -327,6 +440,11 @@ void ProviderBackend::setCustomBaseUrl(const QString &url)
 {
     if (m_customBaseUrl != url) {
         m_customBaseUrl = url;
+        m_responseCache.clear(); // validators belong to the old endpoint
+        invalidateEndpoints();
+        m_unsupportedProbes.clear(); // a different server may answer differently
+        if (m_loading)
+            abortRefresh();
         Q_EMIT customBaseUrlChanged();
     }
 }
@@ -359,16 +477,859 @@ QString ProviderBackend::effectiveBaseUrl(const char *defaultUrl) const
 QDateTime ProviderBackend::lastRefreshed() const { return m_lastRefreshed; }
 int ProviderBackend::refreshCount() const { return m_refreshCount; }
 
+bool ProviderBackend::refreshQueued() const { return m_refreshQueued; }
+int ProviderBackend::coalescedRefreshes() const { return m_coalescedRefreshes; }
+int ProviderBackend::savedRequests() const { return m_savedRequests; }
+int ProviderBackend::abortedRequests() const { return m_abortedRequests; }
+
 void ProviderBackend::updateLastRefreshed()
 {
     m_lastRefreshed = QDateTime::currentDateTime();
     m_refreshCount++;
 }
 
+// --- Adaptive Cadence ---
+
+bool ProviderBackend::adaptiveCadence() const { return m_adaptiveCadence; }
+void ProviderBackend::setAdaptiveCadence(bool enabled)
+{
+    if (m_adaptiveCadence != enabled) {
+        m_adaptiveCadence = enabled;
+        Q_EMIT cadenceChanged();
+    }
+}
+
+double ProviderBackend::cadenceFactor() const
+{
+    return m_adaptiveCadence ? m_cadenceFactor : 1.0;
+}
+
+qint64 ProviderBackend::adaptiveIntervalMs(qint64 baseIntervalMs) const
+{
+    const double factor = cadenceFactor();
+    if (baseIntervalMs <= 0 || qFuzzyCompare(factor, 1.0))
+        return baseIntervalMs;
+
+    const qint64 scaled = qRound64(baseIntervalMs * factor);
+    return qMax(scaled, qMin(baseIntervalMs, MIN_ADAPTIVE_INTERVAL_MS));
+}
+
+// --- Rate-limit probing ---
+
+namespace {
+const QList<QPair<ProviderBackend::ProbeStrategy, QString>> &probeStrategyNames()
+{
+    static const QList<QPair<ProviderBackend::ProbeStrategy, QString>> names = {
+        {ProviderBackend::ProbeStrategy::Models, QStringLiteral("models")},
+        {ProviderBackend::ProbeStrategy::Head, QStringLiteral("head")},
+        {ProviderBackend::ProbeStrategy::CachedHeaders, QStringLiteral("cached")},
+        {ProviderBackend::ProbeStrategy::Predicted, QStringLiteral("predicted")},
+        {ProviderBackend::ProbeStrategy::ChatCompletion, QStringLiteral("chat")},
+    };
+    return names;
+}
+} // namespace
+
+QString ProviderBackend::probeStrategyName(ProbeStrategy strategy)
+{
+    for (const auto &entry : probeStrategyNames()) {
+        if (entry.first == strategy)
+            return entry.second;
+    }
+    return QString();
+}
+
+QList<ProviderBackend::ProbeStrategy> ProviderBackend::defaultProbeOrder() const
+{
+    return {ProbeStrategy::ChatCompletion};
+}
+
+QList<ProviderBackend::ProbeStrategy> ProviderBackend::probeOrder() const
+{
+    QList<ProbeStrategy> order = m_probeOrder.isEmpty() ? defaultProbeOrder() : m_probeOrder;
+    order.removeIf([this](ProbeStrategy strategy) { return m_unsupportedProbes.contains(strategy); });
+    return order;
+}
+
+QStringList ProviderBackend::probeOrderNames() const
+{
+    QStringList names;
+    for (ProbeStrategy strategy : m_probeOrder.isEmpty() ? defaultProbeOrder() : m_probeOrder)
+        names.append(probeStrategyName(strategy));
+    return names;
+}
+
+void ProviderBackend::setProbeOrderNames(const QStringList &names)
+{
+    QList<ProbeStrategy> order;
+    for (const QString &name : names) {
+        bool known = false;
+        for (const auto &entry : probeStrategyNames()) {
+            if (entry.second == name.trimmed().toLower()) {
+                if (!order.contains(entry.first))
+                    order.append(entry.first);
+                known = true;
+                break;
+            }
+        }
+        if (!known)
+            qWarning() << "ProviderBackend:" << name << "is not a probe strategy";
+    }
+
+    if (m_probeOrder != order) {
+        m_probeOrder = order;
+        Q_EMIT probeChanged();
+    }
+}
+
+int ProviderBackend::rateLimitHeaderMaxAgeMs() const { return m_rateLimitHeaderMaxAgeMs; }
+void ProviderBackend::setRateLimitHeaderMaxAgeMs(int ms)
+{
+    ms = qMax(0, ms);
+    if (m_rateLimitHeaderMaxAgeMs != ms) {
+        m_rateLimitHeaderMaxAgeMs = ms;
+        Q_EMIT probeChanged();
+    }
+}
+
+QString ProviderBackend::lastProbeStrategy() const
+{
+    return m_hasLastProbe ? probeStrategyName(m_lastProbe) : QString();
+}
+
+int ProviderBackend::lastProbeLatencyMs() const
+{
+    return m_hasLastProbe ? static_cast<int>(m_probeStats.value(m_lastProbe).lastLatencyMs) : 0;
+}
+
+int ProviderBackend::probeCount() const { return m_probeCount; }
+double ProviderBackend::probeCost() const { return CostMicros::toDollars(m_probeCostMicros); }
+qint64 ProviderBackend::probeCostMicros() const { return m_probeCostMicros; }
+
+QVariantList ProviderBackend::probeStatistics() const
+{
+    QList<ProbeStrategy> order = m_probeOrder.isEmpty() ? defaultProbeOrder() : m_probeOrder;
+
+    QVariantList result;
+    for (ProbeStrategy strategy : order) {
+        const ProbeStats stats = m_probeStats.value(strategy);
+        QVariantMap entry;
+        entry[QStringLiteral("strategy")] = probeStrategyName(strategy);
+        entry[QStringLiteral("supported")] = !m_unsupportedProbes.contains(strategy);
+        entry[QStringLiteral("count")] = stats.count;
+        entry[QStringLiteral("avgLatencyMs")] = stats.count > 0 ? stats.totalLatencyMs / stats.count : 0;
+        entry[QStringLiteral("lastLatencyMs")] = stats.lastLatencyMs;
+        entry[QStringLiteral("cost")] = CostMicros::toDollars(stats.costMicros);
+        result.append(entry);
+    }
+    return result;
+}
+
+bool ProviderBackend::hasFreshRateLimitHeaders() const
+{
+    return m_rateLimitHeadersAge.isValid()
+        && m_rateLimitHeadersAge.elapsed() <= m_rateLimitHeaderMaxAgeMs;
+}
+
+bool ProviderBackend::rateLimitModelPredictsNoChange() const
+{
+    if (!hasFreshRateLimitHeaders())
+        return false;
+
+    const qint64 now = QDateTime::currentMSecsSinceEpoch();
+    bool predicted = false;
+    for (const RateLimitBucket *bucket : {&m_requestBucket, &m_tokenBucket}) {
+        if (!bucket->isValid())
+            continue;
+        if (!bucket->canPredict())
+            return false;
+        const qint64 refilled = bucket->remainingAt(now) - bucket->observedRemaining();
+        if (refilled * 100 > bucket->limit() * PREDICTED_CHANGE_PERCENT)
+            return false;
+        predicted = true;
+    }
+    return predicted;
+}
+
+void ProviderBackend::startProbeTimer()
+{
+    m_probeTimer.start();
+}
+
+void ProviderBackend::recordProbe(ProbeStrategy strategy, qint64 costMicros)
+{
+    // Cached headers and predictions cost no round trip
+    const bool local = strategy == ProbeStrategy::CachedHeaders || strategy == ProbeStrategy::Predicted;
+    const qint64 latency = !local && m_probeTimer.isValid()
+        ? m_probeTimer.elapsed() : 0;
+
+    ProbeStats &stats = m_probeStats[strategy];
+    ++stats.count;
+    stats.totalLatencyMs += latency;
+    stats.lastLatencyMs = latency;
+    stats.costMicros += costMicros;
+
+    m_hasLastProbe = true;
+    m_lastProbe = strategy;
+    ++m_probeCount;
+    m_probeCostMicros += costMicros;
+    m_probeTimer.invalidate();
+    Q_EMIT probeChanged();
+}
+
+void ProviderBackend::markProbeUnsupported(ProbeStrategy strategy)
+{
+    if (!m_unsupportedProbes.contains(strategy)) {
+        m_unsupportedProbes.insert(strategy);
+        Q_EMIT probeChanged();
+    }
+}
+
+// --- Endpoint freshness ---
+
+QVariantMap ProviderBackend::endpointTtls() const
+{
+    QVariantMap ttls;
+    for (auto it = m_endpoints.constBegin(); it != m_endpoints.constEnd(); ++it) {
+        ttls.insert(it.key(), it->ttlMs);
+    }
+    return ttls;
+}
+
+void ProviderBackend::setEndpointTtls(const QVariantMap &ttls)
+{
+    bool changed = false;
+    for (auto it = ttls.constBegin(); it != ttls.constEnd(); ++it) {
+        const qint64 ttlMs = qMax<qint64>(0, it.value().toLongLong());
+        EndpointState &state = m_endpoints[it.key()];
+        if (state.ttlMs != ttlMs || !state.overridden) {
+            state.ttlMs = ttlMs;
+            state.overridden = true;
+            changed = true;
+        }
+    }
+    if (changed)
+        Q_EMIT endpointsChanged();
+}
+
+int ProviderBackend::skippedEndpointFetches() const { return m_skippedEndpointFetches; }
+
+QVariantList ProviderBackend::endpointStatus() const
+{
+    const qint64 now = QDateTime::currentMSecsSinceEpoch();
+
+    QStringList names = m_endpoints.keys();
+    names.sort();
+
+    QVariantList result;
+    for (const QString &name : std::as_const(names)) {
+        const EndpointState &state = m_endpoints[name];
+        const qint64 ageMs = state.fetchedAtMs > 0 ? now - state.fetchedAtMs : -1;
+
+        QVariantMap entry;
+        entry[QStringLiteral("endpoint")] = name;
+        entry[QStringLiteral("ttlMs")] = state.ttlMs;
+        entry[QStringLiteral("ageMs")] = ageMs;
+        entry[QStringLiteral("stale")] = ageMs < 0 || ageMs >= state.ttlMs;
+        result.append(entry);
+    }
+    return result;
+}
+
+void ProviderBackend::invalidateEndpoints()
+{
+    for (EndpointState &state : m_endpoints) {
+        state.fetchedAtMs = 0;
+    }
+    Q_EMIT endpointsChanged();
+}
+
+void ProviderBackend::declareEndpoint(const QString &endpoint, qint64 ttlMs)
+{
+    EndpointState &state = m_endpoints[endpoint];
+    if (!state.overridden)
+        state.ttlMs = qMax<qint64>(0, ttlMs);
+}
+
+bool ProviderBackend::endpointDue(const QString &endpoint)
+{
+    const auto it = m_endpoints.constFind(endpoint);
+    if (it == m_endpoints.constEnd() || it->fetchedAtMs == 0)
+        return true;
+
+    if (QDateTime::currentMSecsSinceEpoch() - it->fetchedAtMs >= it->ttlMs)
+        return true;
+
+    ++m_skippedEndpointFetches;
+    Q_EMIT endpointsChanged();
+    return false;
+}
+
+void ProviderBackend::markEndpointFresh(const QString &endpoint)
+{
+    m_endpoints[endpoint].fetchedAtMs = QDateTime::currentMSecsSinceEpoch();
+    Q_EMIT endpointsChanged();
+}
+
+// --- Network timing ---
+
+namespace {
+// Upper bounds of the latency histogram buckets; the last bucket is open
+const qint64 LATENCY_BUCKETS_MS[] = {10, 25, 50, 100, 250, 500, 1000, 2500, 5000};
+
+// Nearest-rank percentile of sorted values
+qint64 percentileOf(const QList<qint64> &sorted, int p)
+{
+    if (sorted.isEmpty())
+        return 0;
+    const qsizetype rank = (p * sorted.size() + 99) / 100;
+    return sorted.at(qBound<qsizetype>(0, rank - 1, sorted.size() - 1));
+}
+
+QVariantMap phaseStats(QList<qint64> values)
+{
+    QVariantList histogram;
+    for (int i = 0; i <= int(std::size(LATENCY_BUCKETS_MS)); ++i)
+        histogram.append(0);
+
+    qint64 total = 0;
+    for (qint64 value : std::as_const(values)) {
+        total += value;
+        const auto bucket = std::upper_bound(std::begin(LATENCY_BUCKETS_MS), std::end(LATENCY_BUCKETS_MS), value);
+        const int index = int(bucket - std::begin(LATENCY_BUCKETS_MS));
+        histogram[index] = histogram.at(index).toInt() + 1;
+    }
+
+    std::sort(values.begin(), values.end());
+
+    QVariantMap stats;
+    stats[QStringLiteral("count")] = values.size();
+    stats[QStringLiteral("avgMs")] = values.isEmpty() ? 0 : total / values.size();
+    stats[QStringLiteral("p50Ms")] = percentileOf(values, 50);
+    stats[QStringLiteral("p95Ms")] = percentileOf(values, 95);
+    stats[QStringLiteral("maxMs")] = values.isEmpty() ? 0 : values.last();
+    stats[QStringLiteral("histogram")] = histogram;
+    return stats;
+}
+
+QString latencyKey(const QUrl &url)
+{
+    return url.adjusted(QUrl::RemoveUserInfo | QUrl::RemoveQuery | QUrl::RemoveFragment).toString();
+}
+
+// Usage, cost and balance endpoints aggregate server-side and can take far
+// longer than the chat or model calls of the same provider
+bool isBillingEndpoint(const QUrl &url)
+{
+    const QString path = url.path().toLower();
+    for (const QLatin1String word : {QLatin1String("usage"), QLatin1String("cost"), QLatin1String("billing"),
+                                     QLatin1String("balance"), QLatin1String("credit")}) {
+        if (path.contains(word))
+            return true;
+    }
+    return false;
+}
+
+/**
+ * GET that is sent a second time when the first copy has not answered
+ * after `hedgeAfterMs`. The first copy to succeed wins and the other is
+ * aborted; a failure only counts once no copy is left running.
+ *
+ * Once finished it reads like the winning reply: body, headers, status
+ * attributes and error are copied over. Connection and progress signals
+ * could come from either copy, so each copy's milestones are kept apart
+ * and only the winner's are reported, through winnerTiming().
+ */
+class HedgedNetworkReply : public QNetworkReply
+{
+public:
+    HedgedNetworkReply(QNetworkAccessManager *manager, const QNetworkRequest &request, int hedgeAfterMs)
+        : QNetworkReply(manager)
+        , m_manager(manager)
+    {
+        setRequest(request);
+        setOperation(QNetworkAccessManager::GetOperation);
+        setUrl(request.url());
+        open(QIODevice::ReadOnly);
+        m_clock.start();
+
+        adopt(manager->get(request));
+
+        m_hedgeTimer.setSingleShot(true);
+        connect(&m_hedgeTimer, &QTimer::timeout, this, [this]() {
+            if (isFinished() || !m_manager)
+                return;
+            m_hedged = true;
+            adopt(m_manager->get(this->request()));
+        });
+        m_hedgeTimer.start(hedgeAfterMs);
+    }
+
+    /// Milestones of one copy in ms since the hedged request started; -1 until reached.
+    struct CopyTiming {
+        qint64 startedAt = 0;
+        qint64 connectingAt = -1;
+        qint64 connectedAt = -1;
+        qint64 sentAt = -1;
+        qint64 headersAt = -1;
+        qint64 finishedAt = -1;
+        qint64 bytesIn = 0;
+    };
+
+    bool hedged() const { return m_hedged; }
+    bool hedgeWon() const { return m_hedgeWon; }
+    CopyTiming winnerTiming() const { return m_timings.value(m_winner); }
+
+    void abort() override
+    {
+        if (isFinished())
+            return;
+        finish(OperationCanceledError, QStringLiteral("Operation canceled"));
+    }
+
+    void ignoreSslErrors() override
+    {
+        for (QNetworkReply *copy : std::as_const(m_copies))
+            copy->ignoreSslErrors();
+    }
+
+    qint64 bytesAvailable() const override
+    {
+        return m_buffer.size() + QNetworkReply::bytesAvailable();
+    }
+
+protected:
+    qint64 readData(char *data, qint64 maxSize) override
+    {
+        if (m_buffer.isEmpty())
+            return isFinished() ? -1 : 0;
+
+        const qint64 count = qMin<qint64>(maxSize, m_buffer.size());
+        std::copy_n(m_buffer.constData(), count, data);
+        m_buffer.remove(0, count);
+        return count;
+    }
+
+private:
+    void adopt(QNetworkReply *copy)
+    {
+        copy->setParent(this);
+        m_copies.append(copy);
+        m_timings[copy].startedAt = m_clock.elapsed();
+
+        connect(copy, &QNetworkReply::socketStartedConnecting, this, [this, copy]() {
+            CopyTiming &timing = m_timings[copy];
+            if (timing.connectingAt < 0)
+                timing.connectingAt = m_clock.elapsed();
+        });
+#if QT_CONFIG(ssl)
+        connect(copy, &QNetworkReply::encrypted, this, [this, copy]() {
+            CopyTiming &timing = m_timings[copy];
+            if (timing.connectingAt >= 0 && timing.connectedAt < 0)
+                timing.connectedAt = m_clock.elapsed();
+        });
+#endif
+        connect(copy, &QNetworkReply::requestSent, this, [this, copy]() {
+            CopyTiming &timing = m_timings[copy];
+            const qint64 now = m_clock.elapsed();
+            if (timing.connectingAt >= 0 && timing.connectedAt < 0)
+                timing.connectedAt = now;
+            if (timing.sentAt < 0)
+                timing.sentAt = now;
+        });
+        connect(copy, &QNetworkReply::metaDataChanged, this, [this, copy]() {
+            CopyTiming &timing = m_timings[copy];
+            if (timing.headersAt < 0)
+                timing.headersAt = m_clock.elapsed();
+        });
+        connect(copy, &QNetworkReply::downloadProgress, this, [this, copy](qint64 received, qint64) {
+            m_timings[copy].bytesIn = received;
+        });
+        connect(copy, &QNetworkReply::finished, this, [this, copy]() { onCopyFinished(copy); });
+    }
+
+    void onCopyFinished(QNetworkReply *copy)
+    {
+        if (isFinished())
+            return;
+
+        if (copy->error() != NoError) {
+            const bool othersRunning = std::any_of(m_copies.cbegin(), m_copies.cend(),
+                                                   [](QNetworkReply *other) { return other->isRunning(); });
+            if (othersRunning)
+                return;
+        }
+
+        m_winner = copy;
+        m_timings[copy].finishedAt = m_clock.elapsed();
+        m_hedgeWon = m_hedged && copy != m_copies.constFirst();
+        m_buffer = copy->readAll();
+
+        const auto headers = copy->rawHeaderPairs();
+        for (const auto &header : headers)
+            setRawHeader(header.first, header.second);
+        static const QNetworkRequest::Attribute attributes[] = {
+            QNetworkRequest::HttpStatusCodeAttribute,
+            QNetworkRequest::HttpReasonPhraseAttribute,
+            QNetworkRequest::RedirectionTargetAttribute,
+            QNetworkRequest::ConnectionEncryptedAttribute,
+            QNetworkRequest::SourceIsFromCacheAttribute,
+            QNetworkRequest::Http2WasUsedAttribute,
+        };
+        for (const auto attribute : attributes) {
+            const QVariant value = copy->attribute(attribute);
+            if (value.isValid())
+                setAttribute(attribute, value);
+        }
+        Q_EMIT metaDataChanged();
+
+        finish(copy->error(), copy->errorString());
+    }
+
+    void finish(NetworkError code, const QString &errorString)
+    {
+        m_hedgeTimer.stop();
+        if (code != NoError) {
+            setError(code, errorString);
+            Q_EMIT errorOccurred(code);
+        }
+        setFinished(true);
+        Q_EMIT finished();
+
+        // Finished first, so the losers' finished() is ignored
+        for (QNetworkReply *copy : std::as_const(m_copies)) {
+            if (copy->isRunning())
+                copy->abort();
+        }
+    }
+
+    QPointer<QNetworkAccessManager> m_manager;
+    QList<QNetworkReply *> m_copies; // owned; the first is the original
+    QHash<QNetworkReply *, CopyTiming> m_timings;
+    QNetworkReply *m_winner = nullptr;
+    QElapsedTimer m_clock;
+    QTimer m_hedgeTimer;
+    QByteArray m_buffer;
+    bool m_hedged = false;
+    bool m_hedgeWon = false;
+};
+} // namespace
+
+bool ProviderBackend::adaptiveTimeouts() const { return m_adaptiveTimeouts; }
+void ProviderBackend::setAdaptiveTimeouts(bool enabled)
+{
+    if (m_adaptiveTimeouts != enabled) {
+        m_adaptiveTimeouts = enabled;
+        Q_EMIT networkStatsChanged();
+    }
+}
+
+bool ProviderBackend::hedgeRequests() const { return m_hedgeRequests; }
+void ProviderBackend::setHedgeRequests(bool enabled)
+{
+    if (m_hedgeRequests != enabled) {
+        m_hedgeRequests = enabled;
+        Q_EMIT networkStatsChanged();
+    }
+}
+
+int ProviderBackend::requestTimeoutMs(const QUrl &url) const
+{
+    if (!m_adaptiveTimeouts)
+        return REQUEST_TIMEOUT_MS;
+
+    QList<qint64> samples = m_endpointLatencies.value(latencyKey(url));
+    if (samples.size() < MIN_LATENCY_SAMPLES)
+        return REQUEST_TIMEOUT_MS;
+
+    std::sort(samples.begin(), samples.end());
+    const qint64 floorMs = isBillingEndpoint(url) ? MIN_BILLING_TIMEOUT_MS : MIN_REQUEST_TIMEOUT_MS;
+    return int(qBound<qint64>(floorMs, percentileOf(samples, 99) * TIMEOUT_P99_FACTOR,
+                              MAX_REQUEST_TIMEOUT_MS));
+}
+
+QNetworkReply *ProviderBackend::sendGet(const QNetworkRequest &request)
+{
+    QList<qint64> samples = m_endpointLatencies.value(latencyKey(request.url()));
+    if (!m_hedgeRequests || samples.size() < MIN_LATENCY_SAMPLES)
+        return networkManager()->get(request);
+
+    std::sort(samples.begin(), samples.end());
+    auto *reply = new HedgedNetworkReply(networkManager(), request, int(percentileOf(samples, 95)));
+    connect(reply, &QNetworkReply::finished, this, [this, reply]() {
+        if (reply->hedged())
+            ++m_hedgesFired;
+        if (reply->hedgeWon())
+            ++m_hedgesWon;
+    });
+    return reply;
+}
+
+QVariantMap ProviderBackend::networkStats() const
+{
+    QList<qint64> dns, connectSetup, ttfb, download, total;
+    QVariantMap statusCounts;
+    int failures = 0;
+    int retries = 0;
+    int reused = 0;
+    qint64 bytesIn = 0;
+    qint64 bytesOut = 0;
+
+    for (const NetworkSample &sample : m_networkSamples) {
+        if (sample.dnsMs >= 0)
+            dns.append(sample.dnsMs);
+        else
+            ++reused;
+        if (sample.connectMs >= 0)
+            connectSetup.append(sample.connectMs);
+        if (sample.ttfbMs >= 0)
+            ttfb.append(sample.ttfbMs);
+        if (sample.downloadMs >= 0)
+            download.append(sample.downloadMs);
+        total.append(sample.totalMs);
+
+        if (sample.failed)
+            ++failures;
+        if (sample.retryAttempt > 0)
+            ++retries;
+        bytesIn += sample.bytesIn;
+        bytesOut += sample.bytesOut;
+
+        const QString status = QString::number(sample.httpStatus);
+        statusCounts[status] = statusCounts.value(status).toInt() + 1;
+    }
+
+    QVariantList buckets;
+    for (qint64 bound : LATENCY_BUCKETS_MS)
+        buckets.append(bound);
+
+    QVariantMap phases;
+    phases[QStringLiteral("dns")] = phaseStats(dns);
+    phases[QStringLiteral("connect")] = phaseStats(connectSetup);
+    phases[QStringLiteral("ttfb")] = phaseStats(ttfb);
+    phases[QStringLiteral("download")] = phaseStats(download);
+    phases[QStringLiteral("total")] = phaseStats(total);
+
+    QVariantMap stats;
+    stats[QStringLiteral("requests")] = m_networkSamples.size();
+    stats[QStringLiteral("failures")] = failures;
+    stats[QStringLiteral("retries")] = retries;
+    stats[QStringLiteral("reusedConnections")] = reused;
+    stats[QStringLiteral("bytesIn")] = bytesIn;
+    stats[QStringLiteral("bytesOut")] = bytesOut;
+    stats[QStringLiteral("statusCounts")] = statusCounts;
+    stats[QStringLiteral("bucketsMs")] = buckets;
+    stats[QStringLiteral("phases")] = phases;
+    stats[QStringLiteral("hedgesFired")] = m_hedgesFired;
+    stats[QStringLiteral("hedgesWon")] = m_hedgesWon;
+
+    QStringList keys = m_endpointLatencies.keys();
+    keys.sort();
+    QVariantList endpoints;
+    for (const QString &key : std::as_const(keys)) {
+        QList<qint64> samples = m_endpointLatencies.value(key);
+        std::sort(samples.begin(), samples.end());
+        QVariantMap endpoint;
+        endpoint[QStringLiteral("endpoint")] = key;
+        endpoint[QStringLiteral("samples")] = samples.size();
+        endpoint[QStringLiteral("p95Ms")] = percentileOf(samples, 95);
+        endpoint[QStringLiteral("p99Ms")] = percentileOf(samples, 99);
+        endpoint[QStringLiteral("timeoutMs")] = requestTimeoutMs(QUrl(key));
+        endpoints.append(endpoint);
+    }
+    stats[QStringLiteral("endpoints")] = endpoints;
+    return stats;
+}
+
+void ProviderBackend::resetNetworkStats()
+{
+    m_networkSamples.clear();
+    m_endpointLatencies.clear();
+    m_hedgesFired = 0;
+    m_hedgesWon = 0;
+    Q_EMIT networkStatsChanged();
+}
+
+void ProviderBackend::instrumentReply(QNetworkReply *reply)
+{
+    // Milestones in ms since the request was handed to us; -1 until reached
+    struct Timing {
+        QElapsedTimer clock;
+        qint64 connectingAt = -1;
+        qint64 connectedAt = -1;
+        qint64 sentAt = -1;
+        qint64 headersAt = -1;
+        qint64 bytesIn = 0;
+        qint64 bytesOut = 0;
+    };
+    auto timing = std::make_shared<Timing>();
+    timing->clock.start();
+
+    connect(reply, &QNetworkReply::socketStartedConnecting, this, [timing]() {
+        if (timing->connectingAt < 0)
+            timing->connectingAt = timing->clock.elapsed();
+    });
+#if QT_CONFIG(ssl)
+    connect(reply, &QNetworkReply::encrypted, this, [timing]() {
+        if (timing->connectingAt >= 0 && timing->connectedAt < 0)
+            timing->connectedAt = timing->clock.elapsed();
+    });
+#endif
+    connect(reply, &QNetworkReply::requestSent, this, [timing]() {
+        const qint64 now = timing->clock.elapsed();
+        // Plain HTTP has no handshake to end the connect phase
+        if (timing->connectingAt >= 0 && timing->connectedAt < 0)
+            timing->connectedAt = now;
+        if (timing->sentAt < 0)
+            timing->sentAt = now;
+    });
+    connect(reply, &QNetworkReply::metaDataChanged, this, [timing]() {
+        if (timing->headersAt < 0)
+            timing->headersAt = timing->clock.elapsed();
+    });
+    connect(reply, &QNetworkReply::uploadProgress, this, [timing](qint64 sent, qint64) {
+        timing->bytesOut = sent;
+    });
+    connect(reply, &QNetworkReply::downloadProgress, this, [timing](qint64 received, qint64) {
+        timing->bytesIn = received;
+    });
+    connect(reply, &QNetworkReply::finished, this, [this, reply, timing]() {
+        NetworkSample sample;
+        sample.totalMs = timing->clock.elapsed();
+        qint64 startedAt = 0;
+
+        // The wrapper itself never connects; its milestones are the winning copy's
+        if (const auto *hedged = dynamic_cast<const HedgedNetworkReply *>(reply)) {
+            const HedgedNetworkReply::CopyTiming winner = hedged->winnerTiming();
+            startedAt = winner.startedAt;
+            timing->connectingAt = winner.connectingAt;
+            timing->connectedAt = winner.connectedAt;
+            timing->sentAt = winner.sentAt;
+            timing->headersAt = winner.headersAt;
+            timing->bytesIn = winner.bytesIn;
+            if (winner.finishedAt >= 0)
+                sample.totalMs = winner.finishedAt;
+        }
+
+        if (timing->connectingAt >= 0) {
+            sample.dnsMs = timing->connectingAt - startedAt;
+            if (timing->connectedAt >= 0)
+                sample.connectMs = timing->connectedAt - timing->connectingAt;
+        }
+        if (timing->headersAt >= 0) {
+            // A reply that never reported requestSent is timed from its start
+            sample.ttfbMs = timing->headersAt - qMax(startedAt, timing->sentAt);
+            sample.downloadMs = sample.totalMs - timing->headersAt;
+        }
+        sample.bytesIn = timing->bytesIn;
+        sample.bytesOut = timing->bytesOut;
+        sample.httpStatus = reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
+        sample.retryAttempt = reply->property(RETRY_ATTEMPT_PROPERTY).toInt();
+        sample.failed = reply->error() != QNetworkReply::NoError;
+        recordNetworkSample(sample);
+
+        // Answered requests say how long the endpoint normally takes. One
+        // that ran into its timeout took at least that long: counted at the
+        // timeout, it lifts the p99 so the next request waits longer
+        const int timeoutMs = reply->request().transferTimeout();
+        const bool timedOut = sample.failed && timeoutMs > 0 && sample.totalMs >= timeoutMs
+            && (reply->error() == QNetworkReply::OperationCanceledError
+                || reply->error() == QNetworkReply::TimeoutError);
+        if (!sample.failed || timedOut) {
+            QList<qint64> &latencies = m_endpointLatencies[latencyKey(reply->url())];
+            latencies.append(timedOut ? qint64(timeoutMs) : sample.totalMs);
+            if (latencies.size() > ENDPOINT_LATENCY_WINDOW)
+                latencies.removeFirst();
+        }
+    });
+}
+
+void ProviderBackend::recordNetworkSample(const NetworkSample &sample)
+{
+    m_networkSamples.append(sample);
+    if (m_networkSamples.size() > NETWORK_SAMPLE_WINDOW)
+        m_networkSamples.removeFirst();
+    Q_EMIT networkStatsChanged();
+}
+
+// --- Conditional-request cache ---
+
+int ProviderBackend::conditionalRequests() const { return m_conditionalRequests; }
+int ProviderBackend::cacheHits() const { return m_cacheHits; }
+
+double ProviderBackend::cacheHitRatio() const
+{
+    return m_conditionalRequests > 0
+        ? static_cast<double>(m_cacheHits) / m_conditionalRequests
+        : 0.0;
+}
+
+void ProviderBackend::onDataUpdatedForCadence()
+{
+    const DataFingerprint current{m_inputTokens, m_outputTokens, m_requestCount,
+                                  m_costMicros, m_dailyCostMicros, m_monthlyCostMicros,
+                                  m_rateLimitRequestsRemaining, m_rateLimitTokensRemaining};
+
+    if (m_hasFingerprint && current == m_lastFingerprint) {
+        ++m_unchangedUpdates;
+    } else {
+        m_unchangedUpdates = 0;
+    }
+    m_lastFingerprint = current;
+    m_hasFingerprint = true;
+
+    updateCadence();
+}
+
+double ProviderBackend::urgencyFactor() const
+{
+    // Highest share of any budget spent, in percent
+    int budgetPercent = 0;
+    if (m_dailyBudgetMicros > 0)
+        budgetPercent = qMax(budgetPercent, static_cast<int>(m_dailyCostMicros * 100 / m_dailyBudgetMicros));
+    if (m_monthlyBudgetMicros > 0)
+        budgetPercent = qMax(budgetPercent, static_cast<int>(m_monthlyCostMicros * 100 / m_monthlyBudgetMicros));
+
+    // Lowest rate-limit headroom, in percent of the limit
+    int headroomPercent = 100;
+    if (m_rateLimitRequests > 0)
+        headroomPercent = qMin(headroomPercent, static_cast<int>(qint64(m_rateLimitRequestsRemaining) * 100 / m_rateLimitRequests));
+    if (m_rateLimitTokens > 0)
+        headroomPercent = qMin(headroomPercent, static_cast<int>(qint64(m_rateLimitTokensRemaining) * 100 / m_rateLimitTokens));
+
+    if (budgetPercent >= 90 || headroomPercent <= 10)
+        return 0.25;
+    if (budgetPercent >= 75 || headroomPercent <= 25)
+        return 0.5;
+    return 1.0;
+}
+
+void ProviderBackend::updateCadence()
+{
+    // Pressure wins over idleness: a provider close to a limit is polled
+    // faster even if its numbers have not moved lately.
+    const double urgency = urgencyFactor();
+    const double factor = urgency < 1.0
+        ? urgency
+        : static_cast<double>(1 << qMin(m_unchangedUpdates, MAX_BACKOFF_STEPS));
+
+    if (!qFuzzyCompare(m_cadenceFactor, factor)) {
+        m_cadenceFactor = factor;
+        if (m_adaptiveCadence)
+            Q_EMIT cadenceChanged();
+    }
+}
+
 // --- API Key ---
 
 void ProviderBackend::setApiKey(const QString &key)
 {
+    if (m_apiKey != key) {
+        m_responseCache.clear(); // cached bodies belong to the old account
+        invalidateEndpoints();
+        if (m_loading)
+            abortRefresh(); // answers in flight are for the old key
+    }
     m_apiKey = key;
     if (key.isEmpty()) {
         setConnected(false);
@@ -395,7 +1356,7 @@ QNetworkAccessManager *ProviderBackend::networkManager() const
 QNetworkRequest ProviderBackend::createRequest(const QUrl &url) const
 {
     QNetworkRequest request(url);
-    request.setTransferTimeout(REQUEST_TIMEOUT_MS);
+    request.setTransferTimeout(requestTimeoutMs(url));
     request.setRawHeader("Content-Type", "application/json");
 
     // Default Bearer auth (Anthropic overrides with x-api-key)
@@ -407,6 +1368,68 @@ QNetworkRequest ProviderBackend::createRequest(const QUrl &url) const
     return request;
 }
 
+QNetworkRequest ProviderBackend::createCachedRequest(const QUrl &url, const QString &cacheKey) const
+{
+    const QString key = cacheKey.isEmpty() ? url.toString() : cacheKey;
+
+    QNetworkRequest request = createRequest(url);
+    request.setAttribute(CacheKeyAttribute, key);
+
+    auto it = m_responseCache.constFind(key);
+    if (it != m_responseCache.constEnd()) {
+        if (!it->etag.isEmpty())
+            request.setRawHeader("If-None-Match", it->etag);
+        // A date only validates the exact resource it came with; keys that
+        // span a moving query window rely on the ETag alone
+        if (!it->lastModified.isEmpty() && it->url == url)
+            request.setRawHeader("If-Modified-Since", it->lastModified);
+    }
+
+    return request;
+}
+
+QJsonDocument ProviderBackend::readJsonReply(QNetworkReply *reply, bool *notModified)
+{
+    if (notModified)
+        *notModified = false;
+
+    const QString key = reply->request().attribute(CacheKeyAttribute).toString();
+    if (key.isEmpty())
+        return QJsonDocument::fromJson(reply->readAll());
+
+    ++m_conditionalRequests;
+
+    const int httpStatus = reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
+    if (httpStatus == 304) {
+        auto it = m_responseCache.constFind(key);
+        if (it == m_responseCache.constEnd()) {
+            // Cache was cleared while the request was in flight
+            Q_EMIT cacheStatsChanged();
+            return QJsonDocument();
+        }
+        ++m_cacheHits;
+        if (notModified)
+            *notModified = true;
+        Q_EMIT cacheStatsChanged();
+        return it->document;
+    }
+
+    const QJsonDocument doc = QJsonDocument::fromJson(reply->readAll());
+    const QByteArray etag = reply->rawHeader("ETag");
+    const QByteArray lastModified = reply->rawHeader("Last-Modified");
+
+    if (!doc.isNull() && (!etag.isEmpty() || !lastModified.isEmpty())) {
+        if (m_responseCache.size() >= MAX_CACHED_RESPONSES && !m_responseCache.contains(key))
+            m_responseCache.erase(m_responseCache.begin());
+        m_responseCache.insert(key, CachedResponse{reply->url(), etag, lastModified, doc});
+    } else {
+        m_responseCache.remove(key);
+    }
+
+    Q_EMIT cacheStatsChanged();
+    return doc;
+}
+
 // --- Rate Limit Header Parsing ---
 
 void ProviderBackend::parseRateLimitHeaders(QNetworkReply *reply, const char *prefix)
@@ -421,6 +1444,7 @@ void ProviderBackend::parseRateLimitHeaders(QNetworkReply *reply, const char *pr
     int rlReqRemaining = readHeader("remaining-requests");
     int rlTokRemaining = readHeader("remaining-tokens");
     QString rlReset = QString::fromUtf8(reply->rawHeader(QByteArray(prefix) + "reset-requests"));
+    QString rlTokReset = QString::fromUtf8(reply->rawHeader(QByteArray(prefix) + "reset-tokens"));
 
     if (rlRequests > 0) {
         setRateLimitRequests(rlRequests);
@@ -433,6 +1457,66 @@ void ProviderBackend::parseRateLimitHeaders(QNetworkReply *reply, const char *pr
     if (!rlReset.isEmpty()) {
         setRateLimitResetTime(rlReset);
     }
+    if (rlRequests > 0 || rlTokens > 0) {
+        m_rateLimitHeadersAge.start();
+        observeRateLimits(rlRequests, rlReqRemaining, rlReset, rlTokens, rlTokRemaining, rlTokReset);
+    }
+}
+
+void ProviderBackend::observeRateLimits(int requests, int requestsRemaining, const QString &requestsReset,
+                                        int tokens, int tokensRemaining, const QString &tokensReset)
+{
+    const QDateTime now = QDateTime::currentDateTimeUtc();
+    if (requests > 0) {
+        m_requestBucket.observe(requests, requestsRemaining,
+                                RateLimitBucket::parseResetMs(requestsReset, now), now.toMSecsSinceEpoch());
+    }
+    if (tokens > 0) {
+        m_tokenBucket.observe(tokens, tokensRemaining,
+                              RateLimitBucket::parseResetMs(tokensReset, now), now.toMSecsSinceEpoch());
+    }
+}
+
+int ProviderBackend::estimatedRequestsRemaining() const
+{
+    if (!m_requestBucket.isValid())
+        return m_rateLimitRequestsRemaining;
+    return static_cast<int>(m_requestBucket.remainingAt(QDateTime::currentMSecsSinceEpoch()));
+}
+
+int ProviderBackend::estimatedTokensRemaining() const
+{
+    if (!m_tokenBucket.isValid())
+        return m_rateLimitTokensRemaining;
+    return static_cast<int>(m_tokenBucket.remainingAt(QDateTime::currentMSecsSinceEpoch()));
+}
+
+QVariantMap ProviderBackend::rateLimitModel() const
+{
+    const qint64 now = QDateTime::currentMSecsSinceEpoch();
+    QVariantMap model;
+    model[QStringLiteral("valid")] = m_requestBucket.isValid() || m_tokenBucket.isValid();
+
+    auto describe = [&](const RateLimitBucket &bucket, const QString &prefix) {
+        model[prefix + QStringLiteral("Limit")] = bucket.limit();
+        model[prefix + QStringLiteral("Remaining")] = bucket.remainingAt(now);
+        model[prefix + QStringLiteral("Observed")] = bucket.observedRemaining();
+        model[prefix + QStringLiteral("ResetInMs")] = bucket.resetInMs(now);
+        model[prefix + QStringLiteral("PerSecond")] = bucket.refillPerSecond();
+    };
+    describe(m_requestBucket, QStringLiteral("requests"));
+    describe(m_tokenBucket, QStringLiteral("tokens"));
+
+    const qint64 observedAt = qMax(m_requestBucket.observedAtMs(), m_tokenBucket.observedAtMs());
+    model[QStringLiteral("observedAgeMs")] = model.value(QStringLiteral("valid")).toBool() ? now - observedAt : -1;
+    model[QStringLiteral("predictsNoChange")] = rateLimitModelPredictsNoChange();
+    return model;
+}
+
+bool ProviderBackend::hasRateLimitHeaders(QNetworkReply *reply, const char *prefix)
+{
+    return reply->hasRawHeader(QByteArray(prefix) + "limit-requests")
+        || reply->hasRawHeader(QByteArray(prefix) + "limit-tokens");
 }
 
 // --- Generation Counter & Request Cancellation ---
@@ -445,24 +1529,183 @@ int ProviderBackend::currentGeneration() const
 void ProviderBackend::trackReply(QNetworkReply *reply)
 {
     m_activeReplies.append(reply);
+    instrumentReply(reply);
     // Auto-remove from tracking when the reply finishes
     connect(reply, &QNetworkReply::finished, this, [this, reply]() {
         m_activeReplies.removeOne(reply);
+        recordReplyOutcome(reply);
     });
 }
 
-void ProviderBackend::beginRefresh()
+bool ProviderBackend::beginRefresh()
 {
+    if (m_loading) {
+        // A cycle that outlived every timeout and retry has lost track of
+        // its replies; start over rather than attach to it forever
+        if (m_refreshTimer.isValid() && m_refreshTimer.elapsed() > STALLED_REFRESH_MS) {
+            qWarning() << "ProviderBackend:" << name() << "- refresh stalled, restarting";
+            abortRefresh();
+        } else {
+            noteCoalescedRefresh();
+            return false;
+        }
+    }
+
+    if (!circuitAllowsRefresh())
+        return false;
+
+    // Replies left over from an earlier cycle (if any) finish on their own
+    // and are discarded by the generation check
     m_generation++;
+    m_refreshTimer.start();
+    return true;
+}
 
-    // Abort and clean up any in-flight replies from previous refresh
-    for (QNetworkReply *reply : std::as_const(m_activeReplies)) {
-        if (reply != nullptr && reply->isRunning()) {
+void ProviderBackend::abortRefresh()
+{
+    m_generation++;
+    m_refreshQueued = false;
+
+    int aborted = 0;
+    const QList<QNetworkReply *> replies = std::exchange(m_activeReplies, {});
+    for (QNetworkReply *reply : replies) {
+        // Detach first: our own aborts must not count against the circuit
+        reply->disconnect(this);
+        if (reply->isRunning()) {
             reply->abort();
+            ++aborted;
         }
         reply->deleteLater();
     }
-    m_activeReplies.clear();
+
+    m_abortedRequests += aborted;
+    Q_EMIT refreshStatsChanged();
+    setLoading(false);
+}
+
+void ProviderBackend::noteCoalescedRefresh()
+{
+    // Before single-flight, every reply still running here was aborted and
+    // sent again
+    const auto running = std::count_if(m_activeReplies.cbegin(), m_activeReplies.cend(),
+                                       [](QNetworkReply *reply) { return reply->isRunning(); });
+    ++m_coalescedRefreshes;
+    m_savedRequests += static_cast<int>(running);
+    Q_EMIT refreshStatsChanged();
+}
+
+// --- Circuit Breaker ---
+
+ProviderBackend::CircuitState ProviderBackend::circuitState() const { return m_circuitState; }
+bool ProviderBackend::isCircuitOpen() const { return m_circuitState == CircuitState::Open; }
+
+QDateTime ProviderBackend::circuitRetryAt() const
+{
+    return m_circuitState == CircuitState::Open
+        ? QDateTime::fromMSecsSinceEpoch(m_circuitRetryAtMs)
+        : QDateTime();
+}
+
+int ProviderBackend::circuitFailureThreshold() const { return m_circuitFailureThreshold; }
+void ProviderBackend::setCircuitFailureThreshold(int failures)
+{
+    failures = qMax(1, failures);
+    if (m_circuitFailureThreshold != failures) {
+        m_circuitFailureThreshold = failures;
+        Q_EMIT circuitChanged();
+    }
+}
+
+int ProviderBackend::circuitCooldownMs() const { return m_circuitCooldownMs; }
+void ProviderBackend::setCircuitCooldownMs(int ms)
+{
+    ms = static_cast<int>(qBound<qint64>(0, ms, MAX_CIRCUIT_COOLDOWN_MS));
+    if (m_circuitCooldownMs != ms) {
+        m_circuitCooldownMs = ms;
+        Q_EMIT circuitChanged();
+    }
+}
+
+int ProviderBackend::pausedRefreshes() const { return m_pausedRefreshes; }
+
+void ProviderBackend::resetCircuit()
+{
+    if (m_circuitState == CircuitState::Open) {
+        m_circuitState = CircuitState::HalfOpen;
+        m_circuitRetryAtMs = 0;
+        Q_EMIT circuitChanged();
+    }
+}
+
+void ProviderBackend::recordReplyOutcome(QNetworkReply *reply)
+{
+    // No HTTP status means no answer at all (DNS, refused, reset, timeout);
+    // any other status, errors included, shows the host is serving
+    const int httpStatus = reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
+    const bool transient = isRetryableStatus(httpStatus) || httpStatus == 504
+        || (httpStatus == 0 && reply->error() != QNetworkReply::NoError);
+
+    if (!transient) {
+        m_circuitFailures = 0;
+        if (m_circuitState != CircuitState::Closed) {
+            m_circuitState = CircuitState::Closed;
+            m_circuitCurrentCooldownMs = 0;
+            m_circuitRetryAtMs = 0;
+            Q_EMIT circuitChanged();
+        }
+        return;
+    }
+
+    ++m_circuitFailures;
+    if (m_circuitState == CircuitState::HalfOpen
+        || (m_circuitState == CircuitState::Closed && m_circuitFailures >= m_circuitFailureThreshold)) {
+        openCircuit();
+    }
+}
+
+void ProviderBackend::openCircuit()
+{
+    // A failed trial doubles the pause; a fresh trip starts from the base
+    m_circuitCurrentCooldownMs = m_circuitState == CircuitState::HalfOpen
+        ? qBound<qint64>(m_circuitCooldownMs, m_circuitCurrentCooldownMs * 2, MAX_CIRCUIT_COOLDOWN_MS)
+        : m_circuitCooldownMs;
+    m_circuitState = CircuitState::Open;
+    m_circuitRetryAtMs = QDateTime::currentMSecsSinceEpoch() + m_circuitCurrentCooldownMs;
+
+    qWarning() << "ProviderBackend:" << name() << "- circuit open after" << m_circuitFailures
+               << "failures, pausing refreshes for" << m_circuitCurrentCooldownMs << "ms";
+    Q_EMIT circuitChanged();
+}
+
+bool ProviderBackend::circuitAllowsRefresh()
+{
+    if (m_circuitState != CircuitState::Open)
+        return true;
+
+    if (QDateTime::currentMSecsSinceEpoch() < m_circuitRetryAtMs) {
+        ++m_pausedRefreshes;
+        Q_EMIT circuitChanged();
+        return false;
+    }
+
+    // Cooldown over: this refresh is the trial
+    m_circuitState = CircuitState::HalfOpen;
+    Q_EMIT circuitChanged();
+    return true;
+}
+
+void ProviderBackend::requestRefresh(bool againWhenDone)
+{
+    if (!m_loading) {
+        if (againWhenDone)
+            invalidateEndpoints();
+        refresh();
+        return;
+    }
+
+    if (againWhenDone)
+        m_refreshQueued = true;
+    noteCoalescedRefresh();
 }
 
 bool ProviderBackend::isCurrentGeneration(int generation) const
@@ -477,6 +1720,12 @@ bool ProviderBackend::isRetryableStatus(int httpStatus)
     return httpStatus == 429 || httpStatus == 500 || httpStatus == 502 || httpStatus == 503;
 }
 
+bool ProviderBackend::shouldRetry(QNetworkReply *reply) const
+{
+    const int httpStatus = reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
+    return isRetryableStatus(httpStatus) && !reply->property(RETRIES_EXHAUSTED_PROPERTY).toBool();
+}
+
 void ProviderBackend::retryRequest(QNetworkReply *reply,
                                     const QUrl &url,
                                     const QByteArray &postBody,
@@ -484,8 +1733,16 @@ void ProviderBackend::retryRequest(QNetworkReply *reply,
                                     int attempt,
                                     int maxRetries)
 {
-    if (attempt > maxRetries) {
-        // No more retries — let the caller handle the error
+    // Retrying into a failing host, or past the process-wide budget, only
+    // adds to the storm; report the failure instead. The mark stops the
+    // callback's shouldRetry() from starting a fresh round of retries.
+    bool giveUp = attempt > maxRetries || m_circuitState != CircuitState::Closed;
+    if (!giveUp && !SharedNetworkManager::instance()->acquireRetryToken()) {
+        qWarning() << "ProviderBackend:" << name() << "- retry budget exhausted, not retrying";
+        giveUp = true;
+    }
+    if (giveUp) {
+        reply->setProperty(RETRIES_EXHAUSTED_PROPERTY, true);
         callback(reply);
         return;
     }
@@ -509,20 +1766,25 @@ void ProviderBackend::retryRequest(QNetworkReply *reply,
     int delayMs = delaySecs * 1000 + (QRandomGenerator::global()->bounded(500)); // jitter
     int gen = m_generation;
 
+    // Keep conditional requests conditional across retries
+    const QString cacheKey = reply->request().attribute(CacheKeyAttribute).toString();
+
     qWarning() << "ProviderBackend:" << name()
                << "- retrying request (attempt" << attempt << "/" << maxRetries
                << ") after" << delayMs << "ms (HTTP" << httpStatus << ")";
 
-    QTimer::singleShot(delayMs, this, [this, url, postBody, callback, attempt, maxRetries, gen]() {
+    QTimer::singleShot(delayMs, this, [this, url, postBody, callback, attempt, maxRetries, gen, cacheKey]() {
         if (!isCurrentGeneration(gen)) return; // stale
 
-        QNetworkRequest request = createRequest(url);
+        QNetworkRequest request = cacheKey.isEmpty() ? createRequest(url)
+                                                     : createCachedRequest(url, cacheKey);
         QNetworkReply *retryReply;
         if (postBody.isEmpty()) {
             retryReply = networkManager()->get(request);
         } else {
             retryReply = networkManager()->post(request, postBody);
         }
+        retryReply->setProperty(RETRY_ATTEMPT_PROPERTY, attempt);
         trackReply(retryReply);
 
         connect(retryReply, &QNetworkReply::finished, this, [this, retryReply, url, postBody, callback, attempt, maxRetries, gen]() {
@@ -542,41 +1804,53 @@ void ProviderBackend::retryRequest(QNetworkReply *reply,
 
 void ProviderBackend::registerModelPricing(const QString &modelName, double inputPricePerMToken, double outputPricePerMToken)
 {
-    m_modelPricing.insert(modelName, ModelPricing{inputPricePerMToken, outputPricePerMToken});
+    m_localPricing.insert(QString(), modelName,
+                          PricingCatalog::withCacheRates(name(), inputPricePerMToken, outputPricePerMToken));
+}
+
+const PricingCatalog::Price *ProviderBackend::findModelPricing(const QString &model) const
+{
+    // Longest prefix wins, e.g. "mistral-large-latest" uses "mistral-large"
+    if (const PricingCatalog::Price *local = m_localPricing.find(QString(), model))
+        return local;
+    return PricingCatalog::instance().find(name(), model);
+}
+
+qint64 ProviderBackend::estimatedCostMicros(const QString &model, qint64 inputTokens, qint64 outputTokens,
+                                            qint64 cacheReadTokens, qint64 cacheWriteTokens) const
+{
+    const PricingCatalog::Price *pricing = findModelPricing(model);
+    if (!pricing) return 0;
+
+    // Dollars per million tokens is numerically micro-dollars per token
+    const qint64 uncachedTokens = qMax<qint64>(0, inputTokens - cacheReadTokens - cacheWriteTokens);
+    const qint64 inputCost = qRound64(static_cast<double>(uncachedTokens) * pricing->inputPerMToken
+                                      + static_cast<double>(cacheReadTokens) * pricing->cacheReadPerMToken
+                                      + static_cast<double>(cacheWriteTokens) * pricing->cacheWritePerMToken);
+    const qint64 outputCost = qRound64(static_cast<double>(outputTokens) * pricing->outputPerMToken);
+    return inputCost + outputCost;
 }
 
 void ProviderBackend::updateEstimatedCost(const QString &currentModel)
 {
     // Only estimate if no real cost has been set by a billing API
-    if (!m_isEstimatedCost && m_cost > 0) return;
-
-    auto it = m_modelPricing.constFind(currentModel);
-    if (it == m_modelPricing.constEnd()) {
-        // Try prefix matching (e.g., "mistral-large-latest" could match "mistral-large")
-        for (auto pit = m_modelPricing.constBegin(); pit != m_modelPricing.constEnd(); ++pit) {
-            if (currentModel.startsWith(pit.key())) {
-                it = pit;
-                break;
-            }
-        }
-    }
-    if (it == m_modelPricing.constEnd()) return;
+    if (!m_isEstimatedCost && m_costMicros > 0) return;
+
+    if (!findModelPricing(currentModel)) return;
 
-    double inputCost = (static_cast<double>(m_inputTokens) / 1000000.0) * it->inputPricePerMToken;
-    double outputCost = (static_cast<double>(m_outputTokens) / 1000000.0) * it->outputPricePerMToken;
-    double estimatedTotal = inputCost + outputCost;
+    const qint64 estimatedTotal = estimatedCostMicros(currentModel, m_inputTokens, m_outputTokens);
 
-    m_cost = estimatedTotal;
+    m_costMicros = estimatedTotal;
     m_isEstimatedCost = true;
-    m_dailyCost = estimatedTotal; // Best estimate for daily cost from accumulated tokens
+    m_dailyCostMicros = estimatedTotal; // Best estimate for daily cost from accumulated tokens
     checkBudgetLimits();
 }
 
 void ProviderBackend::setEstimatedCost(double cost)
 {
-    m_cost = qMax(0.0, cost);
+    m_costMicros = qMax<qint64>(0, CostMicros::fromDollars(cost));
     m_isEstimatedCost = true;
-    m_dailyCost = m_cost;
-    m_monthlyCost = m_cost;
+    m_dailyCostMicros = m_costMicros;
+    m_monthlyCostMicros = m_costMicros;
     checkBudgetLimits();
 }
@@ -10,16 +10,84 @@
 #include <QHash>
 #include <QList>
 #include <QTimer>
+#include <QJsonDocument>
+#include <QElapsedTimer>
 #include <QJsonObject>
+#include <QSet>
+#include <QStringList>
+#include <QUrl>
+#include <QVariantList>
+#include <QVariantMap>
 #include <functional>
 
+#include "pricingcatalog.h"
+#include "ratelimitbucket.h"
+
 /**
  * Abstract base class for AI provider backends.
  * Exposes usage, rate limits, cost data, and budget tracking to QML.
  * Each provider subclass implements its own API-specific logic.
  *
  * Includes a token-based cost estimation system for providers without
- * billing APIs. Subclasses can register model pricing via registerModelPricing().
+ * billing APIs. Model prices come from the shared PricingCatalog, keyed by
+ * name(); registerModelPricing() adds instance-local prices on top.
+ *
+ * Costs and budgets are held as integer micro-dollars (see costmicros.h);
+ * the double-valued properties convert only when read from QML.
+ *
+ * The backend also suggests how often it should be polled: cadenceFactor
+ * doubles (up to 8x) for each dataUpdated() that brings no change, and
+ * drops to 0.5x / 0.25x as spend approaches a budget or rate-limit
+ * headroom runs low. RefreshScheduler applies it via adaptiveIntervalMs().
+ *
+ * Polled GET endpoints can go through createCachedRequest() and
+ * readJsonReply(): the last ETag / Last-Modified per endpoint is sent back
+ * as If-None-Match / If-Modified-Since, and a 304 hands back the document
+ * parsed from the previous 200 without reading or parsing a body.
+ * cacheHits / conditionalRequests show how often that pays off.
+ *
+ * Refreshes are single-flight: refresh() while one is running attaches to
+ * it instead of aborting and re-sending its requests, and
+ * requestRefresh(true) additionally runs one more cycle once it finishes.
+ * In-flight requests are only aborted when the API key or base URL changes.
+ *
+ * A circuit breaker guards the provider's host: after
+ * `circuitFailureThreshold` transient failures in a row (network errors,
+ * timeouts, 429/5xx) it opens and refresh() is skipped until
+ * `circuitRetryAt`. The first refresh after that is a half-open trial:
+ * success closes the circuit, failure reopens it with twice the cooldown
+ * (up to 30 min). Retries are only attempted while the circuit is closed
+ * and the process-wide retry budget (SharedNetworkManager) has a token.
+ *
+ * Providers with several endpoints declare each one with a freshness TTL
+ * (declareEndpoint()) and only fetch those whose data is older than it
+ * (endpointDue()), so monthly totals, balances and model metadata are not
+ * polled as often as rate limits. QML can override the TTLs through
+ * `endpointTtls`; endpointStatus() lists the age of each endpoint.
+ *
+ * Every tracked request is timed by phase (see networkStats()), so a slow
+ * card can be traced to name lookup, connection setup or the API itself.
+ * The same samples set each endpoint's timeout (`adaptiveTimeouts`): four
+ * times its p99 latency, clamped to 5-60 s (20 s at least for usage,
+ * cost and balance queries), instead of a fixed 30 s. A request that
+ * times out counts as a sample at its timeout, so the next one waits
+ * longer.
+ * With `hedgeRequests`, idempotent GETs sent through sendGet() go out a
+ * second time once they outlast the endpoint's p95, and the first answer
+ * wins.
+ *
+ * Providers that must send a request just to read rate-limit headers go
+ * through a probe order (probeOrder): metadata GET, HEAD, headers cached
+ * from the last call, and a real chat completion only as a last resort.
+ * Strategies that turn out not to carry headers for a provider are skipped
+ * for the rest of the session; probeStatistics() reports latency and
+ * estimated cost per strategy.
+ *
+ * Parsed limits and reset durations also feed a token-bucket model per
+ * limit (RateLimitBucket), which refills linearly until the reported reset.
+ * estimatedRequestsRemaining() reads it without a request, and the opt-in
+ * "predicted" probe strategy skips probing while it expects less than a 5%
+ * change, e.g. probeOrder: ["predicted", "models", "head", "chat"].
  */
 class ProviderBackend : public QObject
 {
@@ -44,6 +112,12 @@ class ProviderBackend : public QObject
     Q_PROPERTY(double cost READ cost NOTIFY dataUpdated)
     Q_PROPERTY(bool isEstimatedCost READ isEstimatedCost NOTIFY dataUpdated)
 
+    // Usage metered per request by UsageProxy
+    Q_PROPERTY(qint64 meteredInputTokens READ meteredInputTokens NOTIFY meteredUsageChanged)
+    Q_PROPERTY(qint64 meteredOutputTokens READ meteredOutputTokens NOTIFY meteredUsageChanged)
+    Q_PROPERTY(int meteredRequests READ meteredRequests NOTIFY meteredUsageChanged)
+    Q_PROPERTY(double meteredCost READ meteredCost NOTIFY meteredUsageChanged)
+
     // Rate limits
     Q_PROPERTY(int rateLimitRequests READ rateLimitRequests NOTIFY dataUpdated)
     Q_PROPERTY(int rateLimitTokens READ rateLimitTokens NOTIFY dataUpdated)
@@ -66,6 +140,45 @@ class ProviderBackend : public QObject
     Q_PROPERTY(QDateTime lastRefreshed READ lastRefreshed NOTIFY dataUpdated)
     Q_PROPERTY(int refreshCount READ refreshCount NOTIFY dataUpdated)
 
+    // Circuit breaker
+    Q_PROPERTY(CircuitState circuitState READ circuitState NOTIFY circuitChanged)
+    Q_PROPERTY(bool circuitOpen READ isCircuitOpen NOTIFY circuitChanged)
+    Q_PROPERTY(QDateTime circuitRetryAt READ circuitRetryAt NOTIFY circuitChanged)
+    Q_PROPERTY(int circuitFailureThreshold READ circuitFailureThreshold WRITE setCircuitFailureThreshold NOTIFY circuitChanged)
+    Q_PROPERTY(int circuitCooldownMs READ circuitCooldownMs WRITE setCircuitCooldownMs NOTIFY circuitChanged)
+    Q_PROPERTY(int pausedRefreshes READ pausedRefreshes NOTIFY circuitChanged)
+
+    // Refresh coalescing
+    Q_PROPERTY(bool refreshQueued READ refreshQueued NOTIFY refreshStatsChanged)
+    Q_PROPERTY(int coalescedRefreshes READ coalescedRefreshes NOTIFY refreshStatsChanged)
+    Q_PROPERTY(int savedRequests READ savedRequests NOTIFY refreshStatsChanged)
+    Q_PROPERTY(int abortedRequests READ abortedRequests NOTIFY refreshStatsChanged)
+
+    // Adaptive polling cadence
+    Q_PROPERTY(bool adaptiveCadence READ adaptiveCadence WRITE setAdaptiveCadence NOTIFY cadenceChanged)
+    Q_PROPERTY(double cadenceFactor READ cadenceFactor NOTIFY cadenceChanged)
+
+    // Conditional-request cache
+    Q_PROPERTY(int conditionalRequests READ conditionalRequests NOTIFY cacheStatsChanged)
+    Q_PROPERTY(int cacheHits READ cacheHits NOTIFY cacheStatsChanged)
+    Q_PROPERTY(double cacheHitRatio READ cacheHitRatio NOTIFY cacheStatsChanged)
+
+    // Endpoint freshness
+    Q_PROPERTY(QVariantMap endpointTtls READ endpointTtls WRITE setEndpointTtls NOTIFY endpointsChanged)
+    Q_PROPERTY(int skippedEndpointFetches READ skippedEndpointFetches NOTIFY endpointsChanged)
+
+    // Adaptive timeouts and hedging
+    Q_PROPERTY(bool adaptiveTimeouts READ adaptiveTimeouts WRITE setAdaptiveTimeouts NOTIFY networkStatsChanged)
+    Q_PROPERTY(bool hedgeRequests READ hedgeRequests WRITE setHedgeRequests NOTIFY networkStatsChanged)
+
+    // Rate-limit probing
+    Q_PROPERTY(QStringList probeOrder READ probeOrderNames WRITE setProbeOrderNames NOTIFY probeChanged)
+    Q_PROPERTY(int rateLimitHeaderMaxAgeMs READ rateLimitHeaderMaxAgeMs WRITE setRateLimitHeaderMaxAgeMs NOTIFY probeChanged)
+    Q_PROPERTY(QString lastProbeStrategy READ lastProbeStrategy NOTIFY probeChanged)
+    Q_PROPERTY(int lastProbeLatencyMs READ lastProbeLatencyMs NOTIFY probeChanged)
+    Q_PROPERTY(int probeCount READ probeCount NOTIFY probeChanged)
+    Q_PROPERTY(double probeCost READ probeCost NOTIFY probeChanged)
+
 public:
     enum class ProviderId {
         Unknown = 0,
@@ -84,6 +197,23 @@ public:
     };
     Q_ENUM(ProviderId)
 
+    /// Ways of discovering rate limits, cheapest first.
+    enum class ProbeStrategy {
+        Models,         // GET the provider's model list
+        Head,           // HEAD the model list: headers without a body
+        CachedHeaders,  // reuse headers from the last call while fresh
+        Predicted,      // skip while the bucket model predicts no meaningful change
+        ChatCompletion  // one-token completion: billed, consumes quota
+    };
+    Q_ENUM(ProbeStrategy)
+
+    enum class CircuitState {
+        Closed,   // requests flow normally
+        Open,     // host is failing; refreshes paused until circuitRetryAt
+        HalfOpen  // cooldown over; the next refresh decides
+    };
+    Q_ENUM(CircuitState)
+
     struct ProviderConfig {
         ProviderId providerId = ProviderId::Unknown;
         QString providerKey;
@@ -98,6 +228,8 @@ public:
         bool parsed = false;
         qint64 inputTokens = 0;
         qint64 outputTokens = 0;
+        qint64 cacheReadTokens = 0;  // of inputTokens, read from the prompt cache
+        qint64 cacheWriteTokens = 0; // of inputTokens, written to the prompt cache
         int requestCount = 0;
         double cost = 0.0;
         double dailyCost = 0.0;
@@ -135,8 +267,22 @@ public:
     qint64 totalTokens() const;
     int requestCount() const;
     double cost() const;
+    qint64 costMicros() const;
     bool isEstimatedCost() const;
 
+    // Metered usage: exact figures of requests that went through UsageProxy,
+    // kept apart from the polled ones so neither is counted twice
+    qint64 meteredInputTokens() const;
+    qint64 meteredOutputTokens() const;
+    int meteredRequests() const;
+    double meteredCost() const;
+    qint64 meteredCostMicros() const;
+
+    /// Add one proxied request. Its cost is the payload's own if it
+    /// reported one, else the model's price; returns it in micro-dollars.
+    qint64 addMeteredUsage(const QString &model, const NormalizedUsageCost &usage);
+    Q_INVOKABLE void resetMeteredUsage();
+
     // Rate limits
     int rateLimitRequests() const;
     int rateLimitTokens() const;
@@ -153,6 +299,8 @@ public:
     void setBudgetWarningPercent(int percent);
     double dailyCost() const;
     double monthlyCost() const;
+    qint64 dailyCostMicros() const;
+    qint64 monthlyCostMicros() const;
     double estimatedMonthlyCost() const;
 
     // Custom URL
@@ -163,6 +311,114 @@ public:
     QDateTime lastRefreshed() const;
     int refreshCount() const;
 
+    // Circuit breaker
+    CircuitState circuitState() const;
+    bool isCircuitOpen() const;
+    QDateTime circuitRetryAt() const;
+    int circuitFailureThreshold() const;
+    void setCircuitFailureThreshold(int failures);
+    int circuitCooldownMs() const;
+    void setCircuitCooldownMs(int ms);
+    int pausedRefreshes() const;
+
+    /// Skip the rest of the cooldown: the next refresh runs as the
+    /// half-open trial (e.g. when the user presses Retry).
+    Q_INVOKABLE void resetCircuit();
+
+    // Refresh coalescing
+    bool refreshQueued() const;
+    int coalescedRefreshes() const;
+    int savedRequests() const;
+    int abortedRequests() const;
+
+    // Adaptive cadence
+    bool adaptiveCadence() const;
+    void setAdaptiveCadence(bool enabled);
+    double cadenceFactor() const;
+
+    /// Scale a configured refresh interval by cadenceFactor. Tightened
+    /// intervals never drop below 30 s (or the base, if that is shorter).
+    Q_INVOKABLE qint64 adaptiveIntervalMs(qint64 baseIntervalMs) const;
+
+    // Conditional-request cache
+    int conditionalRequests() const;
+    int cacheHits() const;
+    double cacheHitRatio() const;
+
+    // Endpoint freshness
+    QVariantMap endpointTtls() const;
+    /// Override TTLs by endpoint name (milliseconds; 0 = fetch every refresh).
+    void setEndpointTtls(const QVariantMap &ttls);
+    int skippedEndpointFetches() const;
+
+    /// One entry per declared endpoint: { endpoint, ttlMs, ageMs, stale }.
+    /// `ageMs` is -1 for endpoints that have not been fetched yet.
+    Q_INVOKABLE QVariantList endpointStatus() const;
+
+    /// Make every endpoint due on the next refresh.
+    Q_INVOKABLE void invalidateEndpoints();
+
+    // Network timing
+    /**
+     * Phase timings of the last 100 tracked requests, retries included:
+     * { requests, failures, retries, reusedConnections, bytesIn, bytesOut,
+     *   statusCounts: { "200": n, ... }, bucketsMs: [10, 25, ...],
+     *   phases: { dns, connect, ttfb, download, total } }.
+     * Each phase is { count, avgMs, p50Ms, p95Ms, maxMs, histogram }, where
+     * histogram[i] counts samples below bucketsMs[i] and the last slot the
+     * rest. `dns` runs from the request to the socket starting to connect
+     * (slot queueing and host lookup), `connect` from there to the finished
+     * TLS handshake or, over plain HTTP, the request being sent; both are
+     * absent for requests on a reused connection. `ttfb` ends at the first
+     * response headers and `download` at the last byte. Bytes count bodies.
+     * Also { hedgesFired, hedgesWon, endpoints: [{ endpoint, samples, p95Ms,
+     * p99Ms, timeoutMs }] } from the per-endpoint latency window that drives
+     * adaptive timeouts and hedging; resetting clears that window too.
+     */
+    Q_INVOKABLE QVariantMap networkStats() const;
+    Q_INVOKABLE void resetNetworkStats();
+
+    bool adaptiveTimeouts() const;
+    void setAdaptiveTimeouts(bool enabled);
+    bool hedgeRequests() const;
+    void setHedgeRequests(bool enabled);
+
+    // Rate-limit probing
+    QStringList probeOrderNames() const;
+    void setProbeOrderNames(const QStringList &names);
+    int rateLimitHeaderMaxAgeMs() const;
+    void setRateLimitHeaderMaxAgeMs(int ms);
+    QString lastProbeStrategy() const;
+    int lastProbeLatencyMs() const;
+    int probeCount() const;
+    double probeCost() const;
+    qint64 probeCostMicros() const;
+
+    /**
+     * One entry per strategy in the effective probe order:
+     * { strategy, supported, count, avgLatencyMs, lastLatencyMs, cost }.
+     */
+    Q_INVOKABLE QVariantList probeStatistics() const;
+
+    static QString probeStrategyName(ProbeStrategy strategy);
+
+    // Rate-limit model
+
+    /// Requests left now according to the token-bucket model fed by the
+    /// last rate-limit headers; the reported value if it cannot predict.
+    /// Costs no request, so QML can re-evaluate it on a timer.
+    Q_INVOKABLE int estimatedRequestsRemaining() const;
+    Q_INVOKABLE int estimatedTokensRemaining() const;
+
+    /**
+     * The model behind the estimates: { valid, requestsLimit,
+     * requestsRemaining, requestsObserved, requestsResetInMs,
+     * requestsPerSecond, tokensLimit, tokensRemaining, tokensObserved,
+     * tokensResetInMs, tokensPerSecond, observedAgeMs, predictsNoChange }.
+     * Reset times are -1 when the provider sent none.
+     */
+    Q_INVOKABLE QVariantMap rateLimitModel() const;
+
     // API key management
     Q_INVOKABLE void setApiKey(const QString &key);
     Q_INVOKABLE bool hasApiKey() const;
@@ -170,6 +426,19 @@ public:
     // Data fetching
     Q_INVOKABLE virtual void refresh() = 0;
 
+    /// refresh(), or attach to the refresh already running. With
+    /// againWhenDone, a coalesced request runs one more refresh after the
+    /// current one finishes (for explicit user requests that want data
+    /// newer than what is already in flight); every endpoint is treated as
+    /// stale, whatever its TTL.
+    Q_INVOKABLE void requestRefresh(bool againWhenDone = false);
+
+    /// Abort the running refresh: advance the generation, abort in-flight
+    /// replies and clear loading. For configuration changes that make the
+    /// pending answers meaningless. Backends that delegate to others
+    /// (ProviderAccountGroup) abort those too.
+    virtual void abortRefresh();
+
     /// Current request generation. Incremented on each refresh().
     /// Reply handlers should discard results if the generation has advanced.
     Q_INVOKABLE int currentGeneration() const;
@@ -186,6 +455,14 @@ Q_SIGNALS:
     void customBaseUrlChanged();
     void providerDisconnected(const QString &provider);
     void providerReconnected(const QString &provider);
+    void cadenceChanged();
+    void refreshStatsChanged();
+    void circuitChanged();
+    void cacheStatsChanged();
+    void endpointsChanged();
+    void networkStatsChanged();
+    void probeChanged();
+    void meteredUsageChanged();
 
 protected:
     void setConnected(bool connected);
@@ -201,13 +478,84 @@ protected:
     /// Subclasses can override authStyle for provider-specific headers.
     QNetworkRequest createRequest(const QUrl &url) const;
 
+    /// Transfer timeout for requests to url: 30 s until the endpoint has
+    /// enough samples, then derived from their p99 latency.
+    int requestTimeoutMs(const QUrl &url) const;
+
+    /// networkManager()->get(), hedged when `hedgeRequests` is on and the
+    /// endpoint's latency is known. Only for idempotent requests. The reply
+    /// is used exactly like a plain one.
+    QNetworkReply *sendGet(const QNetworkRequest &request);
+
+    /// createRequest() plus If-None-Match / If-Modified-Since from the last
+    /// response cached under cacheKey (default: the full URL). Pass an
+    /// explicit key when the query carries a moving time window, so the
+    /// ETag survives from one poll to the next. Read the reply with
+    /// readJsonReply().
+    QNetworkRequest createCachedRequest(const QUrl &url, const QString &cacheKey = QString()) const;
+
+    /// JSON body of a finished, successful reply. For requests made with
+    /// createCachedRequest(), a 304 returns the cached document without
+    /// touching the body (notModified is set), and a 200 carrying
+    /// validators replaces the cache entry. Null document if unparseable.
+    QJsonDocument readJsonReply(QNetworkReply *reply, bool *notModified = nullptr);
+
     /// Parse standard x-ratelimit-* headers from a reply.
     /// @param prefix  Header prefix (e.g. "x-ratelimit-" or "anthropic-ratelimit-")
     void parseRateLimitHeaders(QNetworkReply *reply, const char *prefix = "x-ratelimit-");
 
-    /// Advance the generation counter and abort any in-flight replies.
-    /// Call this at the start of refresh() implementations.
-    void beginRefresh();
+    /// True if the reply carries a request or token limit under prefix.
+    static bool hasRateLimitHeaders(QNetworkReply *reply, const char *prefix = "x-ratelimit-");
+
+    /// Feed the token-bucket model. Reset values are header strings as read
+    /// by RateLimitBucket::parseResetMs(); a limit of 0 leaves its bucket
+    /// unchanged. parseRateLimitHeaders() calls this itself.
+    void observeRateLimits(int requests, int requestsRemaining, const QString &requestsReset,
+                           int tokens, int tokensRemaining, const QString &tokensReset);
+
+    // --- Rate-limit probing ---
+
+    /// Probe order when QML has not set probeOrder. Default: chat only.
+    virtual QList<ProbeStrategy> defaultProbeOrder() const;
+
+    /// Effective order, minus strategies found not to work for this provider.
+    QList<ProbeStrategy> probeOrder() const;
+
+    /// Whether rate-limit headers were parsed within rateLimitHeaderMaxAgeMs.
+    bool hasFreshRateLimitHeaders() const;
+
+    /// Whether the headers are fresh and every limit they reported is
+    /// predicted to have refilled by less than PREDICTED_CHANGE_PERCENT of
+    /// itself since: a probe now would tell us nothing new.
+    bool rateLimitModelPredictsNoChange() const;
+
+    /// Declare an endpoint and how long its data stays fresh. Call from the
+    /// constructor; a TTL set through endpointTtls takes precedence.
+    void declareEndpoint(const QString &endpoint, qint64 ttlMs);
+
+    /// Whether the endpoint should be fetched this refresh: never fetched,
+    /// invalidated, or older than its TTL. Undeclared endpoints are always
+    /// due. A false result is counted in skippedEndpointFetches.
+    bool endpointDue(const QString &endpoint);
+
+    /// Record a successful fetch; the endpoint is fresh for its TTL.
+    void markEndpointFresh(const QString &endpoint);
+
+    /// Start timing a probe; recordProbe() reads the elapsed time.
+    void startProbeTimer();
+
+    /// Record a probe that produced rate limits. costMicros is what the
+    /// probe itself cost (non-zero only for chat completions).
+    void recordProbe(ProbeStrategy strategy, qint64 costMicros = 0);
+
+    /// Stop trying a strategy this session (e.g. the endpoint sent no headers).
+    void markProbeUnsupported(ProbeStrategy strategy);
+
+    /// Start a refresh cycle and advance the generation counter. Returns
+    /// false if a refresh is already running; refresh() implementations call
+    /// this first and return immediately on false, since the running cycle
+    /// answers the request.
+    bool beginRefresh();
 
     /// Check if a reply belongs to the current generation.
     /// Returns false if the reply is stale and should be discarded.
@@ -216,6 +564,12 @@ protected:
     /// Check if an HTTP status code is retryable (429, 500, 502, 503).
     static bool isRetryableStatus(int httpStatus);
 
+    /// Whether a failed reply should go to retryRequest(): a retryable
+    /// status that retryRequest() has not already given up on. Reply
+    /// handlers that pass themselves as the retry callback must use this
+    /// rather than isRetryableStatus(), or a given-up reply starts over.
+    bool shouldRetry(QNetworkReply *reply) const;
+
     /// Register a QNetworkReply for tracking. Tracked replies are aborted
     /// by beginRefresh() when a new refresh cycle starts.
     void trackReply(QNetworkReply *reply);
@@ -241,6 +595,10 @@ protected:
     void setCost(double cost);
     void setDailyCost(double cost);
     void setMonthlyCost(double cost);
+    /// `estimated` marks a cost that was not billed but derived, e.g. from pricing tables.
+    void setCostMicros(qint64 micros, bool estimated = false);
+    void setDailyCostMicros(qint64 micros);
+    void setMonthlyCostMicros(qint64 micros);
     void setRateLimitRequests(int limit);
     void setRateLimitTokens(int limit);
     void setRateLimitRequestsRemaining(int remaining);
@@ -252,20 +610,27 @@ protected:
     void checkBudgetLimits();
 
     // Token-based cost estimation
-    struct ModelPricing {
-        double inputPricePerMToken;   // $ per 1M input tokens
-        double outputPricePerMToken;  // $ per 1M output tokens
-    };
 
-    /// Register pricing for a model name. Used for cost estimation when no billing API is available.
+    /// Register pricing for a model name on this instance only; it takes
+    /// precedence over the shared PricingCatalog.
     void registerModelPricing(const QString &modelName, double inputPricePerMToken, double outputPricePerMToken);
 
     /// Calculate and set estimated cost from accumulated tokens using registered pricing.
     /// Call this after updating token counts. Only sets cost if no real cost has been set.
     void updateEstimatedCost(const QString &currentModel);
 
+    /// Cost of a token count at a model's registered pricing; 0 if unknown.
+    /// The cache counts are the part of `inputTokens` billed at the
+    /// model's cache read and write rates instead of its input rate.
+    qint64 estimatedCostMicros(const QString &model, qint64 inputTokens, qint64 outputTokens,
+                               qint64 cacheReadTokens = 0, qint64 cacheWriteTokens = 0) const;
+
+    /// Set an estimated cost computed by the subclass itself (e.g. per-second
+    /// video pricing); applies to the total, daily and monthly cost.
+    void setEstimatedCost(double cost);
+
 private:
-    QNetworkAccessManager *m_networkManager;
+    QNetworkAccessManager *m_networkManager; // shared, not owned
     QString m_apiKey;
     QString m_customBaseUrl;
 
@@ -278,12 +643,17 @@ private:
     qint64 m_inputTokens = 0;
     qint64 m_outputTokens = 0;
     int m_requestCount = 0;
-    double m_cost = 0.0;
-    double m_dailyCost = 0.0;
-    double m_monthlyCost = 0.0;
+    qint64 m_costMicros = 0;
+    qint64 m_dailyCostMicros = 0;
+    qint64 m_monthlyCostMicros = 0;
 
-    double m_dailyBudget = 0.0;
-    double m_monthlyBudget = 0.0;
+    qint64 m_meteredInputTokens = 0;
+    qint64 m_meteredOutputTokens = 0;
+    int m_meteredRequests = 0;
+    qint64 m_meteredCostMicros = 0;
+
+    qint64 m_dailyBudgetMicros = 0;
+    qint64 m_monthlyBudgetMicros = 0;
     int m_budgetWarningPercent = 80;
 
     int m_rateLimitRequests = 0;
@@ -300,15 +670,154 @@ private:
     int m_generation = 0; // incremented on each refresh() to discard stale replies
     QList<QNetworkReply *> m_activeReplies; // tracked for cancellation
 
+    // Single-flight refresh bookkeeping
+    void noteCoalescedRefresh();
+
+    // Circuit breaker
+    void recordReplyOutcome(QNetworkReply *reply);
+    void openCircuit();
+    bool circuitAllowsRefresh();
+
+    CircuitState m_circuitState = CircuitState::Closed;
+    int m_circuitFailures = 0;         // transient failures in a row
+    int m_circuitFailureThreshold = 5;
+    int m_circuitCooldownMs = 60000;   // first cooldown; doubles per failed trial
+    qint64 m_circuitCurrentCooldownMs = 0;
+    qint64 m_circuitRetryAtMs = 0;
+    int m_pausedRefreshes = 0;
+
+    static constexpr qint64 MAX_CIRCUIT_COOLDOWN_MS = 30 * 60 * 1000;
+    static constexpr const char *RETRIES_EXHAUSTED_PROPERTY = "_retriesExhausted";
+
+    bool m_refreshQueued = false;  // run again once the current refresh ends
+    int m_coalescedRefreshes = 0;  // refresh requests that attached to a running one
+    int m_savedRequests = 0;       // replies those requests would have aborted and re-sent
+    int m_abortedRequests = 0;     // replies aborted by configuration changes
+    QElapsedTimer m_refreshTimer;  // since the current cycle began
+
+    // Longer than a request timeout plus every retry backoff
+    static constexpr qint64 STALLED_REFRESH_MS = 3 * 60 * 1000;
+
     // Budget notification dedup — avoid repeating same alert within a period
     bool m_dailyWarningEmitted = false;
     bool m_dailyExceededEmitted = false;
     bool m_monthlyWarningEmitted = false;
     bool m_monthlyExceededEmitted = false;
 
-    QHash<QString, ModelPricing> m_modelPricing;
+    PricingCatalog m_localPricing; // registerModelPricing(), under an empty provider key
+    const PricingCatalog::Price *findModelPricing(const QString &model) const;
+
+    // Adaptive cadence: what the last dataUpdated() reported, and how many
+    // updates in a row have reported the same thing
+    struct DataFingerprint {
+        qint64 inputTokens = 0;
+        qint64 outputTokens = 0;
+        int requestCount = 0;
+        qint64 costMicros = 0;
+        qint64 dailyCostMicros = 0;
+        qint64 monthlyCostMicros = 0;
+        int rateLimitRequestsRemaining = 0;
+        int rateLimitTokensRemaining = 0;
+        bool operator==(const DataFingerprint &other) const = default;
+    };
+
+    void onDataUpdatedForCadence();
+    void updateCadence();
+    double urgencyFactor() const;
+
+    bool m_adaptiveCadence = true;
+    bool m_hasFingerprint = false;
+    DataFingerprint m_lastFingerprint;
+    int m_unchangedUpdates = 0;
+    double m_cadenceFactor = 1.0;
+
+    static constexpr int MAX_BACKOFF_STEPS = 3;              // 2^3 = 8x the configured interval
+    static constexpr qint64 MIN_ADAPTIVE_INTERVAL_MS = 30000; // tightening floor
+
+    // Conditional requests: validators and parsed body of the last 200 per key
+    struct CachedResponse {
+        QUrl url;
+        QByteArray etag;
+        QByteArray lastModified;
+        QJsonDocument document;
+    };
+
+    QHash<QString, CachedResponse> m_responseCache;
+    int m_conditionalRequests = 0;
+    int m_cacheHits = 0;
+
+    // Rate-limit probing
+    struct ProbeStats {
+        int count = 0;
+        qint64 totalLatencyMs = 0;
+        qint64 lastLatencyMs = 0;
+        qint64 costMicros = 0;
+    };
+
+    QList<ProbeStrategy> m_probeOrder; // empty: defaultProbeOrder()
+    QSet<ProbeStrategy> m_unsupportedProbes;
+    QHash<ProbeStrategy, ProbeStats> m_probeStats;
+    QElapsedTimer m_probeTimer;
+    QElapsedTimer m_rateLimitHeadersAge; // valid once headers were seen
+    int m_rateLimitHeaderMaxAgeMs = 15 * 60 * 1000;
+    RateLimitBucket m_requestBucket;
+    RateLimitBucket m_tokenBucket;
+    bool m_hasLastProbe = false;
+    ProbeStrategy m_lastProbe = ProbeStrategy::ChatCompletion;
+    int m_probeCount = 0;
+    qint64 m_probeCostMicros = 0;
+
+    static constexpr int PREDICTED_CHANGE_PERCENT = 5;
+
+    // Endpoint freshness
+    struct EndpointState {
+        qint64 ttlMs = 0;
+        qint64 fetchedAtMs = 0; // 0: not fetched since declared / invalidated
+        bool overridden = false; // TTL came from endpointTtls
+    };
+
+    QHash<QString, EndpointState> m_endpoints;
+    int m_skippedEndpointFetches = 0;
+
+    // Network timing; phases are -1 when they did not happen
+    struct NetworkSample {
+        qint64 dnsMs = -1;
+        qint64 connectMs = -1;
+        qint64 ttfbMs = -1;
+        qint64 downloadMs = -1;
+        qint64 totalMs = 0;
+        qint64 bytesIn = 0;
+        qint64 bytesOut = 0;
+        int httpStatus = 0;
+        int retryAttempt = 0;
+        bool failed = false;
+    };
 
-    static constexpr int REQUEST_TIMEOUT_MS = 30000; // 30 seconds
+    void instrumentReply(QNetworkReply *reply);
+    void recordNetworkSample(const NetworkSample &sample);
+
+    QList<NetworkSample> m_networkSamples; // oldest first
+    static constexpr int NETWORK_SAMPLE_WINDOW = 100;
+
+    // Total latency of answered requests per endpoint (URL without query)
+    QHash<QString, QList<qint64>> m_endpointLatencies;
+    bool m_adaptiveTimeouts = true;
+    bool m_hedgeRequests = false;
+    int m_hedgesFired = 0;
+    int m_hedgesWon = 0;
+    static constexpr int ENDPOINT_LATENCY_WINDOW = 50;
+    static constexpr int MIN_LATENCY_SAMPLES = 5;
+    static constexpr qint64 TIMEOUT_P99_FACTOR = 4;
+    static constexpr qint64 MIN_REQUEST_TIMEOUT_MS = 5000;
+    static constexpr qint64 MIN_BILLING_TIMEOUT_MS = 20000; // aggregate queries run long
+    static constexpr qint64 MAX_REQUEST_TIMEOUT_MS = 60000;
+    static constexpr const char *RETRY_ATTEMPT_PROPERTY = "_retryAttempt";
+
+    static constexpr int MAX_CACHED_RESPONSES = 16;
+    static constexpr QNetworkRequest::Attribute CacheKeyAttribute =
+        static_cast<QNetworkRequest::Attribute>(QNetworkRequest::User + 1);
+
+    static constexpr int REQUEST_TIMEOUT_MS = 30000; // until latency is known
 };
 
 #endif // PROVIDERBACKEND_H
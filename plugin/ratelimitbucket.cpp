@@ -0,0 +1,116 @@
+#include "ratelimitbucket.h"
+
+#include <cmath>
+
+void RateLimitBucket::observe(qint64 limit, qint64 remaining, qint64 resetMs, qint64 nowMs)
+{
+    m_limit = qMax<qint64>(0, limit);
+    m_remaining = qBound<qint64>(0, remaining, m_limit);
+    m_resetMs = resetMs;
+    m_observedAtMs = nowMs;
+}
+
+void RateLimitBucket::clear()
+{
+    *this = RateLimitBucket();
+}
+
+bool RateLimitBucket::isValid() const { return m_limit > 0; }
+bool RateLimitBucket::canPredict() const { return isValid() && m_resetMs >= 0; }
+qint64 RateLimitBucket::limit() const { return m_limit; }
+qint64 RateLimitBucket::observedRemaining() const { return m_remaining; }
+qint64 RateLimitBucket::observedAtMs() const { return m_observedAtMs; }
+
+qint64 RateLimitBucket::remainingAt(qint64 nowMs) const
+{
+    if (!canPredict() || m_remaining >= m_limit)
+        return m_remaining;
+
+    const qint64 elapsed = qMax<qint64>(0, nowMs - m_observedAtMs);
+    if (elapsed >= m_resetMs)
+        return m_limit;
+
+    // In double: limit times elapsed milliseconds can leave the qint64 range
+    const double refilled = double(m_limit - m_remaining) * double(elapsed) / double(m_resetMs);
+    return qMin(m_limit, m_remaining + static_cast<qint64>(std::floor(refilled)));
+}
+
+qint64 RateLimitBucket::resetInMs(qint64 nowMs) const
+{
+    if (!canPredict())
+        return -1;
+    if (m_remaining >= m_limit)
+        return 0;
+    return qMax<qint64>(0, m_resetMs - qMax<qint64>(0, nowMs - m_observedAtMs));
+}
+
+double RateLimitBucket::refillPerSecond() const
+{
+    if (!canPredict() || m_resetMs == 0)
+        return 0.0;
+    return double(m_limit - m_remaining) * 1000.0 / double(m_resetMs);
+}
+
+qint64 RateLimitBucket::parseResetMs(QStringView value, const QDateTime &now)
+{
+    value = value.trimmed();
+    if (value.isEmpty())
+        return -1;
+
+    // Plain number: seconds, unless it is large enough to be a timestamp
+    bool isNumber = false;
+    const double number = value.toDouble(&isNumber);
+    if (isNumber) {
+        if (!std::isfinite(number) || number < 0)
+            return -1;
+        if (number >= 1e12)
+            return qMax<qint64>(0, qint64(number) - now.toMSecsSinceEpoch());
+        if (number >= 1e9)
+            return qMax<qint64>(0, qRound64(number * 1000.0) - now.toMSecsSinceEpoch());
+        return qRound64(number * 1000.0);
+    }
+
+    // Go-style duration: one or more <number><unit> components
+    static constexpr struct {
+        const char16_t *unit;
+        double ms;
+    } units[] = {
+        // Longer units first so "ms" is not read as minutes
+        {u"ms", 1.0}, {u"us", 1e-3}, {u"µs", 1e-3}, {u"ns", 1e-6},
+        {u"h", 3600000.0}, {u"m", 60000.0}, {u"s", 1000.0},
+    };
+
+    double totalMs = 0.0;
+    qsizetype pos = 0;
+    bool durationOk = true;
+    while (pos < value.size() && durationOk) {
+        qsizetype end = pos;
+        while (end < value.size() && (value.at(end).isDigit() || value.at(end) == u'.'))
+            ++end;
+        bool numberOk = false;
+        const double amount = value.sliced(pos, end - pos).toDouble(&numberOk);
+        if (!numberOk) {
+            durationOk = false;
+            break;
+        }
+
+        durationOk = false;
+        for (const auto &unit : units) {
+            const QStringView suffix(unit.unit);
+            if (value.sliced(end).startsWith(suffix)) {
+                totalMs += amount * unit.ms;
+                pos = end + suffix.size();
+                durationOk = true;
+                break;
+            }
+        }
+    }
+    if (durationOk)
+        return qRound64(totalMs);
+
+    const QDateTime at = QDateTime::fromString(value.toString(), Qt::ISODateWithMs);
+    if (at.isValid())
+        return qMax<qint64>(0, now.msecsTo(at));
+
+    return -1;
+}
@@ -0,0 +1,59 @@
+#ifndef RATELIMITBUCKET_H
+#define RATELIMITBUCKET_H
+
+#include <QDateTime>
+#include <QStringView>
+#include <QtGlobal>
+
+/**
+ * Client-side token-bucket model of one provider limit.
+ *
+ * Each observation comes from rate-limit headers: the limit, what is left
+ * of it, and how long until the bucket is full again. Between observations
+ * the bucket is assumed to refill linearly over that window, so
+ * remainingAt() predicts headroom without another request. Consumption by
+ * other clients of the same key stays invisible until the next observation.
+ *
+ * Times are milliseconds since the epoch, passed in so the model can be
+ * evaluated at any instant.
+ */
+class RateLimitBucket
+{
+public:
+    /// Record what a response reported. resetMs < 0: reset time unknown,
+    /// the remaining count is then held as observed.
+    void observe(qint64 limit, qint64 remaining, qint64 resetMs, qint64 nowMs);
+    void clear();
+
+    /// An observation with a positive limit was made.
+    bool isValid() const;
+    /// The observation carried a reset time, so refills can be predicted.
+    bool canPredict() const;
+
+    qint64 limit() const;
+    qint64 observedRemaining() const;
+    qint64 observedAtMs() const;
+
+    /// Predicted remaining count at nowMs, between the observed value and the limit.
+    qint64 remainingAt(qint64 nowMs) const;
+    /// Time left until the bucket is predicted full; 0 once full, -1 if unknown.
+    qint64 resetInMs(qint64 nowMs) const;
+    /// Units restored per second while refilling.
+    double refillPerSecond() const;
+
+    /**
+     * Milliseconds until a rate-limit reset, or -1 if unparseable. Accepts
+     * Go-style durations ("6m0s", "1.5s", "20ms", "1h2m"), plain numbers
+     * (seconds, or an epoch timestamp in seconds or milliseconds) and
+     * RFC 3339 times. Times in the past give 0.
+     */
+    static qint64 parseResetMs(QStringView value, const QDateTime &now = QDateTime::currentDateTimeUtc());
+
+private:
+    qint64 m_limit = 0;
+    qint64 m_remaining = 0;
+    qint64 m_resetMs = -1;
+    qint64 m_observedAtMs = 0;
+};
+
+#endif // RATELIMITBUCKET_H
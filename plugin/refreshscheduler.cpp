@@ -0,0 +1,444 @@
+#include "refreshscheduler.h"
+#include "providerbackend.h"
+
+#include <QDebug>
+#include <QRandomGenerator>
+#include <QVariantMap>
+
+#include <algorithm>
+#include <limits>
+
+RefreshScheduler::RefreshScheduler(QObject *parent)
+    : QObject(parent)
+{
+    m_wakeTimer.setSingleShot(true);
+    m_wakeTimer.setTimerType(Qt::CoarseTimer);
+    connect(&m_wakeTimer, &QTimer::timeout, this, &RefreshScheduler::wake);
+}
+
+// ── Properties ──
+
+QVariantList RefreshScheduler::entries() const { return m_entriesSource; }
+void RefreshScheduler::setEntries(const QVariantList &entries)
+{
+    const qint64 now = nowMs();
+    QList<Entry> updated;
+    updated.reserve(entries.size());
+
+    for (const QVariant &value : entries) {
+        const QVariantMap map = value.toMap();
+        const QString name = map.value(QStringLiteral("name")).toString();
+        if (name.isEmpty()) {
+            qWarning() << "RefreshScheduler: ignoring entry without a name";
+            continue;
+        }
+
+        // Carry over timing state so re-evaluated QML bindings do not
+        // reset every provider's schedule.
+        const Entry *previous = findEntry(name);
+        Entry entry = previous ? *previous : Entry();
+        entry.name = name;
+        entry.intervalMs = map.value(QStringLiteral("intervalMs")).toLongLong();
+        entry.enabled = map.value(QStringLiteral("enabled"), true).toBool() && entry.intervalMs > 0;
+        entry.requiresApiKey = map.value(QStringLiteral("requiresApiKey")).toBool();
+        entry.isTask = !map.contains(QStringLiteral("backend"));
+
+        ProviderBackend *backend = qobject_cast<ProviderBackend *>(map.value(QStringLiteral("backend")).value<QObject *>());
+        if (entry.backend != backend) {
+            for (const QMetaObject::Connection &connection : std::as_const(entry.connections))
+                disconnect(connection);
+            entry.connections.clear();
+            entry.backend = backend;
+            entry.running = false;
+            if (backend) {
+                entry.connections.append(connect(backend, &ProviderBackend::loadingChanged, this, [this, name]() {
+                    onLoadingChanged(name);
+                }));
+                entry.connections.append(connect(backend, &ProviderBackend::cadenceChanged, this, [this, name]() {
+                    if (Entry *changed = findEntry(name))
+                        retime(*changed, nowMs());
+                    reschedule();
+                }));
+            }
+        }
+
+        if (!previous || previous->intervalMs != entry.intervalMs || !previous->enabled) {
+            setNextDue(entry, entry.lastStartedMs > 0 ? entry.lastStartedMs : now);
+        }
+        updated.append(entry);
+    }
+
+    // Entries that disappeared stop listening to their backends
+    for (const Entry &old : std::as_const(m_entries)) {
+        const bool kept = std::any_of(updated.cbegin(), updated.cend(), [&old](const Entry &entry) {
+            return entry.name == old.name && entry.backend == old.backend;
+        });
+        if (!kept) {
+            for (const QMetaObject::Connection &connection : old.connections)
+                disconnect(connection);
+        }
+    }
+
+    m_entries = updated;
+    m_entriesSource = entries;
+    Q_EMIT entriesChanged();
+    reschedule();
+}
+
+SystemStateMonitor *RefreshScheduler::systemState() const { return m_systemState; }
+void RefreshScheduler::setSystemState(SystemStateMonitor *monitor)
+{
+    if (m_systemState == monitor)
+        return;
+
+    if (m_systemState)
+        disconnect(m_systemState, nullptr, this, nullptr);
+    m_systemState = monitor;
+    if (m_systemState)
+        connect(m_systemState, &SystemStateMonitor::stateChanged, this, &RefreshScheduler::onSystemStateChanged);
+    Q_EMIT systemStateChanged();
+    onSystemStateChanged();
+}
+
+int RefreshScheduler::reconnectStaggerMs() const { return m_reconnectStaggerMs; }
+void RefreshScheduler::setReconnectStaggerMs(int ms)
+{
+    ms = qMax(0, ms);
+    if (m_reconnectStaggerMs != ms) {
+        m_reconnectStaggerMs = ms;
+        Q_EMIT reconnectStaggerMsChanged();
+    }
+}
+
+bool RefreshScheduler::isPaused() const { return !m_online; }
+
+int RefreshScheduler::maxConcurrent() const { return m_maxConcurrent; }
+void RefreshScheduler::setMaxConcurrent(int limit)
+{
+    limit = qMax(1, limit);
+    if (m_maxConcurrent != limit) {
+        m_maxConcurrent = limit;
+        Q_EMIT maxConcurrentChanged();
+        m_wakeTimer.start(0);
+    }
+}
+
+int RefreshScheduler::alignmentMs() const { return m_alignmentMs; }
+void RefreshScheduler::setAlignmentMs(int ms)
+{
+    ms = qMax(0, ms);
+    if (m_alignmentMs != ms) {
+        m_alignmentMs = ms;
+        Q_EMIT alignmentMsChanged();
+        reschedule();
+    }
+}
+
+int RefreshScheduler::jitterPercent() const { return m_jitterPercent; }
+void RefreshScheduler::setJitterPercent(int percent)
+{
+    percent = qBound(0, percent, 50);
+    if (m_jitterPercent != percent) {
+        m_jitterPercent = percent;
+        Q_EMIT jitterPercentChanged();
+    }
+}
+
+QDateTime RefreshScheduler::nextWake() const
+{
+    return m_nextWakeMs > 0 ? QDateTime::fromMSecsSinceEpoch(m_nextWakeMs) : QDateTime();
+}
+
+int RefreshScheduler::runningCount() const
+{
+    return static_cast<int>(std::count_if(m_entries.cbegin(), m_entries.cend(), [](const Entry &entry) {
+        return entry.running;
+    }));
+}
+
+// ── Debugging ──
+
+QVariantList RefreshScheduler::schedule() const
+{
+    const qint64 now = nowMs();
+    QList<const Entry *> ordered;
+    for (const Entry &entry : m_entries)
+        ordered.append(&entry);
+    std::sort(ordered.begin(), ordered.end(), [](const Entry *a, const Entry *b) {
+        return a->nextDueMs < b->nextDueMs;
+    });
+
+    QVariantList result;
+    for (const Entry *entry : std::as_const(ordered)) {
+        QDateTime lastRefreshed = entry->backend ? entry->backend->lastRefreshed() : QDateTime();
+        if (entry->isTask && entry->lastStartedMs > 0)
+            lastRefreshed = QDateTime::fromMSecsSinceEpoch(entry->lastStartedMs);
+
+        QVariantMap item;
+        item[QStringLiteral("name")] = entry->name;
+        item[QStringLiteral("enabled")] = entry->enabled;
+        item[QStringLiteral("running")] = entry->running;
+        item[QStringLiteral("intervalMs")] = entry->intervalMs;
+        item[QStringLiteral("nextDue")] = entry->enabled ? QDateTime::fromMSecsSinceEpoch(entry->nextDueMs) : QDateTime();
+        item[QStringLiteral("lastRefreshed")] = lastRefreshed;
+        item[QStringLiteral("stalenessMs")] = stalenessMs(*entry, now);
+        item[QStringLiteral("wakeups")] = entry->wakeups;
+        result.append(item);
+    }
+    return result;
+}
+
+// ── Manual triggers ──
+
+void RefreshScheduler::refreshAll()
+{
+    const qint64 now = nowMs();
+    for (Entry &entry : m_entries) {
+        if (!entry.isTask && entry.enabled)
+            entry.nextDueMs = now;
+    }
+    m_wakeTimer.start(0);
+}
+
+void RefreshScheduler::refreshNow(const QString &name)
+{
+    Entry *entry = findEntry(name);
+    if (!entry || !entry->enabled)
+        return;
+    entry->nextDueMs = nowMs();
+    m_wakeTimer.start(0);
+}
+
+// ── Scheduling ──
+
+qint64 RefreshScheduler::nowMs()
+{
+    return QDateTime::currentMSecsSinceEpoch();
+}
+
+RefreshScheduler::Entry *RefreshScheduler::findEntry(const QString &name)
+{
+    for (Entry &entry : m_entries) {
+        if (entry.name == name)
+            return &entry;
+    }
+    return nullptr;
+}
+
+qint64 RefreshScheduler::stalenessMs(const Entry &entry, qint64 now) const
+{
+    qint64 last = 0;
+    if (entry.backend) {
+        const QDateTime refreshed = entry.backend->lastRefreshed();
+        if (refreshed.isValid())
+            last = refreshed.toMSecsSinceEpoch();
+    } else if (entry.isTask) {
+        last = entry.lastStartedMs;
+    }
+    return last > 0 ? qMax<qint64>(0, now - last) : -1;
+}
+
+bool RefreshScheduler::isStaler(const Entry &a, const Entry &b, qint64 now) const
+{
+    // Never-refreshed entries (-1) sort ahead of everything
+    const qint64 sa = stalenessMs(a, now);
+    const qint64 sb = stalenessMs(b, now);
+    if ((sa < 0) != (sb < 0))
+        return sa < 0;
+    return sa > sb;
+}
+
+qint64 RefreshScheduler::effectiveIntervalMs(const Entry &entry) const
+{
+    qint64 interval = entry.intervalMs;
+    if (entry.backend)
+        interval = entry.backend->adaptiveIntervalMs(interval);
+    if (m_systemState)
+        interval = qRound64(interval * m_systemState->pollingFactor());
+    return interval;
+}
+
+void RefreshScheduler::setNextDue(Entry &entry, qint64 anchorMs)
+{
+    entry.anchorMs = anchorMs;
+    entry.nextDueMs = anchorMs + jitteredInterval(effectiveIntervalMs(entry));
+    entry.staggered = false;
+}
+
+void RefreshScheduler::retime(Entry &entry, qint64 now)
+{
+    // Entries already due (or forced due by refreshNow) and reconnect-wave
+    // slots keep their time
+    if (!entry.enabled || entry.running || entry.staggered || entry.nextDueMs <= now)
+        return;
+    setNextDue(entry, entry.anchorMs);
+}
+
+void RefreshScheduler::retimeAll()
+{
+    const qint64 now = nowMs();
+    for (Entry &entry : m_entries)
+        retime(entry, now);
+    reschedule();
+}
+
+qint64 RefreshScheduler::jitteredInterval(qint64 intervalMs) const
+{
+    const qint64 spread = intervalMs * m_jitterPercent / 100;
+    if (spread <= 0)
+        return intervalMs;
+    return intervalMs + QRandomGenerator::global()->bounded(-spread, spread + 1);
+}
+
+void RefreshScheduler::onLoadingChanged(const QString &name)
+{
+    Entry *entry = findEntry(name);
+    if (!entry || !entry->running || !entry->backend || entry->backend->isLoading())
+        return;
+
+    // A slot freed up; let anything waiting on the cap start right away.
+    // The refresh may also have moved the provider's cadence.
+    entry->running = false;
+    retime(*entry, nowMs());
+    m_wakeTimer.start(0);
+}
+
+void RefreshScheduler::onSystemStateChanged()
+{
+    const bool online = !m_systemState || m_systemState->isOnline();
+    if (m_online != online) {
+        m_online = online;
+        if (m_online)
+            startReconnectWave();
+    }
+    retimeAll();
+}
+
+void RefreshScheduler::startReconnectWave()
+{
+    const qint64 now = nowMs();
+    QList<Entry *> due;
+    for (Entry &entry : m_entries) {
+        if (entry.enabled && !entry.running && entry.nextDueMs <= now)
+            due.append(&entry);
+    }
+    std::stable_sort(due.begin(), due.end(), [this, now](const Entry *a, const Entry *b) {
+        return isStaler(*a, *b, now);
+    });
+
+    qint64 slot = now;
+    for (Entry *entry : std::as_const(due)) {
+        entry->nextDueMs = slot;
+        entry->staggered = true;
+        slot += jitteredInterval(m_reconnectStaggerMs);
+    }
+}
+
+void RefreshScheduler::wake()
+{
+    if (!m_online) {
+        reschedule();
+        return;
+    }
+
+    const qint64 now = nowMs();
+    // Anything due before the next grid point rides along with this wakeup;
+    // reconnect-wave slots wait for their own time
+    const qint64 horizon = now + m_alignmentMs;
+
+    QList<Entry *> due;
+    for (Entry &entry : m_entries) {
+        if (entry.enabled && !entry.running && entry.nextDueMs <= (entry.staggered ? now : horizon))
+            due.append(&entry);
+    }
+
+    // Stalest first
+    std::stable_sort(due.begin(), due.end(), [this, now](const Entry *a, const Entry *b) {
+        return isStaler(*a, *b, now);
+    });
+
+    int running = runningCount();
+    QStringList tasks;
+    QList<QPointer<ProviderBackend>> toStart;
+    QStringList startedNames;
+
+    for (Entry *entry : std::as_const(due)) {
+        if (entry->isTask) {
+            entry->lastStartedMs = now;
+            setNextDue(*entry, now);
+            ++entry->wakeups;
+            tasks.append(entry->name);
+            continue;
+        }
+
+        // A provider whose backend was destroyed has nothing left to run
+        if (!entry->backend)
+            continue;
+
+        if (entry->requiresApiKey && !entry->backend->hasApiKey()) {
+            setNextDue(*entry, now);
+            continue;
+        }
+
+        if (running >= m_maxConcurrent)
+            continue; // stays due; started when a running refresh finishes
+
+        entry->running = true;
+        entry->lastStartedMs = now;
+        setNextDue(*entry, now);
+        ++entry->wakeups;
+        ++running;
+        toStart.append(entry->backend);
+        startedNames.append(entry->name);
+    }
+
+    // Start outside the loop: refresh() may emit loadingChanged synchronously
+    for (int i = 0; i < toStart.size(); ++i) {
+        ProviderBackend *backend = toStart.at(i);
+        if (!backend)
+            continue;
+        Q_EMIT refreshStarted(startedNames.at(i));
+        backend->refresh();
+        if (!backend->isLoading()) {
+            if (Entry *entry = findEntry(startedNames.at(i)))
+                entry->running = false;
+        }
+    }
+
+    for (const QString &task : std::as_const(tasks))
+        Q_EMIT taskDue(task);
+
+    reschedule();
+}
+
+void RefreshScheduler::reschedule()
+{
+    const qint64 now = nowMs();
+    const bool slotFree = runningCount() < m_maxConcurrent;
+
+    qint64 wakeAt = std::numeric_limits<qint64>::max();
+    for (const Entry &entry : std::as_const(m_entries)) {
+        if (!entry.enabled || entry.running)
+            continue;
+        // Due providers waiting for a slot are woken by onLoadingChanged
+        if (!entry.isTask && !slotFree && entry.nextDueMs <= now)
+            continue;
+
+        qint64 at = qMax(entry.nextDueMs, now);
+        if (m_alignmentMs > 0 && !entry.staggered)
+            at = ((at + m_alignmentMs - 1) / m_alignmentMs) * m_alignmentMs;
+        wakeAt = qMin(wakeAt, at);
+    }
+
+    // Offline nothing is woken; reconnecting starts the wave
+    if (!m_online || wakeAt == std::numeric_limits<qint64>::max()) {
+        m_wakeTimer.stop();
+        m_nextWakeMs = 0;
+        Q_EMIT scheduleChanged();
+        return;
+    }
+
+    m_nextWakeMs = wakeAt;
+    m_wakeTimer.start(static_cast<int>(qMin<qint64>(wakeAt - now, std::numeric_limits<int>::max())));
+    Q_EMIT scheduleChanged();
+}
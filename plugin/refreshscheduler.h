@@ -0,0 +1,163 @@
+#ifndef REFRESHSCHEDULER_H
+#define REFRESHSCHEDULER_H
+
+#include <QObject>
+#include <QDateTime>
+#include <QList>
+#include <QPointer>
+#include <QTimer>
+#include <QVariantList>
+
+#include "systemstatemonitor.h"
+
+class ProviderBackend;
+
+/**
+ * Single timer that drives every periodic refresh in the applet.
+ *
+ * Each entry is either a provider backend, which the scheduler refreshes
+ * itself, or a named task (browser sync, Copilot org metrics), for which it
+ * emits taskDue(). Wakeups are rounded up to a wall-clock grid of
+ * `alignmentMs`, and everything due before the next grid point runs in the
+ * same wakeup, so thirteen providers cost a handful of wakeups instead of
+ * thirteen independent timers. Intervals get ±`jitterPercent` jitter so
+ * entries with equal intervals drift apart instead of firing in lockstep.
+ *
+ * At most `maxConcurrent` provider refreshes run at once; when more are
+ * due, the stalest (longest since its last successful refresh, never
+ * refreshed first) go first and the rest start as slots free up.
+ *
+ * A provider's interval is scaled by its own cadence (see
+ * ProviderBackend::adaptiveIntervalMs) and by the optional `systemState`
+ * polling factor (battery, metered network). Pending due times are
+ * recomputed whenever either changes.
+ *
+ * While `systemState` reports the machine offline nothing is started and
+ * the timer is stopped (`paused`). On reconnect, every entry that fell due
+ * in the meantime runs in a reconnect wave: stalest first, one every
+ * `reconnectStaggerMs` (± jitter), off the alignment grid, so coming back
+ * online does not fire every provider at once.
+ *
+ * Usage from QML:
+ *   RefreshScheduler {
+ *       entries: [{ name: "OpenAI", backend: openaiBackend, intervalMs: 300000,
+ *                   enabled: true, requiresApiKey: true },
+ *                 { name: "browserSync", intervalMs: 600000, enabled: true }]
+ *       onTaskDue: (name) => { ... }
+ *   }
+ */
+class RefreshScheduler : public QObject
+{
+    Q_OBJECT
+    Q_PROPERTY(QVariantList entries READ entries WRITE setEntries NOTIFY entriesChanged)
+    Q_PROPERTY(int maxConcurrent READ maxConcurrent WRITE setMaxConcurrent NOTIFY maxConcurrentChanged)
+    Q_PROPERTY(int alignmentMs READ alignmentMs WRITE setAlignmentMs NOTIFY alignmentMsChanged)
+    Q_PROPERTY(int jitterPercent READ jitterPercent WRITE setJitterPercent NOTIFY jitterPercentChanged)
+    Q_PROPERTY(SystemStateMonitor *systemState READ systemState WRITE setSystemState NOTIFY systemStateChanged)
+    Q_PROPERTY(int reconnectStaggerMs READ reconnectStaggerMs WRITE setReconnectStaggerMs NOTIFY reconnectStaggerMsChanged)
+    Q_PROPERTY(bool paused READ isPaused NOTIFY scheduleChanged)
+    Q_PROPERTY(QDateTime nextWake READ nextWake NOTIFY scheduleChanged)
+    Q_PROPERTY(int runningCount READ runningCount NOTIFY scheduleChanged)
+
+public:
+    explicit RefreshScheduler(QObject *parent = nullptr);
+
+    QVariantList entries() const;
+    void setEntries(const QVariantList &entries);
+
+    int maxConcurrent() const;
+    void setMaxConcurrent(int limit);
+
+    int alignmentMs() const;
+    void setAlignmentMs(int ms);
+
+    int jitterPercent() const;
+    void setJitterPercent(int percent);
+
+    SystemStateMonitor *systemState() const;
+    void setSystemState(SystemStateMonitor *monitor);
+
+    int reconnectStaggerMs() const;
+    void setReconnectStaggerMs(int ms);
+
+    /// True while systemState reports the machine offline.
+    bool isPaused() const;
+
+    /// Time of the next timer wakeup; invalid when nothing is scheduled.
+    QDateTime nextWake() const;
+
+    int runningCount() const;
+
+    /**
+     * One entry per scheduled item, ordered by next due time:
+     * { name, enabled, running, intervalMs, nextDue, lastRefreshed,
+     *   stalenessMs, wakeups }. `stalenessMs` is -1 for entries that have
+     * never refreshed.
+     */
+    Q_INVOKABLE QVariantList schedule() const;
+
+    /// Make every enabled provider due now (tasks are left alone).
+    Q_INVOKABLE void refreshAll();
+
+    /// Make one provider or task due now.
+    Q_INVOKABLE void refreshNow(const QString &name);
+
+Q_SIGNALS:
+    void entriesChanged();
+    void maxConcurrentChanged();
+    void alignmentMsChanged();
+    void jitterPercentChanged();
+    void systemStateChanged();
+    void reconnectStaggerMsChanged();
+    void scheduleChanged();
+    void taskDue(const QString &name);
+    void refreshStarted(const QString &name);
+
+private:
+    struct Entry {
+        QString name;
+        QPointer<ProviderBackend> backend;
+        qint64 intervalMs = 0;
+        bool enabled = false;
+        bool requiresApiKey = false;
+        bool isTask = false;
+        bool running = false;
+        qint64 nextDueMs = 0;
+        qint64 lastStartedMs = 0;
+        qint64 anchorMs = 0; // time nextDueMs was measured from
+        bool staggered = false; // reconnect-wave slot, exempt from alignment
+        int wakeups = 0;
+        // This entry's own connections; other entries may share the backend
+        QList<QMetaObject::Connection> connections;
+    };
+
+    static qint64 nowMs();
+
+    Entry *findEntry(const QString &name);
+    qint64 stalenessMs(const Entry &entry, qint64 now) const;
+    bool isStaler(const Entry &a, const Entry &b, qint64 now) const;
+    qint64 jitteredInterval(qint64 intervalMs) const;
+    qint64 effectiveIntervalMs(const Entry &entry) const;
+    void setNextDue(Entry &entry, qint64 anchorMs);
+    void retime(Entry &entry, qint64 now);
+    void retimeAll();
+    void onLoadingChanged(const QString &name);
+    void onSystemStateChanged();
+    void startReconnectWave();
+    void wake();
+    void reschedule();
+
+    QVariantList m_entriesSource;
+    QList<Entry> m_entries;
+    QTimer m_wakeTimer;
+    qint64 m_nextWakeMs = 0;
+    QPointer<SystemStateMonitor> m_systemState;
+
+    int m_maxConcurrent = 3;
+    int m_alignmentMs = 15000;
+    int m_jitterPercent = 10;
+    int m_reconnectStaggerMs = 2000;
+    bool m_online = true;
+};
+
+#endif // REFRESHSCHEDULER_H
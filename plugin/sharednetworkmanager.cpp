@@ -0,0 +1,429 @@
+#include "sharednetworkmanager.h"
+
+#include <QBuffer>
+#include <QCoreApplication>
+#include <QNetworkReply>
+#include <QVariantMap>
+
+#if QT_CONFIG(ssl)
+#include <QSslConfiguration>
+#endif
+
+#include <algorithm>
+#include <memory>
+
+/**
+ * Stand-in reply handed out for a request that is waiting for a free slot.
+ *
+ * Once the real reply is attached, its body is buffered here and its
+ * headers, attributes, errors and signals are mirrored, so callers never
+ * notice the request was queued. The real reply is parented to the proxy
+ * and goes away with it.
+ */
+class QueuedNetworkReply : public QNetworkReply
+{
+public:
+    QueuedNetworkReply(QNetworkAccessManager::Operation op, const QNetworkRequest &request,
+                       SharedNetworkManager *manager)
+        : QNetworkReply(manager)
+        , m_manager(manager)
+    {
+        setRequest(request);
+        setOperation(op);
+        setUrl(request.url());
+        open(QIODevice::ReadOnly);
+    }
+
+    ~QueuedNetworkReply() override
+    {
+        if (!m_reply && m_manager)
+            m_manager->dropQueued(this);
+    }
+
+    void attach(QNetworkReply *reply)
+    {
+        m_reply = reply;
+        reply->setParent(this);
+
+        connect(reply, &QNetworkReply::metaDataChanged, this, [this]() {
+            copyMetaData();
+            Q_EMIT metaDataChanged();
+        });
+        connect(reply, &QNetworkReply::readyRead, this, [this]() {
+            m_buffer.append(m_reply->readAll());
+            Q_EMIT readyRead();
+        });
+        connect(reply, &QNetworkReply::downloadProgress, this, &QNetworkReply::downloadProgress);
+        connect(reply, &QNetworkReply::uploadProgress, this, &QNetworkReply::uploadProgress);
+        connect(reply, &QNetworkReply::redirected, this, &QNetworkReply::redirected);
+        // Connection milestones, for callers that time the request phases
+        connect(reply, &QNetworkReply::socketStartedConnecting, this, &QNetworkReply::socketStartedConnecting);
+        connect(reply, &QNetworkReply::requestSent, this, &QNetworkReply::requestSent);
+#if QT_CONFIG(ssl)
+        connect(reply, &QNetworkReply::encrypted, this, &QNetworkReply::encrypted);
+#endif
+        connect(reply, &QNetworkReply::finished, this, [this]() {
+            m_buffer.append(m_reply->readAll());
+            copyMetaData();
+            finish(m_reply->error(), m_reply->errorString());
+        });
+    }
+
+    void abort() override
+    {
+        if (m_reply) {
+            m_reply->abort();
+            return;
+        }
+        if (isFinished())
+            return;
+
+        if (m_manager)
+            m_manager->dropQueued(this);
+        finish(OperationCanceledError, QStringLiteral("Operation canceled"));
+    }
+
+    void ignoreSslErrors() override
+    {
+        if (m_reply)
+            m_reply->ignoreSslErrors();
+    }
+
+    qint64 bytesAvailable() const override
+    {
+        return m_buffer.size() + QNetworkReply::bytesAvailable();
+    }
+
+protected:
+    qint64 readData(char *data, qint64 maxSize) override
+    {
+        if (m_buffer.isEmpty())
+            return isFinished() ? -1 : 0;
+
+        const qint64 count = qMin<qint64>(maxSize, m_buffer.size());
+        std::copy_n(m_buffer.constData(), count, data);
+        m_buffer.remove(0, count);
+        return count;
+    }
+
+private:
+    void copyMetaData()
+    {
+        const auto headers = m_reply->rawHeaderPairs();
+        for (const auto &header : headers)
+            setRawHeader(header.first, header.second);
+
+        static const QNetworkRequest::Attribute attributes[] = {
+            QNetworkRequest::HttpStatusCodeAttribute,
+            QNetworkRequest::HttpReasonPhraseAttribute,
+            QNetworkRequest::RedirectionTargetAttribute,
+            QNetworkRequest::ConnectionEncryptedAttribute,
+            QNetworkRequest::SourceIsFromCacheAttribute,
+            QNetworkRequest::Http2WasUsedAttribute,
+        };
+        for (const auto attribute : attributes) {
+            const QVariant value = m_reply->attribute(attribute);
+            if (value.isValid())
+                setAttribute(attribute, value);
+        }
+    }
+
+    void finish(NetworkError code, const QString &errorString)
+    {
+        if (code != NoError) {
+            setError(code, errorString);
+            Q_EMIT errorOccurred(code);
+        }
+        setFinished(true);
+        Q_EMIT finished();
+    }
+
+    QPointer<SharedNetworkManager> m_manager;
+    QPointer<QNetworkReply> m_reply;
+    QByteArray m_buffer;
+};
+
+SharedNetworkManager::SharedNetworkManager(QObject *parent)
+    : QNetworkAccessManager(parent)
+{
+    m_retryRefill.start();
+}
+
+SharedNetworkManager::~SharedNetworkManager()
+{
+    // Replies are children and outlive this destructor body; stop them from
+    // reporting back into members that are already gone.
+    const auto replies = findChildren<QNetworkReply *>();
+    for (QNetworkReply *reply : replies)
+        reply->disconnect(this);
+    m_pending.clear();
+}
+
+SharedNetworkManager *SharedNetworkManager::instance()
+{
+    static QPointer<SharedNetworkManager> s_instance;
+    if (!s_instance)
+        s_instance = new SharedNetworkManager(QCoreApplication::instance());
+    return s_instance;
+}
+
+// ── Properties ──
+
+int SharedNetworkManager::maxConcurrentRequests() const { return m_maxConcurrent; }
+void SharedNetworkManager::setMaxConcurrentRequests(int limit)
+{
+    limit = qBound(1, limit, MAX_CONCURRENT_LIMIT);
+    if (m_maxConcurrent != limit) {
+        m_maxConcurrent = limit;
+        Q_EMIT maxConcurrentRequestsChanged();
+        startQueued();
+    }
+}
+
+int SharedNetworkManager::inFlight() const { return m_inFlight; }
+int SharedNetworkManager::queued() const { return m_pending.size(); }
+
+// ── Retry budget ──
+
+int SharedNetworkManager::retryBudget() const { return m_retryBudget; }
+void SharedNetworkManager::setRetryBudget(int tokens)
+{
+    tokens = qMax(0, tokens);
+    if (m_retryBudget != tokens) {
+        m_retryTokens = qMin(availableRetryTokens(), static_cast<double>(tokens));
+        m_retryRefill.restart();
+        m_retryBudget = tokens;
+        Q_EMIT retryBudgetChanged();
+        Q_EMIT statisticsChanged();
+    }
+}
+
+int SharedNetworkManager::retryTokens() const { return static_cast<int>(availableRetryTokens()); }
+int SharedNetworkManager::retriesGranted() const { return m_retriesGranted; }
+int SharedNetworkManager::retriesDenied() const { return m_retriesDenied; }
+
+double SharedNetworkManager::availableRetryTokens() const
+{
+    const double refilled = static_cast<double>(m_retryRefill.elapsed()) * m_retryBudget / RETRY_REFILL_WINDOW_MS;
+    return qMin(static_cast<double>(m_retryBudget), m_retryTokens + refilled);
+}
+
+bool SharedNetworkManager::acquireRetryToken()
+{
+    m_retryTokens = availableRetryTokens();
+    m_retryRefill.restart();
+
+    const bool granted = m_retryTokens >= 1.0;
+    if (granted) {
+        m_retryTokens -= 1.0;
+        ++m_retriesGranted;
+    } else {
+        ++m_retriesDenied;
+    }
+    Q_EMIT statisticsChanged();
+    return granted;
+}
+
+// ── Statistics ──
+
+QVariantList SharedNetworkManager::hostStatistics() const
+{
+    QStringList hosts = m_hostStats.keys();
+    hosts.sort();
+
+    QVariantList result;
+    result.reserve(hosts.size());
+    for (const QString &host : std::as_const(hosts)) {
+        const HostStats stats = m_hostStats.value(host);
+        const qint64 finished = stats.requests;
+
+        QVariantMap entry;
+        entry[QStringLiteral("host")] = host;
+        entry[QStringLiteral("requests")] = stats.requests;
+        entry[QStringLiteral("failures")] = stats.failures;
+        entry[QStringLiteral("canceled")] = stats.canceled;
+        entry[QStringLiteral("inFlight")] = stats.inFlight;
+        entry[QStringLiteral("http2")] = stats.http2;
+        entry[QStringLiteral("encrypted")] = stats.encrypted;
+        entry[QStringLiteral("bytesReceived")] = stats.bytesReceived;
+        entry[QStringLiteral("avgLatencyMs")] = finished > 0 ? stats.totalLatencyMs / finished : 0;
+        entry[QStringLiteral("maxLatencyMs")] = stats.maxLatencyMs;
+        entry[QStringLiteral("avgQueueMs")] = finished > 0 ? stats.totalQueueMs / finished : 0;
+        entry[QStringLiteral("lastStatus")] = stats.lastStatus;
+        entry[QStringLiteral("lastError")] = stats.lastError;
+        result.append(entry);
+    }
+    return result;
+}
+
+void SharedNetworkManager::resetStatistics()
+{
+    // Keep in-flight counts so requests finishing after the reset still balance
+    for (auto it = m_hostStats.begin(); it != m_hostStats.end();) {
+        if (it->inFlight == 0) {
+            it = m_hostStats.erase(it);
+        } else {
+            const int inFlight = it->inFlight;
+            *it = HostStats();
+            it->inFlight = inFlight;
+            ++it;
+        }
+    }
+    m_retriesGranted = 0;
+    m_retriesDenied = 0;
+    Q_EMIT statisticsChanged();
+}
+
+// ── Request dispatch ──
+
+QNetworkReply *SharedNetworkManager::createRequest(Operation op, const QNetworkRequest &request,
+                                                   QIODevice *outgoingData)
+{
+    if (m_inFlight < m_maxConcurrent && m_pending.isEmpty())
+        return startRequest(op, request, outgoingData, 0);
+
+    // The caller's upload device may not outlive this call (post(QByteArray)
+    // parents its buffer to the returned reply), so take a copy now.
+    PendingRequest pending;
+    pending.op = op;
+    pending.request = request;
+    if (outgoingData) {
+        pending.body = outgoingData->readAll();
+        pending.hasBody = true;
+    }
+    pending.queuedFor.start();
+
+    auto *proxy = new QueuedNetworkReply(op, request, this);
+    pending.proxy = proxy;
+    m_pending.append(pending);
+
+    Q_EMIT statisticsChanged();
+    return proxy;
+}
+
+QString SharedNetworkManager::hostKey(const QUrl &url)
+{
+    const int port = url.port(-1);
+    return port > 0 ? QStringLiteral("%1:%2").arg(url.host()).arg(port) : url.host();
+}
+
+QNetworkRequest SharedNetworkManager::prepareRequest(const QNetworkRequest &request)
+{
+    QNetworkRequest prepared(request);
+
+    // HTTP/2 is negotiated via ALPN and is on by default in Qt 6; requests
+    // that set Http2AllowedAttribute themselves keep their choice.
+#if QT_CONFIG(ssl)
+    if (request.url().scheme() == QLatin1String("https")) {
+        // Share the TLS context between connections to the same host and
+        // keep session tickets, so reconnects resume instead of doing a
+        // full handshake.
+        QSslConfiguration ssl = prepared.sslConfiguration();
+        ssl.setSslOption(QSsl::SslOptionDisableSessionSharing, false);
+        ssl.setSslOption(QSsl::SslOptionDisableSessionPersistence, false);
+        ssl.setSslOption(QSsl::SslOptionDisableSessionTickets, false);
+        prepared.setSslConfiguration(ssl);
+    }
+#endif
+
+    return prepared;
+}
+
+QNetworkReply *SharedNetworkManager::startRequest(Operation op, const QNetworkRequest &request,
+                                                  QIODevice *outgoingData, qint64 queueMs)
+{
+    QNetworkReply *reply = QNetworkAccessManager::createRequest(op, prepareRequest(request), outgoingData);
+
+    const QString host = hostKey(request.url());
+    HostStats &stats = m_hostStats[host];
+    ++stats.inFlight;
+    stats.totalQueueMs += queueMs;
+    ++m_inFlight;
+
+    QElapsedTimer timer;
+    timer.start();
+    auto received = std::make_shared<qint64>(0);
+    auto done = std::make_shared<bool>(false);
+
+    connect(reply, &QNetworkReply::downloadProgress, this, [received](qint64 bytes, qint64) {
+        *received = bytes;
+    });
+    connect(reply, &QNetworkReply::finished, this, [this, host, reply, timer, received, done]() {
+        if (*done)
+            return;
+        *done = true;
+        onRequestDone(host, reply, timer.elapsed(), *received);
+    });
+    connect(reply, &QObject::destroyed, this, [this, host, timer, received, done]() {
+        if (*done)
+            return;
+        *done = true;
+        onRequestDone(host, nullptr, timer.elapsed(), *received);
+    });
+
+    Q_EMIT statisticsChanged();
+    return reply;
+}
+
+void SharedNetworkManager::onRequestDone(const QString &host, QNetworkReply *reply,
+                                         qint64 latencyMs, qint64 bytesReceived)
+{
+    m_inFlight = qMax(0, m_inFlight - 1);
+
+    HostStats &stats = m_hostStats[host];
+    stats.inFlight = qMax(0, stats.inFlight - 1);
+    ++stats.requests;
+    stats.bytesReceived += bytesReceived;
+    stats.totalLatencyMs += latencyMs;
+    stats.maxLatencyMs = qMax(stats.maxLatencyMs, latencyMs);
+
+    if (!reply) {
+        ++stats.canceled;
+    } else {
+        const QNetworkReply::NetworkError error = reply->error();
+        if (error == QNetworkReply::OperationCanceledError) {
+            ++stats.canceled;
+        } else if (error != QNetworkReply::NoError) {
+            ++stats.failures;
+            stats.lastError = reply->errorString();
+        }
+        if (reply->attribute(QNetworkRequest::Http2WasUsedAttribute).toBool())
+            ++stats.http2;
+        if (reply->attribute(QNetworkRequest::ConnectionEncryptedAttribute).toBool())
+            ++stats.encrypted;
+        stats.lastStatus = reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
+    }
+
+    startQueued();
+    Q_EMIT statisticsChanged();
+}
+
+void SharedNetworkManager::startQueued()
+{
+    while (m_inFlight < m_maxConcurrent && !m_pending.isEmpty()) {
+        PendingRequest next = m_pending.takeFirst();
+        if (!next.proxy || next.proxy->isFinished())
+            continue;
+
+        QBuffer *body = nullptr;
+        if (next.hasBody) {
+            body = new QBuffer();
+            body->setData(next.body);
+            body->open(QIODevice::ReadOnly);
+        }
+
+        QNetworkReply *reply = startRequest(next.op, next.request, body, next.queuedFor.elapsed());
+        if (body)
+            body->setParent(reply);
+        next.proxy->attach(reply);
+    }
+}
+
+void SharedNetworkManager::dropQueued(QueuedNetworkReply *proxy)
+{
+    const auto removed = m_pending.removeIf([proxy](const PendingRequest &pending) {
+        return pending.proxy == proxy;
+    });
+    if (removed > 0)
+        Q_EMIT statisticsChanged();
+}
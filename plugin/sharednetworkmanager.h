@@ -0,0 +1,149 @@
+#ifndef SHAREDNETWORKMANAGER_H
+#define SHAREDNETWORKMANAGER_H
+
+#include <QElapsedTimer>
+#include <QHash>
+#include <QList>
+#include <QNetworkAccessManager>
+#include <QNetworkRequest>
+#include <QPointer>
+#include <QVariantList>
+
+class QueuedNetworkReply;
+
+/**
+ * Process-wide network access manager shared by every provider and
+ * subscription tool backend.
+ *
+ * One manager means one connection pool, one DNS cache and one TLS session
+ * cache, so keep-alive connections, HTTP/2 multiplexing (negotiated via ALPN
+ * on HTTPS endpoints that offer it) and TLS session resumption carry over
+ * between backends and refresh cycles.
+ *
+ * Requests beyond `maxConcurrentRequests` are queued and started in FIFO
+ * order as earlier ones finish. A queued request is returned to the caller
+ * as a proxy reply that behaves like a normal QNetworkReply: abort(),
+ * deleteLater(), readAll() and the usual signals all work whether or not
+ * the real request has started yet.
+ *
+ * Retries draw on a process-wide token bucket (acquireRetryToken()) that
+ * holds `retryBudget` tokens and refills at `retryBudget` tokens per
+ * minute, so an outage that fails every backend at once cannot turn into a
+ * retry storm: once the bucket is empty, failures are reported instead of
+ * retried until it refills.
+ *
+ * Usage from QML:
+ *   NetworkStats.hostStatistics()   // [{ host, requests, failures, ... }]
+ *   NetworkStats.inFlight / NetworkStats.queued
+ */
+class SharedNetworkManager : public QNetworkAccessManager
+{
+    Q_OBJECT
+    Q_PROPERTY(int maxConcurrentRequests READ maxConcurrentRequests WRITE setMaxConcurrentRequests NOTIFY maxConcurrentRequestsChanged)
+    Q_PROPERTY(int inFlight READ inFlight NOTIFY statisticsChanged)
+    Q_PROPERTY(int queued READ queued NOTIFY statisticsChanged)
+    Q_PROPERTY(int retryBudget READ retryBudget WRITE setRetryBudget NOTIFY retryBudgetChanged)
+    Q_PROPERTY(int retryTokens READ retryTokens NOTIFY statisticsChanged)
+    Q_PROPERTY(int retriesGranted READ retriesGranted NOTIFY statisticsChanged)
+    Q_PROPERTY(int retriesDenied READ retriesDenied NOTIFY statisticsChanged)
+
+public:
+    explicit SharedNetworkManager(QObject *parent = nullptr);
+    ~SharedNetworkManager() override;
+
+    /// The process-wide instance, created on first use and owned by the application.
+    static SharedNetworkManager *instance();
+
+    int maxConcurrentRequests() const;
+    void setMaxConcurrentRequests(int limit);
+
+    int inFlight() const;
+    int queued() const;
+
+    int retryBudget() const;
+    void setRetryBudget(int tokens);
+    int retryTokens() const;
+    int retriesGranted() const;
+    int retriesDenied() const;
+
+    /// Take one token from the retry budget. False means the caller should
+    /// give up on the request instead of retrying it.
+    bool acquireRetryToken();
+
+    /**
+     * One entry per host (sorted by host):
+     * { host, requests, failures, canceled, inFlight, http2, encrypted,
+     *   bytesReceived, avgLatencyMs, maxLatencyMs, avgQueueMs, lastStatus,
+     *   lastError }.
+     * `http2` and `encrypted` count finished requests that used HTTP/2 or TLS.
+     */
+    Q_INVOKABLE QVariantList hostStatistics() const;
+    Q_INVOKABLE void resetStatistics();
+
+Q_SIGNALS:
+    void maxConcurrentRequestsChanged();
+    void retryBudgetChanged();
+    void statisticsChanged();
+
+protected:
+    QNetworkReply *createRequest(Operation op, const QNetworkRequest &request,
+                                 QIODevice *outgoingData = nullptr) override;
+
+private:
+    struct HostStats {
+        qint64 requests = 0;
+        qint64 failures = 0;
+        qint64 canceled = 0;
+        qint64 http2 = 0;
+        qint64 encrypted = 0;
+        qint64 bytesReceived = 0;
+        qint64 totalLatencyMs = 0;
+        qint64 maxLatencyMs = 0;
+        qint64 totalQueueMs = 0;
+        int inFlight = 0;
+        int lastStatus = 0;
+        QString lastError;
+    };
+
+    struct PendingRequest {
+        Operation op = GetOperation;
+        QNetworkRequest request;
+        QByteArray body;
+        bool hasBody = false;
+        QElapsedTimer queuedFor;
+        QPointer<QueuedNetworkReply> proxy;
+    };
+
+    static QString hostKey(const QUrl &url);
+    static QNetworkRequest prepareRequest(const QNetworkRequest &request);
+
+    QNetworkReply *startRequest(Operation op, const QNetworkRequest &request,
+                                QIODevice *outgoingData, qint64 queueMs);
+    /// `reply` is null when the reply was destroyed before it finished.
+    void onRequestDone(const QString &host, QNetworkReply *reply, qint64 latencyMs, qint64 bytesReceived);
+    void startQueued();
+    void dropQueued(QueuedNetworkReply *proxy);
+
+    int m_maxConcurrent = DEFAULT_MAX_CONCURRENT;
+    int m_inFlight = 0;
+    QList<PendingRequest> m_pending;
+    QHash<QString, HostStats> m_hostStats;
+
+    // Retry token bucket; refilled lazily from the time since the last refill
+    double availableRetryTokens() const;
+
+    int m_retryBudget = DEFAULT_RETRY_BUDGET;
+    double m_retryTokens = DEFAULT_RETRY_BUDGET;
+    QElapsedTimer m_retryRefill;
+    int m_retriesGranted = 0;
+    int m_retriesDenied = 0;
+
+    static constexpr int DEFAULT_MAX_CONCURRENT = 8;
+    static constexpr int MAX_CONCURRENT_LIMIT = 64;
+    static constexpr int DEFAULT_RETRY_BUDGET = 20; // tokens, and tokens per minute
+    static constexpr qint64 RETRY_REFILL_WINDOW_MS = 60000;
+
+    friend class QueuedNetworkReply;
+};
+
+#endif // SHAREDNETWORKMANAGER_H
@@ -0,0 +1,95 @@
+#include "snapshotcursor.h"
+#include "costmicros.h"
+#include "usagedatabase.h"
+#include "usagedatabasesql.h"
+
+#include <QDebug>
+#include <QSqlError>
+#include <QSqlQuery>
+#include <QVariantMap>
+
+SnapshotCursor::SnapshotCursor(const UsageDatabase *database,
+                               const QString &provider,
+                               const QDateTime &from,
+                               const QDateTime &to,
+                               int pageSize,
+                               QObject *parent)
+    : QObject(parent)
+    , m_database(database)
+    , m_provider(provider)
+    , m_to(to.toUTC().toString(QStringLiteral("yyyy-MM-dd HH:mm:ss")))
+    , m_lastTimestamp(from.toUTC().toString(QStringLiteral("yyyy-MM-dd HH:mm:ss")))
+    , m_pageSize(qBound(1, pageSize > 0 ? pageSize : DEFAULT_PAGE_SIZE, MAX_PAGE_SIZE))
+{
+    m_atEnd = !m_database || !m_database->m_initialized;
+}
+
+bool SnapshotCursor::atEnd() const { return m_atEnd; }
+int SnapshotCursor::pageSize() const { return m_pageSize; }
+qint64 SnapshotCursor::rowsRead() const { return m_rowsRead; }
+
+QVariantList SnapshotCursor::nextPage()
+{
+    QVariantList results;
+
+    if (m_atEnd)
+        return results;
+
+    if (!m_database || !m_database->m_initialized) {
+        m_atEnd = true;
+        Q_EMIT pageRead();
+        return results;
+    }
+
+    // The starting key is (from, -1), so the first page includes rows at
+    // exactly `from`. The redundant `timestamp >= ?` keeps the scan on the
+    // idx_snapshots_covering range, whose (timestamp, id) prefix already
+    // matches the ORDER BY, so no sort step is needed.
+    QSqlQuery query(m_database->m_db);
+    query.setForwardOnly(true);
+    query.prepare(UsageDatabaseSql::snapshotPage());
+    query.addBindValue(m_provider);
+    query.addBindValue(m_lastTimestamp);
+    query.addBindValue(m_to);
+    query.addBindValue(m_lastTimestamp);
+    query.addBindValue(m_lastId);
+    query.addBindValue(m_pageSize);
+
+    if (!query.exec()) {
+        qWarning() << "SnapshotCursor: page query failed:" << query.lastError().text();
+        m_atEnd = true;
+        Q_EMIT pageRead();
+        return results;
+    }
+
+    results.reserve(m_pageSize);
+    while (query.next()) {
+        m_lastId = query.value(0).toLongLong();
+        m_lastTimestamp = query.value(1).toString();
+
+        QVariantMap row;
+        row[QStringLiteral("timestamp")] = m_lastTimestamp;
+        row[QStringLiteral("inputTokens")] = query.value(2).toLongLong();
+        row[QStringLiteral("outputTokens")] = query.value(3).toLongLong();
+        row[QStringLiteral("requestCount")] = query.value(4).toInt();
+        const qint64 costMicros = query.value(5).toLongLong();
+        const qint64 dailyCostMicros = query.value(6).toLongLong();
+        const qint64 monthlyCostMicros = query.value(7).toLongLong();
+        row[QStringLiteral("cost")] = CostMicros::toDollars(costMicros);
+        row[QStringLiteral("dailyCost")] = CostMicros::toDollars(dailyCostMicros);
+        row[QStringLiteral("monthlyCost")] = CostMicros::toDollars(monthlyCostMicros);
+        row[QStringLiteral("costMicros")] = costMicros;
+        row[QStringLiteral("dailyCostMicros")] = dailyCostMicros;
+        row[QStringLiteral("monthlyCostMicros")] = monthlyCostMicros;
+        row[QStringLiteral("rlRequests")] = query.value(8).toInt();
+        row[QStringLiteral("rlRequestsRemaining")] = query.value(9).toInt();
+        row[QStringLiteral("rlTokens")] = query.value(10).toInt();
+        row[QStringLiteral("rlTokensRemaining")] = query.value(11).toInt();
+        results.append(row);
+    }
+
+    m_rowsRead += results.size();
+    m_atEnd = results.size() < m_pageSize;
+    Q_EMIT pageRead();
+    return results;
+}
@@ -0,0 +1,69 @@
+#ifndef SNAPSHOTCURSOR_H
+#define SNAPSHOTCURSOR_H
+
+#include <QObject>
+#include <QDateTime>
+#include <QPointer>
+#include <QString>
+#include <QVariantList>
+
+class UsageDatabase;
+
+/**
+ * Forward-only, keyset-paginated reader over usage_snapshots.
+ *
+ * Each page resumes after the last (timestamp, id) seen instead of using
+ * OFFSET, so every page is a bounded index range scan and memory stays at
+ * one page regardless of how large the time range is.
+ *
+ * Usage from QML:
+ *   var cursor = usageDatabase.openSnapshotCursor("OpenAI", from, to, 500);
+ *   while (!cursor.atEnd) {
+ *       var rows = cursor.nextPage();
+ *       ...
+ *   }
+ */
+class SnapshotCursor : public QObject
+{
+    Q_OBJECT
+    Q_PROPERTY(bool atEnd READ atEnd NOTIFY pageRead)
+    Q_PROPERTY(int pageSize READ pageSize CONSTANT)
+    Q_PROPERTY(qint64 rowsRead READ rowsRead NOTIFY pageRead)
+
+public:
+    SnapshotCursor(const UsageDatabase *database,
+                   const QString &provider,
+                   const QDateTime &from,
+                   const QDateTime &to,
+                   int pageSize,
+                   QObject *parent = nullptr);
+
+    bool atEnd() const;
+    int pageSize() const;
+    qint64 rowsRead() const;
+
+    /**
+     * Fetch the next page of at most pageSize rows, in (timestamp, id) order.
+     * Rows use the same keys as UsageDatabase::getSnapshots(). Returns an
+     * empty list once the cursor is exhausted.
+     */
+    Q_INVOKABLE QVariantList nextPage();
+
+    static constexpr int DEFAULT_PAGE_SIZE = 500;
+    static constexpr int MAX_PAGE_SIZE = 10000;
+
+Q_SIGNALS:
+    void pageRead();
+
+private:
+    QPointer<const UsageDatabase> m_database;
+    QString m_provider;
+    QString m_to;
+    QString m_lastTimestamp;
+    qint64 m_lastId = -1;
+    int m_pageSize;
+    qint64 m_rowsRead = 0;
+    bool m_atEnd = false;
+};
+
+#endif // SNAPSHOTCURSOR_H
@@ -1,4 +1,5 @@
 #include "subscriptiontoolbackend.h"
+#include "sharednetworkmanager.h"
 #include <QDate>
 #include <QDebug>
 #include <QTimeZone>
@@ -386,8 +387,5 @@ void SubscriptionToolBackend::syncFromBrowser(const QString &cookieHeader, int b
 
 QNetworkAccessManager *SubscriptionToolBackend::networkManager()
 {
-    if (m_networkManager == nullptr) {
-        m_networkManager = new QNetworkAccessManager(this);
-    }
-    return m_networkManager;
+    return SharedNetworkManager::instance();
 }
@@ -280,7 +280,6 @@ private:
     QDateTime m_lastSyncTime;
 
     QTimer *m_resetCheckTimer;
-    QNetworkAccessManager *m_networkManager = nullptr;
 };
 
 #endif // SUBSCRIPTIONTOOLBACKEND_H
@@ -0,0 +1,132 @@
+#include "systemstatemonitor.h"
+
+#include <QDBusConnection>
+#include <QDBusMessage>
+#include <QDBusPendingCallWatcher>
+#include <QDBusPendingReply>
+#include <QDBusVariant>
+#include <QDebug>
+#include <QNetworkInformation>
+
+namespace {
+const QString UPOWER_SERVICE = QStringLiteral("org.freedesktop.UPower");
+const QString UPOWER_PATH = QStringLiteral("/org/freedesktop/UPower");
+const QString UPOWER_INTERFACE = QStringLiteral("org.freedesktop.UPower");
+const QString PROPERTIES_INTERFACE = QStringLiteral("org.freedesktop.DBus.Properties");
+const QString ON_BATTERY = QStringLiteral("OnBattery");
+} // namespace
+
+SystemStateMonitor::SystemStateMonitor(QObject *parent)
+    : SystemStateMonitor(Sources::System, parent)
+{
+}
+
+SystemStateMonitor::SystemStateMonitor(Sources sources, QObject *parent)
+    : QObject(parent)
+{
+    if (sources == Sources::System) {
+        watchUPower();
+        watchNetwork();
+    }
+}
+
+// ── Properties ──
+
+bool SystemStateMonitor::onBattery() const { return m_onBattery; }
+bool SystemStateMonitor::isMetered() const { return m_metered; }
+bool SystemStateMonitor::isOnline() const { return m_online; }
+
+double SystemStateMonitor::pollingFactor() const
+{
+    double factor = 1.0;
+    if (m_onBattery)
+        factor *= BATTERY_FACTOR;
+    if (m_metered)
+        factor *= METERED_FACTOR;
+    return factor;
+}
+
+void SystemStateMonitor::setOnBattery(bool onBattery)
+{
+    if (m_onBattery != onBattery) {
+        m_onBattery = onBattery;
+        Q_EMIT stateChanged();
+    }
+}
+
+void SystemStateMonitor::setMetered(bool metered)
+{
+    if (m_metered != metered) {
+        m_metered = metered;
+        Q_EMIT stateChanged();
+    }
+}
+
+void SystemStateMonitor::setOnline(bool online)
+{
+    if (m_online != online) {
+        m_online = online;
+        Q_EMIT stateChanged();
+    }
+}
+
+// ── Sources ──
+
+void SystemStateMonitor::watchUPower()
+{
+    QDBusConnection bus = QDBusConnection::systemBus();
+    if (!bus.isConnected()) {
+        qWarning() << "SystemStateMonitor: system bus unavailable, battery state not tracked";
+        return;
+    }
+
+    bus.connect(UPOWER_SERVICE, UPOWER_PATH, PROPERTIES_INTERFACE, QStringLiteral("PropertiesChanged"),
+                this, SLOT(onUPowerPropertiesChanged(QString, QVariantMap, QStringList)));
+
+    // Initial value, fetched asynchronously so startup never blocks on D-Bus
+    QDBusMessage call = QDBusMessage::createMethodCall(UPOWER_SERVICE, UPOWER_PATH,
+                                                       PROPERTIES_INTERFACE, QStringLiteral("Get"));
+    call << UPOWER_INTERFACE << ON_BATTERY;
+    auto *watcher = new QDBusPendingCallWatcher(bus.asyncCall(call), this);
+    connect(watcher, &QDBusPendingCallWatcher::finished, this, [this](QDBusPendingCallWatcher *w) {
+        const QDBusPendingReply<QDBusVariant> reply = *w;
+        if (!reply.isError())
+            setOnBattery(reply.value().variant().toBool());
+        w->deleteLater();
+    });
+}
+
+void SystemStateMonitor::onUPowerPropertiesChanged(const QString &interface,
+                                                   const QVariantMap &changed,
+                                                   const QStringList &invalidated)
+{
+    Q_UNUSED(invalidated)
+    if (interface != UPOWER_INTERFACE)
+        return;
+
+    const auto it = changed.constFind(ON_BATTERY);
+    if (it != changed.constEnd())
+        setOnBattery(it->toBool());
+}
+
+void SystemStateMonitor::watchNetwork()
+{
+    // On Linux the default backend is NetworkManager, which reports both
+    // reachability and metering
+    if (!QNetworkInformation::loadBackendByFeatures(QNetworkInformation::Feature::Reachability)) {
+        qWarning() << "SystemStateMonitor: no network information backend, reachability not tracked";
+        return;
+    }
+
+    QNetworkInformation *info = QNetworkInformation::instance();
+    const auto applyReachability = [this](QNetworkInformation::Reachability reachability) {
+        setOnline(reachability != QNetworkInformation::Reachability::Disconnected);
+    };
+    applyReachability(info->reachability());
+    connect(info, &QNetworkInformation::reachabilityChanged, this, applyReachability);
+
+    if (info->supports(QNetworkInformation::Feature::Metered)) {
+        setMetered(info->isMetered());
+        connect(info, &QNetworkInformation::isMeteredChanged, this, &SystemStateMonitor::setMetered);
+    }
+}
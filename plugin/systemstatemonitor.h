@@ -0,0 +1,73 @@
+#ifndef SYSTEMSTATEMONITOR_H
+#define SYSTEMSTATEMONITOR_H
+
+#include <QObject>
+#include <QString>
+#include <QStringList>
+#include <QVariantMap>
+
+/**
+ * Tracks whether the machine runs on battery (UPower) and whether the
+ * active connection is metered (NetworkManager, via QNetworkInformation),
+ * and turns both into a polling slowdown factor.
+ *
+ * pollingFactor is 1.0 normally, 2.0 on battery or on a metered
+ * connection, and 4.0 when both apply. RefreshScheduler multiplies every
+ * interval by it.
+ *
+ * `online` follows QNetworkInformation reachability. Only a disconnected
+ * machine counts as offline: local-only and site-only reachability still
+ * reach self-hosted providers, and an unknown state is treated as online.
+ * RefreshScheduler pauses while offline.
+ *
+ * Constructed with Sources::None the monitor watches nothing, and tests
+ * drive it through setOnBattery()/setMetered()/setOnline() exactly as the
+ * D-Bus and network-information handlers do.
+ */
+class SystemStateMonitor : public QObject
+{
+    Q_OBJECT
+    Q_PROPERTY(bool onBattery READ onBattery NOTIFY stateChanged)
+    Q_PROPERTY(bool metered READ isMetered NOTIFY stateChanged)
+    Q_PROPERTY(bool online READ isOnline NOTIFY stateChanged)
+    Q_PROPERTY(double pollingFactor READ pollingFactor NOTIFY stateChanged)
+
+public:
+    enum class Sources {
+        System, // UPower over the system bus, QNetworkInformation for metering and reachability
+        None    // no watchers; state only changes through the setters
+    };
+
+    explicit SystemStateMonitor(QObject *parent = nullptr);
+    explicit SystemStateMonitor(Sources sources, QObject *parent = nullptr);
+
+    bool onBattery() const;
+    bool isMetered() const;
+    bool isOnline() const;
+    double pollingFactor() const;
+
+    void setOnBattery(bool onBattery);
+    void setMetered(bool metered);
+    void setOnline(bool online);
+
+Q_SIGNALS:
+    void stateChanged();
+
+private Q_SLOTS:
+    void onUPowerPropertiesChanged(const QString &interface,
+                                   const QVariantMap &changed,
+                                   const QStringList &invalidated);
+
+private:
+    void watchUPower();
+    void watchNetwork();
+
+    bool m_onBattery = false;
+    bool m_metered = false;
+    bool m_online = true;
+
+    static constexpr double BATTERY_FACTOR = 2.0;
+    static constexpr double METERED_FACTOR = 2.0;
+};
+
+#endif // SYSTEMSTATEMONITOR_H
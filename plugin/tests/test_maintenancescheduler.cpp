@@ -0,0 +1,263 @@
+#include <QtTest>
+
+#include <QDir>
+#include <QTemporaryDir>
+#include <QSignalSpy>
+#include <QSqlDatabase>
+#include <QSqlQuery>
+#include <QStandardPaths>
+#include <QUuid>
+
+#include "costmicros.h"
+#include "maintenancescheduler.h"
+#include "usagedatabase.h"
+
+namespace {
+/**
+ * Insert expired snapshot rows directly, bypassing the write throttle.
+ */
+bool insertExpiredSnapshots(const QString &provider, int count, int ageDays)
+{
+    const QString connName = QStringLiteral("maint_test_%1").arg(QUuid::createUuid().toString(QUuid::WithoutBraces));
+    bool ok = false;
+    {
+        QSqlDatabase db = QSqlDatabase::addDatabase(QStringLiteral("QSQLITE"), connName);
+        db.setDatabaseName(
+            QStandardPaths::writableLocation(QStandardPaths::GenericDataLocation)
+            + QStringLiteral("/plasma-ai-usage-monitor/usage_history.db"));
+        if (db.open()) {
+            const QString timestamp = QDateTime::currentDateTimeUtc().addDays(-ageDays)
+                                          .toString(QStringLiteral("yyyy-MM-dd HH:mm:ss"));
+            db.transaction();
+            QSqlQuery query(db);
+            query.prepare(QStringLiteral(
+                "INSERT INTO usage_snapshots (timestamp, provider, cost_micros) VALUES (?, ?, ?)"));
+            ok = true;
+            for (int i = 0; i < count && ok; ++i) {
+                query.addBindValue(timestamp);
+                query.addBindValue(provider);
+                query.addBindValue(CostMicros::fromDollars(i));
+                ok = query.exec();
+            }
+            ok = db.commit() && ok;
+            db.close();
+        }
+    }
+    QSqlDatabase::removeDatabase(connName);
+    return ok;
+}
+
+/**
+ * Insert expired rate limit events directly.
+ */
+bool insertExpiredRateLimitEvents(const QString &provider, int count, int ageDays)
+{
+    const QString connName = QStringLiteral("maint_test_%1").arg(QUuid::createUuid().toString(QUuid::WithoutBraces));
+    bool ok = false;
+    {
+        QSqlDatabase db = QSqlDatabase::addDatabase(QStringLiteral("QSQLITE"), connName);
+        db.setDatabaseName(
+            QStandardPaths::writableLocation(QStandardPaths::GenericDataLocation)
+            + QStringLiteral("/plasma-ai-usage-monitor/usage_history.db"));
+        if (db.open()) {
+            QSqlQuery query(db);
+            query.prepare(QStringLiteral(
+                "WITH RECURSIVE n(i) AS (SELECT 1 UNION ALL SELECT i + 1 FROM n WHERE i < ?) "
+                "INSERT INTO rate_limit_events (timestamp, provider, event_type) "
+                "SELECT datetime('now', ?), ?, 'warning' FROM n"));
+            query.addBindValue(count);
+            query.addBindValue(QStringLiteral("-%1 days").arg(ageDays));
+            query.addBindValue(provider);
+            ok = query.exec();
+            db.close();
+        }
+    }
+    QSqlDatabase::removeDatabase(connName);
+    return ok;
+}
+
+QVariantMap reportEntry(const QVariantList &report, const QString &task)
+{
+    for (const QVariant &entry : report) {
+        const QVariantMap map = entry.toMap();
+        if (map.value(QStringLiteral("task")).toString() == task)
+            return map;
+    }
+    return {};
+}
+} // namespace
+
+class MaintenanceSchedulerTest : public QObject
+{
+    Q_OBJECT
+
+private Q_SLOTS:
+    void testPassRunsAllTasksAndReports();
+    void testWaitsForIdle();
+    void testPruneSpansMultipleSlices();
+    void testPruneBatchCountsEveryTable();
+    void testLegacyDatabaseIsNotVacuumedInSlices();
+};
+
+void MaintenanceSchedulerTest::testPassRunsAllTasksAndReports()
+{
+    QTemporaryDir tmp;
+    QVERIFY(tmp.isValid());
+    qputenv("XDG_DATA_HOME", tmp.path().toUtf8());
+
+    UsageDatabase db;
+    db.init();
+    db.setRetentionDays(7);
+    db.recordSnapshot(QStringLiteral("Recent"), 100, 50, 10, 1.0, 1.0, 10.0, 0, 0, 0, 0);
+    QVERIFY(insertExpiredSnapshots(QStringLiteral("Old"), 20, 30));
+
+    MaintenanceScheduler scheduler;
+    scheduler.setDatabase(&db);
+    scheduler.setIdle(true);
+
+    QSignalSpy finishedSpy(&scheduler, &MaintenanceScheduler::maintenanceFinished);
+    scheduler.runNow();
+    QVERIFY(scheduler.isRunning());
+    QVERIFY(finishedSpy.wait(5000));
+    QVERIFY(!scheduler.isRunning());
+    QVERIFY(scheduler.lastRun().isValid());
+
+    const QVariantList report = scheduler.lastReport();
+    QCOMPARE(report.size(), 4);
+    QCOMPARE(reportEntry(report, QStringLiteral("prune")).value(QStringLiteral("rows")).toLongLong(), 20);
+    for (const QString &task : {QStringLiteral("optimize"), QStringLiteral("checkpoint"), QStringLiteral("vacuum")}) {
+        const QVariantMap entry = reportEntry(report, task);
+        QVERIFY2(!entry.isEmpty(), qPrintable(task));
+        QVERIFY(entry.value(QStringLiteral("slices")).toInt() >= 1);
+        QVERIFY(entry.value(QStringLiteral("durationMs")).toLongLong() >= 0);
+    }
+
+    const QDateTime from = QDateTime::currentDateTimeUtc().addDays(-60);
+    const QDateTime to = QDateTime::currentDateTimeUtc().addSecs(3600);
+    QCOMPARE(db.getSnapshots(QStringLiteral("Old"), from, to).size(), 0);
+    QCOMPARE(db.getSnapshots(QStringLiteral("Recent"), from, to).size(), 1);
+}
+
+void MaintenanceSchedulerTest::testWaitsForIdle()
+{
+    QTemporaryDir tmp;
+    QVERIFY(tmp.isValid());
+    qputenv("XDG_DATA_HOME", tmp.path().toUtf8());
+
+    UsageDatabase db;
+    db.init();
+
+    MaintenanceScheduler scheduler;
+    scheduler.setDatabase(&db);
+    scheduler.setIdle(false);
+
+    QSignalSpy finishedSpy(&scheduler, &MaintenanceScheduler::maintenanceFinished);
+    scheduler.runNow();
+    QVERIFY(scheduler.isRunning());
+    QVERIFY(!finishedSpy.wait(300));
+
+    scheduler.setIdle(true);
+    QVERIFY(finishedSpy.wait(5000));
+    QCOMPARE(finishedSpy.count(), 1);
+}
+
+void MaintenanceSchedulerTest::testPruneSpansMultipleSlices()
+{
+    QTemporaryDir tmp;
+    QVERIFY(tmp.isValid());
+    qputenv("XDG_DATA_HOME", tmp.path().toUtf8());
+
+    UsageDatabase db;
+    db.init();
+    db.setRetentionDays(1);
+    QVERIFY(insertExpiredSnapshots(QStringLiteral("Bulk"), 2500, 10));
+
+    // Batches are deleted one at a time, so each slice covers at least one batch
+    QCOMPARE(db.pruneOldDataBatch(1000), 1000);
+
+    MaintenanceScheduler scheduler;
+    scheduler.setSliceBudgetMs(1);
+    scheduler.setDatabase(&db);
+    scheduler.setIdle(true);
+
+    QSignalSpy finishedSpy(&scheduler, &MaintenanceScheduler::maintenanceFinished);
+    scheduler.runNow();
+    QVERIFY(finishedSpy.wait(10000));
+
+    const QVariantMap prune = reportEntry(scheduler.lastReport(), QStringLiteral("prune"));
+    QCOMPARE(prune.value(QStringLiteral("rows")).toLongLong(), 1500);
+    QVERIFY(prune.value(QStringLiteral("slices")).toInt() >= 1);
+    QCOMPARE(db.pruneOldDataBatch(1000), 0);
+}
+
+void MaintenanceSchedulerTest::testPruneBatchCountsEveryTable()
+{
+    QTemporaryDir tmp;
+    QVERIFY(tmp.isValid());
+    qputenv("XDG_DATA_HOME", tmp.path().toUtf8());
+
+    UsageDatabase db;
+    db.init();
+    db.setRetentionDays(1);
+    QVERIFY(insertExpiredSnapshots(QStringLiteral("Bulk"), 300, 10));
+    QVERIFY(insertExpiredRateLimitEvents(QStringLiteral("Bulk"), 200, 10));
+
+    // Rows of every table add up; neither table reached the limit
+    bool more = true;
+    QCOMPARE(db.pruneOldDataBatch(1000, &more), 500);
+    QVERIFY(!more);
+
+    // One table at the limit is enough to ask for another batch
+    QVERIFY(insertExpiredSnapshots(QStringLiteral("Bulk"), 150, 10));
+    QVERIFY(insertExpiredRateLimitEvents(QStringLiteral("Bulk"), 50, 10));
+    QCOMPARE(db.pruneOldDataBatch(100, &more), 150);
+    QVERIFY(more);
+    QCOMPARE(db.pruneOldDataBatch(100, &more), 50);
+    QVERIFY(!more);
+}
+
+void MaintenanceSchedulerTest::testLegacyDatabaseIsNotVacuumedInSlices()
+{
+    QTemporaryDir tmp;
+    QVERIFY(tmp.isValid());
+    qputenv("XDG_DATA_HOME", tmp.path().toUtf8());
+
+    // A file created before auto_vacuum was turned on
+    const QString dir = tmp.path() + QStringLiteral("/plasma-ai-usage-monitor");
+    QVERIFY(QDir().mkpath(dir));
+    {
+        QSqlDatabase legacy = QSqlDatabase::addDatabase(QStringLiteral("QSQLITE"), QStringLiteral("legacy"));
+        legacy.setDatabaseName(dir + QStringLiteral("/usage_history.db"));
+        QVERIFY(legacy.open());
+        QSqlQuery query(legacy);
+        QVERIFY(query.exec(QStringLiteral("CREATE TABLE legacy_marker (id INTEGER PRIMARY KEY)")));
+        legacy.close();
+    }
+    QSqlDatabase::removeDatabase(QStringLiteral("legacy"));
+
+    UsageDatabase db;
+    db.init();
+    db.setRetentionDays(1);
+    QVERIFY(insertExpiredSnapshots(QStringLiteral("Bulk"), 2000, 10));
+    QVERIFY(db.needsVacuumConversion());
+
+    MaintenanceScheduler scheduler;
+    scheduler.setDatabase(&db);
+    scheduler.setIdle(true);
+
+    QSignalSpy finishedSpy(&scheduler, &MaintenanceScheduler::maintenanceFinished);
+    scheduler.runNow();
+    QVERIFY(finishedSpy.wait(10000));
+
+    // Pages were freed, but the slice left the full rewrite to the user
+    QCOMPARE(reportEntry(scheduler.lastReport(), QStringLiteral("prune")).value(QStringLiteral("rows")).toLongLong(),
+             2000);
+    QVERIFY(db.needsVacuumConversion());
+    QCOMPARE(db.incrementalVacuum(64), 0);
+
+    QVERIFY(db.convertToIncrementalVacuum());
+    QVERIFY(!db.needsVacuumConversion());
+}
+
+QTEST_MAIN(MaintenanceSchedulerTest)
+#include "test_maintenancescheduler.moc"
@@ -0,0 +1,178 @@
+#include <QtTest>
+
+#include <QDir>
+#include <QFile>
+#include <QJsonDocument>
+#include <QTemporaryDir>
+
+#include "pricingcatalog.h"
+
+class PricingCatalogTest : public QObject
+{
+    Q_OBJECT
+
+private Q_SLOTS:
+    void builtinCoversProviders();
+    void longestPrefixWins();
+    void prefixMatchIgnoresInsertionOrder();
+    void overridesReplaceAndAdd();
+    void cacheRatesFollowProvider();
+    void instanceReadsOverrideFile();
+};
+
+void PricingCatalogTest::builtinCoversProviders()
+{
+    const PricingCatalog catalog = PricingCatalog::builtin();
+    QVERIFY(catalog.size() > 60);
+
+    const PricingCatalog::Price *sonnet = catalog.find(QStringLiteral("Anthropic"), u"claude-3-5-sonnet-20241022");
+    QVERIFY(sonnet);
+    QCOMPARE(sonnet->inputPerMToken, 3.0);
+    QCOMPARE(sonnet->outputPerMToken, 15.0);
+
+    // Undated family prefixes match every release of a model line
+    QCOMPARE(catalog.find(QStringLiteral("Anthropic"), u"claude-sonnet-4-5-20250929")->inputPerMToken, 3.0);
+    QCOMPARE(catalog.find(QStringLiteral("Anthropic"), u"claude-opus-4-1-20250805")->outputPerMToken, 75.0);
+    QCOMPARE(catalog.find(QStringLiteral("Anthropic"), u"claude-opus-4-5")->inputPerMToken, 5.0);
+
+    // OpenAI itself has list prices for proxied requests, with per-model cache rates
+    const PricingCatalog::Price *gpt41 = catalog.find(QStringLiteral("OpenAI"), u"gpt-4.1-2025-04-14");
+    QVERIFY(gpt41);
+    QCOMPARE(gpt41->inputPerMToken, 2.00);
+    QCOMPARE(gpt41->cacheReadPerMToken, 0.50);
+    QCOMPARE(catalog.find(QStringLiteral("OpenAI"), u"gpt-4o-mini")->cacheReadPerMToken, 0.075);
+
+    // Prices are per provider: the same name elsewhere is not a match
+    QVERIFY(!catalog.find(QStringLiteral("OpenRouter"), u"gpt-4o"));
+    QVERIFY(!catalog.find(QStringLiteral("Unknown"), u"gpt-4o"));
+    QVERIFY(!catalog.find(QStringLiteral("Azure OpenAI"), u"text-embedding-3-small"));
+    QVERIFY(!catalog.find(QStringLiteral("Azure OpenAI"), u""));
+}
+
+void PricingCatalogTest::longestPrefixWins()
+{
+    const PricingCatalog catalog = PricingCatalog::builtin();
+
+    // "gpt-4o" is also a prefix, but the mini entry is longer
+    const PricingCatalog::Price *mini = catalog.find(QStringLiteral("Azure OpenAI"), u"gpt-4o-mini-2024-07-18");
+    QVERIFY(mini);
+    QCOMPARE(mini->inputPerMToken, 0.15);
+
+    const PricingCatalog::Price *full = catalog.find(QStringLiteral("Azure OpenAI"), u"gpt-4o-2024-08-06");
+    QVERIFY(full);
+    QCOMPARE(full->inputPerMToken, 2.50);
+
+    // "command", "command-r" and "command-r-plus" all prefix this one
+    const PricingCatalog::Price *plus = catalog.find(QStringLiteral("Cohere"), u"command-r-plus-04-2024");
+    QVERIFY(plus);
+    QCOMPARE(plus->inputPerMToken, 3.00);
+
+    // "command-r-plus-08-2024" sorts between "command-r" and this model
+    const PricingCatalog::Price *r = catalog.find(QStringLiteral("Cohere"), u"command-r7b-12-2024");
+    QVERIFY(r);
+    QCOMPARE(r->inputPerMToken, 0.50);
+
+    // "-latest" aliases resolve to their base entry
+    const PricingCatalog::Price *large = catalog.find(QStringLiteral("Mistral AI"), u"mistral-large-latest");
+    QVERIFY(large);
+    QCOMPARE(large->outputPerMToken, 6.0);
+}
+
+void PricingCatalogTest::prefixMatchIgnoresInsertionOrder()
+{
+    const QStringList models{QStringLiteral("a"), QStringLiteral("ab"), QStringLiteral("ab-x"),
+                             QStringLiteral("abc"), QStringLiteral("b")};
+
+    PricingCatalog forward;
+    PricingCatalog backward;
+    for (int i = 0; i < models.size(); ++i) {
+        forward.insert(QStringLiteral("P"), models.at(i), {double(i), 0.0});
+        backward.insert(QStringLiteral("P"), models.at(models.size() - 1 - i), {double(models.size() - 1 - i), 0.0});
+    }
+
+    for (const PricingCatalog &catalog : {forward, backward}) {
+        QCOMPARE(catalog.find(QStringLiteral("P"), u"ab-y")->inputPerMToken, 1.0); // "ab"
+        QCOMPARE(catalog.find(QStringLiteral("P"), u"abcd")->inputPerMToken, 3.0); // "abc"
+        QCOMPARE(catalog.find(QStringLiteral("P"), u"ab-x")->inputPerMToken, 2.0); // exact
+        QCOMPARE(catalog.find(QStringLiteral("P"), u"a")->inputPerMToken, 0.0);
+        QVERIFY(!catalog.find(QStringLiteral("P"), u"Ab"));
+    }
+}
+
+void PricingCatalogTest::overridesReplaceAndAdd()
+{
+    PricingCatalog catalog = PricingCatalog::builtin();
+    const int builtinSize = catalog.size();
+
+    const QJsonObject overrides = QJsonDocument::fromJson(R"JSON({
+        "Groq": {
+            "llama-3.1-8b-instant": {"input": 0.04, "output": 0.07},
+            "llama-4-scout": {"input": 0.11, "output": 0.34},
+            "broken": {"input": "cheap"}
+        },
+        "Local": {"qwen3": {"input": 0, "output": 0}}
+    })JSON").object();
+
+    QCOMPARE(catalog.applyOverrides(overrides), 3);
+    QCOMPARE(catalog.size(), builtinSize + 2);
+    QCOMPARE(catalog.find(QStringLiteral("Groq"), u"llama-3.1-8b-instant")->inputPerMToken, 0.04);
+    QCOMPARE(catalog.find(QStringLiteral("Groq"), u"llama-4-scout-17b")->outputPerMToken, 0.34);
+    QVERIFY(catalog.find(QStringLiteral("Local"), u"qwen3:8b"));
+    QVERIFY(!catalog.find(QStringLiteral("Groq"), u"broken"));
+}
+
+void PricingCatalogTest::cacheRatesFollowProvider()
+{
+    PricingCatalog catalog = PricingCatalog::builtin();
+
+    const PricingCatalog::Price *sonnet = catalog.find(QStringLiteral("Anthropic"), u"claude-sonnet-4-20250514");
+    QVERIFY(sonnet);
+    QCOMPARE(sonnet->cacheReadPerMToken, 0.30);
+    QCOMPARE(sonnet->cacheWritePerMToken, 3.75);
+
+    const PricingCatalog::Price *gpt = catalog.find(QStringLiteral("Azure OpenAI"), u"gpt-4o-2024-08-06");
+    QVERIFY(gpt);
+    QCOMPARE(gpt->cacheReadPerMToken, 1.25);
+    QCOMPARE(gpt->cacheWritePerMToken, 2.50);
+
+    // No prompt caching: cached tokens cost the same as any other input
+    const PricingCatalog::Price *llama = catalog.find(QStringLiteral("Groq"), u"llama-3.3-70b-versatile");
+    QVERIFY(llama);
+    QCOMPARE(llama->cacheReadPerMToken, llama->inputPerMToken);
+
+    // Overrides may set cache rates; otherwise they follow the new input rate
+    const QJsonObject overrides = QJsonDocument::fromJson(R"JSON({
+        "Anthropic": {
+            "claude-opus-4": {"input": 10.0, "output": 50.0},
+            "claude-haiku-4": {"input": 1.0, "output": 5.0, "cache_read": 0.08, "cache_write": 1.0}
+        }
+    })JSON").object();
+    QCOMPARE(catalog.applyOverrides(overrides), 2);
+    QCOMPARE(catalog.find(QStringLiteral("Anthropic"), u"claude-opus-4-1")->cacheReadPerMToken, 1.0);
+    QCOMPARE(catalog.find(QStringLiteral("Anthropic"), u"claude-opus-4-1")->cacheWritePerMToken, 12.5);
+    QCOMPARE(catalog.find(QStringLiteral("Anthropic"), u"claude-haiku-4-5")->cacheReadPerMToken, 0.08);
+    QCOMPARE(catalog.find(QStringLiteral("Anthropic"), u"claude-haiku-4-5")->cacheWritePerMToken, 1.0);
+}
+
+void PricingCatalogTest::instanceReadsOverrideFile()
+{
+    QTemporaryDir tmp;
+    QVERIFY(tmp.isValid());
+    qputenv("XDG_DATA_HOME", tmp.path().toUtf8());
+
+    QVERIFY(QDir().mkpath(tmp.path() + QStringLiteral("/plasma-ai-usage-monitor")));
+    QFile file(PricingCatalog::overridePath());
+    QVERIFY(file.open(QIODevice::WriteOnly));
+    file.write(R"JSON({"xAI": {"grok-3": {"input": 2.5, "output": 12.5}}})JSON");
+    file.close();
+
+    const PricingCatalog &catalog = PricingCatalog::instance();
+    QCOMPARE(catalog.find(QStringLiteral("xAI"), u"grok-3-latest")->inputPerMToken, 2.5);
+    QCOMPARE(catalog.find(QStringLiteral("xAI"), u"grok-3-mini")->inputPerMToken, 0.30);
+
+    // Built once per process
+    QCOMPARE(&PricingCatalog::instance(), &catalog);
+}
+
+QTEST_MAIN(PricingCatalogTest)
+#include "test_pricingcatalog.moc"
@@ -30,6 +30,7 @@ public:
     using ProviderBackend::setCost;
     using ProviderBackend::setDailyCost;
     using ProviderBackend::setMonthlyCost;
+    using ProviderBackend::setCostMicros;
     using ProviderBackend::effectiveBaseUrl;
     using ProviderBackend::beginRefresh;
     using ProviderBackend::isCurrentGeneration;
@@ -37,6 +38,34 @@ public:
     using ProviderBackend::updateEstimatedCost;
     using ProviderBackend::checkBudgetLimits;
     using ProviderBackend::isRetryableStatus;
+    using ProviderBackend::setRateLimitRequests;
+    using ProviderBackend::setRateLimitRequestsRemaining;
+};
+
+/**
+ * Provider whose refresh stays running until finish(), for single-flight tests.
+ */
+class SingleFlightProvider : public ProviderBackend
+{
+    Q_OBJECT
+public:
+    explicit SingleFlightProvider(QObject *parent = nullptr)
+        : ProviderBackend(parent)
+    {}
+
+    QString name() const override { return QStringLiteral("SingleFlight"); }
+    QString iconName() const override { return QStringLiteral("test-icon"); }
+    void refresh() override
+    {
+        if (!beginRefresh())
+            return;
+        ++starts;
+        setLoading(true);
+    }
+
+    void finish() { setLoading(false); }
+
+    int starts = 0;
 };
 
 class ProviderBackendTest : public QObject
@@ -48,11 +77,14 @@ private Q_SLOTS:
     void testProviderKeyEnumConversionAzureAliases();
     void testProviderConfigFallbackUnknownDeterministic();
     void testGoogleVeoNormalizationUsesOpenAiLikeUsage();
+    void testOpenAiNormalizationReadsResponsesUsage();
+    void testAnthropicNormalizationCountsCacheTokens();
     void testExistingProviderMappingsUnchanged();
     void testBudgetWarningSignal();
     void testBudgetExceededSignal();
     void testBudgetDedupFlags();
     void testMonthlyBudgetSignals();
+    void testBudgetWarningExactThreshold();
     void testCostEstimation();
     void testCostEstimationPrefixMatch();
     void testGenerationCounter();
@@ -65,6 +97,13 @@ private Q_SLOTS:
     void testEffectiveBaseUrl();
     void testEffectiveBaseUrlTrailingSlash();
     void testTotalTokens();
+    void testCadenceBacksOffWhileUnchanged();
+    void testCadenceTightensNearBudget();
+    void testCadenceTightensOnLowRateLimitHeadroom();
+    void testCadenceDisabled();
+    void testRefreshCoalescesWhileRunning();
+    void testRefreshAgainWhenDone();
+    void testConfigChangeAbortsRefresh();
 };
 
 void ProviderBackendTest::testBudgetWarningSignal()
@@ -159,6 +198,53 @@ void ProviderBackendTest::testGoogleVeoNormalizationUsesOpenAiLikeUsage()
     QCOMPARE(normalized.cost, 0.0);
 }
 
+void ProviderBackendTest::testOpenAiNormalizationReadsResponsesUsage()
+{
+    QJsonObject usage;
+    usage.insert(QStringLiteral("input_tokens"), 40);
+    usage.insert(QStringLiteral("input_tokens_details"), QJsonObject{{QStringLiteral("cached_tokens"), 32}});
+    usage.insert(QStringLiteral("output_tokens"), 9);
+    usage.insert(QStringLiteral("total_tokens"), 49);
+
+    QJsonObject payload;
+    payload.insert(QStringLiteral("usage"), usage);
+
+    const ProviderBackend::NormalizedUsageCost normalized =
+        ProviderBackend::normalizeUsageCost(ProviderBackend::ProviderId::OpenAI, payload);
+
+    QVERIFY(normalized.parsed);
+    QCOMPARE(normalized.inputTokens, 40);
+    QCOMPARE(normalized.outputTokens, 9);
+    QCOMPARE(normalized.cacheReadTokens, 32);
+    QCOMPARE(normalized.cacheWriteTokens, 0);
+    QCOMPARE(normalized.requestCount, 1);
+}
+
+void ProviderBackendTest::testAnthropicNormalizationCountsCacheTokens()
+{
+    QJsonObject usage;
+    usage.insert(QStringLiteral("input_tokens"), 10);
+    usage.insert(QStringLiteral("cache_creation_input_tokens"), 200);
+    usage.insert(QStringLiteral("cache_read_input_tokens"), 3000);
+    usage.insert(QStringLiteral("output_tokens"), 55);
+
+    QJsonObject payload;
+    payload.insert(QStringLiteral("usage"), usage);
+
+    const ProviderBackend::NormalizedUsageCost normalized =
+        ProviderBackend::normalizeUsageCost(ProviderBackend::ProviderId::Anthropic, payload);
+
+    QVERIFY(normalized.parsed);
+    QCOMPARE(normalized.inputTokens, 3210);
+    QCOMPARE(normalized.cacheWriteTokens, 200);
+    QCOMPARE(normalized.cacheReadTokens, 3000);
+    QCOMPARE(normalized.outputTokens, 55);
+    QCOMPARE(normalized.requestCount, 1);
+    QCOMPARE(normalized.cost, 0.0);
+
+    QVERIFY(!ProviderBackend::normalizeUsageCost(ProviderBackend::ProviderId::Anthropic, QJsonObject{}).parsed);
+}
+
 void ProviderBackendTest::testExistingProviderMappingsUnchanged()
 {
     QCOMPARE(ProviderBackend::providerIdFromKey(QStringLiteral("openai")),
@@ -227,6 +313,30 @@ void ProviderBackendTest::testMonthlyBudgetSignals()
     QCOMPARE(exceededSpy.first().at(1).toString(), QStringLiteral("monthly"));
 }
 
+void ProviderBackendTest::testBudgetWarningExactThreshold()
+{
+    TestProvider p;
+    // 0.11 * 0.8 evaluates to 0.08800000000000001 in doubles; the
+    // micro-dollar comparison must still treat $0.088 as exactly 80%.
+    p.setDailyBudget(0.11);
+    p.setBudgetWarningPercent(80);
+
+    QSignalSpy warningSpy(&p, &ProviderBackend::budgetWarning);
+
+    p.setDailyCost(0.087999);
+    QCOMPARE(warningSpy.count(), 0);
+
+    p.setDailyCost(0.088);
+    QCOMPARE(warningSpy.count(), 1);
+    QCOMPARE(p.dailyCostMicros(), 88000);
+
+    // Costs round to whole micro-dollars at the boundary
+    p.setCostMicros(300000);
+    QCOMPARE(p.cost(), 0.3);
+    p.setCost(0.1 + 0.2);
+    QCOMPARE(p.costMicros(), 300000);
+}
+
 void ProviderBackendTest::testCostEstimation()
 {
     TestProvider p;
@@ -240,6 +350,7 @@ void ProviderBackendTest::testCostEstimation()
 
     // Expected: (1M/1M)*3 + (0.5M/1M)*15 = 3.0 + 7.5 = 10.5
     QVERIFY(qAbs(p.cost() - 10.5) < 0.01);
+    QCOMPARE(p.costMicros(), 10500000);
     QVERIFY(p.isEstimatedCost());
 }
 
@@ -403,5 +514,155 @@ void ProviderBackendTest::testTotalTokens()
     QCOMPARE(p.totalTokens(), 150);
 }
 
+void ProviderBackendTest::testCadenceBacksOffWhileUnchanged()
+{
+    TestProvider p;
+    QSignalSpy cadenceSpy(&p, &ProviderBackend::cadenceChanged);
+
+    p.setInputTokens(100);
+    Q_EMIT p.dataUpdated();
+    QCOMPARE(p.cadenceFactor(), 1.0);
+
+    // Each update without a change doubles the interval, capped at 8x
+    const double expected[] = {2.0, 4.0, 8.0, 8.0};
+    for (double factor : expected) {
+        Q_EMIT p.dataUpdated();
+        QCOMPARE(p.cadenceFactor(), factor);
+    }
+    QCOMPARE(cadenceSpy.count(), 3);
+    QCOMPARE(p.adaptiveIntervalMs(60000), qint64(480000));
+
+    // Any change snaps back to the configured interval
+    p.setInputTokens(101);
+    Q_EMIT p.dataUpdated();
+    QCOMPARE(p.cadenceFactor(), 1.0);
+    QCOMPARE(p.adaptiveIntervalMs(60000), qint64(60000));
+}
+
+void ProviderBackendTest::testCadenceTightensNearBudget()
+{
+    TestProvider p;
+    p.setDailyBudget(10.0);
+
+    p.setDailyCost(7.5);
+    Q_EMIT p.dataUpdated();
+    QCOMPARE(p.cadenceFactor(), 0.5);
+
+    // Unchanged data does not back off while close to the budget
+    p.setDailyCost(9.0);
+    Q_EMIT p.dataUpdated();
+    Q_EMIT p.dataUpdated();
+    QCOMPARE(p.cadenceFactor(), 0.25);
+    QCOMPARE(p.adaptiveIntervalMs(300000), qint64(75000));
+
+    // Tightening never goes below 30 s
+    QCOMPARE(p.adaptiveIntervalMs(60000), qint64(30000));
+    QCOMPARE(p.adaptiveIntervalMs(20000), qint64(20000));
+
+    // Raising the budget relaxes the cadence without waiting for new data
+    p.setDailyBudget(100.0);
+    QCOMPARE(p.cadenceFactor(), 2.0);
+}
+
+void ProviderBackendTest::testCadenceTightensOnLowRateLimitHeadroom()
+{
+    TestProvider p;
+    p.setRateLimitRequests(100);
+    p.setRateLimitRequestsRemaining(20);
+    Q_EMIT p.dataUpdated();
+    QCOMPARE(p.cadenceFactor(), 0.5);
+
+    p.setRateLimitRequestsRemaining(5);
+    Q_EMIT p.dataUpdated();
+    QCOMPARE(p.cadenceFactor(), 0.25);
+}
+
+void ProviderBackendTest::testCadenceDisabled()
+{
+    TestProvider p;
+    Q_EMIT p.dataUpdated();
+    Q_EMIT p.dataUpdated();
+    QCOMPARE(p.cadenceFactor(), 2.0);
+
+    QSignalSpy cadenceSpy(&p, &ProviderBackend::cadenceChanged);
+    p.setAdaptiveCadence(false);
+    QCOMPARE(cadenceSpy.count(), 1);
+    QCOMPARE(p.cadenceFactor(), 1.0);
+    QCOMPARE(p.adaptiveIntervalMs(60000), qint64(60000));
+}
+
+void ProviderBackendTest::testRefreshCoalescesWhileRunning()
+{
+    SingleFlightProvider p;
+    p.refresh();
+    QCOMPARE(p.starts, 1);
+    const int generation = p.currentGeneration();
+
+    // Overlapping requests attach to the running cycle
+    QSignalSpy statsSpy(&p, &ProviderBackend::refreshStatsChanged);
+    p.refresh();
+    p.requestRefresh();
+    QCOMPARE(p.starts, 1);
+    QCOMPARE(p.currentGeneration(), generation);
+    QCOMPARE(p.coalescedRefreshes(), 2);
+    QCOMPARE(statsSpy.count(), 2);
+    QVERIFY(!p.refreshQueued());
+
+    // Nothing was queued, so finishing does not start another cycle
+    p.finish();
+    QTest::qWait(20);
+    QCOMPARE(p.starts, 1);
+
+    p.requestRefresh();
+    QCOMPARE(p.starts, 2);
+    QCOMPARE(p.currentGeneration(), generation + 1);
+}
+
+void ProviderBackendTest::testRefreshAgainWhenDone()
+{
+    SingleFlightProvider p;
+    p.refresh();
+
+    p.requestRefresh(true);
+    p.requestRefresh(true);
+    QVERIFY(p.refreshQueued());
+    QCOMPARE(p.coalescedRefreshes(), 2);
+
+    // One follow-up cycle however many requests asked for it
+    p.finish();
+    QTRY_COMPARE(p.starts, 2);
+    QVERIFY(p.isLoading());
+    QVERIFY(!p.refreshQueued());
+
+    p.finish();
+    QTest::qWait(20);
+    QCOMPARE(p.starts, 2);
+}
+
+void ProviderBackendTest::testConfigChangeAbortsRefresh()
+{
+    SingleFlightProvider p;
+    p.setApiKey(QStringLiteral("old-key"));
+    p.refresh();
+    p.requestRefresh(true);
+    const int generation = p.currentGeneration();
+
+    // Answers in flight belong to the old key: drop them and the queue
+    p.setApiKey(QStringLiteral("new-key"));
+    QVERIFY(!p.isLoading());
+    QVERIFY(!p.refreshQueued());
+    QVERIFY(!p.isCurrentGeneration(generation));
+    QTest::qWait(20);
+    QCOMPARE(p.starts, 1);
+
+    // Re-setting the same key is not a change
+    p.refresh();
+    p.setApiKey(QStringLiteral("new-key"));
+    QVERIFY(p.isLoading());
+
+    p.setCustomBaseUrl(QStringLiteral("http://127.0.0.1:1"));
+    QVERIFY(!p.isLoading());
+}
+
 QTEST_MAIN(ProviderBackendTest)
 #include "test_providerbackend.moc"
@@ -1,13 +1,21 @@
 #include <QtTest>
 
+#include <QElapsedTimer>
 #include <QHash>
 #include <QSignalSpy>
 #include <QHostAddress>
+#include <QNetworkAccessManager>
+#include <QNetworkReply>
 #include <QTcpServer>
 #include <QTcpSocket>
+#include <QTemporaryDir>
 #include <QUrl>
+#include <QUrlQuery>
 #include <QJsonObject>
 
+#include <algorithm>
+#include <memory>
+
 #include "anthropicprovider.h"
 #include "cohereprovider.h"
 #include "deepseekprovider.h"
@@ -16,8 +24,11 @@
 #include "loofiserverprovider.h"
 #include "openaiprovider.h"
 #include "openrouterprovider.h"
+#include "provideraccountgroup.h"
 #include "providerbackend.h"
 #include "togetherprovider.h"
+#include "usagedatabase.h"
+#include "usageproxy.h"
 
 class HttpStubServer : public QObject
 {
@@ -60,9 +71,34 @@ public:
 
                     m_hitCount[path] = m_hitCount.value(path) + 1;
 
-                    const QString key = method + QStringLiteral(" ") + path;
+                    QHash<QByteArray, QByteArray> requestHeaders;
+                    for (qsizetype i = 1; i < lines.size(); ++i) {
+                        const QByteArray line = lines.at(i).trimmed();
+                        const qsizetype colon = line.indexOf(':');
+                        if (line.isEmpty()) break;
+                        if (colon > 0)
+                            requestHeaders.insert(line.left(colon).toLower(), line.mid(colon + 1).trimmed());
+                    }
+                    m_lastHeaders[path] = requestHeaders;
+                    m_lastQueries[path] = QUrlQuery(QUrl(rawTarget));
+
+                    // Cursor pages can have their own route ("?page=<cursor>")
+                    QString key = method + QStringLiteral(" ") + path;
+                    const QString page = QUrlQuery(QUrl(rawTarget)).queryItemValue(QStringLiteral("page"));
+                    if (!page.isEmpty() && m_routes.contains(key + QStringLiteral("?page=") + page))
+                        key += QStringLiteral("?page=") + page;
                     Response response = m_routes.value(key, Response{404, "{\"error\":\"not found\"}", {}});
 
+                    // Conditional GET: a matching validator gets an empty 304
+                    const QByteArray etag = m_etags.value(path);
+                    if (!etag.isEmpty()) {
+                        if (requestHeaders.value("if-none-match") == etag) {
+                            response = Response{304, QByteArray(), {}};
+                            m_notModifiedCount[path] = m_notModifiedCount.value(path) + 1;
+                        }
+                        response.headers.append({"ETag", etag});
+                    }
+
                     QByteArray payload;
                     payload += "HTTP/1.1 " + QByteArray::number(response.status) + " OK\r\n";
                     payload += "Content-Type: application/json\r\n";
@@ -73,6 +109,15 @@ public:
                     payload += "Connection: close\r\n\r\n";
                     payload += response.body;
 
+                    const int delayMs = m_delays.value(path).value(m_hitCount.value(path) - 1, 0);
+                    if (delayMs > 0) {
+                        QTimer::singleShot(delayMs, socket, [socket, payload]() {
+                            socket->write(payload);
+                            socket->disconnectFromHost();
+                        });
+                        return;
+                    }
+
                     socket->write(payload);
                     socket->disconnectFromHost();
                 });
@@ -101,16 +146,47 @@ public:
         m_routes.insert(method + QStringLiteral(" ") + path, Response{status, body, headers});
     }
 
+    /// Hold the answer to the n-th request for path back by delaysMs[n - 1].
+    void setResponseDelays(const QString &path, const QList<int> &delaysMs)
+    {
+        m_delays.insert(path, delaysMs);
+    }
+
     int hitCount(const QString &path) const
     {
         return m_hitCount.value(path, 0);
     }
 
+    void setEtag(const QString &path, const QByteArray &etag)
+    {
+        m_etags.insert(path, etag);
+    }
+
+    int notModifiedCount(const QString &path) const
+    {
+        return m_notModifiedCount.value(path, 0);
+    }
+
+    QByteArray lastRequestHeader(const QString &path, const QByteArray &name) const
+    {
+        return m_lastHeaders.value(path).value(name.toLower());
+    }
+
+    QString lastRequestQueryItem(const QString &path, const QString &item) const
+    {
+        return m_lastQueries.value(path).queryItemValue(item);
+    }
+
 private:
     QTcpServer m_server;
     QHash<QTcpSocket *, QByteArray> m_buffers;
     QHash<QString, Response> m_routes;
     QHash<QString, int> m_hitCount;
+    QHash<QString, QByteArray> m_etags;
+    QHash<QString, int> m_notModifiedCount;
+    QHash<QString, QList<int>> m_delays;
+    QHash<QString, QHash<QByteArray, QByteArray>> m_lastHeaders;
+    QHash<QString, QUrlQuery> m_lastQueries;
 };
 
 class ProvidersMockedHttpTest : public QObject
@@ -122,14 +198,32 @@ private Q_SLOTS:
     void openAiAuthError();
     void anthropicRateLimitHeaders();
     void deepSeekUsageAndBalance();
+    void deepSeekBalanceHonoursEndpointTtl();
     void googleVeoKnownLimitsByTier();
+    void googleVeoModelInfoTtlAndExplicitRefresh();
     void googleVeoUsesHeaderLimitsWhenPresent();
     void googleVeoPartialHeadersFallbackToKnownLimits();
     void googleVeoUsagePayloadEstimatedCost();
     void googleVeoDurationSecondsEstimatedCost();
     void googleVeoAuthError();
     void openRouterUsageAndCredits();
+    void openRouterCreditsNotModifiedReusesCache();
+    void openAiCostsConditionalAcrossWindows();
+    void openAiFollowsPagesAcrossWindows();
+    void openAiLedgerFetchesOnlyOpenDays();
+    void openAiLedgerAcceptsNullIds();
     void togetherAiUsageAndHeaders();
+    void probeReadsLimitsFromModelsEndpoint();
+    void probeFallsBackToChatThenCachedHeaders();
+    void predictedProbeSkipsUntilBucketRefills();
+    void circuitBreakerPausesFailingHost();
+    void networkStatsTimeEachRequest();
+    void adaptiveTimeoutsFollowEndpointLatency();
+    void adaptiveTimeoutsBackOffAfterTimeout();
+    void hedgedGetTakesFirstAnswer();
+    void accountGroupPollsInBatchesAndAggregates();
+    void accountGroupRecordsSnapshotsAndAborts();
+    void accountGroupMarksEstimatedTotals();
     void cohereUsageAndHeaders();
     void azureProviderSuccess();
     void azureProviderMeteredCostPreferred();
@@ -138,6 +232,11 @@ private Q_SLOTS:
     void azureNormalizeFailurePath();
     void loofiServerSummarySuccess();
     void loofiServerAuthError();
+    void usageProxyMetersJsonResponse();
+    void usageProxyMergesAnthropicStream();
+    void usageProxyPassesErrorsWithoutMetering();
+    void usageProxyKeepsNoCookies();
+    void usageProxyOverheadWithinBudget();
 };
 
 void ProvidersMockedHttpTest::openAiSuccessAndHeaders()
@@ -317,6 +416,53 @@ void ProvidersMockedHttpTest::deepSeekUsageAndBalance()
     QVERIFY(provider.isConnected());
 }
 
+void ProvidersMockedHttpTest::deepSeekBalanceHonoursEndpointTtl()
+{
+    HttpStubServer server;
+    QVERIFY(server.listen());
+
+    server.setResponse(QStringLiteral("POST"), QStringLiteral("/chat/completions"), 200,
+                       R"JSON({"usage": {"prompt_tokens": 11, "completion_tokens": 9}})JSON");
+    server.setResponse(QStringLiteral("GET"), QStringLiteral("/user/balance"), 200,
+                       R"JSON({"balance_infos": [{"total_balance": "13.00"}]})JSON");
+
+    DeepSeekProvider provider;
+    provider.setApiKey(QStringLiteral("test-key"));
+    provider.setCustomBaseUrl(server.baseUrl());
+
+    QSignalSpy dataSpy(&provider, &ProviderBackend::dataUpdated);
+    provider.refresh();
+    QTRY_VERIFY_WITH_TIMEOUT(dataSpy.count() >= 1, 3000);
+    QCOMPARE(server.hitCount(QStringLiteral("/user/balance")), 1);
+
+    // The balance is still fresh: usage is polled, the balance is not
+    provider.refresh();
+    QTRY_VERIFY_WITH_TIMEOUT(dataSpy.count() >= 2, 3000);
+    QCOMPARE(server.hitCount(QStringLiteral("/user/balance")), 1);
+    QCOMPARE(server.hitCount(QStringLiteral("/chat/completions")), 2);
+    QCOMPARE(provider.skippedEndpointFetches(), 1);
+    QCOMPARE(provider.balance(), 13.0);
+
+    const QVariantMap status = provider.endpointStatus().first().toMap();
+    QCOMPARE(status.value(QStringLiteral("endpoint")).toString(), QStringLiteral("balance"));
+    QCOMPARE(status.value(QStringLiteral("ttlMs")).toLongLong(), 15 * 60 * 1000);
+    QVERIFY(status.value(QStringLiteral("ageMs")).toLongLong() >= 0);
+    QVERIFY(!status.value(QStringLiteral("stale")).toBool());
+
+    // Invalidating makes it due again
+    provider.invalidateEndpoints();
+    provider.refresh();
+    QTRY_VERIFY_WITH_TIMEOUT(dataSpy.count() >= 3, 3000);
+    QCOMPARE(server.hitCount(QStringLiteral("/user/balance")), 2);
+
+    // A TTL of zero fetches on every refresh
+    provider.setEndpointTtls({{QStringLiteral("balance"), 0}});
+    provider.refresh();
+    QTRY_VERIFY_WITH_TIMEOUT(dataSpy.count() >= 4, 3000);
+    QCOMPARE(server.hitCount(QStringLiteral("/user/balance")), 3);
+    QCOMPARE(provider.skippedEndpointFetches(), 1);
+}
+
 void ProvidersMockedHttpTest::googleVeoKnownLimitsByTier()
 {
     HttpStubServer server;
@@ -352,6 +498,36 @@ void ProvidersMockedHttpTest::googleVeoKnownLimitsByTier()
     QVERIFY(provider.isConnected());
 }
 
+void ProvidersMockedHttpTest::googleVeoModelInfoTtlAndExplicitRefresh()
+{
+    HttpStubServer server;
+    QVERIFY(server.listen());
+    const QString path = QStringLiteral("/v1beta/models/veo-2");
+    server.setResponse(QStringLiteral("GET"), path, 200, R"JSON({"name": "models/veo-2"})JSON");
+
+    GoogleVeoProvider provider;
+    provider.setApiKey(QStringLiteral("test-key"));
+    provider.setCustomBaseUrl(server.baseUrl() + QStringLiteral("/v1beta"));
+    provider.setModel(QStringLiteral("veo-2"));
+
+    QSignalSpy dataSpy(&provider, &ProviderBackend::dataUpdated);
+    provider.refresh();
+    QTRY_VERIFY_WITH_TIMEOUT(dataSpy.count() >= 1, 3000);
+    QCOMPARE(server.hitCount(path), 1);
+
+    // Within the TTL a poll reports the cached state without a request
+    provider.refresh();
+    QCOMPARE(dataSpy.count(), 2);
+    QVERIFY(!provider.isLoading());
+    QVERIFY(provider.isConnected());
+    QCOMPARE(server.hitCount(path), 1);
+
+    // A refresh the user asked for checks again
+    provider.requestRefresh(true);
+    QTRY_VERIFY_WITH_TIMEOUT(dataSpy.count() >= 3, 3000);
+    QCOMPARE(server.hitCount(path), 2);
+}
+
 void ProvidersMockedHttpTest::googleVeoUsesHeaderLimitsWhenPresent()
 {
     HttpStubServer server;
@@ -612,6 +788,247 @@ void ProvidersMockedHttpTest::openRouterUsageAndCredits()
     QVERIFY(server.hitCount(QStringLiteral("/auth/key")) >= 1);
 }
 
+void ProvidersMockedHttpTest::openRouterCreditsNotModifiedReusesCache()
+{
+    HttpStubServer server;
+    QVERIFY(server.listen());
+
+    server.setResponse(QStringLiteral("POST"), QStringLiteral("/chat/completions"), 200,
+                       R"JSON({"usage": {"prompt_tokens": 10, "completion_tokens": 5}})JSON");
+    server.setResponse(QStringLiteral("GET"), QStringLiteral("/auth/key"), 200,
+                       R"JSON({"data": {"usage": 3.50, "limit": 25.00}})JSON");
+    server.setEtag(QStringLiteral("/auth/key"), "\"credits-v1\"");
+
+    OpenRouterProvider provider;
+    provider.setApiKey(QStringLiteral("test-key"));
+    provider.setCustomBaseUrl(server.baseUrl());
+    provider.setEndpointTtls({{QStringLiteral("credits"), 0}}); // revalidate every poll
+
+    QSignalSpy dataSpy(&provider, &ProviderBackend::dataUpdated);
+    provider.refresh();
+    QTRY_VERIFY_WITH_TIMEOUT(dataSpy.count() >= 1, 3000);
+
+    QCOMPARE(provider.credits(), 21.50);
+    QVERIFY(server.lastRequestHeader(QStringLiteral("/auth/key"), "If-None-Match").isEmpty());
+    QCOMPARE(provider.conditionalRequests(), 1);
+    QCOMPARE(provider.cacheHits(), 0);
+
+    // Second poll revalidates; the 304 has no body but credits survive
+    provider.refresh();
+    QTRY_VERIFY_WITH_TIMEOUT(dataSpy.count() >= 2, 3000);
+
+    QCOMPARE(server.lastRequestHeader(QStringLiteral("/auth/key"), "If-None-Match"), QByteArray("\"credits-v1\""));
+    QCOMPARE(server.notModifiedCount(QStringLiteral("/auth/key")), 1);
+    QCOMPARE(provider.credits(), 21.50);
+    QCOMPARE(provider.conditionalRequests(), 2);
+    QCOMPARE(provider.cacheHits(), 1);
+    QCOMPARE(provider.cacheHitRatio(), 0.5);
+
+    // A new key invalidates the cache, so the next poll is unconditional
+    provider.setApiKey(QStringLiteral("other-key"));
+    provider.refresh();
+    QTRY_VERIFY_WITH_TIMEOUT(dataSpy.count() >= 3, 3000);
+    QVERIFY(server.lastRequestHeader(QStringLiteral("/auth/key"), "If-None-Match").isEmpty());
+    QCOMPARE(provider.cacheHits(), 1);
+}
+
+void ProvidersMockedHttpTest::openAiCostsConditionalAcrossWindows()
+{
+    HttpStubServer server;
+    QVERIFY(server.listen());
+
+    server.setResponse(QStringLiteral("GET"), QStringLiteral("/v1/organization/usage/completions"), 200,
+                       R"JSON({"data": [{"result": [{"input_tokens": 100, "output_tokens": 50, "num_model_requests": 7}]}]})JSON");
+    server.setResponse(QStringLiteral("GET"), QStringLiteral("/v1/organization/costs"), 200,
+                       R"JSON({"data": [{"result": [{"amount": 250}]}]})JSON");
+    server.setEtag(QStringLiteral("/v1/organization/usage/completions"), "W/\"usage-1\"");
+
+    OpenAIProvider provider;
+    provider.setApiKey(QStringLiteral("test-key"));
+    provider.setCustomBaseUrl(server.baseUrl() + QStringLiteral("/v1"));
+    provider.setEndpointTtls({{QStringLiteral("monthly-costs"), 0}}); // every feed, every poll
+
+    QSignalSpy dataSpy(&provider, &ProviderBackend::dataUpdated);
+    provider.refresh();
+    QTRY_VERIFY_WITH_TIMEOUT(dataSpy.count() >= 1, 3000);
+    QCOMPARE(provider.inputTokens(), 100);
+
+    // end_time differs on the next poll, yet the usage ETag is still offered
+    QTest::qWait(1100);
+    provider.refresh();
+    QTRY_VERIFY_WITH_TIMEOUT(dataSpy.count() >= 2, 3000);
+
+    QCOMPARE(server.notModifiedCount(QStringLiteral("/v1/organization/usage/completions")), 1);
+    QCOMPARE(provider.inputTokens(), 100);
+    QCOMPARE(provider.outputTokens(), 50);
+    QCOMPARE(provider.requestCount(), 7);
+    QCOMPARE(provider.dailyCost(), 2.5);
+
+    // Costs came without validators, so they are never answered from cache
+    QCOMPARE(provider.cacheHits(), 1);
+    QCOMPARE(provider.conditionalRequests(), 6);
+}
+
+void ProvidersMockedHttpTest::openAiFollowsPagesAcrossWindows()
+{
+    HttpStubServer server;
+    QVERIFY(server.listen());
+
+    // The opening usage page covers the first 6 of 24 hours and has more;
+    // every later window gets the same first page again, then a cursor page
+    const qint64 now = QDateTime::currentSecsSinceEpoch();
+    const QByteArray firstPage = QStringLiteral(R"JSON({
+        "data": [{"start_time": %1, "end_time": %2,
+                  "result": [{"input_tokens": 100, "output_tokens": 50, "num_model_requests": 7}]}],
+        "has_more": true,
+        "next_page": "page-2"
+    })JSON").arg(now - 86400).arg(now - 18 * 3600).toUtf8();
+    const QByteArray secondPage = QStringLiteral(R"JSON({
+        "data": [{"start_time": %1, "end_time": %2,
+                  "result": [{"input_tokens": 20, "output_tokens": 10, "num_model_requests": 3}]}],
+        "has_more": false
+    })JSON").arg(now - 6 * 3600).arg(now).toUtf8();
+
+    const QString usagePath = QStringLiteral("/v1/organization/usage/completions");
+    server.setResponse(QStringLiteral("GET"), usagePath, 200, firstPage);
+    server.setResponse(QStringLiteral("GET"), usagePath + QStringLiteral("?page=page-2"), 200, secondPage);
+    server.setResponse(QStringLiteral("GET"), QStringLiteral("/v1/organization/costs"), 200,
+                       R"JSON({"data": [{"result": [{"amount": 250}]}], "has_more": false})JSON");
+
+    OpenAIProvider provider;
+    provider.setApiKey(QStringLiteral("test-key"));
+    provider.setCustomBaseUrl(server.baseUrl() + QStringLiteral("/v1"));
+    provider.setMaxPagesInFlight(2);
+
+    QSignalSpy dataSpy(&provider, &ProviderBackend::dataUpdated);
+    provider.refresh();
+    QTRY_VERIFY_WITH_TIMEOUT(dataSpy.count() >= 1, 3000);
+
+    // Opening page, at least two split windows, and their cursor pages
+    const int usageHits = server.hitCount(usagePath);
+    QVERIFY(usageHits >= 5);
+    QCOMPARE(provider.pagesFetched(), usageHits + server.hitCount(QStringLiteral("/v1/organization/costs")));
+
+    // Buckets repeated across windows are only counted once
+    QCOMPARE(provider.inputTokens(), 120);
+    QCOMPARE(provider.outputTokens(), 60);
+    QCOMPARE(provider.requestCount(), 10);
+    QCOMPARE(provider.dailyCost(), 2.5);
+    QVERIFY(provider.isConnected());
+    QVERIFY(!provider.isLoading());
+}
+
+void ProvidersMockedHttpTest::openAiLedgerFetchesOnlyOpenDays()
+{
+    QTemporaryDir tmp;
+    QVERIFY(tmp.isValid());
+    qputenv("XDG_DATA_HOME", tmp.path().toUtf8());
+
+    UsageDatabase db;
+    db.init();
+
+    HttpStubServer server;
+    QVERIFY(server.listen());
+
+    // Today's bucket, grouped by project and model / line item
+    const QDate today = QDateTime::currentDateTimeUtc().date();
+    const qint64 todayStart = today.startOfDay(QTimeZone::UTC).toSecsSinceEpoch();
+    const qint64 monthStart = QDate(today.year(), today.month(), 1).startOfDay(QTimeZone::UTC).toSecsSinceEpoch();
+    const QString usagePath = QStringLiteral("/v1/organization/usage/completions");
+    const QString costsPath = QStringLiteral("/v1/organization/costs");
+    server.setResponse(QStringLiteral("GET"), usagePath, 200, QStringLiteral(R"JSON({
+        "data": [{"start_time": %1, "end_time": %2, "result": [
+            {"project_id": "proj-a", "model": "gpt-4o", "input_tokens": 100, "output_tokens": 50, "num_model_requests": 7},
+            {"project_id": "proj-b", "model": "gpt-4o-mini", "input_tokens": 900, "output_tokens": 90, "num_model_requests": 9}
+        ]}], "has_more": false
+    })JSON").arg(todayStart).arg(todayStart + 86400).toUtf8());
+    server.setResponse(QStringLiteral("GET"), costsPath, 200, QStringLiteral(R"JSON({
+        "data": [{"start_time": %1, "end_time": %2, "result": [
+            {"project_id": "proj-a", "line_item": "gpt-4o, input", "amount": 250},
+            {"project_id": "proj-b", "line_item": "gpt-4o-mini, input", "amount": 50}
+        ]}], "has_more": false
+    })JSON").arg(todayStart).arg(todayStart + 86400).toUtf8());
+
+    OpenAIProvider provider;
+    provider.setApiKey(QStringLiteral("test-key"));
+    provider.setCustomBaseUrl(server.baseUrl() + QStringLiteral("/v1"));
+    provider.setLedger(&db);
+
+    QSignalSpy dataSpy(&provider, &ProviderBackend::dataUpdated);
+    provider.refresh();
+    QTRY_VERIFY_WITH_TIMEOUT(dataSpy.count() >= 1, 3000);
+
+    // An empty ledger starts at the month; the model filter is applied locally
+    QCOMPARE(server.lastRequestQueryItem(costsPath, QStringLiteral("start_time")).toLongLong(), monthStart);
+    QVERIFY(server.lastRequestQueryItem(usagePath, QStringLiteral("models")).isEmpty());
+    QCOMPARE(server.hitCount(usagePath), 1);
+    QCOMPARE(server.hitCount(costsPath), 1);
+    QCOMPARE(provider.inputTokens(), 100);
+    QCOMPARE(provider.requestCount(), 7);
+    QCOMPARE(provider.dailyCost(), 3.0);
+    QCOMPARE(provider.monthlyCost(), 3.0);
+
+    // Closed days are now in the ledger: only the open ones are fetched,
+    // and re-fetching today replaces its rows instead of adding to them
+    provider.refresh();
+    QTRY_VERIFY_WITH_TIMEOUT(dataSpy.count() >= 2, 3000);
+    const qint64 secondStart = server.lastRequestQueryItem(costsPath, QStringLiteral("start_time")).toLongLong();
+    QVERIFY(secondStart >= qMax(monthStart, todayStart - 86400));
+    QCOMPARE(provider.dailyCost(), 3.0);
+    QCOMPARE(provider.monthlyCost(), 3.0);
+
+    provider.setProjectId(QStringLiteral("proj-b"));
+    provider.setModel(QString());
+    provider.refresh();
+    QTRY_VERIFY_WITH_TIMEOUT(dataSpy.count() >= 3, 3000);
+    QCOMPARE(provider.inputTokens(), 900);
+    QCOMPARE(provider.dailyCost(), 0.5);
+}
+
+void ProvidersMockedHttpTest::openAiLedgerAcceptsNullIds()
+{
+    QTemporaryDir tmp;
+    QVERIFY(tmp.isValid());
+    qputenv("XDG_DATA_HOME", tmp.path().toUtf8());
+
+    UsageDatabase db;
+    db.init();
+
+    HttpStubServer server;
+    QVERIFY(server.listen());
+
+    // Buckets outside any project, and cost items without a line item
+    const QDate today = QDateTime::currentDateTimeUtc().date();
+    const qint64 todayStart = today.startOfDay(QTimeZone::UTC).toSecsSinceEpoch();
+    server.setResponse(QStringLiteral("GET"), QStringLiteral("/v1/organization/usage/completions"), 200,
+                       QStringLiteral(R"JSON({
+        "data": [{"start_time": %1, "end_time": %2, "result": [
+            {"project_id": null, "model": null, "input_tokens": 40, "output_tokens": 4, "num_model_requests": 2}
+        ]}], "has_more": false
+    })JSON").arg(todayStart).arg(todayStart + 86400).toUtf8());
+    server.setResponse(QStringLiteral("GET"), QStringLiteral("/v1/organization/costs"), 200,
+                       QStringLiteral(R"JSON({
+        "data": [{"start_time": %1, "end_time": %2, "result": [
+            {"project_id": null, "line_item": null, "amount": 125}
+        ]}], "has_more": false
+    })JSON").arg(todayStart).arg(todayStart + 86400).toUtf8());
+
+    OpenAIProvider provider;
+    provider.setApiKey(QStringLiteral("test-key"));
+    provider.setCustomBaseUrl(server.baseUrl() + QStringLiteral("/v1"));
+    provider.setLedger(&db);
+
+    QSignalSpy dataSpy(&provider, &ProviderBackend::dataUpdated);
+    provider.refresh();
+    QTRY_VERIFY_WITH_TIMEOUT(dataSpy.count() >= 1, 3000);
+
+    // Both figures are read back from the ledger rows just written
+    QCOMPARE(provider.inputTokens(), 40);
+    QCOMPARE(provider.requestCount(), 2);
+    QCOMPARE(provider.dailyCost(), 1.25);
+    QCOMPARE(provider.monthlyCost(), 1.25);
+}
+
 void ProvidersMockedHttpTest::togetherAiUsageAndHeaders()
 {
     HttpStubServer server;
@@ -656,6 +1073,615 @@ void ProvidersMockedHttpTest::togetherAiUsageAndHeaders()
     QVERIFY(provider.isConnected());
 }
 
+void ProvidersMockedHttpTest::probeReadsLimitsFromModelsEndpoint()
+{
+    HttpStubServer server;
+    QVERIFY(server.listen());
+
+    server.setResponse(
+        QStringLiteral("GET"),
+        QStringLiteral("/models"),
+        200,
+        R"JSON({"data": []})JSON",
+        {
+            {"x-ratelimit-limit-requests", "60"},
+            {"x-ratelimit-remaining-requests", "59"},
+            {"x-ratelimit-limit-tokens", "4000"},
+            {"x-ratelimit-remaining-tokens", "4000"},
+        });
+
+    TogetherProvider provider;
+    provider.setApiKey(QStringLiteral("test-key"));
+    provider.setCustomBaseUrl(server.baseUrl());
+
+    QSignalSpy dataSpy(&provider, &ProviderBackend::dataUpdated);
+    provider.refresh();
+
+    QTRY_VERIFY_WITH_TIMEOUT(dataSpy.count() >= 1, 3000);
+
+    // Limits came from the free metadata call; no completion was sent
+    QCOMPARE(server.hitCount(QStringLiteral("/chat/completions")), 0);
+    QCOMPARE(provider.rateLimitRequests(), 60);
+    QCOMPARE(provider.rateLimitRequestsRemaining(), 59);
+    QCOMPARE(provider.rateLimitTokens(), 4000);
+    QCOMPARE(provider.requestCount(), 0);
+    QCOMPARE(provider.lastProbeStrategy(), QStringLiteral("models"));
+    QCOMPARE(provider.probeCount(), 1);
+    QCOMPARE(provider.probeCostMicros(), 0);
+    QVERIFY(provider.isConnected());
+}
+
+void ProvidersMockedHttpTest::probeFallsBackToChatThenCachedHeaders()
+{
+    HttpStubServer server;
+    QVERIFY(server.listen());
+
+    // No /models route: both metadata probes get a 404 without headers
+    server.setResponse(
+        QStringLiteral("POST"),
+        QStringLiteral("/chat/completions"),
+        200,
+        R"JSON({"usage": {"prompt_tokens": 8, "completion_tokens": 1}})JSON",
+        {
+            {"x-ratelimit-limit-requests", "60"},
+            {"x-ratelimit-remaining-requests", "42"},
+        });
+
+    TogetherProvider provider;
+    provider.setApiKey(QStringLiteral("test-key"));
+    provider.setCustomBaseUrl(server.baseUrl());
+    QCOMPARE(provider.probeOrderNames(), QStringList({QStringLiteral("models"), QStringLiteral("head"),
+                                                 QStringLiteral("cached"), QStringLiteral("chat")}));
+
+    QSignalSpy dataSpy(&provider, &ProviderBackend::dataUpdated);
+    provider.refresh();
+    QTRY_VERIFY_WITH_TIMEOUT(dataSpy.count() >= 1, 3000);
+
+    QCOMPARE(server.hitCount(QStringLiteral("/models")), 2);
+    QCOMPARE(server.hitCount(QStringLiteral("/chat/completions")), 1);
+    QCOMPARE(provider.rateLimitRequestsRemaining(), 42);
+    QCOMPARE(provider.lastProbeStrategy(), QStringLiteral("chat"));
+    // 8 prompt + 1 completion tokens at $0.88 per million, rounded per side
+    QCOMPARE(provider.probeCostMicros(), 8);
+
+    const QVariantList stats = provider.probeStatistics();
+    QCOMPARE(stats.size(), 4);
+    QCOMPARE(stats.at(0).toMap().value(QStringLiteral("supported")).toBool(), false);
+    QCOMPARE(stats.at(1).toMap().value(QStringLiteral("supported")).toBool(), false);
+    QCOMPARE(stats.at(3).toMap().value(QStringLiteral("count")).toInt(), 1);
+
+    // Within the header max age the next refresh sends nothing at all
+    provider.refresh();
+    QTRY_VERIFY_WITH_TIMEOUT(dataSpy.count() >= 2, 3000);
+    QCOMPARE(server.hitCount(QStringLiteral("/models")), 2);
+    QCOMPARE(server.hitCount(QStringLiteral("/chat/completions")), 1);
+    QCOMPARE(provider.lastProbeStrategy(), QStringLiteral("cached"));
+    QCOMPARE(provider.lastProbeLatencyMs(), 0);
+    QCOMPARE(provider.probeCount(), 2);
+
+    // Once they age out, the completion is used again
+    provider.setRateLimitHeaderMaxAgeMs(0);
+    QTest::qWait(5);
+    provider.refresh();
+    QTRY_VERIFY_WITH_TIMEOUT(dataSpy.count() >= 3, 3000);
+    QCOMPARE(server.hitCount(QStringLiteral("/chat/completions")), 2);
+    QCOMPARE(server.hitCount(QStringLiteral("/models")), 2);
+}
+
+void ProvidersMockedHttpTest::predictedProbeSkipsUntilBucketRefills()
+{
+    HttpStubServer server;
+    QVERIFY(server.listen());
+
+    auto serveLimits = [&](const QByteArray &remaining, const QByteArray &reset) {
+        server.setResponse(
+            QStringLiteral("GET"),
+            QStringLiteral("/models"),
+            200,
+            R"JSON({"data": []})JSON",
+            {
+                {"x-ratelimit-limit-requests", "60"},
+                {"x-ratelimit-remaining-requests", remaining},
+                {"x-ratelimit-reset-requests", reset},
+                {"x-ratelimit-limit-tokens", "4000"},
+                {"x-ratelimit-remaining-tokens", "4000"},
+                {"x-ratelimit-reset-tokens", "0s"},
+            });
+    };
+    serveLimits("30", "6m0s");
+
+    TogetherProvider provider;
+    provider.setApiKey(QStringLiteral("test-key"));
+    provider.setCustomBaseUrl(server.baseUrl());
+    provider.setProbeOrderNames({QStringLiteral("predicted"), QStringLiteral("models")});
+
+    QSignalSpy dataSpy(&provider, &ProviderBackend::dataUpdated);
+
+    // Nothing to predict from yet
+    provider.refresh();
+    QTRY_VERIFY_WITH_TIMEOUT(dataSpy.count() >= 1, 3000);
+    QCOMPARE(server.hitCount(QStringLiteral("/models")), 1);
+    QCOMPARE(provider.lastProbeStrategy(), QStringLiteral("models"));
+
+    QVariantMap model = provider.rateLimitModel();
+    QVERIFY(model.value(QStringLiteral("valid")).toBool());
+    QCOMPARE(model.value(QStringLiteral("requestsObserved")).toInt(), 30);
+    QVERIFY(model.value(QStringLiteral("requestsResetInMs")).toLongLong() > 350000);
+    QCOMPARE(model.value(QStringLiteral("requestsPerSecond")).toDouble(), 30.0 / 360.0);
+    QCOMPARE(model.value(QStringLiteral("tokensResetInMs")).toLongLong(), 0);
+
+    // Half a request per 6 s of refill: no meaningful change yet
+    provider.refresh();
+    QTRY_VERIFY_WITH_TIMEOUT(dataSpy.count() >= 2, 3000);
+    QCOMPARE(server.hitCount(QStringLiteral("/models")), 1);
+    QCOMPARE(provider.lastProbeStrategy(), QStringLiteral("predicted"));
+    QCOMPARE(provider.estimatedRequestsRemaining(), 30);
+
+    // Stale headers are never extrapolated
+    serveLimits("0", "300ms");
+    provider.setRateLimitHeaderMaxAgeMs(0);
+    QTest::qWait(5);
+    provider.refresh();
+    QTRY_VERIFY_WITH_TIMEOUT(dataSpy.count() >= 3, 3000);
+    QCOMPARE(server.hitCount(QStringLiteral("/models")), 2);
+    QCOMPARE(provider.rateLimitRequestsRemaining(), 0);
+
+    // An emptied bucket refilling fast is probed again, and the estimate
+    // climbs back to the limit without any request
+    provider.setRateLimitHeaderMaxAgeMs(60000);
+    QTest::qWait(100);
+    QVERIFY(provider.estimatedRequestsRemaining() >= 15);
+    provider.refresh();
+    QTRY_VERIFY_WITH_TIMEOUT(dataSpy.count() >= 4, 3000);
+    QCOMPARE(server.hitCount(QStringLiteral("/models")), 3);
+    QTRY_COMPARE_WITH_TIMEOUT(provider.estimatedRequestsRemaining(), 60, 3000);
+    QCOMPARE(server.hitCount(QStringLiteral("/models")), 3);
+}
+
+void ProvidersMockedHttpTest::circuitBreakerPausesFailingHost()
+{
+    HttpStubServer server;
+    QVERIFY(server.listen());
+    server.setResponse(QStringLiteral("POST"), QStringLiteral("/chat/completions"), 503, "{}");
+
+    TogetherProvider provider;
+    provider.setApiKey(QStringLiteral("test-key"));
+    provider.setCustomBaseUrl(server.baseUrl());
+    provider.setProbeOrderNames({QStringLiteral("chat")});
+    provider.setCircuitFailureThreshold(1);
+    provider.setCircuitCooldownMs(300);
+
+    // The first 503 trips the breaker, so no retry is scheduled
+    QSignalSpy dataSpy(&provider, &ProviderBackend::dataUpdated);
+    provider.refresh();
+    QTRY_VERIFY_WITH_TIMEOUT(!provider.isLoading(), 3000);
+    QVERIFY(provider.isCircuitOpen());
+    QVERIFY(provider.circuitRetryAt().isValid());
+    QCOMPARE(server.hitCount(QStringLiteral("/chat/completions")), 1);
+
+    // While open, refreshes are skipped without touching the network
+    provider.refresh();
+    QVERIFY(!provider.isLoading());
+    QCOMPARE(provider.pausedRefreshes(), 1);
+    QCOMPARE(server.hitCount(QStringLiteral("/chat/completions")), 1);
+
+    // After the cooldown a successful half-open trial closes it again
+    server.setResponse(
+        QStringLiteral("POST"),
+        QStringLiteral("/chat/completions"),
+        200,
+        R"JSON({"usage": {"prompt_tokens": 5, "completion_tokens": 1}})JSON");
+    QTest::qWait(350);
+    const int updates = dataSpy.count();
+    provider.refresh();
+    QCOMPARE(provider.circuitState(), ProviderBackend::CircuitState::HalfOpen);
+    QTRY_VERIFY_WITH_TIMEOUT(dataSpy.count() > updates, 3000);
+    QCOMPARE(provider.circuitState(), ProviderBackend::CircuitState::Closed);
+    QVERIFY(!provider.circuitRetryAt().isValid());
+    QCOMPARE(server.hitCount(QStringLiteral("/chat/completions")), 2);
+}
+
+void ProvidersMockedHttpTest::networkStatsTimeEachRequest()
+{
+    HttpStubServer server;
+    QVERIFY(server.listen());
+    server.setResponse(QStringLiteral("POST"), QStringLiteral("/chat/completions"), 200,
+                       R"JSON({"usage": {"prompt_tokens": 11, "completion_tokens": 9}})JSON");
+    server.setResponse(QStringLiteral("GET"), QStringLiteral("/user/balance"), 200,
+                       R"JSON({"balance_infos": [{"total_balance": "13.00"}]})JSON");
+
+    DeepSeekProvider provider;
+    provider.setApiKey(QStringLiteral("test-key"));
+    provider.setCustomBaseUrl(server.baseUrl());
+
+    QSignalSpy statsSpy(&provider, &ProviderBackend::networkStatsChanged);
+    provider.refresh();
+    QTRY_VERIFY_WITH_TIMEOUT(!provider.isLoading(), 3000);
+    QCOMPARE(statsSpy.count(), 2);
+
+    QVariantMap stats = provider.networkStats();
+    QCOMPARE(stats.value(QStringLiteral("requests")).toInt(), 2);
+    QCOMPARE(stats.value(QStringLiteral("failures")).toInt(), 0);
+    QCOMPARE(stats.value(QStringLiteral("retries")).toInt(), 0);
+    QCOMPARE(stats.value(QStringLiteral("statusCounts")).toMap().value(QStringLiteral("200")).toInt(), 2);
+    QVERIFY(stats.value(QStringLiteral("bytesIn")).toLongLong() > 0);
+
+    const QVariantMap phases = stats.value(QStringLiteral("phases")).toMap();
+    const QVariantMap total = phases.value(QStringLiteral("total")).toMap();
+    QCOMPARE(total.value(QStringLiteral("count")).toInt(), 2);
+    QVERIFY(total.value(QStringLiteral("p50Ms")).toLongLong() <= total.value(QStringLiteral("p95Ms")).toLongLong());
+    QVERIFY(total.value(QStringLiteral("p95Ms")).toLongLong() <= total.value(QStringLiteral("maxMs")).toLongLong());
+    QCOMPARE(phases.value(QStringLiteral("ttfb")).toMap().value(QStringLiteral("count")).toInt(), 2);
+
+    // One histogram slot per bucket bound plus the open-ended one
+    const QVariantList histogram = total.value(QStringLiteral("histogram")).toList();
+    QCOMPARE(histogram.size(), stats.value(QStringLiteral("bucketsMs")).toList().size() + 1);
+    int binned = 0;
+    for (const QVariant &count : histogram)
+        binned += count.toInt();
+    QCOMPARE(binned, 2);
+
+    // Failed requests are timed too
+    server.setResponse(QStringLiteral("POST"), QStringLiteral("/chat/completions"), 503, "{}");
+    provider.setCircuitFailureThreshold(1);
+    provider.refresh();
+    QTRY_VERIFY_WITH_TIMEOUT(!provider.isLoading(), 3000);
+    stats = provider.networkStats();
+    QCOMPARE(stats.value(QStringLiteral("requests")).toInt(), 3);
+    QCOMPARE(stats.value(QStringLiteral("failures")).toInt(), 1);
+    QCOMPARE(stats.value(QStringLiteral("statusCounts")).toMap().value(QStringLiteral("503")).toInt(), 1);
+
+    provider.resetNetworkStats();
+    QCOMPARE(provider.networkStats().value(QStringLiteral("requests")).toInt(), 0);
+}
+
+void ProvidersMockedHttpTest::adaptiveTimeoutsFollowEndpointLatency()
+{
+    HttpStubServer server;
+    QVERIFY(server.listen());
+    server.setResponse(QStringLiteral("POST"), QStringLiteral("/chat/completions"), 200,
+                       R"JSON({"usage": {"prompt_tokens": 11, "completion_tokens": 9}})JSON");
+    server.setResponse(QStringLiteral("GET"), QStringLiteral("/user/balance"), 200,
+                       R"JSON({"balance_infos": [{"total_balance": "13.00"}]})JSON");
+
+    DeepSeekProvider provider;
+    provider.setApiKey(QStringLiteral("test-key"));
+    provider.setCustomBaseUrl(server.baseUrl());
+
+    const auto timeoutFor = [&provider](const QString &path) -> int {
+        const QVariantList endpoints = provider.networkStats().value(QStringLiteral("endpoints")).toList();
+        for (const QVariant &value : endpoints) {
+            const QVariantMap endpoint = value.toMap();
+            if (endpoint.value(QStringLiteral("endpoint")).toString().endsWith(path))
+                return endpoint.value(QStringLiteral("timeoutMs")).toInt();
+        }
+        return -1;
+    };
+
+    QSignalSpy dataSpy(&provider, &ProviderBackend::dataUpdated);
+    for (int i = 1; i <= 5; ++i) {
+        provider.refresh();
+        QTRY_VERIFY_WITH_TIMEOUT(dataSpy.count() >= i, 3000);
+    }
+
+    // Fast local answers clamp to the minimum; one balance sample is not
+    // enough to move off the default
+    QCOMPARE(timeoutFor(QStringLiteral("/chat/completions")), 5000);
+    QCOMPARE(timeoutFor(QStringLiteral("/user/balance")), 30000);
+
+    provider.setAdaptiveTimeouts(false);
+    QCOMPARE(timeoutFor(QStringLiteral("/chat/completions")), 30000);
+}
+
+void ProvidersMockedHttpTest::adaptiveTimeoutsBackOffAfterTimeout()
+{
+    HttpStubServer server;
+    QVERIFY(server.listen());
+    server.setResponse(QStringLiteral("POST"), QStringLiteral("/chat/completions"), 200,
+                       R"JSON({"usage": {"prompt_tokens": 11, "completion_tokens": 9}})JSON");
+    server.setResponse(QStringLiteral("GET"), QStringLiteral("/user/balance"), 200,
+                       R"JSON({"balance_infos": [{"total_balance": "13.00"}]})JSON");
+    // The sixth completion outlasts the 5 s timeout learnt from the first five
+    server.setResponseDelays(QStringLiteral("/chat/completions"), {0, 0, 0, 0, 0, 7000});
+
+    DeepSeekProvider provider;
+    provider.setApiKey(QStringLiteral("test-key"));
+    provider.setCustomBaseUrl(server.baseUrl());
+    provider.setEndpointTtls({{QStringLiteral("balance"), 0}});
+
+    const auto timeoutFor = [&provider](const QString &path) -> int {
+        const QVariantList endpoints = provider.networkStats().value(QStringLiteral("endpoints")).toList();
+        for (const QVariant &value : endpoints) {
+            const QVariantMap endpoint = value.toMap();
+            if (endpoint.value(QStringLiteral("endpoint")).toString().endsWith(path))
+                return endpoint.value(QStringLiteral("timeoutMs")).toInt();
+        }
+        return -1;
+    };
+
+    QSignalSpy dataSpy(&provider, &ProviderBackend::dataUpdated);
+    for (int i = 1; i <= 5; ++i) {
+        provider.refresh();
+        QTRY_VERIFY_WITH_TIMEOUT(dataSpy.count() >= i, 3000);
+        QTRY_COMPARE_WITH_TIMEOUT(server.hitCount(QStringLiteral("/user/balance")), i, 3000);
+    }
+
+    // Balance queries keep a higher floor than chat calls
+    QCOMPARE(timeoutFor(QStringLiteral("/chat/completions")), 5000);
+    QTRY_COMPARE_WITH_TIMEOUT(timeoutFor(QStringLiteral("/user/balance")), 20000, 3000);
+
+    // The timed-out request counts at its timeout, lifting the next one's
+    provider.refresh();
+    QTRY_COMPARE_WITH_TIMEOUT(timeoutFor(QStringLiteral("/chat/completions")), 20000, 9000);
+}
+
+void ProvidersMockedHttpTest::hedgedGetTakesFirstAnswer()
+{
+    HttpStubServer server;
+    QVERIFY(server.listen());
+    server.setResponse(QStringLiteral("POST"), QStringLiteral("/chat/completions"), 200,
+                       R"JSON({"usage": {"prompt_tokens": 11, "completion_tokens": 9}})JSON");
+    server.setResponse(QStringLiteral("GET"), QStringLiteral("/user/balance"), 200,
+                       R"JSON({"balance_infos": [{"total_balance": "13.00"}]})JSON");
+    // The sixth balance request hangs well past the endpoint's p95
+    server.setResponseDelays(QStringLiteral("/user/balance"), {0, 0, 0, 0, 0, 2000});
+
+    DeepSeekProvider provider;
+    provider.setApiKey(QStringLiteral("test-key"));
+    provider.setCustomBaseUrl(server.baseUrl());
+    provider.setEndpointTtls({{QStringLiteral("balance"), 0}});
+    provider.setHedgeRequests(true);
+
+    QSignalSpy dataSpy(&provider, &ProviderBackend::dataUpdated);
+    for (int i = 1; i <= 5; ++i) {
+        provider.refresh();
+        QTRY_VERIFY_WITH_TIMEOUT(dataSpy.count() >= i, 3000);
+    }
+    QCOMPARE(server.hitCount(QStringLiteral("/user/balance")), 5);
+    QCOMPARE(provider.networkStats().value(QStringLiteral("hedgesFired")).toInt(), 0);
+    const QVariantMap before = provider.networkStats();
+
+    // The duplicate answers first, so the refresh does not wait for the slow copy
+    QElapsedTimer clock;
+    clock.start();
+    provider.refresh();
+    QTRY_VERIFY_WITH_TIMEOUT(dataSpy.count() >= 6, 3000);
+    QVERIFY2(clock.elapsed() < 1500, qPrintable(QString::number(clock.elapsed())));
+    QCOMPARE(server.hitCount(QStringLiteral("/user/balance")), 7);
+    QCOMPARE(provider.networkStats().value(QStringLiteral("hedgesFired")).toInt(), 1);
+    QCOMPARE(provider.balance(), 13.0);
+
+    // The hedged request is timed by the copy that answered: the stub closes
+    // every connection, so it opened a new one, and its body was counted
+    const QVariantMap after = provider.networkStats();
+    QCOMPARE(after.value(QStringLiteral("reusedConnections")).toInt(),
+             before.value(QStringLiteral("reusedConnections")).toInt());
+    QVERIFY(after.value(QStringLiteral("bytesIn")).toLongLong()
+            >= before.value(QStringLiteral("bytesIn")).toLongLong()
+                   + qint64(sizeof(R"JSON({"balance_infos": [{"total_balance": "13.00"}]})JSON") - 1));
+}
+
+void ProvidersMockedHttpTest::accountGroupPollsInBatchesAndAggregates()
+{
+    HttpStubServer server;
+    QVERIFY(server.listen());
+
+    // Each account talks to its own base URL on the stub
+    const auto serve = [&server](const QString &prefix, const QByteArray &remaining) {
+        server.setResponse(QStringLiteral("POST"), prefix + QStringLiteral("/chat/completions"), 200,
+                           R"JSON({"usage": {"prompt_tokens": 11, "completion_tokens": 9}})JSON",
+                           {
+                               {"x-ratelimit-limit-requests", "100"},
+                               {"x-ratelimit-remaining-requests", remaining},
+                               {"x-ratelimit-limit-tokens", "6000"},
+                               {"x-ratelimit-remaining-tokens", "5800"},
+                               {"x-ratelimit-reset-requests", remaining + "s"},
+                           });
+        server.setResponse(QStringLiteral("GET"), prefix + QStringLiteral("/user/balance"), 200,
+                           R"JSON({"balance_infos": [{"total_balance": "1.00"}]})JSON");
+    };
+    serve(QStringLiteral("/a"), "90");
+    serve(QStringLiteral("/b"), "15");
+    serve(QStringLiteral("/c"), "50");
+
+    const auto account = [&server](const QString &id, bool enabled = true) {
+        return QVariantMap{
+            {QStringLiteral("id"), id},
+            {QStringLiteral("label"), id.toUpper()},
+            {QStringLiteral("baseUrl"), server.baseUrl() + QLatin1Char('/') + id},
+            {QStringLiteral("enabled"), enabled},
+        };
+    };
+
+    ProviderAccountGroup group;
+    group.setAccounts({account(QStringLiteral("a")), account(QStringLiteral("b")),
+                       account(QStringLiteral("c")), account(QStringLiteral("d"), false),
+                       account(QStringLiteral("a"))}); // duplicate id: dropped
+    group.setProviderKey(QStringLiteral("deepseek"));
+    group.setMaxConcurrentAccounts(2);
+    QCOMPARE(group.name(), QStringLiteral("DeepSeek"));
+    QCOMPARE(group.accountCount(), 4);
+    QVERIFY(qobject_cast<DeepSeekProvider *>(group.accountBackend(QStringLiteral("a"))));
+    QCOMPARE(group.accountBackend(QStringLiteral("a"))->customBaseUrl(), server.baseUrl() + QStringLiteral("/a"));
+
+    // Without any key there is nothing to poll
+    group.refresh();
+    QVERIFY(!group.errorString().isEmpty());
+    QVERIFY(!group.isLoading());
+
+    // "c" has no key and "d" is disabled: neither is polled
+    group.setAccountKey(QStringLiteral("a"), QStringLiteral("key-a"));
+    group.setAccountKey(QStringLiteral("b"), QStringLiteral("key-b"));
+    group.setAccountKey(QStringLiteral("d"), QStringLiteral("key-d"));
+
+    int loadingNow = 0;
+    int peakLoading = 0;
+    for (const QString &id : {QStringLiteral("a"), QStringLiteral("b")}) {
+        ProviderBackend *backend = group.accountBackend(id);
+        connect(backend, &ProviderBackend::loadingChanged, &group, [&, backend]() {
+            loadingNow += backend->isLoading() ? 1 : -1;
+            peakLoading = qMax(peakLoading, loadingNow);
+        });
+    }
+
+    QSignalSpy dataSpy(&group, &ProviderBackend::dataUpdated);
+    group.refresh();
+    QTRY_VERIFY_WITH_TIMEOUT(dataSpy.count() >= 1, 3000);
+    QCOMPARE(dataSpy.count(), 1);
+
+    QCOMPARE(peakLoading, 2);
+    QCOMPARE(server.hitCount(QStringLiteral("/a/chat/completions")), 1);
+    QCOMPARE(server.hitCount(QStringLiteral("/b/chat/completions")), 1);
+    QCOMPARE(server.hitCount(QStringLiteral("/c/chat/completions")), 0);
+    QCOMPARE(server.hitCount(QStringLiteral("/d/chat/completions")), 0);
+
+    // Usage is summed; rate limits come from the account closest to its limit
+    QVERIFY(group.isConnected());
+    QVERIFY(group.errorString().isEmpty());
+    QCOMPARE(group.connectedAccounts(), 2);
+    QCOMPARE(group.inputTokens(), 22);
+    QCOMPARE(group.outputTokens(), 18);
+    QCOMPARE(group.requestCount(), 2);
+    QCOMPARE(group.rateLimitRequests(), 100);
+    QCOMPARE(group.rateLimitRequestsRemaining(), 15);
+    QCOMPARE(group.rateLimitResetTime(), QStringLiteral("15s"));
+
+    const QVariantList status = group.accountStatus();
+    QCOMPARE(status.size(), 4);
+    QCOMPARE(status.at(0).toMap().value(QStringLiteral("rateLimitRequestsRemaining")).toInt(), 90);
+    QCOMPARE(status.at(1).toMap().value(QStringLiteral("label")).toString(), QStringLiteral("B"));
+    QCOMPARE(status.at(2).toMap().value(QStringLiteral("hasKey")).toBool(), false);
+    QCOMPARE(status.at(2).toMap().value(QStringLiteral("authKeySlot")).toString(), QStringLiteral("deepseek_api_key_c"));
+
+    // One account per batch: still every account, never two at once
+    group.setAccountKey(QStringLiteral("c"), QStringLiteral("key-c"));
+    group.setMaxConcurrentAccounts(1);
+    peakLoading = 0;
+    group.refresh();
+    QTRY_VERIFY_WITH_TIMEOUT(dataSpy.count() >= 2, 3000);
+    QCOMPARE(peakLoading, 1);
+    QCOMPARE(server.hitCount(QStringLiteral("/c/chat/completions")), 1);
+    QCOMPARE(group.connectedAccounts(), 3);
+    QCOMPARE(group.inputTokens(), 33);
+
+    // An unchanged account keeps its backend across reconfiguration
+    ProviderBackend *kept = group.accountBackend(QStringLiteral("a"));
+    group.setAccounts({account(QStringLiteral("a")), account(QStringLiteral("b"))});
+    QCOMPARE(group.accountBackend(QStringLiteral("a")), kept);
+    QVERIFY(group.accountBackend(QStringLiteral("a"))->hasApiKey());
+    QVERIFY(!group.accountBackend(QStringLiteral("c")));
+}
+
+void ProvidersMockedHttpTest::accountGroupMarksEstimatedTotals()
+{
+    HttpStubServer server;
+    QVERIFY(server.listen());
+
+    // "billed" reports its cost, "priced" only usage that is priced locally
+    const QString path = QStringLiteral("/openai/deployments/dep/chat/completions");
+    server.setResponse(QStringLiteral("POST"), QStringLiteral("/billed") + path, 200, R"JSON({
+        "usage": {"prompt_tokens": 120, "completion_tokens": 30, "total_tokens": 150},
+        "cost": {"total_cost": 0.5}
+    })JSON");
+    server.setResponse(QStringLiteral("POST"), QStringLiteral("/priced") + path, 200, R"JSON({
+        "usage": {"prompt_tokens": 42, "completion_tokens": 8, "total_tokens": 50}
+    })JSON");
+
+    const auto account = [&server](const QString &id) {
+        return QVariantMap{
+            {QStringLiteral("id"), id},
+            {QStringLiteral("baseUrl"), server.baseUrl() + QLatin1Char('/') + id},
+            {QStringLiteral("model"), QStringLiteral("gpt-4o")},
+            {QStringLiteral("deploymentId"), QStringLiteral("dep")},
+        };
+    };
+
+    ProviderAccountGroup group;
+    group.setProviderKey(QStringLiteral("azure"));
+    group.setAccounts({account(QStringLiteral("billed"))});
+    group.setAccountKey(QStringLiteral("billed"), QStringLiteral("key-billed"));
+
+    QSignalSpy dataSpy(&group, &ProviderBackend::dataUpdated);
+    group.refresh();
+    QTRY_VERIFY_WITH_TIMEOUT(dataSpy.count() >= 1, 3000);
+    QVERIFY(!group.accountBackend(QStringLiteral("billed"))->isEstimatedCost());
+    QCOMPARE(group.costMicros(), qint64(500000));
+    QVERIFY(!group.isEstimatedCost());
+
+    // Adding an estimated member turns the total into an estimate
+    group.setAccounts({account(QStringLiteral("billed")), account(QStringLiteral("priced"))});
+    group.setAccountKey(QStringLiteral("priced"), QStringLiteral("key-priced"));
+    group.refresh();
+    QTRY_VERIFY_WITH_TIMEOUT(dataSpy.count() >= 2, 3000);
+    const ProviderBackend *priced = group.accountBackend(QStringLiteral("priced"));
+    QVERIFY(priced->isEstimatedCost());
+    QVERIFY(priced->costMicros() > 0);
+    QVERIFY(group.costMicros() > qint64(500000));
+    QVERIFY(group.isEstimatedCost());
+}
+
+void ProvidersMockedHttpTest::accountGroupRecordsSnapshotsAndAborts()
+{
+    QTemporaryDir tmp;
+    QVERIFY(tmp.isValid());
+    qputenv("XDG_DATA_HOME", tmp.path().toUtf8());
+
+    UsageDatabase db;
+    db.init();
+
+    HttpStubServer server;
+    QVERIFY(server.listen());
+    for (const QString &prefix : {QStringLiteral("/a"), QStringLiteral("/b")}) {
+        server.setResponse(QStringLiteral("POST"), prefix + QStringLiteral("/chat/completions"), 200,
+                           R"JSON({"usage": {"prompt_tokens": 11, "completion_tokens": 9}})JSON");
+        server.setResponse(QStringLiteral("GET"), prefix + QStringLiteral("/user/balance"), 200,
+                           R"JSON({"balance_infos": [{"total_balance": "1.00"}]})JSON");
+    }
+    // The second poll of "a" hangs, so the cycle can be aborted
+    server.setResponseDelays(QStringLiteral("/a/chat/completions"), {0, 5000});
+
+    const auto account = [&server](const QString &id) {
+        return QVariantMap{
+            {QStringLiteral("id"), id},
+            {QStringLiteral("baseUrl"), server.baseUrl() + QLatin1Char('/') + id},
+        };
+    };
+
+    ProviderAccountGroup group;
+    group.setProviderKey(QStringLiteral("deepseek"));
+    group.setAccounts({account(QStringLiteral("a")), account(QStringLiteral("b")), account(QStringLiteral("c"))});
+    group.setAccountKey(QStringLiteral("a"), QStringLiteral("key-a"));
+    group.setAccountKey(QStringLiteral("b"), QStringLiteral("key-b"));
+    group.setDatabase(&db);
+
+    // One snapshot per account that answered; "c" has no key
+    QSignalSpy dataSpy(&group, &ProviderBackend::dataUpdated);
+    group.refresh();
+    QTRY_VERIFY_WITH_TIMEOUT(dataSpy.count() >= 1, 3000);
+    QStringList recorded = db.getAccounts(QStringLiteral("DeepSeek"));
+    recorded.sort();
+    QCOMPARE(recorded, QStringList({QStringLiteral("a"), QStringLiteral("b")}));
+
+    // Aborting the group aborts the accounts' requests too
+    group.refresh();
+    QTRY_VERIFY_WITH_TIMEOUT(server.hitCount(QStringLiteral("/a/chat/completions")) == 2, 3000);
+    ProviderBackend *slow = group.accountBackend(QStringLiteral("a"));
+    QVERIFY(group.isLoading());
+    QVERIFY(slow->isLoading());
+    group.abortRefresh();
+    QVERIFY(!group.isLoading());
+    QVERIFY(!slow->isLoading());
+    QVERIFY(slow->abortedRequests() >= 1);
+
+    // OpenAI accounts keep their ledger in the group's database
+    group.setProviderKey(QStringLiteral("openai"));
+    auto *openai = qobject_cast<OpenAIProvider *>(group.accountBackend(QStringLiteral("a")));
+    QVERIFY(openai);
+    QCOMPARE(openai->ledger(), &db);
+    group.setDatabase(nullptr);
+    QCOMPARE(openai->ledger(), nullptr);
+}
+
 void ProvidersMockedHttpTest::cohereUsageAndHeaders()
 {
     HttpStubServer server;
@@ -934,5 +1960,272 @@ void ProvidersMockedHttpTest::loofiServerAuthError()
     QVERIFY(!provider.isConnected());
 }
 
+namespace {
+/// Send a request through client and wait for the answer; null on timeout.
+QNetworkReply *awaitReply(QNetworkAccessManager &client, const QUrl &url, const QByteArray &body = QByteArray())
+{
+    QNetworkRequest request(url);
+    request.setHeader(QNetworkRequest::ContentTypeHeader, QStringLiteral("application/json"));
+    request.setRawHeader("Authorization", "Bearer sk-tool");
+    QNetworkReply *reply = body.isNull() ? client.get(request) : client.post(request, body);
+    QSignalSpy finishedSpy(reply, &QNetworkReply::finished);
+    if (!reply->isFinished() && !finishedSpy.wait(3000)) {
+        delete reply;
+        return nullptr;
+    }
+    return reply;
+}
+} // namespace
+
+void ProvidersMockedHttpTest::usageProxyMetersJsonResponse()
+{
+    QTemporaryDir tmp;
+    QVERIFY(tmp.isValid());
+    qputenv("XDG_DATA_HOME", tmp.path().toUtf8());
+
+    UsageDatabase db;
+    db.init();
+
+    HttpStubServer server;
+    QVERIFY(server.listen());
+    const QByteArray body = R"JSON({"id":"chatcmpl-1","model":"gpt-4o-mini","choices":[],
+        "usage":{"prompt_tokens":120,"completion_tokens":30,"total_tokens":150}})JSON";
+    server.setResponse(QStringLiteral("POST"), QStringLiteral("/v1/chat/completions"), 200, body);
+
+    OpenAIProvider backend;
+    UsageProxy proxy;
+    proxy.setPort(0);
+    proxy.setUpstreams({{QStringLiteral("openai"), server.baseUrl()}});
+    proxy.setDatabase(&db);
+    proxy.setBackend(QStringLiteral("openai"), &backend);
+    proxy.setEnabled(true);
+    QVERIFY(proxy.isListening());
+    QVERIFY(proxy.serverPort() > 0);
+
+    QSignalSpy meteredSpy(&proxy, &UsageProxy::requestMetered);
+    QNetworkAccessManager client;
+    std::unique_ptr<QNetworkReply> reply(awaitReply(
+        client, QUrl(proxy.routeUrl(QStringLiteral("openai")) + QStringLiteral("/v1/chat/completions")),
+        R"JSON({"model":"gpt-4o-mini","messages":[]})JSON"));
+    QVERIFY(reply);
+    QCOMPARE(reply->error(), QNetworkReply::NoError);
+    QCOMPARE(reply->readAll(), body);
+
+    // Forwarded under the route's prefix, with the tool's own credentials
+    QCOMPARE(server.hitCount(QStringLiteral("/v1/chat/completions")), 1);
+    QCOMPARE(server.lastRequestHeader(QStringLiteral("/v1/chat/completions"), "Authorization"),
+             QByteArray("Bearer sk-tool"));
+
+    QCOMPARE(meteredSpy.count(), 1);
+    QCOMPARE(meteredSpy.first().at(0).toString(), QStringLiteral("openai"));
+    QCOMPARE(meteredSpy.first().at(1).toString(), QStringLiteral("gpt-4o-mini"));
+    // OpenAI bodies carry no cost: 120 * $0.15 / M + 30 * $0.60 / M
+    QCOMPARE(meteredSpy.first().at(4).toDouble(), 0.000036);
+    QCOMPARE(backend.meteredInputTokens(), qint64(120));
+    QCOMPARE(backend.meteredOutputTokens(), qint64(30));
+    QCOMPARE(backend.meteredRequests(), 1);
+    QCOMPARE(backend.meteredCostMicros(), qint64(36));
+    QCOMPARE(proxy.meteredRequests(), 1);
+    QCOMPARE(proxy.activeRequests(), 0);
+
+    // Polled figures are left alone
+    QCOMPARE(backend.inputTokens(), qint64(0));
+    QCOMPARE(backend.requestCount(), 0);
+
+    // Ledger rows are written in batches
+    const QDate today = QDateTime::currentDateTimeUtc().date();
+    QCOMPARE(db.ledgerTotals(backend.name(), QStringLiteral("openai"), QStringLiteral("proxy"), today, today).requests,
+             qint64(0));
+    proxy.flush();
+    const UsageDatabase::LedgerTotals totals =
+        db.ledgerTotals(backend.name(), QStringLiteral("openai"), QStringLiteral("proxy"), today, today);
+    QCOMPARE(totals.inputTokens, qint64(120));
+    QCOMPARE(totals.outputTokens, qint64(30));
+    QCOMPARE(totals.requests, qint64(1));
+    QCOMPARE(totals.costMicros, qint64(36));
+}
+
+void ProvidersMockedHttpTest::usageProxyMergesAnthropicStream()
+{
+    QTemporaryDir tmp;
+    QVERIFY(tmp.isValid());
+    qputenv("XDG_DATA_HOME", tmp.path().toUtf8());
+
+    UsageDatabase db;
+    db.init();
+
+    HttpStubServer server;
+    QVERIFY(server.listen());
+
+    // Input counts arrive in message_start, the final output count in message_delta
+    const QByteArray stream =
+        "event: message_start\r\n"
+        "data: {\"type\":\"message_start\",\"message\":{\"id\":\"msg_1\",\"model\":\"claude-sonnet-4-20250514\","
+        "\"usage\":{\"input_tokens\":1000,\"cache_read_input_tokens\":2000,\"output_tokens\":1}}}\r\n\r\n"
+        "event: content_block_delta\r\n"
+        "data: {\"type\":\"content_block_delta\",\"index\":0,\"delta\":{\"type\":\"text_delta\",\"text\":\"usage\"}}\r\n\r\n"
+        "event: message_delta\r\n"
+        "data: {\"type\":\"message_delta\",\"delta\":{\"stop_reason\":\"end_turn\"},\"usage\":{\"output_tokens\":200}}\r\n\r\n"
+        "event: message_stop\r\n"
+        "data: {\"type\":\"message_stop\"}\r\n\r\n";
+    // The stub always sends a JSON content type as well; the proxy only
+    // looks for the event-stream one
+    server.setResponse(QStringLiteral("POST"), QStringLiteral("/v1/messages"), 200, stream,
+                       {{"Content-Type", "text/event-stream"}});
+
+    AnthropicProvider backend;
+    UsageProxy proxy;
+    proxy.setPort(0);
+    proxy.setUpstreams({{QStringLiteral("anthropic"), server.baseUrl()}});
+    proxy.setDatabase(&db);
+    proxy.setBackend(QStringLiteral("anthropic"), &backend);
+    proxy.setEnabled(true);
+    QVERIFY(proxy.isListening());
+
+    QSignalSpy meteredSpy(&proxy, &UsageProxy::requestMetered);
+    QNetworkAccessManager client;
+    std::unique_ptr<QNetworkReply> reply(awaitReply(
+        client, QUrl(proxy.routeUrl(QStringLiteral("anthropic")) + QStringLiteral("/v1/messages")),
+        R"JSON({"model":"claude-sonnet-4-20250514","stream":true})JSON"));
+    QVERIFY(reply);
+    QCOMPARE(reply->error(), QNetworkReply::NoError);
+    QCOMPARE(reply->readAll(), stream);
+
+    // Cache reads count as input; the later output count replaces the first
+    QCOMPARE(backend.meteredInputTokens(), qint64(3000));
+    QCOMPARE(backend.meteredOutputTokens(), qint64(200));
+    QCOMPARE(backend.meteredRequests(), 1);
+    // 1000 * $3 / M + 2000 cache reads * $0.30 / M + 200 * $15 / M
+    QCOMPARE(backend.meteredCostMicros(), qint64(6600));
+    QCOMPARE(meteredSpy.count(), 1);
+    QCOMPARE(meteredSpy.first().at(4).toDouble(), 0.0066);
+
+    proxy.flush();
+    const QDate today = QDateTime::currentDateTimeUtc().date();
+    const UsageDatabase::LedgerTotals totals =
+        db.ledgerTotals(backend.name(), QStringLiteral("anthropic"), QStringLiteral("proxy"), today, today);
+    QCOMPARE(totals.requests, qint64(1));
+    QCOMPARE(totals.costMicros, qint64(6600));
+
+    backend.resetMeteredUsage();
+    QCOMPARE(backend.meteredInputTokens(), qint64(0));
+    QCOMPARE(backend.meteredCost(), 0.0);
+}
+
+void ProvidersMockedHttpTest::usageProxyPassesErrorsWithoutMetering()
+{
+    HttpStubServer server;
+    QVERIFY(server.listen());
+    const QByteArray limited = R"JSON({"error":{"type":"rate_limit_error"},"usage":{"prompt_tokens":5}})JSON";
+    server.setResponse(QStringLiteral("POST"), QStringLiteral("/v1/chat/completions"), 429, limited,
+                       {{"Retry-After", "7"}});
+
+    OpenAIProvider backend;
+    UsageProxy proxy;
+    proxy.setPort(0);
+    proxy.setUpstreams({{QStringLiteral("openai"), server.baseUrl()}});
+    proxy.setBackend(QStringLiteral("openai"), &backend);
+    proxy.setEnabled(true);
+    QVERIFY(proxy.isListening());
+
+    QNetworkAccessManager client;
+
+    // Upstream errors reach the tool as they are
+    std::unique_ptr<QNetworkReply> reply(awaitReply(
+        client, QUrl(proxy.routeUrl(QStringLiteral("openai")) + QStringLiteral("/v1/chat/completions")), "{}"));
+    QVERIFY(reply);
+    QCOMPARE(reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt(), 429);
+    QCOMPARE(reply->rawHeader("Retry-After"), QByteArray("7"));
+    QCOMPARE(reply->readAll(), limited);
+
+    // Unknown routes are answered by the proxy itself
+    reply.reset(awaitReply(client, QUrl(proxy.routeUrl(QStringLiteral("nowhere")) + QStringLiteral("/v1/models"))));
+    QVERIFY(reply);
+    QCOMPARE(reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt(), 404);
+    QVERIFY(reply->readAll().contains("proxy_error"));
+
+    QCOMPARE(proxy.forwardedRequests(), 1);
+    QCOMPARE(proxy.meteredRequests(), 0);
+    QCOMPARE(backend.meteredRequests(), 0);
+}
+
+void ProvidersMockedHttpTest::usageProxyKeepsNoCookies()
+{
+    HttpStubServer server;
+    QVERIFY(server.listen());
+    server.setResponse(QStringLiteral("GET"), QStringLiteral("/v1/models"), 200, R"JSON({"data":[]})JSON",
+                       {{"Set-Cookie", "__cf_bm=abc; Path=/"}});
+
+    UsageProxy proxy;
+    proxy.setPort(0);
+    proxy.setUpstreams({{QStringLiteral("openai"), server.baseUrl()}});
+    proxy.setEnabled(true);
+    QVERIFY(proxy.isListening());
+    const QUrl url(proxy.routeUrl(QStringLiteral("openai")) + QStringLiteral("/v1/models"));
+
+    // The cookie is passed on to the tool that received it...
+    QNetworkAccessManager firstTool;
+    std::unique_ptr<QNetworkReply> reply(awaitReply(firstTool, url));
+    QVERIFY(reply);
+    QCOMPARE(reply->error(), QNetworkReply::NoError);
+    QVERIFY(reply->rawHeader("Set-Cookie").startsWith("__cf_bm=abc"));
+
+    // ...but not kept by the proxy for another tool's request
+    QNetworkAccessManager secondTool;
+    reply.reset(awaitReply(secondTool, url));
+    QVERIFY(reply);
+    QCOMPARE(server.hitCount(QStringLiteral("/v1/models")), 2);
+    QVERIFY(server.lastRequestHeader(QStringLiteral("/v1/models"), "Cookie").isEmpty());
+}
+
+void ProvidersMockedHttpTest::usageProxyOverheadWithinBudget()
+{
+    HttpStubServer server;
+    QVERIFY(server.listen());
+    server.setResponse(QStringLiteral("POST"), QStringLiteral("/v1/chat/completions"), 200,
+                       R"JSON({"model":"gpt-4o-mini","usage":{"prompt_tokens":10,"completion_tokens":5}})JSON");
+
+    UsageProxy proxy;
+    proxy.setPort(0);
+    proxy.setUpstreams({{QStringLiteral("openai"), server.baseUrl()}});
+    proxy.setEnabled(true);
+    QVERIFY(proxy.isListening());
+
+    constexpr int REQUESTS = 40;
+    const auto p99Ms = [](QList<qint64> samples) {
+        std::sort(samples.begin(), samples.end());
+        return samples.at(qMax<qsizetype>(1, (samples.size() * 99 + 99) / 100) - 1) / 1e6;
+    };
+    const auto timeRequests = [&](const QString &baseUrl) {
+        QNetworkAccessManager client;
+        QList<qint64> samples;
+        for (int i = 0; i < REQUESTS; ++i) {
+            QElapsedTimer timer;
+            timer.start();
+            std::unique_ptr<QNetworkReply> reply(
+                awaitReply(client, QUrl(baseUrl + QStringLiteral("/v1/chat/completions")), "{}"));
+            if (!reply || reply->error() != QNetworkReply::NoError)
+                return QList<qint64>();
+            samples.append(timer.nsecsElapsed());
+        }
+        return samples;
+    };
+
+    const QList<qint64> direct = timeRequests(server.baseUrl());
+    const QList<qint64> proxied = timeRequests(proxy.routeUrl(QStringLiteral("openai")));
+    QCOMPARE(direct.size(), REQUESTS);
+    QCOMPARE(proxied.size(), REQUESTS);
+    QCOMPARE(proxy.meteredRequests(), REQUESTS);
+
+    // Time spent inside the proxy, and what a tool sees end to end; the
+    // bounds are loose enough for a loaded CI machine
+    const QVariantMap overhead = proxy.overheadStats();
+    QCOMPARE(overhead.value(QStringLiteral("samples")).toInt(), REQUESTS);
+    QVERIFY2(overhead.value(QStringLiteral("p99Ms")).toDouble() < 10.0,
+             qPrintable(QStringLiteral("proxy p99 %1 ms").arg(overhead.value(QStringLiteral("p99Ms")).toDouble())));
+    const double addedMs = p99Ms(proxied) - p99Ms(direct);
+    QVERIFY2(addedMs < 50.0, qPrintable(QStringLiteral("added p99 %1 ms").arg(addedMs)));
+}
+
 QTEST_MAIN(ProvidersMockedHttpTest)
 #include "test_providers_mocked_http.moc"
@@ -0,0 +1,100 @@
+#include <QtTest>
+
+#include "ratelimitbucket.h"
+
+class RateLimitBucketTest : public QObject
+{
+    Q_OBJECT
+
+private Q_SLOTS:
+    void parsesDurations_data();
+    void parsesDurations();
+    void parsesTimestamps();
+    void refillsLinearlyUntilReset();
+    void holdsWithoutResetTime();
+};
+
+void RateLimitBucketTest::parsesDurations_data()
+{
+    QTest::addColumn<QString>("value");
+    QTest::addColumn<qint64>("ms");
+
+    QTest::newRow("minutes") << QStringLiteral("6m0s") << qint64(360000);
+    QTest::newRow("seconds") << QStringLiteral("1s") << qint64(1000);
+    QTest::newRow("fractional") << QStringLiteral("2m59.56s") << qint64(179560);
+    QTest::newRow("millis") << QStringLiteral("20ms") << qint64(20);
+    QTest::newRow("hours") << QStringLiteral("1h2m") << qint64(3720000);
+    QTest::newRow("micros") << QStringLiteral("1500us") << qint64(2);
+    QTest::newRow("plain seconds") << QStringLiteral("30") << qint64(30000);
+    QTest::newRow("padded") << QStringLiteral(" 45s ") << qint64(45000);
+    QTest::newRow("empty") << QString() << qint64(-1);
+    QTest::newRow("unit only") << QStringLiteral("s") << qint64(-1);
+    QTest::newRow("unknown unit") << QStringLiteral("5d") << qint64(-1);
+    QTest::newRow("garbage") << QStringLiteral("soon") << qint64(-1);
+}
+
+void RateLimitBucketTest::parsesDurations()
+{
+    QFETCH(QString, value);
+    QFETCH(qint64, ms);
+    QCOMPARE(RateLimitBucket::parseResetMs(value), ms);
+}
+
+void RateLimitBucketTest::parsesTimestamps()
+{
+    const QDateTime now = QDateTime::fromString(QStringLiteral("2026-02-16T12:34:00Z"), Qt::ISODate);
+
+    QCOMPARE(RateLimitBucket::parseResetMs(u"2026-02-16T12:34:56Z", now), qint64(56000));
+    QCOMPARE(RateLimitBucket::parseResetMs(u"2026-02-16T12:33:00Z", now), qint64(0));
+    QCOMPARE(RateLimitBucket::parseResetMs(QString::number(now.toSecsSinceEpoch() + 10), now), qint64(10000));
+    QCOMPARE(RateLimitBucket::parseResetMs(QString::number(now.toMSecsSinceEpoch() + 2500), now), qint64(2500));
+}
+
+void RateLimitBucketTest::refillsLinearlyUntilReset()
+{
+    RateLimitBucket bucket;
+    QVERIFY(!bucket.isValid());
+
+    // 60 of 100 left, full again in 40 s: one request per second
+    bucket.observe(100, 60, 40000, 1000);
+    QVERIFY(bucket.canPredict());
+    QCOMPARE(bucket.refillPerSecond(), 1.0);
+
+    QCOMPARE(bucket.remainingAt(1000), qint64(60));
+    QCOMPARE(bucket.remainingAt(500), qint64(60)); // clock before the observation
+    QCOMPARE(bucket.remainingAt(11500), qint64(70));
+    QCOMPARE(bucket.resetInMs(11000), qint64(30000));
+    QCOMPARE(bucket.remainingAt(41000), qint64(100));
+    QCOMPARE(bucket.remainingAt(100000), qint64(100));
+    QCOMPARE(bucket.resetInMs(100000), qint64(0));
+
+    // A full bucket stays full
+    bucket.observe(100, 100, 40000, 0);
+    QCOMPARE(bucket.remainingAt(20000), qint64(100));
+    QCOMPARE(bucket.resetInMs(0), qint64(0));
+    QCOMPARE(bucket.refillPerSecond(), 0.0);
+
+    // Large token limits do not overflow
+    bucket.observe(2000000000, 0, 60000, 0);
+    QCOMPARE(bucket.remainingAt(30000), qint64(1000000000));
+}
+
+void RateLimitBucketTest::holdsWithoutResetTime()
+{
+    RateLimitBucket bucket;
+    bucket.observe(100, 40, -1, 0);
+    QVERIFY(bucket.isValid());
+    QVERIFY(!bucket.canPredict());
+    QCOMPARE(bucket.remainingAt(60000), qint64(40));
+    QCOMPARE(bucket.resetInMs(60000), qint64(-1));
+
+    // Remaining is clamped to the limit
+    bucket.observe(10, 25, 1000, 0);
+    QCOMPARE(bucket.observedRemaining(), qint64(10));
+
+    bucket.clear();
+    QVERIFY(!bucket.isValid());
+}
+
+QTEST_MAIN(RateLimitBucketTest)
+#include "test_ratelimitbucket.moc"
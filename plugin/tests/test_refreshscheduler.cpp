@@ -0,0 +1,331 @@
+#include <QtTest>
+#include <QSignalSpy>
+
+#include "providerbackend.h"
+#include "refreshscheduler.h"
+#include "systemstatemonitor.h"
+
+/**
+ * Provider whose refresh stays in flight until finish() is called, so
+ * tests control exactly when scheduler slots free up.
+ */
+class FakeProvider : public ProviderBackend
+{
+    Q_OBJECT
+public:
+    explicit FakeProvider(const QString &name, QObject *parent = nullptr)
+        : ProviderBackend(parent)
+        , m_name(name)
+    {}
+
+    QString name() const override { return m_name; }
+    QString iconName() const override { return QStringLiteral("test-icon"); }
+    void refresh() override
+    {
+        ++refreshes;
+        setLoading(true);
+    }
+
+    void finish()
+    {
+        updateLastRefreshed();
+        setLoading(false);
+    }
+
+    int refreshes = 0;
+
+private:
+    QString m_name;
+};
+
+class RefreshSchedulerTest : public QObject
+{
+    Q_OBJECT
+
+private Q_SLOTS:
+    void capsConcurrencyStalestFirst();
+    void coalescesIntoAlignedWakeup();
+    void skipsProvidersWithoutApiKey();
+    void scheduleReportsEntries();
+    void entryUpdatesKeepTiming();
+    void sharedBackendSurvivesEntryRemoval();
+    void systemStateStretchesIntervals();
+    void providerCadenceStretchesInterval();
+    void pausesOfflineAndStaggersReconnect();
+
+private:
+    static qint64 nextDueIn(const RefreshScheduler &scheduler)
+    {
+        const QDateTime due = scheduler.schedule().first().toMap().value(QStringLiteral("nextDue")).toDateTime();
+        return QDateTime::currentDateTime().msecsTo(due);
+    }
+
+    static QVariantMap providerEntry(FakeProvider *provider, qint64 intervalMs, bool requiresApiKey = false)
+    {
+        QVariantMap entry;
+        entry[QStringLiteral("name")] = provider->name();
+        entry[QStringLiteral("backend")] = QVariant::fromValue<QObject *>(provider);
+        entry[QStringLiteral("intervalMs")] = intervalMs;
+        entry[QStringLiteral("enabled")] = true;
+        entry[QStringLiteral("requiresApiKey")] = requiresApiKey;
+        return entry;
+    }
+
+    static QVariantMap taskEntry(const QString &name, qint64 intervalMs, bool enabled = true)
+    {
+        QVariantMap entry;
+        entry[QStringLiteral("name")] = name;
+        entry[QStringLiteral("intervalMs")] = intervalMs;
+        entry[QStringLiteral("enabled")] = enabled;
+        return entry;
+    }
+};
+
+void RefreshSchedulerTest::capsConcurrencyStalestFirst()
+{
+    FakeProvider a(QStringLiteral("A"));
+    FakeProvider b(QStringLiteral("B"));
+    FakeProvider c(QStringLiteral("C"));
+    FakeProvider d(QStringLiteral("D"));
+
+    // B refreshed before C, so B is staler; A and D never refreshed
+    b.finish();
+    QTest::qWait(20);
+    c.finish();
+
+    RefreshScheduler scheduler;
+    scheduler.setAlignmentMs(0);
+    scheduler.setJitterPercent(0);
+    scheduler.setMaxConcurrent(2);
+    scheduler.setEntries({providerEntry(&b, 60000), providerEntry(&c, 60000),
+                          providerEntry(&a, 60000), providerEntry(&d, 60000)});
+
+    scheduler.refreshAll();
+    QTRY_COMPARE(scheduler.runningCount(), 2);
+    QCOMPARE(a.refreshes, 1);
+    QCOMPARE(d.refreshes, 1);
+    QCOMPARE(b.refreshes, 0);
+    QCOMPARE(c.refreshes, 0);
+
+    a.finish();
+    QTRY_COMPARE(b.refreshes, 1);
+    QCOMPARE(c.refreshes, 0);
+    QCOMPARE(scheduler.runningCount(), 2);
+
+    d.finish();
+    QTRY_COMPARE(c.refreshes, 1);
+
+    b.finish();
+    c.finish();
+    QTRY_COMPARE(scheduler.runningCount(), 0);
+    QCOMPARE(a.refreshes, 1);
+    QCOMPARE(d.refreshes, 1);
+}
+
+void RefreshSchedulerTest::coalescesIntoAlignedWakeup()
+{
+    RefreshScheduler scheduler;
+    scheduler.setAlignmentMs(500);
+    scheduler.setJitterPercent(0);
+
+    QSignalSpy taskSpy(&scheduler, &RefreshScheduler::taskDue);
+    scheduler.setEntries({taskEntry(QStringLiteral("first"), 300),
+                          taskEntry(QStringLiteral("second"), 600)});
+
+    QVERIFY(scheduler.nextWake().isValid());
+    QCOMPARE(scheduler.nextWake().toMSecsSinceEpoch() % 500, 0);
+
+    // Both are due within one alignment window, so one wakeup runs both
+    QTRY_VERIFY(taskSpy.count() >= 1);
+    QCOMPARE(taskSpy.count(), 2);
+    QCOMPARE(taskSpy.at(0).at(0).toString(), QStringLiteral("first"));
+    QCOMPARE(taskSpy.at(1).at(0).toString(), QStringLiteral("second"));
+}
+
+void RefreshSchedulerTest::skipsProvidersWithoutApiKey()
+{
+    FakeProvider provider(QStringLiteral("Keyed"));
+
+    RefreshScheduler scheduler;
+    scheduler.setAlignmentMs(0);
+    scheduler.setJitterPercent(0);
+    scheduler.setEntries({providerEntry(&provider, 60000, true)});
+
+    scheduler.refreshAll();
+    QTest::qWait(20);
+    QCOMPARE(provider.refreshes, 0);
+
+    provider.setApiKey(QStringLiteral("sk-test"));
+    scheduler.refreshAll();
+    QTRY_COMPARE(provider.refreshes, 1);
+}
+
+void RefreshSchedulerTest::scheduleReportsEntries()
+{
+    FakeProvider provider(QStringLiteral("Reported"));
+
+    RefreshScheduler scheduler;
+    scheduler.setJitterPercent(0);
+    scheduler.setEntries({providerEntry(&provider, 120000),
+                          taskEntry(QStringLiteral("soon"), 60000),
+                          taskEntry(QStringLiteral("off"), 60000, false)});
+
+    const QVariantList schedule = scheduler.schedule();
+    QCOMPARE(schedule.size(), 3);
+
+    // Disabled entries carry no due time; enabled ones are ordered by it
+    QVariantMap soon, reported, off;
+    for (const QVariant &value : schedule) {
+        const QVariantMap item = value.toMap();
+        const QString name = item.value(QStringLiteral("name")).toString();
+        if (name == QLatin1String("soon")) soon = item;
+        else if (name == QLatin1String("Reported")) reported = item;
+        else off = item;
+    }
+    QVERIFY(soon.value(QStringLiteral("nextDue")).toDateTime() < reported.value(QStringLiteral("nextDue")).toDateTime());
+    QVERIFY(!off.value(QStringLiteral("nextDue")).toDateTime().isValid());
+    QCOMPARE(reported.value(QStringLiteral("stalenessMs")).toLongLong(), -1);
+    QCOMPARE(reported.value(QStringLiteral("running")).toBool(), false);
+    QVERIFY(scheduler.nextWake() <= soon.value(QStringLiteral("nextDue")).toDateTime().addMSecs(scheduler.alignmentMs()));
+}
+
+void RefreshSchedulerTest::entryUpdatesKeepTiming()
+{
+    FakeProvider provider(QStringLiteral("Stable"));
+
+    RefreshScheduler scheduler;
+    scheduler.setEntries({providerEntry(&provider, 300000)});
+    const QDateTime due = scheduler.schedule().first().toMap().value(QStringLiteral("nextDue")).toDateTime();
+
+    // Re-evaluated QML bindings hand over the same entries again
+    QTest::qWait(10);
+    scheduler.setEntries({providerEntry(&provider, 300000)});
+    QCOMPARE(scheduler.schedule().first().toMap().value(QStringLiteral("nextDue")).toDateTime(), due);
+
+    // A changed interval reschedules
+    scheduler.setJitterPercent(0);
+    scheduler.setEntries({providerEntry(&provider, 600000)});
+    QVERIFY(scheduler.schedule().first().toMap().value(QStringLiteral("nextDue")).toDateTime() > due);
+}
+
+void RefreshSchedulerTest::sharedBackendSurvivesEntryRemoval()
+{
+    FakeProvider provider(QStringLiteral("Shared"));
+    QVariantMap second = providerEntry(&provider, 600000);
+    second[QStringLiteral("name")] = QStringLiteral("Shared (billing)");
+
+    RefreshScheduler scheduler;
+    scheduler.setEntries({providerEntry(&provider, 300000), second});
+
+    // Dropping one entry must not cut the other one off from the backend
+    scheduler.setEntries({providerEntry(&provider, 300000)});
+    scheduler.refreshAll();
+    QTRY_COMPARE(scheduler.runningCount(), 1);
+    QCOMPARE(provider.refreshes, 1);
+
+    provider.finish();
+    QTRY_COMPARE(scheduler.runningCount(), 0);
+}
+
+void RefreshSchedulerTest::systemStateStretchesIntervals()
+{
+    // Stand-in for UPower / NetworkManager: drive the monitor directly
+    SystemStateMonitor monitor(SystemStateMonitor::Sources::None);
+    QCOMPARE(monitor.pollingFactor(), 1.0);
+
+    RefreshScheduler scheduler;
+    scheduler.setJitterPercent(0);
+    scheduler.setSystemState(&monitor);
+    scheduler.setEntries({taskEntry(QStringLiteral("sync"), 60000)});
+    QVERIFY(qAbs(nextDueIn(scheduler) - 60000) < 1000);
+
+    QSignalSpy stateSpy(&monitor, &SystemStateMonitor::stateChanged);
+    monitor.setOnBattery(true);
+    QCOMPARE(stateSpy.count(), 1);
+    QCOMPARE(monitor.pollingFactor(), 2.0);
+    QVERIFY(qAbs(nextDueIn(scheduler) - 120000) < 1000);
+
+    monitor.setMetered(true);
+    QCOMPARE(monitor.pollingFactor(), 4.0);
+    QVERIFY(qAbs(nextDueIn(scheduler) - 240000) < 1000);
+
+    // Back on AC and an unmetered link restores the configured interval
+    monitor.setOnBattery(false);
+    monitor.setMetered(false);
+    QVERIFY(qAbs(nextDueIn(scheduler) - 60000) < 1000);
+}
+
+void RefreshSchedulerTest::providerCadenceStretchesInterval()
+{
+    FakeProvider provider(QStringLiteral("Idle"));
+
+    RefreshScheduler scheduler;
+    scheduler.setJitterPercent(0);
+    scheduler.setEntries({providerEntry(&provider, 60000)});
+    QVERIFY(qAbs(nextDueIn(scheduler) - 60000) < 1000);
+
+    // Two updates with identical data: the provider asks for 2x
+    Q_EMIT provider.dataUpdated();
+    Q_EMIT provider.dataUpdated();
+    QCOMPARE(provider.cadenceFactor(), 2.0);
+    QVERIFY(qAbs(nextDueIn(scheduler) - 120000) < 1000);
+}
+
+void RefreshSchedulerTest::pausesOfflineAndStaggersReconnect()
+{
+    // Stand-in for QNetworkInformation reachability
+    SystemStateMonitor monitor(SystemStateMonitor::Sources::None);
+    FakeProvider a(QStringLiteral("A"));
+    FakeProvider b(QStringLiteral("B"));
+    FakeProvider c(QStringLiteral("C"));
+
+    RefreshScheduler scheduler;
+    scheduler.setAlignmentMs(60000);
+    scheduler.setJitterPercent(0);
+    scheduler.setReconnectStaggerMs(150);
+    scheduler.setSystemState(&monitor);
+    scheduler.setEntries({providerEntry(&a, 60000), providerEntry(&b, 60000),
+                          providerEntry(&c, 60000), taskEntry(QStringLiteral("sync"), 60000)});
+
+    QElapsedTimer clock;
+    clock.start();
+    QStringList started;
+    QList<qint64> startedAt;
+    const auto onStart = [&](const QString &name) {
+        started.append(name);
+        startedAt.append(clock.elapsed());
+    };
+    connect(&scheduler, &RefreshScheduler::refreshStarted, this, onStart);
+    connect(&scheduler, &RefreshScheduler::taskDue, this, onStart);
+
+    monitor.setOnline(false);
+    QVERIFY(scheduler.isPaused());
+    QVERIFY(!scheduler.nextWake().isValid());
+
+    // Nothing goes out while offline, not even a manual refresh
+    scheduler.refreshAll();
+    scheduler.refreshNow(QStringLiteral("sync"));
+    QTest::qWait(50);
+    QVERIFY(started.isEmpty());
+    QVERIFY(!scheduler.nextWake().isValid());
+
+    // Back online, everything that fell due goes out one slot at a time
+    // instead of waiting for the 60 s grid or firing together
+    monitor.setOnline(true);
+    QVERIFY(!scheduler.isPaused());
+    QTRY_COMPARE_WITH_TIMEOUT(started.size(), 4, 3000);
+    QCOMPARE(started, QStringList({QStringLiteral("A"), QStringLiteral("B"),
+                                   QStringLiteral("C"), QStringLiteral("sync")}));
+    for (int i = 1; i < startedAt.size(); ++i)
+        QVERIFY2(startedAt.at(i) - startedAt.at(i - 1) >= 100, qPrintable(QString::number(startedAt.at(i) - startedAt.at(i - 1))));
+
+    // A short drop with nothing due starts no wave
+    monitor.setOnline(false);
+    monitor.setOnline(true);
+    QTest::qWait(50);
+    QCOMPARE(started.size(), 4);
+    QCOMPARE(a.refreshes, 1);
+}
+
+QTEST_MAIN(RefreshSchedulerTest)
+#include "test_refreshscheduler.moc"
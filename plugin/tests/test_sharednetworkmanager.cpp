@@ -0,0 +1,286 @@
+#include <QtTest>
+
+#include <QHash>
+#include <QHostAddress>
+#include <QNetworkReply>
+#include <QPointer>
+#include <QSignalSpy>
+#include <QTcpServer>
+#include <QTcpSocket>
+#include <QUrl>
+
+#include <utility>
+
+#include "sharednetworkmanager.h"
+
+/**
+ * Minimal HTTP/1.1 server that holds every request until releaseAll() is
+ * called, so tests can observe how many requests are on the wire at once.
+ *
+ * "/echo" answers with the request body, "/fail" with a 500 and any other
+ * path with the path itself.
+ */
+class HoldingHttpServer : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit HoldingHttpServer(QObject *parent = nullptr)
+        : QObject(parent)
+    {
+        connect(&m_server, &QTcpServer::newConnection, this, [this]() {
+            while (m_server.hasPendingConnections()) {
+                QTcpSocket *socket = m_server.nextPendingConnection();
+                connect(socket, &QTcpSocket::readyRead, this, [this, socket]() {
+                    QByteArray &buffer = m_buffers[socket];
+                    buffer += socket->readAll();
+
+                    const int headerEnd = buffer.indexOf("\r\n\r\n");
+                    if (headerEnd < 0)
+                        return;
+
+                    qint64 contentLength = 0;
+                    const QList<QByteArray> lines = buffer.left(headerEnd).split('\n');
+                    for (const QByteArray &line : lines) {
+                        if (line.toLower().startsWith("content-length:"))
+                            contentLength = line.mid(15).trimmed().toLongLong();
+                    }
+                    if (buffer.size() < headerEnd + 4 + contentLength)
+                        return;
+
+                    const QList<QByteArray> firstLine = lines.first().trimmed().split(' ');
+                    Held held;
+                    held.socket = socket;
+                    held.path = QUrl(QString::fromUtf8(firstLine.value(1))).path();
+                    held.body = buffer.mid(headerEnd + 4, contentLength);
+                    m_buffers.remove(socket);
+
+                    m_hitCount[held.path] = m_hitCount.value(held.path) + 1;
+                    m_held.append(held);
+                    Q_EMIT requestHeld();
+                });
+                connect(socket, &QTcpSocket::disconnected, socket, &QObject::deleteLater);
+            }
+        });
+    }
+
+    bool listen() { return m_server.listen(QHostAddress::LocalHost, 0); }
+
+    QUrl url(const QString &path) const
+    {
+        return QUrl(QStringLiteral("http://127.0.0.1:%1%2").arg(m_server.serverPort()).arg(path));
+    }
+
+    QString host() const { return QStringLiteral("127.0.0.1:%1").arg(m_server.serverPort()); }
+
+    int heldCount() const { return m_held.size(); }
+    int hitCount(const QString &path) const { return m_hitCount.value(path, 0); }
+
+    void releaseAll()
+    {
+        const QList<Held> held = std::exchange(m_held, {});
+        for (const Held &request : held) {
+            if (!request.socket)
+                continue;
+
+            int status = 200;
+            QByteArray body = request.path.toUtf8();
+            if (request.path == QLatin1String("/echo")) {
+                body = request.body;
+            } else if (request.path == QLatin1String("/fail")) {
+                status = 500;
+            }
+
+            QByteArray payload;
+            payload += "HTTP/1.1 " + QByteArray::number(status) + " Status\r\n";
+            payload += "Content-Type: text/plain\r\n";
+            payload += "Content-Length: " + QByteArray::number(body.size()) + "\r\n";
+            payload += "Connection: close\r\n\r\n";
+            payload += body;
+            request.socket->write(payload);
+            request.socket->disconnectFromHost();
+        }
+    }
+
+Q_SIGNALS:
+    void requestHeld();
+
+private:
+    struct Held {
+        QPointer<QTcpSocket> socket;
+        QString path;
+        QByteArray body;
+    };
+
+    QTcpServer m_server;
+    QHash<QTcpSocket *, QByteArray> m_buffers;
+    QList<Held> m_held;
+    QHash<QString, int> m_hitCount;
+};
+
+class TestSharedNetworkManager : public QObject
+{
+    Q_OBJECT
+
+private Q_SLOTS:
+    void instanceIsProcessWide();
+    void limitsRequestsInFlight();
+    void queuedPostKeepsBody();
+    void abortQueuedReply();
+    void hostStatisticsCountOutcomes();
+    void retryBudgetDeniesWhenEmpty();
+};
+
+void TestSharedNetworkManager::instanceIsProcessWide()
+{
+    SharedNetworkManager *first = SharedNetworkManager::instance();
+    QVERIFY(first != nullptr);
+    QCOMPARE(SharedNetworkManager::instance(), first);
+}
+
+void TestSharedNetworkManager::limitsRequestsInFlight()
+{
+    HoldingHttpServer server;
+    QVERIFY(server.listen());
+
+    SharedNetworkManager manager;
+    manager.setMaxConcurrentRequests(2);
+
+    const QStringList paths = {QStringLiteral("/a"), QStringLiteral("/b"),
+                               QStringLiteral("/c"), QStringLiteral("/d")};
+    QList<QNetworkReply *> replies;
+    for (const QString &path : paths)
+        replies.append(manager.get(QNetworkRequest(server.url(path))));
+
+    QCOMPARE(manager.inFlight(), 2);
+    QCOMPARE(manager.queued(), 2);
+
+    QTRY_COMPARE(server.heldCount(), 2);
+    QTest::qWait(50);
+    QCOMPARE(server.heldCount(), 2); // the queued pair must not reach the server yet
+
+    server.releaseAll();
+    QTRY_COMPARE(server.heldCount(), 2);
+    QCOMPARE(manager.queued(), 0);
+
+    server.releaseAll();
+    for (int i = 0; i < replies.size(); ++i) {
+        QNetworkReply *reply = replies.at(i);
+        QTRY_VERIFY(reply->isFinished());
+        QCOMPARE(reply->error(), QNetworkReply::NoError);
+        QCOMPARE(reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt(), 200);
+        QCOMPARE(reply->readAll(), paths.at(i).toUtf8());
+    }
+    QCOMPARE(manager.inFlight(), 0);
+}
+
+void TestSharedNetworkManager::queuedPostKeepsBody()
+{
+    HoldingHttpServer server;
+    QVERIFY(server.listen());
+
+    SharedNetworkManager manager;
+    manager.setMaxConcurrentRequests(1);
+
+    QNetworkReply *blocker = manager.get(QNetworkRequest(server.url(QStringLiteral("/hold"))));
+    QNetworkRequest postRequest(server.url(QStringLiteral("/echo")));
+    postRequest.setHeader(QNetworkRequest::ContentTypeHeader, QStringLiteral("application/json"));
+    QNetworkReply *post = manager.post(postRequest, QByteArrayLiteral("{\"payload\":true}"));
+    QCOMPARE(manager.queued(), 1);
+
+    QSignalSpy finishedSpy(post, &QNetworkReply::finished);
+    QTRY_COMPARE(server.heldCount(), 1);
+    server.releaseAll();
+    QTRY_COMPARE(server.heldCount(), 1);
+    server.releaseAll();
+
+    QTRY_COMPARE(finishedSpy.count(), 1);
+    QVERIFY(blocker->isFinished());
+    QCOMPARE(post->error(), QNetworkReply::NoError);
+    QCOMPARE(post->readAll(), QByteArrayLiteral("{\"payload\":true}"));
+}
+
+void TestSharedNetworkManager::abortQueuedReply()
+{
+    HoldingHttpServer server;
+    QVERIFY(server.listen());
+
+    SharedNetworkManager manager;
+    manager.setMaxConcurrentRequests(1);
+
+    QNetworkReply *blocker = manager.get(QNetworkRequest(server.url(QStringLiteral("/hold"))));
+    QNetworkReply *queued = manager.get(QNetworkRequest(server.url(QStringLiteral("/never"))));
+    QCOMPARE(manager.queued(), 1);
+
+    QSignalSpy finishedSpy(queued, &QNetworkReply::finished);
+    queued->abort();
+    QCOMPARE(finishedSpy.count(), 1);
+    QCOMPARE(queued->error(), QNetworkReply::OperationCanceledError);
+    QCOMPARE(manager.queued(), 0);
+
+    // A deleted queued reply is dropped as well
+    QNetworkReply *deleted = manager.get(QNetworkRequest(server.url(QStringLiteral("/never"))));
+    QCOMPARE(manager.queued(), 1);
+    delete deleted;
+    QCOMPARE(manager.queued(), 0);
+
+    QTRY_COMPARE(server.heldCount(), 1);
+    server.releaseAll();
+    QTRY_VERIFY(blocker->isFinished());
+    QTest::qWait(50);
+    QCOMPARE(server.hitCount(QStringLiteral("/never")), 0);
+    QCOMPARE(manager.inFlight(), 0);
+}
+
+void TestSharedNetworkManager::hostStatisticsCountOutcomes()
+{
+    HoldingHttpServer server;
+    QVERIFY(server.listen());
+    connect(&server, &HoldingHttpServer::requestHeld, &server, &HoldingHttpServer::releaseAll);
+
+    SharedNetworkManager manager;
+    QSignalSpy statsSpy(&manager, &SharedNetworkManager::statisticsChanged);
+
+    QNetworkReply *ok = manager.get(QNetworkRequest(server.url(QStringLiteral("/ok"))));
+    QTRY_VERIFY(ok->isFinished());
+    QNetworkReply *failed = manager.get(QNetworkRequest(server.url(QStringLiteral("/fail"))));
+    QTRY_VERIFY(failed->isFinished());
+    QVERIFY(statsSpy.count() > 0);
+
+    const QVariantList stats = manager.hostStatistics();
+    QCOMPARE(stats.size(), 1);
+    const QVariantMap entry = stats.first().toMap();
+    QCOMPARE(entry.value(QStringLiteral("host")).toString(), server.host());
+    QCOMPARE(entry.value(QStringLiteral("requests")).toLongLong(), 2);
+    QCOMPARE(entry.value(QStringLiteral("failures")).toLongLong(), 1);
+    QCOMPARE(entry.value(QStringLiteral("inFlight")).toInt(), 0);
+    QCOMPARE(entry.value(QStringLiteral("encrypted")).toLongLong(), 0);
+    QCOMPARE(entry.value(QStringLiteral("lastStatus")).toInt(), 500);
+    QVERIFY(entry.value(QStringLiteral("bytesReceived")).toLongLong() > 0);
+
+    manager.resetStatistics();
+    QVERIFY(manager.hostStatistics().isEmpty());
+}
+
+void TestSharedNetworkManager::retryBudgetDeniesWhenEmpty()
+{
+    SharedNetworkManager manager;
+    QCOMPARE(manager.retryTokens(), manager.retryBudget());
+
+    manager.setRetryBudget(2);
+    QVERIFY(manager.acquireRetryToken());
+    QVERIFY(manager.acquireRetryToken());
+    QVERIFY(!manager.acquireRetryToken());
+    QCOMPARE(manager.retriesGranted(), 2);
+    QCOMPARE(manager.retriesDenied(), 1);
+
+    // Two tokens per minute: one is back after half a minute, not sooner
+    QCOMPARE(manager.retryTokens(), 0);
+
+    manager.resetStatistics();
+    QCOMPARE(manager.retriesGranted(), 0);
+    QCOMPARE(manager.retriesDenied(), 0);
+}
+
+QTEST_MAIN(TestSharedNetworkManager)
+#include "test_sharednetworkmanager.moc"
@@ -1,14 +1,20 @@
 #include <QtTest>
 
 #include <QTemporaryDir>
+#include <QDir>
 #include <QJsonDocument>
 #include <QJsonArray>
 #include <QJsonObject>
 #include <QSqlDatabase>
 #include <QSqlQuery>
+#include <QSignalSpy>
 #include <QStandardPaths>
 #include <QUuid>
 
+#include <memory>
+
+#include "costmicros.h"
+#include "snapshotcursor.h"
 #include "usagedatabase.h"
 
 namespace {
@@ -27,10 +33,10 @@ bool setSnapshotTimestamp(const QString &provider, double cost, const QString &t
         if (db.open()) {
             QSqlQuery query(db);
             query.prepare(QStringLiteral(
-                "UPDATE usage_snapshots SET timestamp = ? WHERE provider = ? AND ABS(cost - ?) < 0.00001"));
+                "UPDATE usage_snapshots SET timestamp = ? WHERE provider = ? AND cost_micros = ?"));
             query.addBindValue(timestamp);
             query.addBindValue(provider);
-            query.addBindValue(cost);
+            query.addBindValue(CostMicros::fromDollars(cost));
             ok = query.exec() && query.numRowsAffected() > 0;
             db.close();
         }
@@ -38,6 +44,37 @@ bool setSnapshotTimestamp(const QString &provider, double cost, const QString &t
     QSqlDatabase::removeDatabase(connName);
     return ok;
 }
+
+/**
+ * Insert snapshot rows that share timestamps, bypassing the write throttle.
+ * Rows get cost 0..count-1 and every three rows share one timestamp.
+ */
+bool insertTiedSnapshots(const QString &provider, int count, const QDateTime &start)
+{
+    const QString connName = QStringLiteral("ext_test_%1").arg(QUuid::createUuid().toString(QUuid::WithoutBraces));
+    bool ok = false;
+    {
+        QSqlDatabase db = QSqlDatabase::addDatabase(QStringLiteral("QSQLITE"), connName);
+        db.setDatabaseName(
+            QStandardPaths::writableLocation(QStandardPaths::GenericDataLocation)
+            + QStringLiteral("/plasma-ai-usage-monitor/usage_history.db"));
+        if (db.open()) {
+            QSqlQuery query(db);
+            query.prepare(QStringLiteral(
+                "INSERT INTO usage_snapshots (timestamp, provider, cost_micros) VALUES (?, ?, ?)"));
+            ok = true;
+            for (int i = 0; i < count && ok; ++i) {
+                query.addBindValue(start.addSecs((i / 3) * 60).toString(QStringLiteral("yyyy-MM-dd HH:mm:ss")));
+                query.addBindValue(provider);
+                query.addBindValue(CostMicros::fromDollars(i));
+                ok = query.exec();
+            }
+            db.close();
+        }
+    }
+    QSqlDatabase::removeDatabase(connName);
+    return ok;
+}
 } // namespace
 
 class UsageDatabaseExtendedTest : public QObject
@@ -54,6 +91,16 @@ private Q_SLOTS:
     void testGetDailyCosts();
     void testPruneOldData();
     void testDisabledRecording();
+    void testSnapshotCursorPaging();
+    void testSnapshotCursorEmptyRange();
+    void testBackupTo();
+    void testBackupRotation();
+    void testScheduledBackupFollowsLastBackup();
+    void testCostsStoredAsMicros();
+    void testLegacyRealCostsMigrated();
+    void testBillingLedger();
+    void testLatencySeries();
+    void testAccountSnapshots();
 };
 
 void UsageDatabaseExtendedTest::testRetentionDaysClamping()
@@ -269,5 +316,417 @@ void UsageDatabaseExtendedTest::testDisabledRecording()
     QCOMPARE(snapshots.size(), 0);
 }
 
+void UsageDatabaseExtendedTest::testSnapshotCursorPaging()
+{
+    QTemporaryDir tmp;
+    QVERIFY(tmp.isValid());
+    qputenv("XDG_DATA_HOME", tmp.path().toUtf8());
+
+    UsageDatabase db;
+    db.init();
+
+    const QDateTime start = QDateTime::currentDateTimeUtc().addSecs(-3600);
+    QVERIFY(insertTiedSnapshots(QStringLiteral("CursorProv"), 11, start));
+    QVERIFY(insertTiedSnapshots(QStringLiteral("OtherProv"), 4, start));
+
+    // Page boundaries fall inside groups of rows with the same timestamp
+    std::unique_ptr<SnapshotCursor> cursor(db.openSnapshotCursor(
+        QStringLiteral("CursorProv"), start, QDateTime::currentDateTimeUtc(), 4));
+    QCOMPARE(cursor->pageSize(), 4);
+
+    QList<int> costs;
+    QList<int> pageSizes;
+    while (!cursor->atEnd()) {
+        const QVariantList page = cursor->nextPage();
+        pageSizes.append(page.size());
+        for (const QVariant &row : page)
+            costs.append(qRound(row.toMap().value(QStringLiteral("cost")).toDouble()));
+    }
+
+    QCOMPARE(pageSizes, (QList<int>{4, 4, 3}));
+    QCOMPARE(cursor->rowsRead(), 11);
+    QCOMPARE(costs.size(), 11);
+    for (int i = 0; i < costs.size(); ++i)
+        QCOMPARE(costs.at(i), i);
+    QVERIFY(cursor->nextPage().isEmpty());
+
+    // getSnapshots and exports return the same rows
+    QCOMPARE(db.getSnapshots(QStringLiteral("CursorProv"), start, QDateTime::currentDateTimeUtc()).size(), 11);
+    const QStringList csvLines = db.exportCsv(QStringLiteral("CursorProv"), start, QDateTime::currentDateTimeUtc())
+                                     .split(QLatin1Char('\n'), Qt::SkipEmptyParts);
+    QCOMPARE(csvLines.size(), 12);
+}
+
+void UsageDatabaseExtendedTest::testSnapshotCursorEmptyRange()
+{
+    QTemporaryDir tmp;
+    QVERIFY(tmp.isValid());
+    qputenv("XDG_DATA_HOME", tmp.path().toUtf8());
+
+    UsageDatabase uninitialized;
+    std::unique_ptr<SnapshotCursor> unopened(uninitialized.openSnapshotCursor(
+        QStringLiteral("Any"), QDateTime::currentDateTimeUtc().addDays(-1), QDateTime::currentDateTimeUtc()));
+    QVERIFY(unopened->atEnd());
+
+    UsageDatabase db;
+    db.init();
+    std::unique_ptr<SnapshotCursor> cursor(db.openSnapshotCursor(
+        QStringLiteral("Missing"), QDateTime::currentDateTimeUtc().addDays(-1), QDateTime::currentDateTimeUtc(), 10));
+    QVERIFY(!cursor->atEnd());
+    QVERIFY(cursor->nextPage().isEmpty());
+    QVERIFY(cursor->atEnd());
+}
+
+void UsageDatabaseExtendedTest::testBackupTo()
+{
+    QTemporaryDir tmp;
+    QVERIFY(tmp.isValid());
+    qputenv("XDG_DATA_HOME", tmp.path().toUtf8());
+
+    UsageDatabase db;
+    db.init();
+    db.recordSnapshot(QStringLiteral("BackupProv"), 100, 50, 10, 4.0, 4.0, 40.0, 0, 0, 0, 0);
+
+    QSignalSpy finishedSpy(&db, &UsageDatabase::backupFinished);
+    const QString target = tmp.path() + QStringLiteral("/copies/manual.db");
+    QVERIFY(db.backupTo(target));
+    QVERIFY(db.isBackupRunning());
+    QVERIFY(!db.backupTo(target)); // only one backup at a time
+
+    // Writes keep working while the backup runs
+    db.recordSnapshot(QStringLiteral("BackupProv"), 200, 100, 20, 5.0, 5.0, 50.0, 0, 0, 0, 0);
+
+    QVERIFY(finishedSpy.wait(10000));
+    const QList<QVariant> args = finishedSpy.takeFirst();
+    QVERIFY2(args.at(0).toBool(), qPrintable(args.at(4).toString()));
+    QCOMPARE(args.at(1).toString(), target);
+    QVERIFY(args.at(2).toLongLong() > 0);
+    QVERIFY(args.at(3).toDouble() > 0.0);
+    QVERIFY(!db.isBackupRunning());
+    QCOMPARE(db.backupProgress(), 1.0);
+    QVERIFY(!QFile::exists(target + QStringLiteral(".part")));
+
+    // The copy is a standalone database with the recorded rows
+    const QString connName = QStringLiteral("ext_backup_%1").arg(QUuid::createUuid().toString(QUuid::WithoutBraces));
+    int rows = -1;
+    {
+        QSqlDatabase copy = QSqlDatabase::addDatabase(QStringLiteral("QSQLITE"), connName);
+        copy.setDatabaseName(target);
+        QVERIFY(copy.open());
+        QSqlQuery query(copy);
+        QVERIFY(query.exec(QStringLiteral("SELECT COUNT(*) FROM usage_snapshots WHERE provider = 'BackupProv'")));
+        QVERIFY(query.next());
+        rows = query.value(0).toInt();
+        copy.close();
+    }
+    QSqlDatabase::removeDatabase(connName);
+    QVERIFY(rows >= 1);
+}
+
+void UsageDatabaseExtendedTest::testBackupRotation()
+{
+    QTemporaryDir tmp;
+    QVERIFY(tmp.isValid());
+    qputenv("XDG_DATA_HOME", tmp.path().toUtf8());
+
+    UsageDatabase db;
+    db.init();
+    db.setBackupDirectory(tmp.path() + QStringLiteral("/rotating"));
+    db.setBackupKeepCount(2);
+
+    // Pre-existing older backups that should be rotated out
+    QDir().mkpath(db.backupDirectory());
+    for (const QString &name : {QStringLiteral("usage_history-20200101-000000.db"),
+                                QStringLiteral("usage_history-20200102-000000.db"),
+                                QStringLiteral("usage_history-20200103-000000.db")}) {
+        QFile file(db.backupDirectory() + QLatin1Char('/') + name);
+        QVERIFY(file.open(QIODevice::WriteOnly));
+    }
+
+    QSignalSpy finishedSpy(&db, &UsageDatabase::backupFinished);
+    const QString path = db.backupNow();
+    QVERIFY(!path.isEmpty());
+    QVERIFY(finishedSpy.wait(10000));
+    QVERIFY(finishedSpy.first().at(0).toBool());
+
+    const QStringList remaining = QDir(db.backupDirectory())
+        .entryList({QStringLiteral("usage_history-*.db")}, QDir::Files, QDir::Name);
+    QCOMPARE(remaining.size(), 2);
+    QCOMPARE(remaining.last(), QFileInfo(path).fileName());
+    QCOMPARE(remaining.first(), QStringLiteral("usage_history-20200103-000000.db"));
+}
+
+void UsageDatabaseExtendedTest::testScheduledBackupFollowsLastBackup()
+{
+    QTemporaryDir tmp;
+    QVERIFY(tmp.isValid());
+    qputenv("XDG_DATA_HOME", tmp.path().toUtf8());
+
+    UsageDatabase db;
+    db.init();
+    db.setBackupDirectory(tmp.path() + QStringLiteral("/scheduled"));
+    QDir().mkpath(db.backupDirectory());
+
+    // A backup from an hour ago is recent enough for a daily interval
+    const QString recent = QStringLiteral("usage_history-%1.db")
+        .arg(QDateTime::currentDateTimeUtc().addSecs(-3600).toString(QStringLiteral("yyyyMMdd-HHmmss")));
+    QFile recentFile(db.backupDirectory() + QLatin1Char('/') + recent);
+    QVERIFY(recentFile.open(QIODevice::WriteOnly));
+    recentFile.close();
+
+    QSignalSpy finishedSpy(&db, &UsageDatabase::backupFinished);
+    db.setBackupIntervalHours(24);
+    QTest::qWait(100);
+    QVERIFY(!db.isBackupRunning());
+    QCOMPARE(finishedSpy.count(), 0);
+
+    // The longest interval must not overflow the check
+    db.setBackupIntervalHours(24 * 30);
+    QCOMPARE(db.backupIntervalHours(), 720);
+    QTest::qWait(100);
+    QCOMPARE(finishedSpy.count(), 0);
+
+    // Past the interval, the check backs up right away
+    db.setBackupIntervalHours(0);
+    QVERIFY(QFile::remove(recentFile.fileName()));
+    db.setBackupIntervalHours(1);
+    QVERIFY(finishedSpy.wait(10000));
+    QVERIFY(finishedSpy.first().at(0).toBool());
+}
+
+void UsageDatabaseExtendedTest::testCostsStoredAsMicros()
+{
+    QTemporaryDir tmp;
+    QVERIFY(tmp.isValid());
+    qputenv("XDG_DATA_HOME", tmp.path().toUtf8());
+
+    UsageDatabase db;
+    db.init();
+
+    // 0.1 + 0.2 is not 0.3 in binary floating point
+    db.recordSnapshot(QStringLiteral("MicroProv"), 100, 50, 5, 0.1 + 0.2, 0.000001, 1234.567891, 0, 0, 0, 0);
+
+    const QDateTime from = QDateTime::currentDateTimeUtc().addSecs(-3600);
+    const QDateTime to = QDateTime::currentDateTimeUtc().addSecs(3600);
+
+    const QVariantList snapshots = db.getSnapshots(QStringLiteral("MicroProv"), from, to);
+    QCOMPARE(snapshots.size(), 1);
+    const QVariantMap row = snapshots.first().toMap();
+    QCOMPARE(row.value(QStringLiteral("costMicros")).toLongLong(), 300000);
+    QCOMPARE(row.value(QStringLiteral("dailyCostMicros")).toLongLong(), 1);
+    QCOMPARE(row.value(QStringLiteral("monthlyCostMicros")).toLongLong(), Q_INT64_C(1234567891));
+    QCOMPARE(row.value(QStringLiteral("cost")).toDouble(), 0.3);
+
+    const QStringList lines = db.exportCsv(QStringLiteral("MicroProv"), from, to)
+                                  .split(QLatin1Char('\n'), Qt::SkipEmptyParts);
+    QCOMPARE(lines.size(), 2);
+    QVERIFY2(lines.at(1).contains(QStringLiteral(",0.300000,0.000001,1234.567891,")), qPrintable(lines.at(1)));
+
+    QCOMPARE(db.getSummary(QStringLiteral("MicroProv"), from, to).value(QStringLiteral("totalCost")).toDouble(), 0.3);
+}
+
+void UsageDatabaseExtendedTest::testLegacyRealCostsMigrated()
+{
+    QTemporaryDir tmp;
+    QVERIFY(tmp.isValid());
+    qputenv("XDG_DATA_HOME", tmp.path().toUtf8());
+
+    const QString dataDir = tmp.path() + QStringLiteral("/plasma-ai-usage-monitor");
+    QVERIFY(QDir().mkpath(dataDir));
+
+    // Database as written by releases that stored costs as REAL dollars
+    const QString connName = QStringLiteral("ext_test_%1").arg(QUuid::createUuid().toString(QUuid::WithoutBraces));
+    {
+        QSqlDatabase legacy = QSqlDatabase::addDatabase(QStringLiteral("QSQLITE"), connName);
+        legacy.setDatabaseName(dataDir + QStringLiteral("/usage_history.db"));
+        QVERIFY(legacy.open());
+        QSqlQuery query(legacy);
+        QVERIFY(query.exec(QStringLiteral(
+            "CREATE TABLE usage_snapshots ("
+            "  id INTEGER PRIMARY KEY AUTOINCREMENT,"
+            "  timestamp DATETIME DEFAULT (datetime('now')),"
+            "  provider TEXT NOT NULL,"
+            "  input_tokens INTEGER DEFAULT 0,"
+            "  output_tokens INTEGER DEFAULT 0,"
+            "  request_count INTEGER DEFAULT 0,"
+            "  cost REAL DEFAULT 0.0,"
+            "  daily_cost REAL DEFAULT 0.0,"
+            "  monthly_cost REAL DEFAULT 0.0,"
+            "  rl_requests INTEGER DEFAULT 0,"
+            "  rl_requests_remaining INTEGER DEFAULT 0,"
+            "  rl_tokens INTEGER DEFAULT 0,"
+            "  rl_tokens_remaining INTEGER DEFAULT 0)")));
+        QVERIFY(query.exec(QStringLiteral(
+            "CREATE INDEX idx_snapshots_provider_time ON usage_snapshots(provider, timestamp)")));
+        QVERIFY(query.exec(QStringLiteral(
+            "INSERT INTO usage_snapshots (provider, request_count, cost, daily_cost, monthly_cost) "
+            "VALUES ('Legacy', 7, 0.1 + 0.2, 1.2345675, 42.5)")));
+        legacy.close();
+    }
+    QSqlDatabase::removeDatabase(connName);
+
+    UsageDatabase db;
+    db.init();
+
+    const QDateTime from = QDateTime::currentDateTimeUtc().addSecs(-3600);
+    const QDateTime to = QDateTime::currentDateTimeUtc().addSecs(3600);
+
+    const QVariantList snapshots = db.getSnapshots(QStringLiteral("Legacy"), from, to);
+    QCOMPARE(snapshots.size(), 1);
+    const QVariantMap row = snapshots.first().toMap();
+    QCOMPARE(row.value(QStringLiteral("requestCount")).toInt(), 7);
+    QCOMPARE(row.value(QStringLiteral("costMicros")).toLongLong(), 300000);
+    QCOMPARE(row.value(QStringLiteral("dailyCostMicros")).toLongLong(), 1234568);
+    QCOMPARE(row.value(QStringLiteral("monthlyCostMicros")).toLongLong(), 42500000);
+
+    // Re-opening a migrated database leaves it alone
+    UsageDatabase reopened;
+    reopened.init();
+    QCOMPARE(reopened.getSnapshots(QStringLiteral("Legacy"), from, to).size(), 1);
+    QVERIFY(reopened.queryPlan(QStringLiteral("summary")).contains(QStringLiteral("idx_snapshots_covering")));
+}
+
+void UsageDatabaseExtendedTest::testBillingLedger()
+{
+    QTemporaryDir tmp;
+    QVERIFY(tmp.isValid());
+    qputenv("XDG_DATA_HOME", tmp.path().toUtf8());
+
+    UsageDatabase db;
+    db.init();
+
+    const QString provider = QStringLiteral("OpenAI");
+    const QString account = QStringLiteral("acct");
+    const QString costs = QStringLiteral("costs");
+    const QDate today = QDateTime::currentDateTimeUtc().date();
+    const QDate yesterday = today.addDays(-1);
+    QVERIFY(!db.ledgerClosedThrough(provider, account, costs).isValid());
+
+    auto entry = [](const QDate &day, const QString &project, const QString &model, double dollars) {
+        UsageDatabase::LedgerEntry e;
+        e.day = day;
+        e.project = project;
+        e.model = model;
+        e.costMicros = CostMicros::fromDollars(dollars);
+        return e;
+    };
+
+    // Same key twice within one write is summed
+    QVERIFY(db.writeLedger(provider, account, costs, yesterday, today,
+                           {entry(yesterday, QStringLiteral("p1"), QStringLiteral("m1"), 1.0),
+                            entry(today, QStringLiteral("p1"), QStringLiteral("m1"), 2.0),
+                            entry(today, QStringLiteral("p1"), QStringLiteral("m1"), 0.5),
+                            entry(today, QStringLiteral("p2"), QStringLiteral("m2"), 4.0)},
+                           yesterday));
+    QCOMPARE(db.ledgerClosedThrough(provider, account, costs), yesterday);
+    QCOMPARE(db.ledgerTotals(provider, account, costs, yesterday, today).costMicros, 7500000);
+    QCOMPARE(db.ledgerTotals(provider, account, costs, today, today, QStringLiteral("p1")).costMicros, 2500000);
+    QCOMPARE(db.ledgerTotals(provider, account, costs, yesterday, today, QString(), QStringLiteral("m2")).costMicros, 4000000);
+    QCOMPARE(db.ledgerTotals(provider, QStringLiteral("other"), costs, yesterday, today).costMicros, 0);
+
+    // Rewriting today replaces its rows and leaves closed days alone; the
+    // mark never moves back
+    QVERIFY(db.writeLedger(provider, account, costs, today, today,
+                           {entry(today, QStringLiteral("p1"), QStringLiteral("m1"), 3.0)},
+                           yesterday.addDays(-5)));
+    QCOMPARE(db.ledgerTotals(provider, account, costs, yesterday, today).costMicros, 4000000);
+    QCOMPARE(db.ledgerClosedThrough(provider, account, costs), yesterday);
+
+    db.setEnabled(false);
+    QVERIFY(!db.writeLedger(provider, account, costs, today, today, {}, today));
+}
+
+void UsageDatabaseExtendedTest::testLatencySeries()
+{
+    QTemporaryDir tmp;
+    QVERIFY(tmp.isValid());
+    qputenv("XDG_DATA_HOME", tmp.path().toUtf8());
+
+    UsageDatabase db;
+    db.init();
+
+    const auto phase = [](qint64 p50, qint64 p95) {
+        return QVariantMap{{QStringLiteral("p50Ms"), p50}, {QStringLiteral("p95Ms"), p95}};
+    };
+    QVariantMap stats;
+    stats[QStringLiteral("requests")] = 4;
+    stats[QStringLiteral("failures")] = 1;
+    stats[QStringLiteral("phases")] = QVariantMap{
+        {QStringLiteral("dns"), phase(3, 9)},
+        {QStringLiteral("connect"), phase(40, 80)},
+        {QStringLiteral("ttfb"), phase(120, 300)},
+        {QStringLiteral("total"), phase(180, 420)},
+    };
+    db.recordNetworkStats(QStringLiteral("OpenAI"), stats);
+
+    // An empty window is not worth a row
+    db.recordNetworkStats(QStringLiteral("OpenAI"), QVariantMap{{QStringLiteral("requests"), 0}});
+
+    const QDateTime from = QDateTime::currentDateTimeUtc().addSecs(-3600);
+    const QDateTime to = QDateTime::currentDateTimeUtc().addSecs(3600);
+    const QVariantList series = db.getLatencySeries(QStringLiteral("OpenAI"), from, to);
+    QCOMPARE(series.size(), 1);
+
+    const QVariantMap row = series.first().toMap();
+    QCOMPARE(row.value(QStringLiteral("requests")).toInt(), 4);
+    QCOMPARE(row.value(QStringLiteral("failures")).toInt(), 1);
+    QCOMPARE(row.value(QStringLiteral("dnsP50Ms")).toLongLong(), 3);
+    QCOMPARE(row.value(QStringLiteral("connectP50Ms")).toLongLong(), 40);
+    QCOMPARE(row.value(QStringLiteral("ttfbP50Ms")).toLongLong(), 120);
+    QCOMPARE(row.value(QStringLiteral("totalP50Ms")).toLongLong(), 180);
+    QCOMPARE(row.value(QStringLiteral("totalP95Ms")).toLongLong(), 420);
+    QVERIFY(db.getLatencySeries(QStringLiteral("Anthropic"), from, to).isEmpty());
+}
+
+void UsageDatabaseExtendedTest::testAccountSnapshots()
+{
+    QTemporaryDir tmp;
+    QVERIFY(tmp.isValid());
+    qputenv("XDG_DATA_HOME", tmp.path().toUtf8());
+
+    UsageDatabase db;
+    db.init();
+
+    const auto account = [](const QString &id, qint64 costMicros, qint64 inputTokens) {
+        return QVariantMap{
+            {QStringLiteral("id"), id},
+            {QStringLiteral("costMicros"), costMicros},
+            {QStringLiteral("dailyCostMicros"), costMicros / 2},
+            {QStringLiteral("inputTokens"), inputTokens},
+            {QStringLiteral("requestCount"), 3},
+            {QStringLiteral("rateLimitRequests"), 100},
+            {QStringLiteral("rateLimitRequestsRemaining"), 40},
+        };
+    };
+    db.recordAccountSnapshots(QStringLiteral("OpenAI"),
+                              {account(QStringLiteral("team-b"), 2500000, 200),
+                               account(QStringLiteral("team-a"), 1250000, 100),
+                               QVariantMap{{QStringLiteral("costMicros"), 1}}}); // no id: skipped
+
+    // Unchanged accounts are throttled, changed ones are written
+    db.recordAccountSnapshots(QStringLiteral("OpenAI"),
+                              {account(QStringLiteral("team-b"), 2500000, 200),
+                               account(QStringLiteral("team-a"), 1500000, 150)});
+
+    QCOMPARE(db.getAccounts(QStringLiteral("OpenAI")),
+             QStringList({QStringLiteral("team-a"), QStringLiteral("team-b")}));
+    QVERIFY(db.getAccounts(QStringLiteral("Anthropic")).isEmpty());
+
+    const QDateTime from = QDateTime::currentDateTimeUtc().addSecs(-3600);
+    const QDateTime to = QDateTime::currentDateTimeUtc().addSecs(3600);
+    const QVariantList teamA = db.getAccountSeries(QStringLiteral("OpenAI"), QStringLiteral("team-a"), from, to);
+    QCOMPARE(teamA.size(), 2);
+    QCOMPARE(teamA.last().toMap().value(QStringLiteral("costMicros")).toLongLong(), 1500000);
+    QCOMPARE(teamA.last().toMap().value(QStringLiteral("cost")).toDouble(), 1.5);
+    QCOMPARE(teamA.last().toMap().value(QStringLiteral("dailyCost")).toDouble(), 0.75);
+    QCOMPARE(teamA.last().toMap().value(QStringLiteral("inputTokens")).toLongLong(), 150);
+    QCOMPARE(teamA.last().toMap().value(QStringLiteral("rlRequestsRemaining")).toInt(), 40);
+    QCOMPARE(db.getAccountSeries(QStringLiteral("OpenAI"), QStringLiteral("team-b"), from, to).size(), 1);
+
+    // Per-account rows stay out of the provider's own history
+    QVERIFY(db.getSnapshots(QStringLiteral("OpenAI"), from, to).isEmpty());
+    QVERIFY(!db.getProviders().contains(QStringLiteral("OpenAI")));
+}
+
 QTEST_MAIN(UsageDatabaseExtendedTest)
 #include "test_usagedatabase_extended.moc"
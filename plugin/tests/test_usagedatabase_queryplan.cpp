@@ -0,0 +1,118 @@
+#include <QtTest>
+
+#include <QRegularExpression>
+#include <QTemporaryDir>
+
+#include <memory>
+
+#include "usagedatabase.h"
+
+/**
+ * Guards the index design: every hot read path must be answered from its
+ * intended index. A schema or SQL edit that falls back to a table scan or
+ * an extra sort step fails here instead of silently slowing down charts.
+ */
+class UsageDatabaseQueryPlanTest : public QObject
+{
+    Q_OBJECT
+
+private Q_SLOTS:
+    void initTestCase();
+    void testEveryHotQueryIsExplained();
+    void testUsesIntendedIndex_data();
+    void testUsesIntendedIndex();
+    void testLegacyIndexesDropped();
+
+private:
+    QTemporaryDir m_tmp;
+    std::unique_ptr<UsageDatabase> m_db;
+};
+
+void UsageDatabaseQueryPlanTest::initTestCase()
+{
+    QVERIFY(m_tmp.isValid());
+    qputenv("XDG_DATA_HOME", m_tmp.path().toUtf8());
+
+    m_db = std::make_unique<UsageDatabase>();
+    m_db->init();
+
+    // A little data so the planner sees non-empty tables
+    m_db->recordSnapshot(QStringLiteral("OpenAI"), 100, 50, 10, 1.0, 1.0, 10.0, 100, 90, 1000, 950);
+    m_db->recordToolSnapshot(QStringLiteral("Codex CLI"), 10, 100, QStringLiteral("5-hour"), QStringLiteral("Pro"), false);
+    m_db->recordRateLimitEvent(QStringLiteral("OpenAI"), QStringLiteral("warning"), 85);
+}
+
+void UsageDatabaseQueryPlanTest::testEveryHotQueryIsExplained()
+{
+    const QStringList names = UsageDatabase::hotQueryNames();
+    QVERIFY(!names.isEmpty());
+    for (const QString &name : names) {
+        QVERIFY2(!m_db->queryPlan(name).isEmpty(), qPrintable(name));
+    }
+    QVERIFY(m_db->queryPlan(QStringLiteral("noSuchQuery")).isEmpty());
+}
+
+void UsageDatabaseQueryPlanTest::testUsesIntendedIndex_data()
+{
+    QTest::addColumn<QString>("queryName");
+    QTest::addColumn<QString>("expectedStep");
+
+    const QString snapshotsCovering = QStringLiteral("USING COVERING INDEX idx_snapshots_covering");
+    const QString toolCovering = QStringLiteral("USING COVERING INDEX idx_tool_usage_covering");
+
+    // Full-row reads use the index for the range and order, then fetch rows
+    QTest::newRow("snapshotPage") << QStringLiteral("snapshotPage")
+                                  << QStringLiteral("USING INDEX idx_snapshots_covering");
+    QTest::newRow("dailyCosts") << QStringLiteral("dailyCosts") << snapshotsCovering;
+    QTest::newRow("summary") << QStringLiteral("summary") << snapshotsCovering;
+    QTest::newRow("providerSeries") << QStringLiteral("providerSeries") << snapshotsCovering;
+    QTest::newRow("rateSeries") << QStringLiteral("rateSeries") << snapshotsCovering;
+    QTest::newRow("heatmapCounters") << QStringLiteral("heatmapCounters") << snapshotsCovering;
+    QTest::newRow("heatmapEvents") << QStringLiteral("heatmapEvents")
+                                   << QStringLiteral("USING COVERING INDEX idx_ratelimit_provider_time");
+    QTest::newRow("periodComparison") << QStringLiteral("periodComparison") << snapshotsCovering;
+    QTest::newRow("providers") << QStringLiteral("providers") << snapshotsCovering;
+    QTest::newRow("toolSnapshots") << QStringLiteral("toolSnapshots")
+                                   << QStringLiteral("USING INDEX idx_tool_usage_covering");
+    QTest::newRow("toolSeries") << QStringLiteral("toolSeries") << toolCovering;
+    QTest::newRow("toolNames") << QStringLiteral("toolNames") << toolCovering;
+    QTest::newRow("ledgerTotals") << QStringLiteral("ledgerTotals")
+                                  << QStringLiteral("USING PRIMARY KEY (provider=? AND account=? AND source=? AND day>? AND day<?)");
+    QTest::newRow("latencySeries") << QStringLiteral("latencySeries")
+                                   << QStringLiteral("USING COVERING INDEX idx_latency_covering");
+    QTest::newRow("accountSeries") << QStringLiteral("accountSeries")
+                                   << QStringLiteral("USING COVERING INDEX idx_account_snapshots_covering");
+    QTest::newRow("accounts") << QStringLiteral("accounts")
+                              << QStringLiteral("USING COVERING INDEX idx_account_snapshots_covering");
+}
+
+void UsageDatabaseQueryPlanTest::testUsesIntendedIndex()
+{
+    QFETCH(QString, queryName);
+    QFETCH(QString, expectedStep);
+
+    QVERIFY(UsageDatabase::hotQueryNames().contains(queryName));
+
+    const QString plan = m_db->queryPlan(queryName);
+    QVERIFY2(plan.contains(expectedStep), qPrintable(plan));
+
+    // No bare table scans and no sort for ORDER BY / window ordering
+    static const QRegularExpression bareScan(QStringLiteral("^SCAN (usage_snapshots|subscription_tool_usage|rate_limit_events|billing_ledger|api_latency|account_snapshots)$"),
+                                             QRegularExpression::MultilineOption);
+    QVERIFY2(!bareScan.match(plan).hasMatch(), qPrintable(plan));
+    QVERIFY2(!plan.contains(QStringLiteral("TEMP B-TREE FOR ORDER BY")), qPrintable(plan));
+    QVERIFY2(!plan.contains(QStringLiteral("TEMP B-TREE FOR RIGHT PART OF ORDER BY")), qPrintable(plan));
+}
+
+void UsageDatabaseQueryPlanTest::testLegacyIndexesDropped()
+{
+    // The covering indexes supersede the original narrow ones
+    for (const QString &name : UsageDatabase::hotQueryNames()) {
+        const QString plan = m_db->queryPlan(name);
+        QVERIFY2(!plan.contains(QStringLiteral("idx_snapshots_provider_time")), qPrintable(plan));
+        QVERIFY2(!plan.contains(QStringLiteral("idx_tool_usage_name_time")), qPrintable(plan));
+    }
+}
+
+QTEST_MAIN(UsageDatabaseQueryPlanTest)
+#include "test_usagedatabase_queryplan.moc"
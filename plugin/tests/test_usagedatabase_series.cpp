@@ -8,6 +8,7 @@
 #include <QUuid>
 #include <cmath>
 
+#include "costmicros.h"
 #include "usagedatabase.h"
 
 namespace {
@@ -30,11 +31,11 @@ bool updateProviderSnapshotTimestamp(const QString &provider, double cost, const
             QSqlQuery query(db);
             query.prepare(QStringLiteral(
                 "UPDATE usage_snapshots SET timestamp = ? "
-                "WHERE provider = ? AND ABS(cost - ?) < 0.00001"
+                "WHERE provider = ? AND cost_micros = ?"
             ));
             query.addBindValue(timestamp);
             query.addBindValue(provider);
-            query.addBindValue(cost);
+            query.addBindValue(CostMicros::fromDollars(cost));
 
             ok = query.exec() && query.numRowsAffected() > 0;
             if (!ok) {
@@ -77,6 +78,31 @@ bool updateToolSnapshotTimestamp(const QString &tool, int usageCount, const QStr
     return ok;
 }
 
+bool setRateLimitEventTimestamps(const QString &timestamp)
+{
+    const QString connName = QStringLiteral("event_test_conn_%1").arg(QUuid::createUuid().toString(QUuid::WithoutBraces));
+    bool ok = false;
+    {
+        QSqlDatabase db = QSqlDatabase::addDatabase(QStringLiteral("QSQLITE"), connName);
+        db.setDatabaseName(dbFilePath());
+        if (db.open()) {
+            QSqlQuery query(db);
+            query.prepare(QStringLiteral("UPDATE rate_limit_events SET timestamp = ?"));
+            query.addBindValue(timestamp);
+            ok = query.exec() && query.numRowsAffected() > 0;
+            db.close();
+        }
+    }
+    QSqlDatabase::removeDatabase(connName);
+    return ok;
+}
+
+int heatmapCell(const QString &utcTimestamp)
+{
+    const QDateTime local = QDateTime::fromString(utcTimestamp, Qt::ISODate).toLocalTime();
+    return (local.date().dayOfWeek() % 7) * 24 + local.time().hour();
+}
+
 double pointValue(const QVariantList &points, int index)
 {
     return points.at(index).toMap().value(QStringLiteral("value")).toDouble();
@@ -89,6 +115,9 @@ class UsageDatabaseSeriesTest : public QObject
 
 private Q_SLOTS:
     void providerSeriesMetrics();
+    void providerRateMetrics();
+    void usageHeatmap();
+    void comparePeriods();
     void toolSeriesMetrics();
 };
 
@@ -152,6 +181,179 @@ void UsageDatabaseSeriesTest::providerSeriesMetrics()
     QVERIFY(std::abs(pointValue(bucketedCostPoints, 1) - 4.0) < 0.01);
 }
 
+void UsageDatabaseSeriesTest::providerRateMetrics()
+{
+    QTemporaryDir tmp;
+    QVERIFY(tmp.isValid());
+    qputenv("XDG_DATA_HOME", tmp.path().toUtf8());
+
+    UsageDatabase db;
+    db.init();
+
+    db.recordSnapshot(QStringLiteral("OpenAI"), 100, 50, 10, 1.0, 1.0, 10.0, 0, 0, 0, 0);
+    db.recordSnapshot(QStringLiteral("OpenAI"), 250, 100, 20, 2.0, 2.0, 20.0, 0, 0, 0, 0);
+    db.recordSnapshot(QStringLiteral("OpenAI"), 400, 200, 40, 4.0, 4.0, 40.0, 0, 0, 0, 0);
+    // Counters reset at a period boundary
+    db.recordSnapshot(QStringLiteral("OpenAI"), 30, 20, 5, 0.5, 0.5, 0.5, 0, 0, 0, 0);
+
+    QVERIFY(updateProviderSnapshotTimestamp(QStringLiteral("OpenAI"), 1.0, QStringLiteral("2026-01-01 00:00:00")));
+    QVERIFY(updateProviderSnapshotTimestamp(QStringLiteral("OpenAI"), 2.0, QStringLiteral("2026-01-01 01:00:00")));
+    QVERIFY(updateProviderSnapshotTimestamp(QStringLiteral("OpenAI"), 4.0, QStringLiteral("2026-01-01 02:00:00")));
+    QVERIFY(updateProviderSnapshotTimestamp(QStringLiteral("OpenAI"), 0.5, QStringLiteral("2026-01-01 02:30:00")));
+
+    const QDateTime from = QDateTime::fromString(QStringLiteral("2026-01-01T00:00:00Z"), Qt::ISODate);
+    const QDateTime to = QDateTime::fromString(QStringLiteral("2026-01-01T03:00:00Z"), Qt::ISODate);
+
+    // Bucket 01:00 holds the 00:00→01:00 interval (+200 tokens in 60 min).
+    // Bucket 02:00 holds 01:00→02:00 (+250) and the reset 02:00→02:30 (+50),
+    // i.e. 300 tokens over 90 minutes.
+    const QVariantList tokenRate = db.getProviderSeries({QStringLiteral("OpenAI")}, from, to,
+                                                        QStringLiteral("tokensPerMinute"), 60);
+    QCOMPARE(tokenRate.size(), 1);
+    const QVariantMap tokenRateMap = tokenRate.first().toMap();
+    QCOMPARE(tokenRateMap.value(QStringLiteral("sampleCount")).toInt(), 3);
+    const QVariantList tokenRatePoints = tokenRateMap.value(QStringLiteral("points")).toList();
+    QCOMPARE(tokenRatePoints.size(), 2);
+    QCOMPARE(tokenRatePoints.at(0).toMap().value(QStringLiteral("timestamp")).toString(),
+             QStringLiteral("2026-01-01T01:00:00Z"));
+    QVERIFY(std::abs(pointValue(tokenRatePoints, 0) - 200.0 / 60.0) < 0.001);
+    QVERIFY(std::abs(pointValue(tokenRatePoints, 1) - 300.0 / 90.0) < 0.001);
+
+    const QVariantList costRate = db.getProviderSeries({QStringLiteral("OpenAI")}, from, to,
+                                                       QStringLiteral("costPerHour"), 60);
+    QCOMPARE(costRate.size(), 1);
+    const QVariantList costRatePoints = costRate.first().toMap().value(QStringLiteral("points")).toList();
+    QCOMPARE(costRatePoints.size(), 2);
+    QVERIFY(std::abs(pointValue(costRatePoints, 0) - 1.0) < 0.001);
+    QVERIFY(std::abs(pointValue(costRatePoints, 1) - 2.5 / 1.5) < 0.001);
+
+    const QVariantList requestRate = db.getProviderSeries({QStringLiteral("OpenAI")}, from, to,
+                                                          QStringLiteral("requestsPerMinute"), 180);
+    QCOMPARE(requestRate.size(), 1);
+    const QVariantList requestRatePoints = requestRate.first().toMap().value(QStringLiteral("points")).toList();
+    QCOMPARE(requestRatePoints.size(), 1);
+    // +10, +20, then 5 after the reset, over 150 minutes
+    QVERIFY(std::abs(pointValue(requestRatePoints, 0) - 35.0 / 150.0) < 0.001);
+}
+
+void UsageDatabaseSeriesTest::usageHeatmap()
+{
+    QTemporaryDir tmp;
+    QVERIFY(tmp.isValid());
+    qputenv("XDG_DATA_HOME", tmp.path().toUtf8());
+
+    UsageDatabase db;
+    db.init();
+
+    db.recordSnapshot(QStringLiteral("OpenAI"), 100, 50, 10, 1.0, 1.0, 10.0, 0, 0, 0, 0);
+    db.recordSnapshot(QStringLiteral("OpenAI"), 250, 100, 20, 2.0, 2.0, 20.0, 0, 0, 0, 0);
+    db.recordSnapshot(QStringLiteral("OpenAI"), 400, 200, 40, 4.0, 4.0, 40.0, 0, 0, 0, 0);
+    db.recordSnapshot(QStringLiteral("Mistral"), 10, 10, 1, 0.1, 0.1, 0.1, 0, 0, 0, 0);
+    db.recordSnapshot(QStringLiteral("Mistral"), 60, 60, 2, 0.2, 0.2, 0.2, 0, 0, 0, 0);
+    db.recordRateLimitEvent(QStringLiteral("OpenAI"), QStringLiteral("warning"), 85);
+    db.recordRateLimitEvent(QStringLiteral("OpenAI"), QStringLiteral("exceeded"), 100);
+
+    QVERIFY(updateProviderSnapshotTimestamp(QStringLiteral("OpenAI"), 1.0, QStringLiteral("2026-01-01 00:00:00")));
+    QVERIFY(updateProviderSnapshotTimestamp(QStringLiteral("OpenAI"), 2.0, QStringLiteral("2026-01-01 01:00:00")));
+    QVERIFY(updateProviderSnapshotTimestamp(QStringLiteral("OpenAI"), 4.0, QStringLiteral("2026-01-01 02:00:00")));
+    QVERIFY(updateProviderSnapshotTimestamp(QStringLiteral("Mistral"), 0.1, QStringLiteral("2026-01-01 00:10:00")));
+    QVERIFY(updateProviderSnapshotTimestamp(QStringLiteral("Mistral"), 0.2, QStringLiteral("2026-01-01 01:10:00")));
+    QVERIFY(setRateLimitEventTimestamps(QStringLiteral("2026-01-01 02:05:00")));
+
+    const QDateTime from = QDateTime::fromString(QStringLiteral("2026-01-01T00:00:00Z"), Qt::ISODate);
+    const QDateTime to = QDateTime::fromString(QStringLiteral("2026-01-01T03:00:00Z"), Qt::ISODate);
+    const int cell01 = heatmapCell(QStringLiteral("2026-01-01T01:00:00Z"));
+    const int cell02 = heatmapCell(QStringLiteral("2026-01-01T02:00:00Z"));
+
+    const QList<double> openaiTokens = db.getUsageHeatmap({QStringLiteral("OpenAI")}, from, to, QStringLiteral("tokens"));
+    QCOMPARE(openaiTokens.size(), 168);
+    QCOMPARE(openaiTokens.at(cell01), 200.0);
+    QCOMPARE(openaiTokens.at(cell02), 250.0);
+    double total = 0.0;
+    for (double value : openaiTokens)
+        total += value;
+    QCOMPARE(total, 450.0);
+
+    // Counters are differenced per provider, never across providers
+    const QList<double> allTokens = db.getUsageHeatmap({}, from, to, QStringLiteral("tokens"));
+    QCOMPARE(allTokens.at(cell01), 300.0);
+    QCOMPARE(allTokens.at(cell02), 250.0);
+
+    const QList<double> events = db.getUsageHeatmap({QStringLiteral("OpenAI")}, from, to, QStringLiteral("rateLimitEvents"));
+    QCOMPARE(events.at(cell02), 2.0);
+
+    const QList<double> unknown = db.getUsageHeatmap({}, from, to, QStringLiteral("bogus"));
+    QCOMPARE(unknown.size(), 168);
+    QCOMPARE(unknown.at(cell01), 0.0);
+}
+
+void UsageDatabaseSeriesTest::comparePeriods()
+{
+    QTemporaryDir tmp;
+    QVERIFY(tmp.isValid());
+    qputenv("XDG_DATA_HOME", tmp.path().toUtf8());
+
+    UsageDatabase db;
+    db.init();
+
+    db.recordSnapshot(QStringLiteral("OpenAI"), 100, 50, 10, 1.0, 1.0, 10.0, 0, 0, 0, 0);
+    db.recordSnapshot(QStringLiteral("OpenAI"), 250, 100, 20, 2.0, 2.0, 20.0, 0, 0, 0, 0);
+    db.recordSnapshot(QStringLiteral("OpenAI"), 400, 200, 40, 4.0, 4.0, 40.0, 0, 0, 0, 0);
+    // Counters reset at a period boundary
+    db.recordSnapshot(QStringLiteral("OpenAI"), 30, 20, 5, 0.5, 0.5, 0.5, 0, 0, 0, 0);
+
+    QVERIFY(updateProviderSnapshotTimestamp(QStringLiteral("OpenAI"), 1.0, QStringLiteral("2026-01-01 00:00:00")));
+    QVERIFY(updateProviderSnapshotTimestamp(QStringLiteral("OpenAI"), 2.0, QStringLiteral("2026-01-01 01:00:00")));
+    QVERIFY(updateProviderSnapshotTimestamp(QStringLiteral("OpenAI"), 4.0, QStringLiteral("2026-01-02 00:30:00")));
+    QVERIFY(updateProviderSnapshotTimestamp(QStringLiteral("OpenAI"), 0.5, QStringLiteral("2026-01-02 01:30:00")));
+
+    const QDateTime previousFrom = QDateTime::fromString(QStringLiteral("2026-01-01T00:00:00Z"), Qt::ISODate);
+    const QDateTime currentFrom = previousFrom.addDays(1);
+    const QDateTime currentTo = currentFrom.addDays(1);
+
+    // Previous day: +200 tokens at 01:00. Current day: +250 at 00:30,
+    // measured from the previous day's last snapshot, then 50 after the reset.
+    const QVariantMap tokens = db.comparePeriods({QStringLiteral("OpenAI"), QStringLiteral("Missing")},
+                                                 QStringLiteral("tokens"),
+                                                 currentFrom, currentTo, previousFrom, currentFrom, 60);
+    QCOMPARE(tokens.value(QStringLiteral("bucketSeconds")).toInt(), 3600);
+    QCOMPARE(tokens.value(QStringLiteral("currentTotal")).toDouble(), 300.0);
+    QCOMPARE(tokens.value(QStringLiteral("previousTotal")).toDouble(), 200.0);
+    QCOMPARE(tokens.value(QStringLiteral("deltaPercent")).toDouble(), 50.0);
+
+    const QVariantList providers = tokens.value(QStringLiteral("providers")).toList();
+    QCOMPARE(providers.size(), 2);
+    const QVariantMap openai = providers.at(0).toMap();
+    QCOMPARE(openai.value(QStringLiteral("name")).toString(), QStringLiteral("OpenAI"));
+    QCOMPARE(openai.value(QStringLiteral("currentSampleCount")).toInt(), 2);
+    QCOMPARE(openai.value(QStringLiteral("previousSampleCount")).toInt(), 1);
+
+    const QVariantList points = openai.value(QStringLiteral("points")).toList();
+    QCOMPARE(points.size(), 25);
+    QCOMPARE(points.at(0).toMap().value(QStringLiteral("current")).toDouble(), 250.0);
+    QCOMPARE(points.at(1).toMap().value(QStringLiteral("current")).toDouble(), 50.0);
+    QCOMPARE(points.at(1).toMap().value(QStringLiteral("previous")).toDouble(), 200.0);
+    QCOMPARE(points.at(1).toMap().value(QStringLiteral("offsetSeconds")).toLongLong(), 3600);
+    QCOMPARE(points.at(1).toMap().value(QStringLiteral("timestamp")).toString(),
+             QStringLiteral("2026-01-02T01:00:00Z"));
+
+    // Providers without data are reported with zero totals
+    const QVariantMap missing = providers.at(1).toMap();
+    QCOMPARE(missing.value(QStringLiteral("currentTotal")).toDouble(), 0.0);
+    QCOMPARE(missing.value(QStringLiteral("deltaPercent")).toDouble(), 0.0);
+
+    const QVariantMap cost = db.comparePeriods({QStringLiteral("OpenAI")}, QStringLiteral("cost"),
+                                               currentFrom, currentTo, previousFrom, currentFrom, 60);
+    QVERIFY(std::abs(cost.value(QStringLiteral("currentTotal")).toDouble() - 2.5) < 0.000001);
+    QVERIFY(std::abs(cost.value(QStringLiteral("previousTotal")).toDouble() - 1.0) < 0.000001);
+    QVERIFY(std::abs(cost.value(QStringLiteral("deltaPercent")).toDouble() - 150.0) < 0.0001);
+
+    QVERIFY(db.comparePeriods({QStringLiteral("OpenAI")}, QStringLiteral("rateLimitUsed"),
+                              currentFrom, currentTo, previousFrom, currentFrom).isEmpty());
+    QVERIFY(db.comparePeriods({QStringLiteral("OpenAI")}, QStringLiteral("tokens"),
+                              currentTo, currentFrom, previousFrom, currentFrom).isEmpty());
+}
+
 void UsageDatabaseSeriesTest::toolSeriesMetrics()
 {
     QTemporaryDir tmp;
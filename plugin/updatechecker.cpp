@@ -1,4 +1,5 @@
 #include "updatechecker.h"
+#include "sharednetworkmanager.h"
 #include <QJsonDocument>
 #include <QJsonObject>
 #include <QUrl>
@@ -20,7 +21,7 @@ static QString normalizeVersionString(QString version)
 
 UpdateChecker::UpdateChecker(QObject *parent)
     : QObject(parent)
-    , m_nam(new QNetworkAccessManager(this))
+    , m_nam(SharedNetworkManager::instance())
     , m_timer(new QTimer(this))
 {
     m_timer->setSingleShot(false);
@@ -67,6 +68,8 @@ void UpdateChecker::checkForUpdate()
     req.setTransferTimeout(30000);
     req.setRawHeader("Accept", "application/vnd.github+json");
     req.setRawHeader("User-Agent", "plasma-ai-usage-monitor/" + m_currentVersion.toUtf8());
+    if (!m_etag.isEmpty() && !m_cachedRelease.isEmpty())
+        req.setRawHeader("If-None-Match", m_etag);
 
     QNetworkReply *reply = m_nam->get(req);
     connect(reply, &QNetworkReply::finished, this, [this, reply]() {
@@ -79,31 +82,43 @@ void UpdateChecker::checkForUpdate()
             return;
         }
 
+        // Unchanged since the last check: skip the body entirely
+        if (reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt() == 304) {
+            processRelease(m_cachedRelease);
+            return;
+        }
+
         const QJsonDocument doc = QJsonDocument::fromJson(reply->readAll());
         if (!doc.isObject()) return;
 
-        const QJsonObject obj = doc.object();
-        QString tagName = obj.value(QStringLiteral("tag_name")).toString();
-        const QString htmlUrl = obj.value(QStringLiteral("html_url")).toString();
+        m_cachedRelease = doc.object();
+        m_etag = reply->rawHeader("ETag");
+        processRelease(m_cachedRelease);
+    });
+}
+
+// ── Private ──
+
+void UpdateChecker::processRelease(const QJsonObject &release)
+{
+    const QString tagName = release.value(QStringLiteral("tag_name")).toString();
+    const QString htmlUrl = release.value(QStringLiteral("html_url")).toString();
 
-        const QString normalizedRemote = normalizeVersionString(tagName);
-        const QString normalizedLocal = normalizeVersionString(m_currentVersion);
-        const QVersionNumber remote = QVersionNumber::fromString(normalizedRemote);
-        const QVersionNumber local  = QVersionNumber::fromString(normalizedLocal);
+    const QString normalizedRemote = normalizeVersionString(tagName);
+    const QString normalizedLocal = normalizeVersionString(m_currentVersion);
+    const QVersionNumber remote = QVersionNumber::fromString(normalizedRemote);
+    const QVersionNumber local  = QVersionNumber::fromString(normalizedLocal);
 
-        if (remote.isNull() || local.isNull()) return;
+    if (remote.isNull() || local.isNull()) return;
 
-        m_latestVersion = normalizedRemote;
-        Q_EMIT latestVersionChanged();
+    m_latestVersion = normalizedRemote;
+    Q_EMIT latestVersionChanged();
 
-        if (remote > local) {
-            Q_EMIT updateAvailable(normalizedRemote, htmlUrl);
-        }
-    });
+    if (remote > local) {
+        Q_EMIT updateAvailable(normalizedRemote, htmlUrl);
+    }
 }
 
-// ── Private ──
-
 void UpdateChecker::startTimerIfReady()
 {
     if (m_currentVersion.isEmpty()) return;
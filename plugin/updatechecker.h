@@ -2,6 +2,8 @@
 #define UPDATECHECKER_H
 
 #include <QObject>
+#include <QByteArray>
+#include <QJsonObject>
 #include <QNetworkAccessManager>
 #include <QNetworkReply>
 #include <QTimer>
@@ -11,6 +13,10 @@
  * Periodically checks GitHub releases for newer versions and emits
  * updateAvailable() so QML can fire a KDE notification.
  *
+ * Checks are conditional: the ETag of the last release response is sent
+ * back as If-None-Match, and a 304 (which GitHub does not count against
+ * the unauthenticated rate limit) reuses the cached release.
+ *
  * Usage from QML:
  *   UpdateChecker {
  *       currentVersion: "2.1.0"
@@ -52,13 +58,18 @@ Q_SIGNALS:
 
 private:
     void startTimerIfReady();
+    void processRelease(const QJsonObject &release);
 
-    QNetworkAccessManager *m_nam = nullptr;
+    QNetworkAccessManager *m_nam = nullptr; // shared, not owned
     QTimer *m_timer = nullptr;
     QString m_currentVersion;
     QString m_latestVersion;
     int m_intervalHours = 12;
     bool m_checking = false;
+
+    // Last successful release response, for conditional requests
+    QByteArray m_etag;
+    QJsonObject m_cachedRelease;
 };
 
 #endif // UPDATECHECKER_H
@@ -1,4 +1,7 @@
 #include "usagedatabase.h"
+#include "costmicros.h"
+#include "snapshotcursor.h"
+#include "usagedatabasesql.h"
 #include <QDir>
 #include <QStandardPaths>
 #include <QSqlQuery>
@@ -10,7 +13,16 @@
 #include <QDebug>
 #include <QMap>
 #include <QTimeZone>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QSqlDriver>
+#include <QThread>
+#include <QTimer>
+#include <QUuid>
 #include <cmath>
+#include <functional>
+
+#include <sqlite3.h>
 
 std::atomic<int> UsageDatabase::s_instanceCounter{0};
 
@@ -80,16 +92,215 @@ QVariantList bucketToPoints(const QMap<qint64, BucketAggregate> &buckets)
     }
     return points;
 }
+
+QVariantMap makeSeries(const QString &name, const QVariantList &points, int sampleCount)
+{
+    QVariantMap series;
+    series[QStringLiteral("name")] = name;
+    series[QStringLiteral("points")] = points;
+    series[QStringLiteral("sampleCount")] = sampleCount;
+
+    double latestValue = 0.0;
+    double change = 0.0;
+    if (!points.isEmpty()) {
+        const double first = points.first().toMap().value(QStringLiteral("value")).toDouble();
+        latestValue = points.last().toMap().value(QStringLiteral("value")).toDouble();
+        change = deltaPercent(first, latestValue);
+    }
+
+    series[QStringLiteral("latestValue")] = latestValue;
+    series[QStringLiteral("deltaPercent")] = change;
+    return series;
+}
+
+/**
+ * Rate metrics derived from cumulative counters: the SQL column expression
+ * to difference and the factor converting counter units per second into
+ * the reported unit.
+ */
+struct RateMetric {
+    const char *counterExpr;
+    double scale;
+};
+
+/**
+ * Cumulative counter metrics summed as increases between snapshots:
+ * the SQL column expression and the factor to the reported unit.
+ */
+bool counterMetricFor(const QString &metric, QString *counterExpr, double *scale)
+{
+    *scale = 1.0;
+    if (metric == QStringLiteral("tokens")) {
+        *counterExpr = QStringLiteral("input_tokens + output_tokens");
+    } else if (metric == QStringLiteral("requests")) {
+        *counterExpr = QStringLiteral("request_count");
+    } else if (metric == QStringLiteral("cost")) {
+        *counterExpr = QStringLiteral("cost_micros");
+        *scale = 1.0 / CostMicros::PER_DOLLAR;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+bool rateMetricFor(const QString &metric, RateMetric *out)
+{
+    if (metric == QStringLiteral("tokensPerMinute")) {
+        *out = {"input_tokens + output_tokens", 60.0};
+    } else if (metric == QStringLiteral("requestsPerMinute")) {
+        *out = {"request_count", 60.0};
+    } else if (metric == QStringLiteral("costPerHour")) {
+        *out = {"cost_micros", 3600.0 / CostMicros::PER_DOLLAR};
+    } else {
+        return false;
+    }
+    return true;
+}
+
+struct BackupOutcome {
+    bool success = false;
+    QString error;
+    qint64 bytes = 0;
+    qint64 elapsedMs = 0;
+};
+
+sqlite3 *sqliteHandle(const QSqlDatabase &db)
+{
+    const QVariant handle = db.driver()->handle();
+    if (handle.isValid() && qstrcmp(handle.typeName(), "sqlite3*") == 0) {
+        return *static_cast<sqlite3 *const *>(handle.constData());
+    }
+    return nullptr;
+}
+
+/**
+ * Copy sourcePath to targetPath with the SQLite online backup API.
+ * Runs on a worker thread with its own connections. The copy is written to
+ * "<targetPath>.part" and renamed into place only once it is complete.
+ */
+BackupOutcome runOnlineBackup(const QString &sourcePath,
+                              const QString &targetPath,
+                              int pagesPerStep,
+                              int stepSleepMs,
+                              const std::atomic_bool &cancel,
+                              const std::function<void(int, int)> &progress)
+{
+    BackupOutcome outcome;
+    QElapsedTimer timer;
+    timer.start();
+
+    const QString partPath = targetPath + QStringLiteral(".part");
+    QFile::remove(partPath);
+
+    const QString tag = QUuid::createUuid().toString(QUuid::WithoutBraces);
+    const QString srcConnection = QStringLiteral("aiusagemonitor_backup_src_%1").arg(tag);
+    const QString dstConnection = QStringLiteral("aiusagemonitor_backup_dst_%1").arg(tag);
+    {
+        QSqlDatabase src = QSqlDatabase::addDatabase(QStringLiteral("QSQLITE"), srcConnection);
+        src.setDatabaseName(sourcePath);
+        src.setConnectOptions(QStringLiteral("QSQLITE_OPEN_READONLY"));
+        QSqlDatabase dst = QSqlDatabase::addDatabase(QStringLiteral("QSQLITE"), dstConnection);
+        dst.setDatabaseName(partPath);
+
+        if (!src.open() || !dst.open()) {
+            outcome.error = src.isOpen() ? dst.lastError().text() : src.lastError().text();
+        } else {
+            sqlite3 *srcHandle = sqliteHandle(src);
+            sqlite3 *dstHandle = sqliteHandle(dst);
+            sqlite3_backup *backup = (srcHandle && dstHandle)
+                ? sqlite3_backup_init(dstHandle, "main", srcHandle, "main")
+                : nullptr;
+
+            if (!backup) {
+                outcome.error = dstHandle ? QString::fromUtf8(sqlite3_errmsg(dstHandle))
+                                          : QStringLiteral("SQLite handle unavailable");
+            } else {
+                // Each step holds a read lock on the source only for the pages it
+                // copies. If the main connection writes in between, SQLite restarts
+                // the copy automatically so the result is always consistent.
+                int rc;
+                do {
+                    rc = sqlite3_backup_step(backup, pagesPerStep);
+                    progress(sqlite3_backup_remaining(backup), sqlite3_backup_pagecount(backup));
+                    if (rc == SQLITE_OK || rc == SQLITE_BUSY || rc == SQLITE_LOCKED) {
+                        QThread::msleep(stepSleepMs);
+                    }
+                } while ((rc == SQLITE_OK || rc == SQLITE_BUSY || rc == SQLITE_LOCKED) && !cancel.load());
+                sqlite3_backup_finish(backup);
+
+                if (rc == SQLITE_DONE) {
+                    // Make the copy a self-contained file without a -wal sidecar
+                    QSqlQuery query(dst);
+                    query.exec(QStringLiteral("PRAGMA journal_mode=DELETE"));
+                    outcome.success = true;
+                } else if (cancel.load()) {
+                    outcome.error = QStringLiteral("Backup cancelled");
+                } else {
+                    outcome.error = QString::fromUtf8(sqlite3_errstr(rc));
+                }
+            }
+        }
+        src.close();
+        dst.close();
+    }
+    QSqlDatabase::removeDatabase(srcConnection);
+    QSqlDatabase::removeDatabase(dstConnection);
+
+    if (outcome.success) {
+        QFile::remove(targetPath);
+        if (QFile::rename(partPath, targetPath)) {
+            outcome.bytes = QFileInfo(targetPath).size();
+        } else {
+            outcome.success = false;
+            outcome.error = QStringLiteral("Could not move backup into place");
+        }
+    }
+    if (!outcome.success) {
+        QFile::remove(partPath);
+    }
+
+    outcome.elapsedMs = timer.elapsed();
+    return outcome;
+}
+
+QString snapshotsTableSql()
+{
+    return QStringLiteral(
+        "CREATE TABLE IF NOT EXISTS usage_snapshots ("
+        "  id INTEGER PRIMARY KEY AUTOINCREMENT,"
+        "  timestamp DATETIME DEFAULT (datetime('now')),"
+        "  provider TEXT NOT NULL,"
+        "  input_tokens INTEGER DEFAULT 0,"
+        "  output_tokens INTEGER DEFAULT 0,"
+        "  request_count INTEGER DEFAULT 0,"
+        "  cost_micros INTEGER DEFAULT 0,"
+        "  daily_cost_micros INTEGER DEFAULT 0,"
+        "  monthly_cost_micros INTEGER DEFAULT 0,"
+        "  rl_requests INTEGER DEFAULT 0,"
+        "  rl_requests_remaining INTEGER DEFAULT 0,"
+        "  rl_tokens INTEGER DEFAULT 0,"
+        "  rl_tokens_remaining INTEGER DEFAULT 0"
+        ")");
+}
 } // namespace
 
 UsageDatabase::UsageDatabase(QObject *parent)
     : QObject(parent)
     , m_connectionName(QStringLiteral("aiusagemonitor_history_%1").arg(s_instanceCounter.fetch_add(1)))
+    , m_backupTimer(new QTimer(this))
 {
+    // Checked hourly against the newest backup on disk, so a long interval
+    // neither overflows a timer nor restarts with every session
+    m_backupTimer->setInterval(BACKUP_CHECK_INTERVAL_MS);
+    connect(m_backupTimer, &QTimer::timeout, this, &UsageDatabase::runScheduledBackup);
 }
 
 UsageDatabase::~UsageDatabase()
 {
+    if (m_backupThread) {
+        m_backupCancel->store(true);
+        m_backupThread->wait();
+    }
     if (m_db.isOpen()) {
         m_db.close();
     }
@@ -116,6 +327,47 @@ void UsageDatabase::setRetentionDays(int days)
     }
 }
 
+bool UsageDatabase::isBackupRunning() const { return !m_backupThread.isNull(); }
+double UsageDatabase::backupProgress() const { return m_backupProgress; }
+
+QString UsageDatabase::backupDirectory() const { return m_backupDirectory; }
+void UsageDatabase::setBackupDirectory(const QString &directory)
+{
+    if (m_backupDirectory != directory) {
+        m_backupDirectory = directory;
+        Q_EMIT backupDirectoryChanged();
+    }
+}
+
+int UsageDatabase::backupIntervalHours() const { return m_backupIntervalHours; }
+void UsageDatabase::setBackupIntervalHours(int hours)
+{
+    // 0 disables scheduled backups; otherwise at most once per month
+    hours = qBound(0, hours, 24 * 30);
+    if (m_backupIntervalHours == hours)
+        return;
+
+    m_backupIntervalHours = hours;
+    if (hours > 0) {
+        m_backupTimer->start();
+        // Once the other settings are applied: a backup may be overdue already
+        QTimer::singleShot(0, this, &UsageDatabase::runScheduledBackup);
+    } else {
+        m_backupTimer->stop();
+    }
+    Q_EMIT backupIntervalHoursChanged();
+}
+
+int UsageDatabase::backupKeepCount() const { return m_backupKeepCount; }
+void UsageDatabase::setBackupKeepCount(int count)
+{
+    count = qBound(1, count, 100);
+    if (m_backupKeepCount != count) {
+        m_backupKeepCount = count;
+        Q_EMIT backupKeepCountChanged();
+    }
+}
+
 void UsageDatabase::initDatabase()
 {
     if (m_initialized)
@@ -135,8 +387,11 @@ void UsageDatabase::initDatabase()
         return;
     }
 
-    // Enable WAL mode for better concurrent read performance
+    // Enable WAL mode for better concurrent read performance.
+    // auto_vacuum only takes effect on a fresh database; existing files are
+    // converted on request by convertToIncrementalVacuum().
     QSqlQuery pragma(m_db);
+    pragma.exec(QStringLiteral("PRAGMA auto_vacuum=INCREMENTAL"));
     pragma.exec(QStringLiteral("PRAGMA journal_mode=WAL"));
     pragma.exec(QStringLiteral("PRAGMA synchronous=NORMAL"));
 
@@ -148,30 +403,31 @@ void UsageDatabase::createTables()
 {
     QSqlQuery query(m_db);
 
-    // Usage snapshots -- one row per provider per refresh
-    query.exec(QStringLiteral(
-        "CREATE TABLE IF NOT EXISTS usage_snapshots ("
-        "  id INTEGER PRIMARY KEY AUTOINCREMENT,"
-        "  timestamp DATETIME DEFAULT (datetime('now')),"
-        "  provider TEXT NOT NULL,"
-        "  input_tokens INTEGER DEFAULT 0,"
-        "  output_tokens INTEGER DEFAULT 0,"
-        "  request_count INTEGER DEFAULT 0,"
-        "  cost REAL DEFAULT 0.0,"
-        "  daily_cost REAL DEFAULT 0.0,"
-        "  monthly_cost REAL DEFAULT 0.0,"
-        "  rl_requests INTEGER DEFAULT 0,"
-        "  rl_requests_remaining INTEGER DEFAULT 0,"
-        "  rl_tokens INTEGER DEFAULT 0,"
-        "  rl_tokens_remaining INTEGER DEFAULT 0"
-        ")"
-    ));
+    query.exec(QStringLiteral("PRAGMA user_version"));
+    const int schemaVersion = query.next() ? query.value(0).toInt() : 0;
 
-    // Indexes for efficient time-range queries
+    // Usage snapshots -- one row per provider per refresh.
+    // Costs are integer micro-dollars (see costmicros.h).
+    query.exec(snapshotsTableSql());
+
+    if (schemaVersion < SCHEMA_VERSION) {
+        if (migrateCostsToMicros()) {
+            query.exec(QStringLiteral("PRAGMA user_version = %1").arg(SCHEMA_VERSION));
+        } else {
+            // Leave user_version alone so the migration is retried next start
+            qWarning() << "UsageDatabase: Schema migration failed, cost history is unavailable";
+        }
+    }
+
+    // Covering index for the time-range reads (see usagedatabasesql.h).
+    // It supersedes the original (provider, timestamp) index.
     query.exec(QStringLiteral(
-        "CREATE INDEX IF NOT EXISTS idx_snapshots_provider_time "
-        "ON usage_snapshots(provider, timestamp)"
+        "CREATE INDEX IF NOT EXISTS idx_snapshots_covering "
+        "ON usage_snapshots(provider, timestamp, id, cost_micros, daily_cost_micros, "
+        "input_tokens, output_tokens, request_count, "
+        "rl_requests, rl_requests_remaining)"
     ));
+    query.exec(QStringLiteral("DROP INDEX IF EXISTS idx_snapshots_provider_time"));
 
     // Rate limit events -- recorded when thresholds are hit
     query.exec(QStringLiteral(
@@ -189,6 +445,56 @@ void UsageDatabase::createTables()
         "ON rate_limit_events(provider, timestamp)"
     ));
 
+    // Request latency -- one row per provider refresh, summarising the
+    // backend's rolling network sample window
+    query.exec(QStringLiteral(
+        "CREATE TABLE IF NOT EXISTS api_latency ("
+        "  id INTEGER PRIMARY KEY AUTOINCREMENT,"
+        "  timestamp DATETIME DEFAULT (datetime('now')),"
+        "  provider TEXT NOT NULL,"
+        "  requests INTEGER DEFAULT 0,"
+        "  failures INTEGER DEFAULT 0,"
+        "  dns_p50_ms INTEGER DEFAULT 0,"
+        "  connect_p50_ms INTEGER DEFAULT 0,"
+        "  ttfb_p50_ms INTEGER DEFAULT 0,"
+        "  total_p50_ms INTEGER DEFAULT 0,"
+        "  total_p95_ms INTEGER DEFAULT 0"
+        ")"
+    ));
+
+    query.exec(QStringLiteral(
+        "CREATE INDEX IF NOT EXISTS idx_latency_covering "
+        "ON api_latency(provider, timestamp, id, requests, failures, dns_p50_ms, "
+        "connect_p50_ms, ttfb_p50_ms, total_p50_ms, total_p95_ms)"
+    ));
+
+    // Per-account snapshots of multi-account providers. Their combined
+    // figures go to usage_snapshots like any other provider's.
+    query.exec(QStringLiteral(
+        "CREATE TABLE IF NOT EXISTS account_snapshots ("
+        "  id INTEGER PRIMARY KEY AUTOINCREMENT,"
+        "  timestamp DATETIME DEFAULT (datetime('now')),"
+        "  provider TEXT NOT NULL,"
+        "  account TEXT NOT NULL,"
+        "  input_tokens INTEGER DEFAULT 0,"
+        "  output_tokens INTEGER DEFAULT 0,"
+        "  request_count INTEGER DEFAULT 0,"
+        "  cost_micros INTEGER DEFAULT 0,"
+        "  daily_cost_micros INTEGER DEFAULT 0,"
+        "  monthly_cost_micros INTEGER DEFAULT 0,"
+        "  rl_requests INTEGER DEFAULT 0,"
+        "  rl_requests_remaining INTEGER DEFAULT 0,"
+        "  rl_tokens INTEGER DEFAULT 0,"
+        "  rl_tokens_remaining INTEGER DEFAULT 0"
+        ")"
+    ));
+
+    query.exec(QStringLiteral(
+        "CREATE INDEX IF NOT EXISTS idx_account_snapshots_covering "
+        "ON account_snapshots(provider, account, timestamp, id, cost_micros, daily_cost_micros, "
+        "input_tokens, output_tokens, request_count, rl_requests, rl_requests_remaining)"
+    ));
+
     // Subscription tool usage snapshots
     query.exec(QStringLiteral(
         "CREATE TABLE IF NOT EXISTS subscription_tool_usage ("
@@ -204,11 +510,88 @@ void UsageDatabase::createTables()
     ));
 
     query.exec(QStringLiteral(
-        "CREATE INDEX IF NOT EXISTS idx_tool_usage_name_time "
-        "ON subscription_tool_usage(tool_name, timestamp)"
+        "CREATE INDEX IF NOT EXISTS idx_tool_usage_covering "
+        "ON subscription_tool_usage(tool_name, timestamp, id, usage_count, usage_limit)"
+    ));
+    query.exec(QStringLiteral("DROP INDEX IF EXISTS idx_tool_usage_name_time"));
+
+    // Billing ledger -- one row per provider account, source, UTC day,
+    // project and model; the primary key serves every ledger read
+    query.exec(QStringLiteral(
+        "CREATE TABLE IF NOT EXISTS billing_ledger ("
+        "  provider TEXT NOT NULL,"
+        "  account TEXT NOT NULL,"
+        "  source TEXT NOT NULL,"
+        "  day TEXT NOT NULL,"
+        "  project TEXT NOT NULL DEFAULT '',"
+        "  model TEXT NOT NULL DEFAULT '',"
+        "  input_tokens INTEGER DEFAULT 0,"
+        "  output_tokens INTEGER DEFAULT 0,"
+        "  request_count INTEGER DEFAULT 0,"
+        "  cost_micros INTEGER DEFAULT 0,"
+        "  PRIMARY KEY (provider, account, source, day, project, model)"
+        ") WITHOUT ROWID"
+    ));
+
+    query.exec(QStringLiteral(
+        "CREATE TABLE IF NOT EXISTS billing_ledger_marks ("
+        "  provider TEXT NOT NULL,"
+        "  account TEXT NOT NULL,"
+        "  source TEXT NOT NULL,"
+        "  closed_through TEXT NOT NULL,"
+        "  PRIMARY KEY (provider, account, source)"
+        ") WITHOUT ROWID"
     ));
 }
 
+bool UsageDatabase::migrateCostsToMicros()
+{
+    QSqlQuery query(m_db);
+
+    bool hasRealCosts = false;
+    query.exec(QStringLiteral("PRAGMA table_info(usage_snapshots)"));
+    while (query.next()) {
+        if (query.value(1).toString() == QStringLiteral("cost")) {
+            hasRealCosts = true;
+        }
+    }
+    if (!hasRealCosts)
+        return true;
+
+    // SQLite cannot change a column's type in place, so rebuild the table.
+    // Dropping the old table also drops its indexes; createTables()
+    // recreates them on the new layout.
+    const QStringList steps = {
+        QStringLiteral("ALTER TABLE usage_snapshots RENAME TO usage_snapshots_v0"),
+        snapshotsTableSql(),
+        QStringLiteral(
+            "INSERT INTO usage_snapshots "
+            "(id, timestamp, provider, input_tokens, output_tokens, request_count, "
+            "cost_micros, daily_cost_micros, monthly_cost_micros, "
+            "rl_requests, rl_requests_remaining, rl_tokens, rl_tokens_remaining) "
+            "SELECT id, timestamp, provider, input_tokens, output_tokens, request_count, "
+            "CAST(ROUND(cost * 1000000) AS INTEGER), "
+            "CAST(ROUND(daily_cost * 1000000) AS INTEGER), "
+            "CAST(ROUND(monthly_cost * 1000000) AS INTEGER), "
+            "rl_requests, rl_requests_remaining, rl_tokens, rl_tokens_remaining "
+            "FROM usage_snapshots_v0"),
+        QStringLiteral("DROP TABLE usage_snapshots_v0"),
+    };
+
+    if (!m_db.transaction()) {
+        qWarning() << "UsageDatabase: Failed to start cost migration:" << m_db.lastError().text();
+        return false;
+    }
+    for (const QString &sql : steps) {
+        if (!query.exec(sql)) {
+            qWarning() << "UsageDatabase: Cost migration failed:" << query.lastError().text();
+            m_db.rollback();
+            return false;
+        }
+    }
+    return m_db.commit();
+}
+
 void UsageDatabase::recordSnapshot(const QString &provider,
                                     qint64 inputTokens,
                                     qint64 outputTokens,
@@ -224,12 +607,15 @@ void UsageDatabase::recordSnapshot(const QString &provider,
     if (!m_enabled)
         return;
 
+    // QML hands over dollars; everything below works in micro-dollars
+    const qint64 costMicros = CostMicros::fromDollars(cost);
+
     // Throttle writes: skip if the same provider wrote recently AND data hasn't changed
     qint64 now = QDateTime::currentSecsSinceEpoch();
     qint64 lastWrite = m_lastWriteTime.value(provider, 0);
-    double lastCost = m_lastWrittenCost.value(provider, -1.0);
+    qint64 lastCost = m_lastWrittenCost.value(provider, -1);
 
-    bool dataChanged = (cost != lastCost);
+    bool dataChanged = (costMicros != lastCost);
     bool throttled = (now - lastWrite) < WRITE_THROTTLE_SECS;
 
     if (throttled && !dataChanged)
@@ -242,7 +628,8 @@ void UsageDatabase::recordSnapshot(const QString &provider,
     QSqlQuery query(m_db);
     query.prepare(QStringLiteral(
         "INSERT INTO usage_snapshots "
-        "(provider, input_tokens, output_tokens, request_count, cost, daily_cost, monthly_cost, "
+        "(provider, input_tokens, output_tokens, request_count, "
+        "cost_micros, daily_cost_micros, monthly_cost_micros, "
         "rl_requests, rl_requests_remaining, rl_tokens, rl_tokens_remaining) "
         "VALUES (?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?)"
     ));
@@ -250,9 +637,9 @@ void UsageDatabase::recordSnapshot(const QString &provider,
     query.addBindValue(inputTokens);
     query.addBindValue(outputTokens);
     query.addBindValue(requestCount);
-    query.addBindValue(cost);
-    query.addBindValue(dailyCost);
-    query.addBindValue(monthlyCost);
+    query.addBindValue(costMicros);
+    query.addBindValue(CostMicros::fromDollars(dailyCost));
+    query.addBindValue(CostMicros::fromDollars(monthlyCost));
     query.addBindValue(rateLimitRequests);
     query.addBindValue(rateLimitRequestsRemaining);
     query.addBindValue(rateLimitTokens);
@@ -262,7 +649,7 @@ void UsageDatabase::recordSnapshot(const QString &provider,
         qWarning() << "UsageDatabase: Failed to record snapshot:" << query.lastError().text();
     } else {
         m_lastWriteTime[provider] = now;
-        m_lastWrittenCost[provider] = cost;
+        m_lastWrittenCost[provider] = costMicros;
     }
 }
 
@@ -290,6 +677,104 @@ void UsageDatabase::recordRateLimitEvent(const QString &provider,
     }
 }
 
+void UsageDatabase::recordNetworkStats(const QString &provider, const QVariantMap &stats)
+{
+    if (!m_enabled)
+        return;
+
+    const int requests = stats.value(QStringLiteral("requests")).toInt();
+    if (requests <= 0)
+        return;
+
+    initDatabase();
+    if (!m_initialized)
+        return;
+
+    const QVariantMap phases = stats.value(QStringLiteral("phases")).toMap();
+    const auto percentile = [&phases](const char *phase, const char *key) {
+        return phases.value(QLatin1String(phase)).toMap().value(QLatin1String(key)).toLongLong();
+    };
+
+    QSqlQuery query(m_db);
+    query.prepare(QStringLiteral(
+        "INSERT INTO api_latency (provider, requests, failures, dns_p50_ms, connect_p50_ms, "
+        "ttfb_p50_ms, total_p50_ms, total_p95_ms) VALUES (?, ?, ?, ?, ?, ?, ?, ?)"
+    ));
+    query.addBindValue(provider);
+    query.addBindValue(requests);
+    query.addBindValue(stats.value(QStringLiteral("failures")).toInt());
+    query.addBindValue(percentile("dns", "p50Ms"));
+    query.addBindValue(percentile("connect", "p50Ms"));
+    query.addBindValue(percentile("ttfb", "p50Ms"));
+    query.addBindValue(percentile("total", "p50Ms"));
+    query.addBindValue(percentile("total", "p95Ms"));
+
+    if (!query.exec()) {
+        qWarning() << "UsageDatabase: Failed to record network stats:" << query.lastError().text();
+    }
+}
+
+void UsageDatabase::recordAccountSnapshots(const QString &provider, const QVariantList &accounts)
+{
+    if (!m_enabled || accounts.isEmpty())
+        return;
+
+    initDatabase();
+    if (!m_initialized)
+        return;
+
+    const qint64 now = QDateTime::currentSecsSinceEpoch();
+    const auto value = [](const QVariantMap &account, const char *key) {
+        return account.value(QLatin1String(key)).toLongLong();
+    };
+
+    QSqlQuery query(m_db);
+    query.prepare(QStringLiteral(
+        "INSERT INTO account_snapshots "
+        "(provider, account, input_tokens, output_tokens, request_count, "
+        "cost_micros, daily_cost_micros, monthly_cost_micros, "
+        "rl_requests, rl_requests_remaining, rl_tokens, rl_tokens_remaining) "
+        "VALUES (?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?)"
+    ));
+
+    m_db.transaction();
+    for (const QVariant &entry : accounts) {
+        const QVariantMap account = entry.toMap();
+        const QString id = account.value(QStringLiteral("id")).toString();
+        if (id.isEmpty())
+            continue;
+
+        // Same throttle as recordSnapshot(), per account
+        const QString throttleKey = QStringLiteral("account:") + provider + QLatin1Char('/') + id;
+        const qint64 costMicros = value(account, "costMicros");
+        const bool dataChanged = costMicros != m_lastWrittenCost.value(throttleKey, -1);
+        const bool throttled = (now - m_lastWriteTime.value(throttleKey, 0)) < WRITE_THROTTLE_SECS;
+        if (throttled && !dataChanged)
+            continue;
+
+        query.addBindValue(provider);
+        query.addBindValue(id);
+        query.addBindValue(value(account, "inputTokens"));
+        query.addBindValue(value(account, "outputTokens"));
+        query.addBindValue(value(account, "requestCount"));
+        query.addBindValue(costMicros);
+        query.addBindValue(value(account, "dailyCostMicros"));
+        query.addBindValue(value(account, "monthlyCostMicros"));
+        query.addBindValue(value(account, "rateLimitRequests"));
+        query.addBindValue(value(account, "rateLimitRequestsRemaining"));
+        query.addBindValue(value(account, "rateLimitTokens"));
+        query.addBindValue(value(account, "rateLimitTokensRemaining"));
+
+        if (!query.exec()) {
+            qWarning() << "UsageDatabase: Failed to record account snapshot:" << query.lastError().text();
+            continue;
+        }
+        m_lastWriteTime[throttleKey] = now;
+        m_lastWrittenCost[throttleKey] = costMicros;
+    }
+    m_db.commit();
+}
+
 void UsageDatabase::recordToolSnapshot(const QString &toolName,
                                         int usageCount,
                                         int usageLimit,
@@ -304,9 +789,9 @@ void UsageDatabase::recordToolSnapshot(const QString &toolName,
     qint64 now = QDateTime::currentSecsSinceEpoch();
     QString throttleKey = QStringLiteral("tool:") + toolName;
     qint64 lastWrite = m_lastWriteTime.value(throttleKey, 0);
-    double lastCount = m_lastWrittenCost.value(throttleKey, -1.0);
+    qint64 lastCount = m_lastWrittenCost.value(throttleKey, -1);
 
-    bool dataChanged = (static_cast<double>(usageCount) != lastCount);
+    bool dataChanged = (usageCount != lastCount);
     bool throttled = (now - lastWrite) < WRITE_THROTTLE_SECS;
 
     if (throttled && !dataChanged)
@@ -333,7 +818,7 @@ void UsageDatabase::recordToolSnapshot(const QString &toolName,
         qWarning() << "UsageDatabase: Failed to record tool snapshot:" << query.lastError().text();
     } else {
         m_lastWriteTime[throttleKey] = now;
-        m_lastWrittenCost[throttleKey] = static_cast<double>(usageCount);
+        m_lastWrittenCost[throttleKey] = usageCount;
     }
 }
 
@@ -343,46 +828,22 @@ QVariantList UsageDatabase::getSnapshots(const QString &provider,
 {
     QVariantList results;
 
-    if (!m_initialized)
-        return results;
-
-    QSqlQuery query(m_db);
-    query.prepare(QStringLiteral(
-        "SELECT timestamp, input_tokens, output_tokens, request_count, cost, "
-        "daily_cost, monthly_cost, rl_requests, rl_requests_remaining, "
-        "rl_tokens, rl_tokens_remaining "
-        "FROM usage_snapshots "
-        "WHERE provider = ? AND timestamp >= ? AND timestamp <= ? "
-        "ORDER BY timestamp ASC"
-    ));
-    query.addBindValue(provider);
-    query.addBindValue(toDbDateTimeString(from));
-    query.addBindValue(toDbDateTimeString(to));
-
-    if (!query.exec()) {
-        qWarning() << "UsageDatabase: getSnapshots query failed:" << query.lastError().text();
-        return results;
-    }
-
-    while (query.next()) {
-        QVariantMap row;
-        row[QStringLiteral("timestamp")] = query.value(0).toString();
-        row[QStringLiteral("inputTokens")] = query.value(1).toLongLong();
-        row[QStringLiteral("outputTokens")] = query.value(2).toLongLong();
-        row[QStringLiteral("requestCount")] = query.value(3).toInt();
-        row[QStringLiteral("cost")] = query.value(4).toDouble();
-        row[QStringLiteral("dailyCost")] = query.value(5).toDouble();
-        row[QStringLiteral("monthlyCost")] = query.value(6).toDouble();
-        row[QStringLiteral("rlRequests")] = query.value(7).toInt();
-        row[QStringLiteral("rlRequestsRemaining")] = query.value(8).toInt();
-        row[QStringLiteral("rlTokens")] = query.value(9).toInt();
-        row[QStringLiteral("rlTokensRemaining")] = query.value(10).toInt();
-        results.append(row);
+    SnapshotCursor cursor(this, provider, from, to, SnapshotCursor::MAX_PAGE_SIZE);
+    while (!cursor.atEnd()) {
+        results.append(cursor.nextPage());
     }
 
     return results;
 }
 
+SnapshotCursor *UsageDatabase::openSnapshotCursor(const QString &provider,
+                                                  const QDateTime &from,
+                                                  const QDateTime &to,
+                                                  int pageSize) const
+{
+    return new SnapshotCursor(this, provider, from, to, pageSize);
+}
+
 QVariantList UsageDatabase::getDailyCosts(const QString &provider,
                                            const QDateTime &from,
                                            const QDateTime &to) const
@@ -393,12 +854,7 @@ QVariantList UsageDatabase::getDailyCosts(const QString &provider,
         return results;
 
     QSqlQuery query(m_db);
-    query.prepare(QStringLiteral(
-        "SELECT date(timestamp) as day, MAX(cost) as total_cost, MAX(daily_cost) as max_daily "
-        "FROM usage_snapshots "
-        "WHERE provider = ? AND timestamp >= ? AND timestamp <= ? "
-        "GROUP BY day ORDER BY day ASC"
-    ));
+    query.prepare(UsageDatabaseSql::dailyCosts());
     query.addBindValue(provider);
     query.addBindValue(toDbDateTimeString(from));
     query.addBindValue(toDbDateTimeString(to));
@@ -411,8 +867,8 @@ QVariantList UsageDatabase::getDailyCosts(const QString &provider,
     while (query.next()) {
         QVariantMap row;
         row[QStringLiteral("date")] = query.value(0).toString();
-        row[QStringLiteral("totalCost")] = query.value(1).toDouble();
-        row[QStringLiteral("maxDailyCost")] = query.value(2).toDouble();
+        row[QStringLiteral("totalCost")] = CostMicros::toDollars(query.value(1).toLongLong());
+        row[QStringLiteral("maxDailyCost")] = CostMicros::toDollars(query.value(2).toLongLong());
         results.append(row);
     }
 
@@ -429,15 +885,7 @@ QVariantMap UsageDatabase::getSummary(const QString &provider,
         return result;
 
     QSqlQuery query(m_db);
-    query.prepare(QStringLiteral(
-        "SELECT MAX(cost) as total_cost, "
-        "AVG(daily_cost) as avg_daily, MAX(daily_cost) as max_daily, "
-        "MAX(request_count) as total_requests, "
-        "MAX(input_tokens + output_tokens) as peak_tokens, "
-        "COUNT(*) as snapshot_count "
-        "FROM usage_snapshots "
-        "WHERE provider = ? AND timestamp >= ? AND timestamp <= ?"
-    ));
+    query.prepare(UsageDatabaseSql::summary());
     query.addBindValue(provider);
     query.addBindValue(toDbDateTimeString(from));
     query.addBindValue(toDbDateTimeString(to));
@@ -447,9 +895,9 @@ QVariantMap UsageDatabase::getSummary(const QString &provider,
         return result;
     }
 
-    result[QStringLiteral("totalCost")] = query.value(0).toDouble();
-    result[QStringLiteral("avgDailyCost")] = query.value(1).toDouble();
-    result[QStringLiteral("maxDailyCost")] = query.value(2).toDouble();
+    result[QStringLiteral("totalCost")] = CostMicros::toDollars(query.value(0).toLongLong());
+    result[QStringLiteral("avgDailyCost")] = query.value(1).toDouble() / CostMicros::PER_DOLLAR;
+    result[QStringLiteral("maxDailyCost")] = CostMicros::toDollars(query.value(2).toLongLong());
     result[QStringLiteral("totalRequests")] = query.value(3).toInt();
     result[QStringLiteral("peakTokenUsage")] = query.value(4).toLongLong();
     result[QStringLiteral("snapshotCount")] = query.value(5).toInt();
@@ -465,9 +913,7 @@ QStringList UsageDatabase::getProviders() const
         return providers;
 
     QSqlQuery query(m_db);
-    query.exec(QStringLiteral(
-        "SELECT DISTINCT provider FROM usage_snapshots ORDER BY provider"
-    ));
+    query.exec(UsageDatabaseSql::providers());
 
     while (query.next()) {
         providers.append(query.value(0).toString());
@@ -486,13 +932,7 @@ QVariantList UsageDatabase::getToolSnapshots(const QString &toolName,
         return results;
 
     QSqlQuery query(m_db);
-    query.prepare(QStringLiteral(
-        "SELECT timestamp, usage_count, usage_limit, period_type, "
-        "plan_tier, limit_reached "
-        "FROM subscription_tool_usage "
-        "WHERE tool_name = ? AND timestamp >= ? AND timestamp <= ? "
-        "ORDER BY timestamp ASC"
-    ));
+    query.prepare(UsageDatabaseSql::toolSnapshots());
     query.addBindValue(toolName);
     query.addBindValue(toDbDateTimeString(from));
     query.addBindValue(toDbDateTimeString(to));
@@ -519,47 +959,147 @@ QVariantList UsageDatabase::getToolSnapshots(const QString &toolName,
     return results;
 }
 
-QStringList UsageDatabase::getToolNames() const
+QVariantList UsageDatabase::getLatencySeries(const QString &provider,
+                                               const QDateTime &from,
+                                               const QDateTime &to) const
 {
-    QStringList names;
+    QVariantList results;
 
     if (!m_initialized)
-        return names;
+        return results;
 
     QSqlQuery query(m_db);
-    query.exec(QStringLiteral(
-        "SELECT DISTINCT tool_name FROM subscription_tool_usage ORDER BY tool_name"
-    ));
+    query.prepare(UsageDatabaseSql::latencySeries());
+    query.addBindValue(provider);
+    query.addBindValue(toDbDateTimeString(from));
+    query.addBindValue(toDbDateTimeString(to));
+
+    if (!query.exec()) {
+        qWarning() << "UsageDatabase: getLatencySeries query failed:" << query.lastError().text();
+        return results;
+    }
 
     while (query.next()) {
-        names.append(query.value(0).toString());
+        QVariantMap row;
+        row[QStringLiteral("timestamp")] = query.value(0).toString();
+        row[QStringLiteral("requests")] = query.value(1).toInt();
+        row[QStringLiteral("failures")] = query.value(2).toInt();
+        row[QStringLiteral("dnsP50Ms")] = query.value(3).toLongLong();
+        row[QStringLiteral("connectP50Ms")] = query.value(4).toLongLong();
+        row[QStringLiteral("ttfbP50Ms")] = query.value(5).toLongLong();
+        row[QStringLiteral("totalP50Ms")] = query.value(6).toLongLong();
+        row[QStringLiteral("totalP95Ms")] = query.value(7).toLongLong();
+        results.append(row);
     }
 
-    return names;
+    return results;
 }
 
-QVariantList UsageDatabase::getProviderSeries(const QStringList &providers,
-                                              const QDateTime &from,
-                                              const QDateTime &to,
-                                              const QString &metric,
-                                              int bucketMinutes) const
+QVariantList UsageDatabase::getAccountSeries(const QString &provider,
+                                               const QString &account,
+                                               const QDateTime &from,
+                                               const QDateTime &to) const
 {
     QVariantList results;
 
-    if (!m_initialized || providers.isEmpty()) {
+    if (!m_initialized)
         return results;
-    }
 
-    if (metric != QStringLiteral("cost")
-        && metric != QStringLiteral("tokens")
-        && metric != QStringLiteral("requests")
-        && metric != QStringLiteral("rateLimitUsed")) {
-        return results;
-    }
+    QSqlQuery query(m_db);
+    query.prepare(UsageDatabaseSql::accountSeries());
+    query.addBindValue(provider);
+    query.addBindValue(account);
+    query.addBindValue(toDbDateTimeString(from));
+    query.addBindValue(toDbDateTimeString(to));
 
-    const QDateTime fromUtc = from.toUTC();
-    const QDateTime toUtc = to.toUTC();
-    if (!fromUtc.isValid() || !toUtc.isValid() || fromUtc >= toUtc) {
+    if (!query.exec()) {
+        qWarning() << "UsageDatabase: getAccountSeries query failed:" << query.lastError().text();
+        return results;
+    }
+
+    while (query.next()) {
+        const qint64 costMicros = query.value(1).toLongLong();
+        QVariantMap row;
+        row[QStringLiteral("timestamp")] = query.value(0).toString();
+        row[QStringLiteral("cost")] = CostMicros::toDollars(costMicros);
+        row[QStringLiteral("costMicros")] = costMicros;
+        row[QStringLiteral("dailyCost")] = CostMicros::toDollars(query.value(2).toLongLong());
+        row[QStringLiteral("inputTokens")] = query.value(3).toLongLong();
+        row[QStringLiteral("outputTokens")] = query.value(4).toLongLong();
+        row[QStringLiteral("requestCount")] = query.value(5).toInt();
+        row[QStringLiteral("rlRequests")] = query.value(6).toInt();
+        row[QStringLiteral("rlRequestsRemaining")] = query.value(7).toInt();
+        results.append(row);
+    }
+
+    return results;
+}
+
+QStringList UsageDatabase::getAccounts(const QString &provider) const
+{
+    QStringList accounts;
+
+    if (!m_initialized)
+        return accounts;
+
+    QSqlQuery query(m_db);
+    query.prepare(UsageDatabaseSql::accounts());
+    query.addBindValue(provider);
+    if (!query.exec()) {
+        qWarning() << "UsageDatabase: getAccounts query failed:" << query.lastError().text();
+        return accounts;
+    }
+
+    while (query.next()) {
+        accounts.append(query.value(0).toString());
+    }
+
+    return accounts;
+}
+
+QStringList UsageDatabase::getToolNames() const
+{
+    QStringList names;
+
+    if (!m_initialized)
+        return names;
+
+    QSqlQuery query(m_db);
+    query.exec(UsageDatabaseSql::toolNames());
+
+    while (query.next()) {
+        names.append(query.value(0).toString());
+    }
+
+    return names;
+}
+
+QVariantList UsageDatabase::getProviderSeries(const QStringList &providers,
+                                              const QDateTime &from,
+                                              const QDateTime &to,
+                                              const QString &metric,
+                                              int bucketMinutes) const
+{
+    QVariantList results;
+
+    if (!m_initialized || providers.isEmpty()) {
+        return results;
+    }
+
+    RateMetric rateMetric{};
+    const bool isRateMetric = rateMetricFor(metric, &rateMetric);
+
+    if (!isRateMetric
+        && metric != QStringLiteral("cost")
+        && metric != QStringLiteral("tokens")
+        && metric != QStringLiteral("requests")
+        && metric != QStringLiteral("rateLimitUsed")) {
+        return results;
+    }
+
+    const QDateTime fromUtc = from.toUTC();
+    const QDateTime toUtc = to.toUTC();
+    if (!fromUtc.isValid() || !toUtc.isValid() || fromUtc >= toUtc) {
         return results;
     }
 
@@ -570,14 +1110,19 @@ QVariantList UsageDatabase::getProviderSeries(const QStringList &providers,
             continue;
         }
 
+        if (isRateMetric) {
+            int sampleCount = 0;
+            QVariantList points;
+            if (!queryRateSeries(provider, fromUtc, toUtc, QLatin1String(rateMetric.counterExpr),
+                                 rateMetric.scale, bucketSecs, &points, &sampleCount)) {
+                continue;
+            }
+            results.append(makeSeries(provider, points, sampleCount));
+            continue;
+        }
+
         QSqlQuery query(m_db);
-        query.prepare(QStringLiteral(
-            "SELECT timestamp, cost, input_tokens, output_tokens, request_count, "
-            "rl_requests, rl_requests_remaining "
-            "FROM usage_snapshots "
-            "WHERE provider = ? AND timestamp >= ? AND timestamp <= ? "
-            "ORDER BY timestamp ASC"
-        ));
+        query.prepare(UsageDatabaseSql::providerSeries());
         query.addBindValue(provider);
         query.addBindValue(toDbDateTimeString(fromUtc));
         query.addBindValue(toDbDateTimeString(toUtc));
@@ -599,7 +1144,7 @@ QVariantList UsageDatabase::getProviderSeries(const QStringList &providers,
 
             double value = 0.0;
             if (metric == QStringLiteral("cost")) {
-                value = query.value(1).toDouble();
+                value = CostMicros::toDollars(query.value(1).toLongLong());
             } else if (metric == QStringLiteral("tokens")) {
                 value = static_cast<double>(query.value(2).toLongLong() + query.value(3).toLongLong());
             } else if (metric == QStringLiteral("requests")) {
@@ -622,26 +1167,239 @@ QVariantList UsageDatabase::getProviderSeries(const QStringList &providers,
             sampleCount++;
         }
 
-        const QVariantList points = bucketToPoints(buckets);
-        QVariantMap series;
-        series[QStringLiteral("name")] = provider;
-        series[QStringLiteral("points")] = points;
-        series[QStringLiteral("sampleCount")] = sampleCount;
-
-        double latestValue = 0.0;
-        double change = 0.0;
-        if (!points.isEmpty()) {
-            const double first = points.first().toMap().value(QStringLiteral("value")).toDouble();
-            latestValue = points.last().toMap().value(QStringLiteral("value")).toDouble();
-            change = deltaPercent(first, latestValue);
+        results.append(makeSeries(provider, bucketToPoints(buckets), sampleCount));
+    }
+
+    return results;
+}
+
+bool UsageDatabase::queryRateSeries(const QString &provider,
+                                    const QDateTime &fromUtc,
+                                    const QDateTime &toUtc,
+                                    QLatin1String counterExpr,
+                                    double scale,
+                                    int bucketSecs,
+                                    QVariantList *points,
+                                    int *sampleCount) const
+{
+    // One ordered range scan on (provider, timestamp): LAG() pairs every
+    // snapshot with its predecessor, and each pair contributes its counter
+    // increase and elapsed time to the bucket of the later sample. A counter
+    // that went down was reset at a period boundary, so the new value itself
+    // is the increase since the reset.
+    QSqlQuery query(m_db);
+    query.prepare(UsageDatabaseSql::rateSeries(counterExpr));
+    query.addBindValue(provider);
+    query.addBindValue(toDbDateTimeString(fromUtc));
+    query.addBindValue(toDbDateTimeString(toUtc));
+    query.addBindValue(fromUtc.toSecsSinceEpoch());
+    query.addBindValue(bucketSecs);
+
+    if (!query.exec()) {
+        qWarning() << "UsageDatabase: rate series query failed for" << provider
+                   << ":" << query.lastError().text();
+        return false;
+    }
+
+    while (query.next()) {
+        const qint64 bucketIndex = query.value(0).toLongLong();
+        const double increase = query.value(1).toDouble();
+        const double seconds = query.value(2).toDouble();
+        if (seconds <= 0.0) {
+            continue;
         }
 
-        series[QStringLiteral("latestValue")] = latestValue;
-        series[QStringLiteral("deltaPercent")] = change;
-        results.append(series);
+        QVariantMap point;
+        point[QStringLiteral("timestamp")] = fromUtc.addSecs(bucketIndex * bucketSecs).toString(Qt::ISODate);
+        point[QStringLiteral("value")] = increase / seconds * scale;
+        points->append(point);
+        *sampleCount += query.value(3).toInt();
     }
 
-    return results;
+    return true;
+}
+
+QList<double> UsageDatabase::getUsageHeatmap(const QStringList &providers,
+                                             const QDateTime &from,
+                                             const QDateTime &to,
+                                             const QString &metric) const
+{
+    constexpr int HEATMAP_CELLS = 7 * 24;
+    QList<double> cells(HEATMAP_CELLS, 0.0);
+
+    if (!m_initialized)
+        return cells;
+
+    const QDateTime fromUtc = from.toUTC();
+    const QDateTime toUtc = to.toUTC();
+    if (!fromUtc.isValid() || !toUtc.isValid() || fromUtc >= toUtc)
+        return cells;
+
+    QString counterExpr;
+    double scale = 1.0;
+    if (!counterMetricFor(metric, &counterExpr, &scale) && metric != QStringLiteral("rateLimitEvents")) {
+        return cells;
+    }
+
+    const QString sql = counterExpr.isEmpty()
+        ? UsageDatabaseSql::heatmapEvents(providers.size())
+        : UsageDatabaseSql::heatmapCounters(providers.size(), counterExpr);
+
+    QSqlQuery query(m_db);
+    query.prepare(sql);
+    for (const QString &provider : providers) {
+        query.addBindValue(provider);
+    }
+    query.addBindValue(toDbDateTimeString(fromUtc));
+    query.addBindValue(toDbDateTimeString(toUtc));
+
+    if (!query.exec()) {
+        qWarning() << "UsageDatabase: getUsageHeatmap query failed:" << query.lastError().text();
+        return cells;
+    }
+
+    while (query.next()) {
+        const int cell = query.value(0).toInt();
+        if (cell >= 0 && cell < HEATMAP_CELLS) {
+            cells[cell] = query.value(1).toDouble() * scale;
+        }
+    }
+
+    return cells;
+}
+
+QVariantMap UsageDatabase::comparePeriods(const QStringList &providers,
+                                          const QString &metric,
+                                          const QDateTime &currentFrom,
+                                          const QDateTime &currentTo,
+                                          const QDateTime &previousFrom,
+                                          const QDateTime &previousTo,
+                                          int bucketMinutes) const
+{
+    QVariantMap result;
+
+    if (!m_initialized || providers.isEmpty())
+        return result;
+
+    QString counterExpr;
+    double scale = 1.0;
+    if (!counterMetricFor(metric, &counterExpr, &scale))
+        return result;
+
+    const QDateTime curFrom = currentFrom.toUTC();
+    const QDateTime curTo = currentTo.toUTC();
+    const QDateTime prevFrom = previousFrom.toUTC();
+    const QDateTime prevTo = previousTo.toUTC();
+    if (!curFrom.isValid() || !curTo.isValid() || curFrom >= curTo
+        || !prevFrom.isValid() || !prevTo.isValid() || prevFrom >= prevTo) {
+        return result;
+    }
+
+    // Both periods share one bucket grid sized for the longer of the two,
+    // so bucket i of each period covers the same offset from its start.
+    const qint64 longestSecs = qMax(curFrom.secsTo(curTo), prevFrom.secsTo(prevTo));
+    const int bucketSecs = effectiveBucketSeconds(curFrom, curFrom.addSecs(longestSecs), bucketMinutes);
+    const int bucketCount = static_cast<int>(longestSecs / bucketSecs) + 1;
+
+    struct PeriodTotals {
+        QList<double> current;
+        QList<double> previous;
+        double currentTotal = 0.0;
+        double previousTotal = 0.0;
+        int currentSamples = 0;
+        int previousSamples = 0;
+    };
+
+    QStringList names;
+    QHash<QString, PeriodTotals> totals;
+    for (const QString &provider : providers) {
+        if (provider.isEmpty() || totals.contains(provider))
+            continue;
+        names.append(provider);
+        PeriodTotals &entry = totals[provider];
+        entry.current.fill(0.0, bucketCount);
+        entry.previous.fill(0.0, bucketCount);
+    }
+    if (names.isEmpty())
+        return result;
+
+    QSqlQuery query(m_db);
+    query.setForwardOnly(true);
+    query.prepare(UsageDatabaseSql::periodComparison(names.size(), counterExpr));
+    for (const QString &provider : std::as_const(names)) {
+        query.addBindValue(provider);
+    }
+    query.addBindValue(toDbDateTimeString(qMin(curFrom, prevFrom)));
+    query.addBindValue(toDbDateTimeString(qMax(curTo, prevTo)));
+    query.addBindValue(curFrom.toSecsSinceEpoch());
+    query.addBindValue(curTo.toSecsSinceEpoch());
+    query.addBindValue(prevFrom.toSecsSinceEpoch());
+    query.addBindValue(prevTo.toSecsSinceEpoch());
+    query.addBindValue(curFrom.toSecsSinceEpoch());
+    query.addBindValue(prevFrom.toSecsSinceEpoch());
+    query.addBindValue(bucketSecs);
+
+    if (!query.exec()) {
+        qWarning() << "UsageDatabase: comparePeriods query failed:" << query.lastError().text();
+        return result;
+    }
+
+    while (query.next()) {
+        auto it = totals.find(query.value(0).toString());
+        const int bucket = query.value(2).toInt();
+        if (it == totals.end() || bucket < 0 || bucket >= bucketCount)
+            continue;
+
+        const double value = query.value(3).toDouble() * scale;
+        const int samples = query.value(4).toInt();
+        if (query.value(1).toInt() == 0) {
+            it->current[bucket] += value;
+            it->currentTotal += value;
+            it->currentSamples += samples;
+        } else {
+            it->previous[bucket] += value;
+            it->previousTotal += value;
+            it->previousSamples += samples;
+        }
+    }
+
+    QVariantList providerResults;
+    double currentTotal = 0.0;
+    double previousTotal = 0.0;
+    for (const QString &provider : std::as_const(names)) {
+        const PeriodTotals &entry = totals[provider];
+
+        QVariantList points;
+        points.reserve(bucketCount);
+        for (int i = 0; i < bucketCount; ++i) {
+            QVariantMap point;
+            point[QStringLiteral("offsetSeconds")] = qint64(i) * bucketSecs;
+            point[QStringLiteral("timestamp")] = curFrom.addSecs(qint64(i) * bucketSecs).toString(Qt::ISODate);
+            point[QStringLiteral("current")] = entry.current.at(i);
+            point[QStringLiteral("previous")] = entry.previous.at(i);
+            points.append(point);
+        }
+
+        QVariantMap item;
+        item[QStringLiteral("name")] = provider;
+        item[QStringLiteral("points")] = points;
+        item[QStringLiteral("currentTotal")] = entry.currentTotal;
+        item[QStringLiteral("previousTotal")] = entry.previousTotal;
+        item[QStringLiteral("deltaPercent")] = deltaPercent(entry.previousTotal, entry.currentTotal);
+        item[QStringLiteral("currentSampleCount")] = entry.currentSamples;
+        item[QStringLiteral("previousSampleCount")] = entry.previousSamples;
+        providerResults.append(item);
+
+        currentTotal += entry.currentTotal;
+        previousTotal += entry.previousTotal;
+    }
+
+    result[QStringLiteral("bucketSeconds")] = bucketSecs;
+    result[QStringLiteral("currentTotal")] = currentTotal;
+    result[QStringLiteral("previousTotal")] = previousTotal;
+    result[QStringLiteral("deltaPercent")] = deltaPercent(previousTotal, currentTotal);
+    result[QStringLiteral("providers")] = providerResults;
+    return result;
 }
 
 QVariantList UsageDatabase::getToolSeries(const QStringList &tools,
@@ -676,12 +1434,7 @@ QVariantList UsageDatabase::getToolSeries(const QStringList &tools,
         }
 
         QSqlQuery query(m_db);
-        query.prepare(QStringLiteral(
-            "SELECT timestamp, usage_count, usage_limit "
-            "FROM subscription_tool_usage "
-            "WHERE tool_name = ? AND timestamp >= ? AND timestamp <= ? "
-            "ORDER BY timestamp ASC"
-        ));
+        query.prepare(UsageDatabaseSql::toolSeries());
         query.addBindValue(tool);
         query.addBindValue(toDbDateTimeString(fromUtc));
         query.addBindValue(toDbDateTimeString(toUtc));
@@ -725,23 +1478,7 @@ QVariantList UsageDatabase::getToolSeries(const QStringList &tools,
             sampleCount++;
         }
 
-        const QVariantList points = bucketToPoints(buckets);
-        QVariantMap series;
-        series[QStringLiteral("name")] = tool;
-        series[QStringLiteral("points")] = points;
-        series[QStringLiteral("sampleCount")] = sampleCount;
-
-        double latestValue = 0.0;
-        double change = 0.0;
-        if (!points.isEmpty()) {
-            const double first = points.first().toMap().value(QStringLiteral("value")).toDouble();
-            latestValue = points.last().toMap().value(QStringLiteral("value")).toDouble();
-            change = deltaPercent(first, latestValue);
-        }
-
-        series[QStringLiteral("latestValue")] = latestValue;
-        series[QStringLiteral("deltaPercent")] = change;
-        results.append(series);
+        results.append(makeSeries(tool, bucketToPoints(buckets), sampleCount));
     }
 
     return results;
@@ -756,25 +1493,29 @@ QString UsageDatabase::exportCsv(const QString &provider,
                           "cost,daily_cost,monthly_cost,rl_requests,rl_requests_remaining,"
                           "rl_tokens,rl_tokens_remaining\n");
 
-    QVariantList snapshots = getSnapshots(provider, from, to);
-    for (const QVariant &snap : snapshots) {
-        QVariantMap row = snap.toMap();
-        // Qt's multi-arg .arg() supports at most 9 QString arguments,
-        // so we split into two chained calls.
-        csv += QStringLiteral("%1,%2,%3,%4,%5,%6,%7,%8,%9,")
-                   .arg(row[QStringLiteral("timestamp")].toString(),
-                        provider,
-                        QString::number(row[QStringLiteral("inputTokens")].toLongLong()),
-                        QString::number(row[QStringLiteral("outputTokens")].toLongLong()),
-                        QString::number(row[QStringLiteral("requestCount")].toInt()),
-                        QString::number(row[QStringLiteral("cost")].toDouble(), 'f', 6),
-                        QString::number(row[QStringLiteral("dailyCost")].toDouble(), 'f', 6),
-                        QString::number(row[QStringLiteral("monthlyCost")].toDouble(), 'f', 6),
-                        QString::number(row[QStringLiteral("rlRequests")].toInt()));
-        csv += QStringLiteral("%1,%2,%3\n")
-                   .arg(QString::number(row[QStringLiteral("rlRequestsRemaining")].toInt()),
-                        QString::number(row[QStringLiteral("rlTokens")].toInt()),
-                        QString::number(row[QStringLiteral("rlTokensRemaining")].toInt()));
+    // Stream page by page so only one page of rows is held alongside the output
+    SnapshotCursor cursor(this, provider, from, to, SnapshotCursor::DEFAULT_PAGE_SIZE);
+    while (!cursor.atEnd()) {
+        const QVariantList page = cursor.nextPage();
+        for (const QVariant &snap : page) {
+            const QVariantMap row = snap.toMap();
+            // Qt's multi-arg .arg() supports at most 9 QString arguments,
+            // so we split into two chained calls.
+            csv += QStringLiteral("%1,%2,%3,%4,%5,%6,%7,%8,%9,")
+                       .arg(row[QStringLiteral("timestamp")].toString(),
+                            provider,
+                            QString::number(row[QStringLiteral("inputTokens")].toLongLong()),
+                            QString::number(row[QStringLiteral("outputTokens")].toLongLong()),
+                            QString::number(row[QStringLiteral("requestCount")].toInt()),
+                            CostMicros::toDecimalString(row[QStringLiteral("costMicros")].toLongLong()),
+                            CostMicros::toDecimalString(row[QStringLiteral("dailyCostMicros")].toLongLong()),
+                            CostMicros::toDecimalString(row[QStringLiteral("monthlyCostMicros")].toLongLong()),
+                            QString::number(row[QStringLiteral("rlRequests")].toInt()));
+            csv += QStringLiteral("%1,%2,%3\n")
+                       .arg(QString::number(row[QStringLiteral("rlRequestsRemaining")].toInt()),
+                            QString::number(row[QStringLiteral("rlTokens")].toInt()),
+                            QString::number(row[QStringLiteral("rlTokensRemaining")].toInt()));
+        }
     }
 
     return csv;
@@ -784,11 +1525,13 @@ QString UsageDatabase::exportJson(const QString &provider,
                                    const QDateTime &from,
                                    const QDateTime &to) const
 {
-    QVariantList snapshots = getSnapshots(provider, from, to);
-
     QJsonArray arr;
-    for (const QVariant &snap : snapshots) {
-        arr.append(QJsonObject::fromVariantMap(snap.toMap()));
+    SnapshotCursor cursor(this, provider, from, to, SnapshotCursor::DEFAULT_PAGE_SIZE);
+    while (!cursor.atEnd()) {
+        const QVariantList page = cursor.nextPage();
+        for (const QVariant &snap : page) {
+            arr.append(QJsonObject::fromVariantMap(snap.toMap()));
+        }
     }
 
     QJsonObject root;
@@ -851,6 +1594,36 @@ void UsageDatabase::pruneOldData()
         totalDeleted += query.numRowsAffected();
     }
 
+    query.prepare(QStringLiteral(
+        "DELETE FROM api_latency WHERE timestamp < ?"
+    ));
+    query.addBindValue(cutoffStr);
+    if (!query.exec()) {
+        qWarning() << "UsageDatabase: Failed to prune latency:" << query.lastError().text();
+    } else {
+        totalDeleted += query.numRowsAffected();
+    }
+
+    query.prepare(QStringLiteral(
+        "DELETE FROM account_snapshots WHERE timestamp < ?"
+    ));
+    query.addBindValue(cutoffStr);
+    if (!query.exec()) {
+        qWarning() << "UsageDatabase: Failed to prune account snapshots:" << query.lastError().text();
+    } else {
+        totalDeleted += query.numRowsAffected();
+    }
+
+    query.prepare(QStringLiteral(
+        "DELETE FROM billing_ledger WHERE day < ?"
+    ));
+    query.addBindValue(ledgerCutoff().toString(Qt::ISODate));
+    if (!query.exec()) {
+        qWarning() << "UsageDatabase: Failed to prune billing ledger:" << query.lastError().text();
+    } else {
+        totalDeleted += query.numRowsAffected();
+    }
+
     m_db.commit();
 
     // Only vacuum if a meaningful number of rows were deleted
@@ -860,6 +1633,144 @@ void UsageDatabase::pruneOldData()
     }
 }
 
+int UsageDatabase::pruneOldDataBatch(int maxRows, bool *more)
+{
+    if (more)
+        *more = false;
+    if (!m_initialized || maxRows <= 0)
+        return 0;
+
+    const QString cutoffStr = toDbDateTimeString(
+        QDateTime::currentDateTimeUtc().addDays(-m_retentionDays));
+
+    // Rows are appended in time order, so walking the rowid from the start
+    // finds expired rows first and LIMIT stops the scan early.
+    static const char *const tables[] = {
+        "usage_snapshots",
+        "rate_limit_events",
+        "subscription_tool_usage",
+        "api_latency",
+        "account_snapshots",
+    };
+
+    int deleted = 0;
+    QSqlQuery query(m_db);
+    for (const char *table : tables) {
+        query.prepare(QStringLiteral(
+            "DELETE FROM %1 WHERE id IN "
+            "(SELECT id FROM %1 WHERE timestamp < ? ORDER BY id LIMIT ?)")
+                          .arg(QLatin1String(table)));
+        query.addBindValue(cutoffStr);
+        query.addBindValue(maxRows);
+        if (!query.exec()) {
+            qWarning() << "UsageDatabase: Failed to prune" << table << ":" << query.lastError().text();
+            continue;
+        }
+        const int affected = query.numRowsAffected();
+        deleted += affected;
+        if (more && affected >= maxRows)
+            *more = true;
+    }
+
+    // The ledger has at most a few rows per day, so one statement is cheap
+    query.prepare(QStringLiteral("DELETE FROM billing_ledger WHERE day < ?"));
+    query.addBindValue(ledgerCutoff().toString(Qt::ISODate));
+    if (!query.exec()) {
+        qWarning() << "UsageDatabase: Failed to prune billing ledger:" << query.lastError().text();
+    } else {
+        deleted += query.numRowsAffected();
+    }
+
+    return deleted;
+}
+
+bool UsageDatabase::optimize()
+{
+    if (!m_initialized)
+        return false;
+
+    QSqlQuery query(m_db);
+    if (!query.exec(QStringLiteral("PRAGMA optimize"))) {
+        qWarning() << "UsageDatabase: PRAGMA optimize failed:" << query.lastError().text();
+        return false;
+    }
+    return true;
+}
+
+bool UsageDatabase::checkpointWal()
+{
+    if (!m_initialized)
+        return false;
+
+    QSqlQuery query(m_db);
+    if (!query.exec(QStringLiteral("PRAGMA wal_checkpoint(TRUNCATE)"))) {
+        qWarning() << "UsageDatabase: WAL checkpoint failed:" << query.lastError().text();
+        return false;
+    }
+    // Result row: busy, log frames, checkpointed frames
+    return query.next() && query.value(0).toInt() == 0;
+}
+
+int UsageDatabase::incrementalVacuum(int maxPages)
+{
+    if (!m_initialized)
+        return -1;
+
+    QSqlQuery query(m_db);
+    auto pragmaInt = [&query](const QString &sql) -> int {
+        if (!query.exec(sql) || !query.next()) {
+            return -1;
+        }
+        return query.value(0).toInt();
+    };
+
+    const int freePages = pragmaInt(QStringLiteral("PRAGMA freelist_count"));
+    if (freePages <= 0) {
+        return freePages;
+    }
+
+    // Older files need the full conversion first, which is too long for a slice
+    if (pragmaInt(QStringLiteral("PRAGMA auto_vacuum")) != 2) {
+        return 0;
+    }
+
+    if (!query.exec(QStringLiteral("PRAGMA incremental_vacuum(%1)").arg(qMax(1, maxPages)))) {
+        qWarning() << "UsageDatabase: incremental_vacuum failed:" << query.lastError().text();
+        return -1;
+    }
+    // incremental_vacuum returns no rows but needs to be stepped to completion
+    while (query.next()) {
+    }
+
+    return pragmaInt(QStringLiteral("PRAGMA freelist_count"));
+}
+
+bool UsageDatabase::needsVacuumConversion() const
+{
+    if (!m_initialized)
+        return false;
+
+    QSqlQuery query(m_db);
+    // 2 = INCREMENTAL
+    return query.exec(QStringLiteral("PRAGMA auto_vacuum")) && query.next() && query.value(0).toInt() != 2;
+}
+
+bool UsageDatabase::convertToIncrementalVacuum()
+{
+    if (!m_initialized)
+        return false;
+    if (!needsVacuumConversion())
+        return true;
+
+    QSqlQuery query(m_db);
+    query.exec(QStringLiteral("PRAGMA auto_vacuum=INCREMENTAL"));
+    if (!query.exec(QStringLiteral("VACUUM"))) {
+        qWarning() << "UsageDatabase: VACUUM failed:" << query.lastError().text();
+        return false;
+    }
+    return !needsVacuumConversion();
+}
+
 qint64 UsageDatabase::databaseSize() const
 {
     if (!m_initialized)
@@ -868,3 +1779,415 @@ qint64 UsageDatabase::databaseSize() const
     QFileInfo fi(m_db.databaseName());
     return fi.size();
 }
+
+// --- Billing ledger ---
+
+bool UsageDatabase::writeLedger(const QString &provider, const QString &account, const QString &source,
+                                const QDate &from, const QDate &to,
+                                const QList<LedgerEntry> &entries, const QDate &closedThrough)
+{
+    if (!m_enabled || !from.isValid() || !to.isValid() || from > to)
+        return false;
+
+    initDatabase();
+    if (!m_initialized)
+        return false;
+
+    if (!m_db.transaction()) {
+        qWarning() << "UsageDatabase: Failed to start ledger write:" << m_db.lastError().text();
+        return false;
+    }
+
+    QSqlQuery query(m_db);
+    query.prepare(QStringLiteral(
+        "DELETE FROM billing_ledger "
+        "WHERE provider = ? AND account = ? AND source = ? AND day >= ? AND day <= ?"));
+    query.addBindValue(provider);
+    query.addBindValue(account);
+    query.addBindValue(source);
+    query.addBindValue(from.toString(Qt::ISODate));
+    query.addBindValue(to.toString(Qt::ISODate));
+    bool ok = query.exec();
+
+    query.prepare(QStringLiteral(
+        "INSERT INTO billing_ledger "
+        "(provider, account, source, day, project, model, "
+        "input_tokens, output_tokens, request_count, cost_micros) "
+        "VALUES (?, ?, ?, ?, ?, ?, ?, ?, ?, ?) "
+        "ON CONFLICT (provider, account, source, day, project, model) DO UPDATE SET "
+        "input_tokens = input_tokens + excluded.input_tokens, "
+        "output_tokens = output_tokens + excluded.output_tokens, "
+        "request_count = request_count + excluded.request_count, "
+        "cost_micros = cost_micros + excluded.cost_micros"));
+    for (const LedgerEntry &entry : entries) {
+        if (!ok)
+            break;
+        if (entry.day < from || entry.day > to)
+            continue;
+        query.addBindValue(provider);
+        query.addBindValue(account);
+        query.addBindValue(source);
+        query.addBindValue(entry.day.toString(Qt::ISODate));
+        // A null string would bind as NULL; the key columns need ''
+        query.addBindValue(entry.project.isNull() ? QStringLiteral("") : entry.project);
+        query.addBindValue(entry.model.isNull() ? QStringLiteral("") : entry.model);
+        query.addBindValue(entry.inputTokens);
+        query.addBindValue(entry.outputTokens);
+        query.addBindValue(entry.requests);
+        query.addBindValue(entry.costMicros);
+        ok = query.exec();
+    }
+
+    if (ok && closedThrough.isValid()) {
+        query.prepare(QStringLiteral(
+            "INSERT INTO billing_ledger_marks (provider, account, source, closed_through) "
+            "VALUES (?, ?, ?, ?) "
+            "ON CONFLICT (provider, account, source) DO UPDATE SET "
+            "closed_through = MAX(closed_through, excluded.closed_through)"));
+        query.addBindValue(provider);
+        query.addBindValue(account);
+        query.addBindValue(source);
+        query.addBindValue(closedThrough.toString(Qt::ISODate));
+        ok = query.exec();
+    }
+
+    if (!ok) {
+        qWarning() << "UsageDatabase: Failed to write billing ledger:" << query.lastError().text();
+        m_db.rollback();
+        return false;
+    }
+    return m_db.commit();
+}
+
+bool UsageDatabase::addLedgerEntries(const QString &provider, const QString &account, const QString &source,
+                                     const QList<LedgerEntry> &entries)
+{
+    if (!m_enabled || entries.isEmpty())
+        return false;
+
+    initDatabase();
+    if (!m_initialized)
+        return false;
+
+    if (!m_db.transaction()) {
+        qWarning() << "UsageDatabase: Failed to start ledger write:" << m_db.lastError().text();
+        return false;
+    }
+
+    QSqlQuery query(m_db);
+    query.prepare(QStringLiteral(
+        "INSERT INTO billing_ledger "
+        "(provider, account, source, day, project, model, "
+        "input_tokens, output_tokens, request_count, cost_micros) "
+        "VALUES (?, ?, ?, ?, ?, ?, ?, ?, ?, ?) "
+        "ON CONFLICT (provider, account, source, day, project, model) DO UPDATE SET "
+        "input_tokens = input_tokens + excluded.input_tokens, "
+        "output_tokens = output_tokens + excluded.output_tokens, "
+        "request_count = request_count + excluded.request_count, "
+        "cost_micros = cost_micros + excluded.cost_micros"));
+
+    bool ok = true;
+    for (const LedgerEntry &entry : entries) {
+        if (!entry.day.isValid())
+            continue;
+        query.addBindValue(provider);
+        query.addBindValue(account);
+        query.addBindValue(source);
+        query.addBindValue(entry.day.toString(Qt::ISODate));
+        // A null string would bind as NULL; the key columns need ''
+        query.addBindValue(entry.project.isNull() ? QStringLiteral("") : entry.project);
+        query.addBindValue(entry.model.isNull() ? QStringLiteral("") : entry.model);
+        query.addBindValue(entry.inputTokens);
+        query.addBindValue(entry.outputTokens);
+        query.addBindValue(entry.requests);
+        query.addBindValue(entry.costMicros);
+        if (!query.exec()) {
+            ok = false;
+            break;
+        }
+    }
+
+    if (!ok) {
+        qWarning() << "UsageDatabase: Failed to add to billing ledger:" << query.lastError().text();
+        m_db.rollback();
+        return false;
+    }
+    return m_db.commit();
+}
+
+QDate UsageDatabase::ledgerClosedThrough(const QString &provider, const QString &account,
+                                         const QString &source) const
+{
+    if (!m_initialized)
+        return QDate();
+
+    QSqlQuery query(m_db);
+    query.prepare(QStringLiteral(
+        "SELECT closed_through FROM billing_ledger_marks "
+        "WHERE provider = ? AND account = ? AND source = ?"));
+    query.addBindValue(provider);
+    query.addBindValue(account);
+    query.addBindValue(source);
+    if (!query.exec() || !query.next())
+        return QDate();
+
+    // A mark older than the prune cutoff points at rows that are gone
+    const QDate closed = QDate::fromString(query.value(0).toString(), Qt::ISODate);
+    return closed >= ledgerCutoff() ? closed : QDate();
+}
+
+UsageDatabase::LedgerTotals UsageDatabase::ledgerTotals(const QString &provider, const QString &account,
+                                                        const QString &source,
+                                                        const QDate &from, const QDate &to,
+                                                        const QString &project, const QString &model) const
+{
+    LedgerTotals totals;
+    if (!m_initialized)
+        return totals;
+
+    QSqlQuery query(m_db);
+    query.prepare(UsageDatabaseSql::ledgerTotals());
+    query.addBindValue(provider);
+    query.addBindValue(account);
+    query.addBindValue(source);
+    query.addBindValue(from.toString(Qt::ISODate));
+    query.addBindValue(to.toString(Qt::ISODate));
+    query.addBindValue(project);
+    query.addBindValue(project);
+    query.addBindValue(model);
+    query.addBindValue(model);
+
+    if (!query.exec()) {
+        qWarning() << "UsageDatabase: Failed to sum billing ledger:" << query.lastError().text();
+        return totals;
+    }
+    if (query.next()) {
+        totals.inputTokens = query.value(0).toLongLong();
+        totals.outputTokens = query.value(1).toLongLong();
+        totals.requests = query.value(2).toLongLong();
+        totals.costMicros = query.value(3).toLongLong();
+    }
+    return totals;
+}
+
+QDate UsageDatabase::ledgerCutoff() const
+{
+    const QDate today = QDateTime::currentDateTimeUtc().date();
+    const QDate previousMonth = QDate(today.year(), today.month(), 1).addMonths(-1);
+    return qMin(today.addDays(-m_retentionDays), previousMonth);
+}
+
+// --- Query plans ---
+
+namespace {
+struct HotQuery {
+    const char *name;
+    QString (*sql)();
+};
+
+// Representative instances of every read path; parameterised SQL uses one
+// provider and the widest counter expression.
+const HotQuery s_hotQueries[] = {
+    {"snapshotPage", &UsageDatabaseSql::snapshotPage},
+    {"dailyCosts", &UsageDatabaseSql::dailyCosts},
+    {"summary", &UsageDatabaseSql::summary},
+    {"providerSeries", &UsageDatabaseSql::providerSeries},
+    {"rateSeries", []() { return UsageDatabaseSql::rateSeries(QStringLiteral("input_tokens + output_tokens")); }},
+    {"heatmapCounters", []() { return UsageDatabaseSql::heatmapCounters(1, QStringLiteral("input_tokens + output_tokens")); }},
+    {"heatmapEvents", []() { return UsageDatabaseSql::heatmapEvents(1); }},
+    {"periodComparison", []() { return UsageDatabaseSql::periodComparison(1, QStringLiteral("input_tokens + output_tokens")); }},
+    {"providers", &UsageDatabaseSql::providers},
+    {"toolSnapshots", &UsageDatabaseSql::toolSnapshots},
+    {"toolSeries", &UsageDatabaseSql::toolSeries},
+    {"toolNames", &UsageDatabaseSql::toolNames},
+    {"ledgerTotals", &UsageDatabaseSql::ledgerTotals},
+    {"latencySeries", &UsageDatabaseSql::latencySeries},
+    {"accountSeries", &UsageDatabaseSql::accountSeries},
+    {"accounts", &UsageDatabaseSql::accounts},
+};
+} // namespace
+
+QStringList UsageDatabase::hotQueryNames()
+{
+    QStringList names;
+    for (const HotQuery &hot : s_hotQueries) {
+        names.append(QLatin1String(hot.name));
+    }
+    return names;
+}
+
+QString UsageDatabase::queryPlan(const QString &queryName) const
+{
+    if (!m_initialized)
+        return QString();
+
+    for (const HotQuery &hot : s_hotQueries) {
+        if (queryName != QLatin1String(hot.name))
+            continue;
+
+        const QString sql = hot.sql();
+        QSqlQuery query(m_db);
+        if (!query.prepare(QStringLiteral("EXPLAIN QUERY PLAN ") + sql)) {
+            qWarning() << "UsageDatabase: Failed to explain" << queryName << ":" << query.lastError().text();
+            return QString();
+        }
+        // Placeholder values do not change the plan shape
+        for (qsizetype i = 0, n = sql.count(QLatin1Char('?')); i < n; ++i) {
+            query.addBindValue(QString());
+        }
+        if (!query.exec()) {
+            qWarning() << "UsageDatabase: Failed to explain" << queryName << ":" << query.lastError().text();
+            return QString();
+        }
+
+        // Columns: id, parent, notused, detail
+        QStringList lines;
+        while (query.next()) {
+            lines.append(query.value(3).toString());
+        }
+        return lines.join(QLatin1Char('\n'));
+    }
+
+    return QString();
+}
+
+// --- Online backup ---
+
+bool UsageDatabase::backupTo(const QString &path)
+{
+    if (m_backupThread) {
+        qWarning() << "UsageDatabase: Backup already in progress";
+        return false;
+    }
+
+    initDatabase();
+    if (!m_initialized || path.isEmpty())
+        return false;
+
+    const QString source = m_db.databaseName();
+    const QString target = QFileInfo(path).absoluteFilePath();
+    if (target == QFileInfo(source).absoluteFilePath()) {
+        qWarning() << "UsageDatabase: Refusing to back up the database onto itself";
+        return false;
+    }
+    QDir().mkpath(QFileInfo(target).absolutePath());
+
+    m_backupCancel = std::make_shared<std::atomic_bool>(false);
+    const std::shared_ptr<std::atomic_bool> cancel = m_backupCancel;
+
+    // The destructor joins the worker, so `this` outlives every queued call.
+    m_backupThread = QThread::create([this, source, target, cancel]() {
+        const BackupOutcome outcome = runOnlineBackup(
+            source, target, BACKUP_PAGES_PER_STEP, BACKUP_STEP_SLEEP_MS, *cancel,
+            [this](int remaining, int total) {
+                const double progress = total > 0 ? double(total - remaining) / double(total) : 0.0;
+                QMetaObject::invokeMethod(this, [this, progress]() {
+                    setBackupProgress(progress);
+                }, Qt::QueuedConnection);
+            });
+
+        QMetaObject::invokeMethod(this, [this, target, outcome]() {
+            finishBackup(target, outcome.success, outcome.bytes, outcome.elapsedMs, outcome.error);
+        }, Qt::QueuedConnection);
+    });
+    connect(m_backupThread, &QThread::finished, m_backupThread, &QObject::deleteLater);
+
+    m_backupRotating = false;
+    setBackupProgress(0.0);
+    m_backupThread->start(QThread::LowPriority);
+    Q_EMIT backupRunningChanged();
+    return true;
+}
+
+QString UsageDatabase::backupNow()
+{
+    const QString path = effectiveBackupDirectory()
+        + QStringLiteral("/usage_history-%1.db")
+              .arg(QDateTime::currentDateTimeUtc().toString(QStringLiteral("yyyyMMdd-HHmmss")));
+
+    if (!backupTo(path))
+        return QString();
+
+    m_backupRotating = true;
+    return path;
+}
+
+QString UsageDatabase::effectiveBackupDirectory() const
+{
+    if (!m_backupDirectory.isEmpty())
+        return m_backupDirectory;
+
+    return QStandardPaths::writableLocation(QStandardPaths::GenericDataLocation)
+           + QStringLiteral("/plasma-ai-usage-monitor/backups");
+}
+
+void UsageDatabase::setBackupProgress(double progress)
+{
+    if (!qFuzzyCompare(1.0 + m_backupProgress, 1.0 + progress)) {
+        m_backupProgress = progress;
+        Q_EMIT backupProgressChanged();
+    }
+}
+
+void UsageDatabase::finishBackup(const QString &path, bool success, qint64 bytes,
+                                 qint64 elapsedMs, const QString &error)
+{
+    // The worker posts this as its last action, so the join is immediate.
+    if (m_backupThread) {
+        m_backupThread->wait();
+        m_backupThread = nullptr;
+    }
+
+    const double bytesPerSecond = elapsedMs > 0 ? double(bytes) * 1000.0 / double(elapsedMs) : double(bytes);
+    if (success) {
+        setBackupProgress(1.0);
+        if (m_backupRotating) {
+            rotateBackups();
+        }
+    } else {
+        qWarning() << "UsageDatabase: Backup to" << path << "failed:" << error;
+    }
+    m_backupRotating = false;
+
+    Q_EMIT backupRunningChanged();
+    Q_EMIT backupFinished(success, path, bytes, bytesPerSecond, error);
+}
+
+QDateTime UsageDatabase::lastBackupTime() const
+{
+    // Names carry the UTC start time; the newest sorts first
+    const QStringList backups = QDir(effectiveBackupDirectory())
+        .entryList({QStringLiteral("usage_history-*.db")}, QDir::Files, QDir::Name | QDir::Reversed);
+    for (const QString &name : backups) {
+        QDateTime time = QDateTime::fromString(name.mid(14, 15), QStringLiteral("yyyyMMdd-HHmmss"));
+        if (time.isValid()) {
+            time.setTimeZone(QTimeZone::UTC);
+            return time;
+        }
+    }
+    return QDateTime();
+}
+
+void UsageDatabase::runScheduledBackup()
+{
+    if (m_backupIntervalHours <= 0 || m_backupThread)
+        return;
+
+    const QDateTime last = lastBackupTime();
+    if (last.isValid()
+        && last.secsTo(QDateTime::currentDateTimeUtc()) < qint64(m_backupIntervalHours) * 60 * 60) {
+        return;
+    }
+    backupNow();
+}
+
+void UsageDatabase::rotateBackups()
+{
+    QDir dir(effectiveBackupDirectory());
+    // Timestamped names sort chronologically; newest first
+    const QStringList backups = dir.entryList({QStringLiteral("usage_history-*.db")},
+                                              QDir::Files, QDir::Name | QDir::Reversed);
+    for (int i = m_backupKeepCount; i < backups.size(); ++i) {
+        dir.remove(backups.at(i));
+    }
+}
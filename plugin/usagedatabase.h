@@ -3,27 +3,71 @@
 
 #include <QObject>
 #include <QString>
+#include <QDate>
 #include <QDateTime>
 #include <QVariantList>
 #include <QVariantMap>
 #include <QSqlDatabase>
 #include <QHash>
+#include <QList>
+#include <QPointer>
 #include <atomic>
+#include <memory>
+
+class QThread;
+class QTimer;
+class SnapshotCursor;
 
 /**
  * SQLite database for persisting AI usage history.
  *
  * Stores periodic snapshots of provider usage data and rate limit events.
  * Supports configurable retention and querying by time range for charts.
+ *
+ * Providers polled through several accounts (ProviderAccountGroup) record
+ * their combined figures as ordinary snapshots and each account's own
+ * figures in account_snapshots, so aggregate history is never counted
+ * twice.
+ *
+ * Also holds the billing ledger: per-day usage and cost rows keyed by
+ * provider, account, source, UTC day, project and model, plus a
+ * closed-through mark per source. Providers with day-bucketed billing APIs
+ * fetch only the days after the mark and sum the rest locally.
  */
 class UsageDatabase : public QObject
 {
     Q_OBJECT
+    Q_MOC_INCLUDE("snapshotcursor.h")
 
     Q_PROPERTY(bool enabled READ isEnabled WRITE setEnabled NOTIFY enabledChanged)
     Q_PROPERTY(int retentionDays READ retentionDays WRITE setRetentionDays NOTIFY retentionDaysChanged)
 
+    // Online backups
+    Q_PROPERTY(bool backupRunning READ isBackupRunning NOTIFY backupRunningChanged)
+    Q_PROPERTY(double backupProgress READ backupProgress NOTIFY backupProgressChanged)
+    Q_PROPERTY(QString backupDirectory READ backupDirectory WRITE setBackupDirectory NOTIFY backupDirectoryChanged)
+    Q_PROPERTY(int backupIntervalHours READ backupIntervalHours WRITE setBackupIntervalHours NOTIFY backupIntervalHoursChanged)
+    Q_PROPERTY(int backupKeepCount READ backupKeepCount WRITE setBackupKeepCount NOTIFY backupKeepCountChanged)
+
 public:
+    /// One billing ledger row: usage or cost for one UTC day, project and model.
+    struct LedgerEntry {
+        QDate day;
+        QString project;
+        QString model;
+        qint64 inputTokens = 0;
+        qint64 outputTokens = 0;
+        qint64 requests = 0;
+        qint64 costMicros = 0;
+    };
+
+    struct LedgerTotals {
+        qint64 inputTokens = 0;
+        qint64 outputTokens = 0;
+        qint64 requests = 0;
+        qint64 costMicros = 0;
+    };
+
     explicit UsageDatabase(QObject *parent = nullptr);
     ~UsageDatabase() override;
 
@@ -32,6 +76,18 @@ public:
     int retentionDays() const;
     void setRetentionDays(int days);
 
+    bool isBackupRunning() const;
+    double backupProgress() const;
+    /// Directory for rotating backups; empty means "<data dir>/backups".
+    QString backupDirectory() const;
+    void setBackupDirectory(const QString &directory);
+    /// Hours between scheduled backups; 0 disables scheduling.
+    int backupIntervalHours() const;
+    void setBackupIntervalHours(int hours);
+    /// Number of rotating backups to keep.
+    int backupKeepCount() const;
+    void setBackupKeepCount(int count);
+
     /**
      * Record a usage snapshot for a provider.
      * Called automatically after each successful refresh.
@@ -66,16 +122,43 @@ public:
                                            const QString &eventType,
                                            int percentUsed);
 
+    /**
+     * Record one summary of ProviderBackend::networkStats(): request and
+     * failure counts plus median DNS, connect, TTFB and total latency and
+     * the p95 total. Windows without requests are not written.
+     */
+    Q_INVOKABLE void recordNetworkStats(const QString &provider, const QVariantMap &stats);
+
+    /**
+     * Record one snapshot per account of a multi-account provider, in one
+     * transaction. Takes ProviderAccountGroup::accountStatus() as is: maps
+     * with id, inputTokens, outputTokens, requestCount, costMicros,
+     * dailyCostMicros, monthlyCostMicros and the rateLimit* values. Accounts
+     * are throttled like recordSnapshot().
+     */
+    Q_INVOKABLE void recordAccountSnapshots(const QString &provider, const QVariantList &accounts);
+
     /**
      * Query usage snapshots for a provider within a time range.
      * Returns a list of QVariantMap with keys: timestamp, inputTokens, outputTokens,
      * requestCount, cost, dailyCost, monthlyCost, rlRequests, rlRequestsRemaining,
-     * rlTokens, rlTokensRemaining.
+     * rlTokens, rlTokensRemaining. Costs are in dollars; the exact stored values
+     * are also returned as costMicros, dailyCostMicros and monthlyCostMicros.
      */
     Q_INVOKABLE QVariantList getSnapshots(const QString &provider,
                                            const QDateTime &from,
                                            const QDateTime &to) const;
 
+    /**
+     * Open a keyset-paginated cursor over the same rows as getSnapshots().
+     * Call nextPage() until atEnd to read the range in bounded pages.
+     * The cursor has no parent: QML garbage-collects it, C++ callers own it.
+     */
+    Q_INVOKABLE SnapshotCursor *openSnapshotCursor(const QString &provider,
+                                                   const QDateTime &from,
+                                                   const QDateTime &to,
+                                                   int pageSize = 500) const;
+
     /**
      * Query cost data aggregated by day for a provider.
      * Returns a list of QVariantMap with keys: date, totalCost, maxDailyCost.
@@ -107,12 +190,41 @@ public:
                                                const QDateTime &from,
                                                const QDateTime &to) const;
 
+    /**
+     * Query recorded latency summaries for a provider within a time range.
+     * Returns a list of QVariantMap with keys: timestamp, requests, failures,
+     * dnsP50Ms, connectP50Ms, ttfbP50Ms, totalP50Ms, totalP95Ms.
+     */
+    Q_INVOKABLE QVariantList getLatencySeries(const QString &provider,
+                                              const QDateTime &from,
+                                              const QDateTime &to) const;
+
+    /**
+     * Query one account's snapshots within a time range.
+     * Returns a list of QVariantMap with keys: timestamp, cost, dailyCost,
+     * costMicros, inputTokens, outputTokens, requestCount, rlRequests,
+     * rlRequestsRemaining.
+     */
+    Q_INVOKABLE QVariantList getAccountSeries(const QString &provider,
+                                              const QString &account,
+                                              const QDateTime &from,
+                                              const QDateTime &to) const;
+
+    /**
+     * Accounts that have recorded data for a provider.
+     */
+    Q_INVOKABLE QStringList getAccounts(const QString &provider) const;
+
     /**
      * Query aggregated time series for one or more providers.
      * Returns items with keys: name, points, latestValue, deltaPercent, sampleCount.
      * Each points entry has: timestamp, value.
      *
-     * Supported metrics: cost, tokens, requests, rateLimitUsed
+     * Supported metrics: cost, tokens, requests, rateLimitUsed, and the
+     * rate metrics tokensPerMinute, requestsPerMinute and costPerHour.
+     * Rate metrics are derived in SQL from consecutive snapshots, treating a
+     * decreasing counter as a reset; each point is the average rate over
+     * the snapshot intervals ending in that bucket.
      */
     Q_INVOKABLE QVariantList getProviderSeries(const QStringList &providers,
                                                const QDateTime &from,
@@ -120,6 +232,44 @@ public:
                                                const QString &metric,
                                                int bucketMinutes = 60) const;
 
+    /**
+     * Aggregate usage into a local-time day-of-week x hour-of-day grid.
+     * Returns 168 values, index = dayOfWeek * 24 + hour with Sunday = 0.
+     * An empty providers list means all providers.
+     *
+     * Supported metrics: tokens, requests, cost (counter increases between
+     * consecutive snapshots, resets handled as in getProviderSeries) and
+     * rateLimitEvents (number of recorded rate limit events).
+     */
+    Q_INVOKABLE QList<double> getUsageHeatmap(const QStringList &providers,
+                                              const QDateTime &from,
+                                              const QDateTime &to,
+                                              const QString &metric) const;
+
+    /**
+     * Compare usage in two periods, e.g. this week against last week.
+     *
+     * Both periods are scanned in one pass and bucketed on a shared grid
+     * relative to each period's start, so point i of "current" and
+     * "previous" covers the same offset into its period.
+     *
+     * Returns a map with keys: bucketSeconds, currentTotal, previousTotal,
+     * deltaPercent (summed over all providers) and providers, a list with
+     * keys: name, points, currentTotal, previousTotal, deltaPercent,
+     * currentSampleCount, previousSampleCount. Each points entry has:
+     * offsetSeconds, timestamp (in the current period), current, previous.
+     *
+     * Supported metrics: tokens, requests, cost (counter increases, resets
+     * handled as in getProviderSeries).
+     */
+    Q_INVOKABLE QVariantMap comparePeriods(const QStringList &providers,
+                                           const QString &metric,
+                                           const QDateTime &currentFrom,
+                                           const QDateTime &currentTo,
+                                           const QDateTime &previousFrom,
+                                           const QDateTime &previousTo,
+                                           int bucketMinutes = 60) const;
+
     /**
      * Query aggregated time series for one or more subscription tools.
      * Returns items with keys: name, points, latestValue, deltaPercent, sampleCount.
@@ -157,6 +307,45 @@ public:
      */
     Q_INVOKABLE void pruneOldData();
 
+    /**
+     * Remove at most maxRows expired rows from each history table.
+     * Returns the total number of rows deleted. If `more` is given, it is
+     * set when some table hit the limit and may still hold expired rows.
+     * Used by MaintenanceScheduler to keep each slice short.
+     */
+    int pruneOldDataBatch(int maxRows, bool *more = nullptr);
+
+    /**
+     * Refresh query planner statistics (PRAGMA optimize, which runs
+     * ANALYZE only on tables whose statistics are stale).
+     */
+    bool optimize();
+
+    /**
+     * Checkpoint the WAL into the main database file and truncate it.
+     */
+    bool checkpointWal();
+
+    /**
+     * Return up to maxPages free pages to the filesystem.
+     * Returns the number of free pages still left, or -1 on failure.
+     * Does nothing (returns 0) until the database is in incremental
+     * auto-vacuum mode; see convertToIncrementalVacuum().
+     */
+    int incrementalVacuum(int maxPages);
+
+    /**
+     * Whether the file predates incremental auto-vacuum and still needs
+     * the one-time conversion before incrementalVacuum() can free pages.
+     */
+    Q_INVOKABLE bool needsVacuumConversion() const;
+
+    /**
+     * Switch the file to incremental auto-vacuum with a full VACUUM.
+     * Rewrites the whole database, so it only runs on explicit request.
+     */
+    Q_INVOKABLE bool convertToIncrementalVacuum();
+
     /**
      * Eagerly initialize the database.
      * Call early (e.g., Component.onCompleted) to avoid blocking on first write.
@@ -168,13 +357,98 @@ public:
      */
     Q_INVOKABLE qint64 databaseSize() const;
 
+    /**
+     * Names of the read queries covered by queryPlan().
+     */
+    static QStringList hotQueryNames();
+
+    /**
+     * EXPLAIN QUERY PLAN output for one of hotQueryNames(), one plan step
+     * per line. Used by tests to catch queries that stop using their index.
+     */
+    QString queryPlan(const QString &queryName) const;
+
+    /**
+     * Copy the live database to path using the SQLite online backup API.
+     * Pages are copied in small batches on a worker thread, sleeping between
+     * batches so writers on the main connection are never blocked for long.
+     * Returns false if a backup is already running or the database is not
+     * available; completion is reported via backupFinished().
+     */
+    Q_INVOKABLE bool backupTo(const QString &path);
+
+    /**
+     * Start a timestamped backup in backupDirectory and drop the oldest
+     * files beyond backupKeepCount once it completes.
+     * Returns the target path, or an empty string if no backup was started.
+     */
+    Q_INVOKABLE QString backupNow();
+
+    // ── Billing ledger ──
+
+    /**
+     * Replace the ledger rows of one source (e.g. "usage", "costs") for
+     * every day in [from, to] with entries, and move the source's
+     * closed-through mark forward to closedThrough (it never moves back).
+     * Entries sharing a key are summed. Runs in one transaction; returns
+     * false if nothing was written.
+     */
+    bool writeLedger(const QString &provider, const QString &account, const QString &source,
+                     const QDate &from, const QDate &to,
+                     const QList<LedgerEntry> &entries, const QDate &closedThrough);
+
+    /**
+     * Add entries to the ledger rows of one source without replacing any:
+     * usage that is counted as it happens (e.g. requests seen by
+     * UsageProxy, source "proxy") rather than fetched per day. Entries
+     * sharing a key are summed. Runs in one transaction.
+     */
+    bool addLedgerEntries(const QString &provider, const QString &account, const QString &source,
+                          const QList<LedgerEntry> &entries);
+
+    /// Last day whose rows are final; invalid if the source has no ledger yet.
+    QDate ledgerClosedThrough(const QString &provider, const QString &account,
+                              const QString &source) const;
+
+    /// Sums over [from, to]; an empty project or model matches all.
+    LedgerTotals ledgerTotals(const QString &provider, const QString &account, const QString &source,
+                              const QDate &from, const QDate &to,
+                              const QString &project = QString(), const QString &model = QString()) const;
+
 Q_SIGNALS:
     void enabledChanged();
     void retentionDaysChanged();
+    void backupRunningChanged();
+    void backupProgressChanged();
+    void backupDirectoryChanged();
+    void backupIntervalHoursChanged();
+    void backupKeepCountChanged();
+    void backupFinished(bool success, const QString &path, qint64 bytes,
+                        double bytesPerSecond, const QString &error);
 
 private:
+    friend class SnapshotCursor;
+
     void initDatabase();
     void createTables();
+    bool migrateCostsToMicros();
+    bool queryRateSeries(const QString &provider,
+                         const QDateTime &fromUtc,
+                         const QDateTime &toUtc,
+                         QLatin1String counterExpr,
+                         double scale,
+                         int bucketSecs,
+                         QVariantList *points,
+                         int *sampleCount) const;
+    QString effectiveBackupDirectory() const;
+    void setBackupProgress(double progress);
+    void finishBackup(const QString &path, bool success, qint64 bytes,
+                      qint64 elapsedMs, const QString &error);
+    void rotateBackups();
+    /// Start time of the newest backup in the backup directory, if any.
+    QDateTime lastBackupTime() const;
+    /// Back up if the newest backup is older than backupIntervalHours.
+    void runScheduledBackup();
 
     QSqlDatabase m_db;
     QString m_connectionName;
@@ -184,10 +458,33 @@ private:
 
     static std::atomic<int> s_instanceCounter;
 
+    // Schema versions (PRAGMA user_version):
+    //   0 - original layout, costs stored as REAL dollars
+    //   1 - costs stored as INTEGER micro-dollars (*_cost_micros columns)
+    static constexpr int SCHEMA_VERSION = 1;
+
+    // Ledger rows are kept for the retention period, but never less than
+    // the current and previous month so month-to-date sums stay complete
+    QDate ledgerCutoff() const;
+
     // Write throttling: minimum 60 seconds between writes per provider
     static constexpr int WRITE_THROTTLE_SECS = 60;
     QHash<QString, qint64> m_lastWriteTime; // provider -> epoch seconds
-    QHash<QString, double> m_lastWrittenCost; // provider -> last cost to detect changes
+    QHash<QString, qint64> m_lastWrittenCost; // provider -> last cost (micro-dollars) to detect changes
+
+    // Online backup state
+    QPointer<QThread> m_backupThread;
+    std::shared_ptr<std::atomic_bool> m_backupCancel;
+    QTimer *m_backupTimer = nullptr;
+    QString m_backupDirectory;
+    double m_backupProgress = 0.0;
+    bool m_backupRotating = false;
+    int m_backupIntervalHours = 0;
+    int m_backupKeepCount = 7;
+
+    static constexpr int BACKUP_PAGES_PER_STEP = 256; // ~1 MiB with 4 KiB pages
+    static constexpr int BACKUP_STEP_SLEEP_MS = 10;   // let writers in between batches
+    static constexpr int BACKUP_CHECK_INTERVAL_MS = 60 * 60 * 1000;
 };
 
 #endif // USAGEDATABASE_H
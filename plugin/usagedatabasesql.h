@@ -0,0 +1,261 @@
+#ifndef USAGEDATABASESQL_H
+#define USAGEDATABASESQL_H
+
+#include <QString>
+#include <QStringList>
+
+/**
+ * SQL for the hot read paths of UsageDatabase.
+ *
+ * Kept in one place so UsageDatabase::queryPlan() explains exactly the
+ * statements the public methods run. Every query here is written to be
+ * answered from one of the indexes created in UsageDatabase::createTables():
+ *
+ *   idx_snapshots_covering   usage_snapshots(provider, timestamp, id,
+ *                            cost_micros, daily_cost_micros, input_tokens,
+ *                            output_tokens, request_count, rl_requests,
+ *                            rl_requests_remaining)
+ *   idx_tool_usage_covering  subscription_tool_usage(tool_name, timestamp, id,
+ *                            usage_count, usage_limit)
+ *   idx_ratelimit_provider_time  rate_limit_events(provider, timestamp)
+ *   idx_latency_covering     api_latency(provider, timestamp, id, requests,
+ *                            failures, dns_p50_ms, connect_p50_ms,
+ *                            ttfb_p50_ms, total_p50_ms, total_p95_ms)
+ *   idx_account_snapshots_covering  account_snapshots(provider, account,
+ *                            timestamp, id, cost_micros, daily_cost_micros,
+ *                            input_tokens, output_tokens, request_count,
+ *                            rl_requests, rl_requests_remaining)
+ *   billing_ledger primary key   (provider, account, source, day, project,
+ *                                model), WITHOUT ROWID
+ *
+ * `id` is listed explicitly so (timestamp, id) ordering comes straight from
+ * the index even though value columns follow it.
+ *
+ * Cost columns hold integer micro-dollars (see costmicros.h), so SUM and MAX
+ * over them are exact; callers convert to dollars when building results.
+ */
+namespace UsageDatabaseSql {
+
+/// "provider IN (?, ...) AND " for count providers, or empty for all.
+inline QString providerInFilter(int count)
+{
+    if (count <= 0)
+        return QString();
+
+    QStringList placeholders;
+    placeholders.fill(QStringLiteral("?"), count);
+    return QStringLiteral("provider IN (%1) AND ").arg(placeholders.join(QStringLiteral(", ")));
+}
+
+/// Binds: provider, lastTimestamp, to, lastTimestamp, lastId, limit
+inline QString snapshotPage()
+{
+    return QStringLiteral(
+        "SELECT id, timestamp, input_tokens, output_tokens, request_count, cost_micros, "
+        "daily_cost_micros, monthly_cost_micros, rl_requests, rl_requests_remaining, "
+        "rl_tokens, rl_tokens_remaining "
+        "FROM usage_snapshots "
+        "WHERE provider = ? AND timestamp >= ? AND timestamp <= ? "
+        "AND (timestamp > ? OR id > ?) "
+        "ORDER BY timestamp ASC, id ASC "
+        "LIMIT ?");
+}
+
+/// Binds: provider, from, to
+inline QString dailyCosts()
+{
+    return QStringLiteral(
+        "SELECT date(timestamp) as day, MAX(cost_micros) as total_cost, "
+        "MAX(daily_cost_micros) as max_daily "
+        "FROM usage_snapshots "
+        "WHERE provider = ? AND timestamp >= ? AND timestamp <= ? "
+        "GROUP BY day ORDER BY day ASC");
+}
+
+/// Binds: provider, from, to
+inline QString summary()
+{
+    return QStringLiteral(
+        "SELECT MAX(cost_micros) as total_cost, "
+        "AVG(daily_cost_micros) as avg_daily, MAX(daily_cost_micros) as max_daily, "
+        "MAX(request_count) as total_requests, "
+        "MAX(input_tokens + output_tokens) as peak_tokens, "
+        "COUNT(*) as snapshot_count "
+        "FROM usage_snapshots "
+        "WHERE provider = ? AND timestamp >= ? AND timestamp <= ?");
+}
+
+/// Binds: provider, from, to
+inline QString providerSeries()
+{
+    return QStringLiteral(
+        "SELECT timestamp, cost_micros, input_tokens, output_tokens, request_count, "
+        "rl_requests, rl_requests_remaining "
+        "FROM usage_snapshots "
+        "WHERE provider = ? AND timestamp >= ? AND timestamp <= ? "
+        "ORDER BY timestamp ASC");
+}
+
+/// Binds: provider, from, to, fromEpochSecs, bucketSecs
+inline QString rateSeries(const QString &counterExpr)
+{
+    return QStringLiteral(
+        "WITH deltas AS ("
+        "  SELECT CAST(strftime('%s', timestamp) AS INTEGER) AS ts,"
+        "         (%1) AS v,"
+        "         LAG(%1) OVER w AS prev,"
+        "         CAST(strftime('%s', timestamp) AS INTEGER)"
+        "           - CAST(strftime('%s', LAG(timestamp) OVER w) AS INTEGER) AS dt"
+        "  FROM usage_snapshots"
+        "  WHERE provider = ? AND timestamp >= ? AND timestamp <= ?"
+        "  WINDOW w AS (ORDER BY timestamp, id)"
+        ") "
+        "SELECT (ts - ?) / ? AS bucket,"
+        "       SUM(CASE WHEN v >= prev THEN v - prev ELSE v END) AS increase,"
+        "       SUM(dt) AS seconds,"
+        "       COUNT(*) AS samples "
+        "FROM deltas "
+        "WHERE prev IS NOT NULL AND dt > 0 "
+        "GROUP BY bucket "
+        "ORDER BY bucket").arg(counterExpr);
+}
+
+inline QString heatmapCell()
+{
+    return QStringLiteral(
+        "CAST(strftime('%w', timestamp, 'localtime') AS INTEGER) * 24"
+        " + CAST(strftime('%H', timestamp, 'localtime') AS INTEGER)");
+}
+
+/// Binds: providers..., from, to
+inline QString heatmapCounters(int providerCount, const QString &counterExpr)
+{
+    // Attribute each counter increase to the hour in which it was observed
+    return QStringLiteral(
+        "WITH deltas AS ("
+        "  SELECT timestamp, (%3) AS v, LAG(%3) OVER w AS prev"
+        "  FROM usage_snapshots"
+        "  WHERE %2timestamp >= ? AND timestamp <= ?"
+        "  WINDOW w AS (PARTITION BY provider ORDER BY timestamp, id)"
+        ") "
+        "SELECT %1 AS cell, SUM(CASE WHEN v >= prev THEN v - prev ELSE v END) "
+        "FROM deltas "
+        "WHERE prev IS NOT NULL "
+        "GROUP BY cell").arg(heatmapCell(), providerInFilter(providerCount), counterExpr);
+}
+
+/// Binds: providers..., scanFrom, scanTo, currentFromEpoch, currentToEpoch,
+/// previousFromEpoch, previousToEpoch, currentFromEpoch, previousFromEpoch,
+/// bucketSecs
+inline QString periodComparison(int providerCount, const QString &counterExpr)
+{
+    // One scan over the span covering both periods. LAG() runs over the
+    // whole span, so the first increase of the later period is measured
+    // from the last snapshot of the earlier one. Each increase is tagged
+    // with its period (current wins where they overlap) and bucketed by
+    // its offset from that period's start.
+    return QStringLiteral(
+        "WITH deltas AS ("
+        "  SELECT provider, CAST(strftime('%s', timestamp) AS INTEGER) AS ts,"
+        "         (%2) AS v, LAG(%2) OVER w AS prev"
+        "  FROM usage_snapshots"
+        "  WHERE %1timestamp >= ? AND timestamp <= ?"
+        "  WINDOW w AS (PARTITION BY provider ORDER BY timestamp, id)"
+        "), tagged AS ("
+        "  SELECT provider, ts,"
+        "         CASE WHEN ts BETWEEN ? AND ? THEN 0"
+        "              WHEN ts BETWEEN ? AND ? THEN 1 END AS period,"
+        "         CASE WHEN v >= prev THEN v - prev ELSE v END AS increase"
+        "  FROM deltas"
+        "  WHERE prev IS NOT NULL"
+        ") "
+        "SELECT provider, period,"
+        "       (ts - CASE period WHEN 0 THEN ? ELSE ? END) / ? AS bucket,"
+        "       SUM(increase), COUNT(*) "
+        "FROM tagged "
+        "WHERE period IS NOT NULL "
+        "GROUP BY provider, period, bucket").arg(providerInFilter(providerCount), counterExpr);
+}
+
+/// Binds: providers..., from, to
+inline QString heatmapEvents(int providerCount)
+{
+    return QStringLiteral(
+        "SELECT %1 AS cell, COUNT(*) "
+        "FROM rate_limit_events "
+        "WHERE %2timestamp >= ? AND timestamp <= ? "
+        "GROUP BY cell").arg(heatmapCell(), providerInFilter(providerCount));
+}
+
+inline QString providers()
+{
+    return QStringLiteral("SELECT DISTINCT provider FROM usage_snapshots ORDER BY provider");
+}
+
+/// Binds: toolName, from, to
+inline QString toolSnapshots()
+{
+    return QStringLiteral(
+        "SELECT timestamp, usage_count, usage_limit, period_type, "
+        "plan_tier, limit_reached "
+        "FROM subscription_tool_usage "
+        "WHERE tool_name = ? AND timestamp >= ? AND timestamp <= ? "
+        "ORDER BY timestamp ASC");
+}
+
+/// Binds: toolName, from, to
+inline QString toolSeries()
+{
+    return QStringLiteral(
+        "SELECT timestamp, usage_count, usage_limit "
+        "FROM subscription_tool_usage "
+        "WHERE tool_name = ? AND timestamp >= ? AND timestamp <= ? "
+        "ORDER BY timestamp ASC");
+}
+
+inline QString toolNames()
+{
+    return QStringLiteral("SELECT DISTINCT tool_name FROM subscription_tool_usage ORDER BY tool_name");
+}
+
+/// Binds: provider, account, source, fromDay, toDay, project, project, model, model
+inline QString ledgerTotals()
+{
+    return QStringLiteral(
+        "SELECT SUM(input_tokens), SUM(output_tokens), SUM(request_count), SUM(cost_micros) "
+        "FROM billing_ledger "
+        "WHERE provider = ? AND account = ? AND source = ? AND day >= ? AND day <= ? "
+        "AND (? = '' OR project = ?) AND (? = '' OR model = ?)");
+}
+
+/// Binds: provider, from, to
+inline QString latencySeries()
+{
+    return QStringLiteral(
+        "SELECT timestamp, requests, failures, dns_p50_ms, connect_p50_ms, "
+        "ttfb_p50_ms, total_p50_ms, total_p95_ms "
+        "FROM api_latency "
+        "WHERE provider = ? AND timestamp >= ? AND timestamp <= ? "
+        "ORDER BY timestamp ASC");
+}
+
+/// Binds: provider, account, from, to
+inline QString accountSeries()
+{
+    return QStringLiteral(
+        "SELECT timestamp, cost_micros, daily_cost_micros, input_tokens, output_tokens, "
+        "request_count, rl_requests, rl_requests_remaining "
+        "FROM account_snapshots "
+        "WHERE provider = ? AND account = ? AND timestamp >= ? AND timestamp <= ? "
+        "ORDER BY timestamp ASC");
+}
+
+/// Binds: provider
+inline QString accounts()
+{
+    return QStringLiteral("SELECT DISTINCT account FROM account_snapshots WHERE provider = ? ORDER BY account");
+}
+
+} // namespace UsageDatabaseSql
+
+#endif // USAGEDATABASESQL_H
@@ -0,0 +1,842 @@
+#include "usageproxy.h"
+
+#include "costmicros.h"
+
+#include <QElapsedTimer>
+#include <QHostAddress>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QNetworkReply>
+#include <QNetworkRequest>
+#include <QSet>
+#include <QTcpSocket>
+#include <QUrl>
+
+#include <algorithm>
+#include <utility>
+
+namespace {
+
+// JSON bodies up to this size are parsed whole; beyond it only the tail,
+// where the usage block sits, is kept
+constexpr qsizetype METERED_BODY_BYTES = 1024 * 1024;
+constexpr qsizetype METERED_TAIL_BYTES = 64 * 1024;
+
+// Headers that describe one connection rather than the message
+bool isHopByHop(const QByteArray &lowerName)
+{
+    static const QSet<QByteArray> names = {
+        "connection", "keep-alive", "proxy-connection", "proxy-authenticate",
+        "proxy-authorization", "te", "trailer", "transfer-encoding", "upgrade",
+    };
+    return names.contains(lowerName);
+}
+
+QByteArray reasonPhrase(int status)
+{
+    switch (status) {
+    case 400: return "Bad Request";
+    case 404: return "Not Found";
+    case 413: return "Content Too Large";
+    case 431: return "Request Header Fields Too Large";
+    case 502: return "Bad Gateway";
+    default: return "Error";
+    }
+}
+
+/// Move complete chunks of a chunked request body from buffer to body.
+/// 1 once the last chunk was read, 0 while more is needed, -1 if malformed.
+int takeChunks(QByteArray &buffer, QByteArray &body)
+{
+    qsizetype pos = 0;
+    for (;;) {
+        const qsizetype lineEnd = buffer.indexOf("\r\n", pos);
+        if (lineEnd < 0)
+            break;
+
+        QByteArray sizeField = buffer.mid(pos, lineEnd - pos);
+        const qsizetype extension = sizeField.indexOf(';');
+        if (extension >= 0)
+            sizeField.truncate(extension);
+        bool ok = false;
+        const qint64 size = sizeField.trimmed().toLongLong(&ok, 16);
+        if (!ok || size < 0)
+            return -1;
+
+        if (size == 0) {
+            // Optional trailers, then an empty line
+            const qsizetype end = buffer.indexOf("\r\n\r\n", lineEnd);
+            if (end < 0)
+                break;
+            buffer.remove(0, end + 4);
+            return 1;
+        }
+
+        if (buffer.size() < lineEnd + 2 + size + 2)
+            break;
+        body.append(buffer.constData() + lineEnd + 2, size);
+        pos = lineEnd + 2 + size + 2;
+    }
+    buffer.remove(0, pos);
+    return 0;
+}
+
+/// The last `"usage": {...}` object in text, found by brace matching, for
+/// bodies too large to parse whole.
+QJsonObject lastUsageObject(const QByteArray &text)
+{
+    static const QByteArray key = QByteArrayLiteral("\"usage\"");
+    for (qsizetype at = text.lastIndexOf(key); at >= 0; at = at > 0 ? text.lastIndexOf(key, at - 1) : -1) {
+        const qsizetype open = text.indexOf('{', at + key.size());
+        if (open < 0 || text.mid(at + key.size(), open - at - key.size()).trimmed() != ":")
+            continue;
+
+        int depth = 0;
+        bool inString = false;
+        bool escaped = false;
+        for (qsizetype i = open; i < text.size(); ++i) {
+            const char c = text.at(i);
+            if (inString) {
+                if (escaped)
+                    escaped = false;
+                else if (c == '\\')
+                    escaped = true;
+                else if (c == '"')
+                    inString = false;
+            } else if (c == '"') {
+                inString = true;
+            } else if (c == '{') {
+                ++depth;
+            } else if (c == '}' && --depth == 0) {
+                const QJsonDocument doc = QJsonDocument::fromJson(text.mid(open, i - open + 1));
+                if (doc.isObject())
+                    return doc.object();
+                break;
+            }
+        }
+    }
+    return QJsonObject();
+}
+
+/**
+ * Picks the model and usage block out of a response as it passes through.
+ *
+ * Event streams are scanned line by line and only `data:` lines that
+ * mention "usage" are parsed; usage blocks are merged key by key, so
+ * Anthropic's output count in message_delta completes the input count of
+ * message_start. JSON bodies are parsed once at the end.
+ */
+class UsageMeter
+{
+public:
+    void begin(bool eventStream)
+    {
+        *this = UsageMeter();
+        m_eventStream = eventStream;
+        m_active = true;
+    }
+
+    bool isActive() const { return m_active; }
+
+    void feed(const QByteArray &data)
+    {
+        if (!m_active)
+            return;
+
+        if (!m_eventStream) {
+            // Kept as received; the chunks share their data with the reply
+            m_chunks.append(data);
+            m_bytes += data.size();
+            if (m_bytes > METERED_BODY_BYTES)
+                m_truncated = true;
+            while (m_truncated && m_chunks.size() > 1
+                   && m_bytes - m_chunks.first().size() >= METERED_TAIL_BYTES) {
+                m_bytes -= m_chunks.takeFirst().size();
+            }
+            return;
+        }
+
+        m_line += data;
+        qsizetype start = 0;
+        for (qsizetype end = m_line.indexOf('\n'); end >= 0; end = m_line.indexOf('\n', start)) {
+            takeEvent(QByteArray::fromRawData(m_line.constData() + start, end - start));
+            start = end + 1;
+        }
+        m_line.remove(0, start);
+        if (m_line.size() > METERED_BODY_BYTES)
+            m_line.clear(); // no event line is that long
+    }
+
+    void finish()
+    {
+        if (!m_active || m_eventStream)
+            return;
+
+        const QByteArray body = m_chunks.join();
+        m_chunks.clear();
+        if (!m_truncated) {
+            const QJsonDocument doc = QJsonDocument::fromJson(body);
+            if (doc.isObject())
+                merge(doc.object());
+        } else {
+            const QJsonObject usage = lastUsageObject(body);
+            if (!usage.isEmpty())
+                merge(QJsonObject{{QStringLiteral("usage"), usage}});
+        }
+    }
+
+    QString model() const { return m_model; }
+    QJsonObject usage() const { return m_usage; }
+
+private:
+    void takeEvent(QByteArray line)
+    {
+        if (line.endsWith('\r'))
+            line.chop(1);
+        if (!line.startsWith("data:") || !line.contains("\"usage\"") || line.contains("\"usage\":null"))
+            return;
+
+        const QJsonDocument doc = QJsonDocument::fromJson(line.mid(5).trimmed());
+        if (doc.isObject())
+            merge(doc.object());
+    }
+
+    void merge(const QJsonObject &object)
+    {
+        // Anthropic's message_start nests the message, the Responses API's
+        // response.completed the response
+        QJsonObject source = object.value(QStringLiteral("message")).toObject();
+        if (source.isEmpty())
+            source = object.value(QStringLiteral("response")).toObject();
+        if (source.isEmpty())
+            source = object;
+
+        if (m_model.isEmpty())
+            m_model = source.value(QStringLiteral("model")).toString();
+
+        const QJsonObject usage = source.value(QStringLiteral("usage")).toObject();
+        for (auto it = usage.constBegin(); it != usage.constEnd(); ++it) {
+            if (!it.value().isNull())
+                m_usage.insert(it.key(), it.value());
+        }
+    }
+
+    bool m_active = false;
+    bool m_eventStream = false;
+    bool m_truncated = false;
+    QByteArrayList m_chunks; // JSON body, or its tail once truncated
+    qsizetype m_bytes = 0;
+    QByteArray m_line;       // event stream: the incomplete last line
+    QString m_model;
+    QJsonObject m_usage;
+};
+
+} // namespace
+
+/// One request and its response on a client connection. Connections are
+/// kept alive; requests on one are answered in order, one at a time.
+struct UsageProxy::Exchange {
+    QByteArray buffer; // received, not yet consumed
+
+    // Request
+    bool headerRead = false;
+    QByteArray method;
+    QByteArray target;
+    QList<QPair<QByteArray, QByteArray>> headers;
+    qint64 contentLength = 0;
+    bool chunkedRequest = false;
+    bool expectContinue = false;
+    QByteArray body;
+    bool keepAlive = true;
+    int errorStatus = 0; // set when the request cannot be read
+
+    // Response
+    QString route;
+    QPointer<QNetworkReply> reply;
+    bool responseStarted = false;
+    bool chunkedResponse = false;
+    bool bodyless = false;
+    UsageMeter meter;
+    qint64 overheadNs = 0;
+
+    /// Ready for the next request, keeping bytes already received for it.
+    void reset()
+    {
+        QByteArray rest = std::move(buffer);
+        *this = Exchange();
+        buffer = std::move(rest);
+    }
+};
+
+UsageProxy::UsageProxy(QObject *parent)
+    : QObject(parent)
+{
+    m_upstreams = {
+        {QStringLiteral("openai"), QStringLiteral("https://api.openai.com")},
+        {QStringLiteral("anthropic"), QStringLiteral("https://api.anthropic.com")},
+    };
+
+    // Redirects are the tool's business
+    m_network.setRedirectPolicy(QNetworkRequest::ManualRedirectPolicy);
+
+    m_flushTimer.setSingleShot(true);
+    m_flushTimer.setInterval(LEDGER_FLUSH_MS);
+    connect(&m_flushTimer, &QTimer::timeout, this, &UsageProxy::flush);
+
+    connect(&m_server, &QTcpServer::newConnection, this, &UsageProxy::onNewConnection);
+}
+
+UsageProxy::~UsageProxy()
+{
+    m_server.close();
+    for (auto it = m_exchanges.constBegin(); it != m_exchanges.constEnd(); ++it) {
+        disconnect(it.key(), nullptr, this, nullptr);
+        if (it.value()->reply) {
+            it.value()->reply->disconnect(this);
+            it.value()->reply->abort();
+        }
+        delete it.value();
+    }
+    m_exchanges.clear();
+    flush();
+}
+
+// ── Properties ──
+
+bool UsageProxy::isEnabled() const { return m_enabled; }
+
+void UsageProxy::setEnabled(bool enabled)
+{
+    if (m_enabled == enabled)
+        return;
+    m_enabled = enabled;
+    Q_EMIT enabledChanged();
+    updateListening();
+}
+
+int UsageProxy::port() const { return m_port; }
+
+void UsageProxy::setPort(int port)
+{
+    port = qBound(0, port, 65535);
+    if (m_port == port)
+        return;
+    m_port = port;
+    Q_EMIT portChanged();
+    updateListening();
+}
+
+bool UsageProxy::isListening() const { return m_server.isListening(); }
+int UsageProxy::serverPort() const { return m_server.isListening() ? m_server.serverPort() : 0; }
+
+QVariantMap UsageProxy::upstreams() const { return m_upstreams; }
+
+void UsageProxy::setUpstreams(const QVariantMap &upstreams)
+{
+    QVariantMap normalized;
+    for (auto it = upstreams.constBegin(); it != upstreams.constEnd(); ++it) {
+        const QString route = it.key().trimmed().toLower();
+        const QString url = it.value().toString().trimmed();
+        if (route.isEmpty() || route.contains(QLatin1Char('/')) || !QUrl(url).isValid()) {
+            qWarning() << "UsageProxy: ignoring route" << it.key() << "->" << it.value();
+            continue;
+        }
+        normalized.insert(route, url);
+    }
+
+    if (m_upstreams != normalized) {
+        m_upstreams = normalized;
+        Q_EMIT upstreamsChanged();
+    }
+}
+
+UsageDatabase *UsageProxy::database() const { return m_database; }
+
+void UsageProxy::setDatabase(UsageDatabase *database)
+{
+    if (m_database == database)
+        return;
+    flush();
+    m_database = database;
+    Q_EMIT databaseChanged();
+}
+
+int UsageProxy::activeRequests() const
+{
+    return static_cast<int>(std::count_if(m_exchanges.cbegin(), m_exchanges.cend(),
+                                          [](const Exchange *exchange) { return !exchange->reply.isNull(); }));
+}
+
+int UsageProxy::forwardedRequests() const { return m_forwardedRequests; }
+int UsageProxy::meteredRequests() const { return m_meteredRequests; }
+
+void UsageProxy::setBackend(const QString &route, ProviderBackend *backend)
+{
+    const QString key = route.trimmed().toLower();
+    if (backend)
+        m_backends.insert(key, backend);
+    else
+        m_backends.remove(key);
+}
+
+QString UsageProxy::routeUrl(const QString &route) const
+{
+    const int port = m_server.isListening() ? m_server.serverPort() : m_port;
+    return QStringLiteral("http://127.0.0.1:%1/%2").arg(port).arg(route.trimmed().toLower());
+}
+
+QVariantMap UsageProxy::overheadStats() const
+{
+    QList<qint64> sorted = m_overheadNs;
+    std::sort(sorted.begin(), sorted.end());
+
+    const auto percentileMs = [&sorted](int percentile) {
+        if (sorted.isEmpty())
+            return 0.0;
+        // Nearest rank
+        const qsizetype rank = qMax<qsizetype>(1, (sorted.size() * percentile + 99) / 100);
+        return sorted.at(rank - 1) / 1e6;
+    };
+
+    QVariantMap stats;
+    stats[QStringLiteral("samples")] = sorted.size();
+    stats[QStringLiteral("p50Ms")] = percentileMs(50);
+    stats[QStringLiteral("p99Ms")] = percentileMs(99);
+    stats[QStringLiteral("maxMs")] = sorted.isEmpty() ? 0.0 : sorted.last() / 1e6;
+    return stats;
+}
+
+// ── Ledger ──
+
+void UsageProxy::flush()
+{
+    m_flushTimer.stop();
+    const auto pending = std::exchange(m_pendingLedger, {});
+    if (!m_database)
+        return;
+
+    for (auto it = pending.constBegin(); it != pending.constEnd(); ++it)
+        m_database->addLedgerEntries(it.key().first, it.key().second, QStringLiteral("proxy"), it.value());
+}
+
+// ── Listening ──
+
+void UsageProxy::updateListening()
+{
+    const bool wasListening = m_server.isListening();
+    if (wasListening) {
+        if (m_enabled && (m_port == 0 || m_server.serverPort() == m_port))
+            return;
+        // Connections already accepted are served to the end
+        m_server.close();
+    }
+
+    if (m_enabled && !m_server.listen(QHostAddress::LocalHost, static_cast<quint16>(m_port))) {
+        qWarning() << "UsageProxy: cannot listen on 127.0.0.1 port" << m_port << m_server.errorString();
+    }
+
+    if (wasListening || m_server.isListening())
+        Q_EMIT listeningChanged();
+}
+
+void UsageProxy::onNewConnection()
+{
+    while (QTcpSocket *socket = m_server.nextPendingConnection()) {
+        // Event-stream chunks are small and must not wait for more data
+        socket->setSocketOption(QAbstractSocket::LowDelayOption, 1);
+        m_exchanges.insert(socket, new Exchange);
+        connect(socket, &QTcpSocket::readyRead, this, [this, socket]() { onClientReadyRead(socket); });
+        connect(socket, &QTcpSocket::disconnected, this, [this, socket]() { onClientDisconnected(socket); });
+    }
+}
+
+void UsageProxy::onClientDisconnected(QTcpSocket *socket)
+{
+    if (Exchange *exchange = m_exchanges.take(socket)) {
+        // The tool gave up: stop the upstream request too
+        if (QNetworkReply *reply = exchange->reply) {
+            reply->disconnect(this);
+            reply->abort();
+            reply->deleteLater();
+        }
+        delete exchange;
+        Q_EMIT statsChanged();
+    }
+    socket->deleteLater();
+}
+
+// ── Requests ──
+
+void UsageProxy::onClientReadyRead(QTcpSocket *socket)
+{
+    Exchange *exchange = m_exchanges.value(socket);
+    if (!exchange)
+        return;
+
+    QElapsedTimer timer;
+    timer.start();
+
+    exchange->buffer += socket->readAll();
+    // The next request waits until this one is answered
+    if (exchange->reply || exchange->responseStarted)
+        return;
+
+    if (!readRequest(*exchange)) {
+        if (exchange->expectContinue) {
+            socket->write("HTTP/1.1 100 Continue\r\n\r\n");
+            exchange->expectContinue = false;
+        }
+        return;
+    }
+
+    exchange->overheadNs += timer.nsecsElapsed();
+    if (exchange->errorStatus) {
+        exchange->keepAlive = false; // the rest of the stream cannot be framed
+        sendError(socket, *exchange, exchange->errorStatus, QStringLiteral("Malformed or oversized request"));
+        return;
+    }
+
+    // May finish the exchange and close the connection
+    forwardRequest(socket, *exchange);
+}
+
+bool UsageProxy::readRequest(Exchange &exchange)
+{
+    if (!exchange.headerRead) {
+        const qsizetype end = exchange.buffer.indexOf("\r\n\r\n");
+        if (end < 0) {
+            if (exchange.buffer.size() > MAX_HEADER_BYTES) {
+                exchange.errorStatus = 431;
+                return true;
+            }
+            return false;
+        }
+
+        const QList<QByteArray> lines = exchange.buffer.left(end).split('\n');
+        exchange.buffer.remove(0, end + 4);
+
+        const QList<QByteArray> requestLine = lines.first().trimmed().split(' ');
+        if (requestLine.size() != 3 || !requestLine.at(2).startsWith("HTTP/1.")) {
+            exchange.errorStatus = 400;
+            return true;
+        }
+        exchange.method = requestLine.at(0);
+        exchange.target = requestLine.at(1);
+        exchange.keepAlive = requestLine.at(2) != "HTTP/1.0";
+
+        for (qsizetype i = 1; i < lines.size(); ++i) {
+            const QByteArray line = lines.at(i).trimmed();
+            const qsizetype colon = line.indexOf(':');
+            if (colon <= 0)
+                continue;
+            const QByteArray name = line.left(colon).trimmed();
+            const QByteArray value = line.mid(colon + 1).trimmed();
+            const QByteArray lower = name.toLower();
+
+            if (lower == "content-length") {
+                bool ok = false;
+                exchange.contentLength = value.toLongLong(&ok);
+                if (!ok || exchange.contentLength < 0) {
+                    exchange.errorStatus = 400;
+                    return true;
+                }
+            } else if (lower == "transfer-encoding") {
+                exchange.chunkedRequest = value.toLower().contains("chunked");
+            } else if (lower == "connection") {
+                const QByteArray option = value.toLower();
+                if (option == "close")
+                    exchange.keepAlive = false;
+                else if (option == "keep-alive")
+                    exchange.keepAlive = true;
+            } else if (lower == "expect") {
+                exchange.expectContinue = value.toLower() == "100-continue";
+            }
+            exchange.headers.append({name, value});
+        }
+
+        if (exchange.contentLength > MAX_BODY_BYTES) {
+            exchange.errorStatus = 413;
+            return true;
+        }
+        exchange.headerRead = true;
+    }
+
+    if (exchange.chunkedRequest) {
+        const int state = takeChunks(exchange.buffer, exchange.body);
+        if (state < 0 || exchange.body.size() > MAX_BODY_BYTES) {
+            exchange.errorStatus = state < 0 ? 400 : 413;
+            return true;
+        }
+        return state > 0;
+    }
+
+    if (exchange.buffer.size() < exchange.contentLength)
+        return false;
+    exchange.body = exchange.buffer.left(exchange.contentLength);
+    exchange.buffer.remove(0, exchange.contentLength);
+    return true;
+}
+
+void UsageProxy::forwardRequest(QTcpSocket *socket, Exchange &exchange)
+{
+    QElapsedTimer timer;
+    timer.start();
+
+    exchange.expectContinue = false;
+    if (!exchange.target.startsWith('/')) {
+        sendError(socket, exchange, 400, QStringLiteral("Only origin-form request targets are supported"));
+        return;
+    }
+
+    // "/openai/v1/chat/completions?x" -> route "openai", rest "/v1/chat/completions?x"
+    qsizetype routeEnd = 1;
+    while (routeEnd < exchange.target.size() && exchange.target.at(routeEnd) != '/'
+           && exchange.target.at(routeEnd) != '?') {
+        ++routeEnd;
+    }
+    exchange.route = QString::fromUtf8(exchange.target.mid(1, routeEnd - 1)).toLower();
+
+    QByteArray upstream = m_upstreams.value(exchange.route).toString().toUtf8();
+    if (upstream.isEmpty()) {
+        sendError(socket, exchange, 404, QStringLiteral("No upstream for route \"%1\"").arg(exchange.route));
+        return;
+    }
+    while (upstream.endsWith('/'))
+        upstream.chop(1);
+
+    const QUrl url = QUrl::fromEncoded(upstream + exchange.target.mid(routeEnd));
+    if (!url.isValid()) {
+        sendError(socket, exchange, 400, QStringLiteral("Invalid request target"));
+        return;
+    }
+
+    QNetworkRequest request(url);
+    // Cookies belong to each tool: the manager's jar must neither store an
+    // upstream's Set-Cookie nor hand it to the next tool's request
+    request.setAttribute(QNetworkRequest::CookieLoadControlAttribute, QNetworkRequest::Manual);
+    request.setAttribute(QNetworkRequest::CookieSaveControlAttribute, QNetworkRequest::Manual);
+    for (const auto &header : std::as_const(exchange.headers)) {
+        const QByteArray lower = header.first.toLower();
+        // Framing and compression are negotiated per hop; the manager
+        // decompresses, so the body can be read for usage
+        if (isHopByHop(lower) || lower == "host" || lower == "content-length"
+            || lower == "accept-encoding" || lower == "expect") {
+            continue;
+        }
+        const QByteArray existing = request.rawHeader(header.first);
+        request.setRawHeader(header.first, existing.isEmpty() ? header.second : existing + ", " + header.second);
+    }
+
+    QNetworkReply *reply = m_network.sendCustomRequest(request, exchange.method, exchange.body);
+    exchange.body.clear();
+    exchange.reply = reply;
+    connect(reply, &QNetworkReply::readyRead, this, [this, socket]() { onUpstreamReadyRead(socket); });
+    connect(reply, &QNetworkReply::finished, this, [this, socket]() { onUpstreamFinished(socket); });
+
+    ++m_forwardedRequests;
+    exchange.overheadNs += timer.nsecsElapsed();
+    Q_EMIT statsChanged();
+}
+
+// ── Responses ──
+
+void UsageProxy::startResponse(QTcpSocket *socket, Exchange &exchange)
+{
+    QNetworkReply *reply = exchange.reply;
+    const int status = reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
+    QByteArray reason = reply->attribute(QNetworkRequest::HttpReasonPhraseAttribute).toByteArray();
+    if (reason.isEmpty())
+        reason = status < 400 ? QByteArray("OK") : reasonPhrase(status);
+
+    exchange.bodyless = exchange.method == "HEAD" || status == 204 || status == 304;
+    // A decompressed body no longer matches the upstream's length
+    const bool decoded = reply->hasRawHeader("Content-Encoding");
+    exchange.chunkedResponse = !exchange.bodyless && (decoded || !reply->hasRawHeader("Content-Length"));
+
+    QByteArray head = "HTTP/1.1 " + QByteArray::number(status) + ' ' + reason + "\r\n";
+    const auto &pairs = reply->rawHeaderPairs();
+    for (const auto &header : pairs) {
+        const QByteArray lower = header.first.toLower();
+        if (isHopByHop(lower) || lower == "content-encoding"
+            || (exchange.chunkedResponse && lower == "content-length")) {
+            continue;
+        }
+        head += header.first + ": " + header.second + "\r\n";
+    }
+    if (exchange.chunkedResponse)
+        head += "Transfer-Encoding: chunked\r\n";
+    head += exchange.keepAlive ? "Connection: keep-alive\r\n\r\n" : "Connection: close\r\n\r\n";
+    socket->write(head);
+    exchange.responseStarted = true;
+
+    // Only successful answers carry usage that was billed
+    if (status >= 200 && status < 300)
+        exchange.meter.begin(reply->rawHeader("Content-Type").contains("text/event-stream"));
+}
+
+void UsageProxy::writeBody(QTcpSocket *socket, Exchange &exchange, const QByteArray &data)
+{
+    if (exchange.bodyless || data.isEmpty())
+        return;
+
+    // The payload is handed to the socket as is, framed by separate writes
+    if (exchange.chunkedResponse) {
+        socket->write(QByteArray::number(data.size(), 16) + "\r\n");
+        socket->write(data);
+        socket->write("\r\n");
+    } else {
+        socket->write(data);
+    }
+    exchange.meter.feed(data);
+}
+
+void UsageProxy::onUpstreamReadyRead(QTcpSocket *socket)
+{
+    Exchange *exchange = m_exchanges.value(socket);
+    if (!exchange || !exchange->reply)
+        return;
+
+    QElapsedTimer timer;
+    timer.start();
+
+    if (!exchange->responseStarted)
+        startResponse(socket, *exchange);
+    writeBody(socket, *exchange, exchange->reply->readAll());
+
+    exchange->overheadNs += timer.nsecsElapsed();
+}
+
+void UsageProxy::onUpstreamFinished(QTcpSocket *socket)
+{
+    Exchange *exchange = m_exchanges.value(socket);
+    if (!exchange || !exchange->reply)
+        return;
+
+    QElapsedTimer timer;
+    timer.start();
+
+    QNetworkReply *reply = exchange->reply;
+    exchange->reply = nullptr;
+    reply->deleteLater();
+
+    // Errors below ProxyConnectionRefusedError are transport failures;
+    // the ones above it stand for HTTP statuses whose body is forwarded
+    const bool transportFailed = reply->error() != QNetworkReply::NoError
+        && reply->error() < QNetworkReply::ProxyConnectionRefusedError;
+
+    if (!exchange->responseStarted && reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt() == 0) {
+        exchange->overheadNs += timer.nsecsElapsed();
+        sendError(socket, *exchange, 502, reply->errorString());
+        return;
+    }
+
+    if (!exchange->responseStarted)
+        startResponse(socket, *exchange);
+    writeBody(socket, *exchange, reply->readAll());
+
+    if (transportFailed) {
+        // Cut off mid-body: closing without the final chunk tells the tool
+        exchange->keepAlive = false;
+    } else {
+        if (exchange->chunkedResponse)
+            socket->write("0\r\n\r\n");
+        exchange->meter.finish();
+        recordUsage(*exchange);
+    }
+
+    exchange->overheadNs += timer.nsecsElapsed();
+    finishExchange(socket, *exchange);
+}
+
+void UsageProxy::sendError(QTcpSocket *socket, Exchange &exchange, int status, const QString &message)
+{
+    const QJsonObject error{
+        {QStringLiteral("error"), QJsonObject{
+            {QStringLiteral("type"), QStringLiteral("proxy_error")},
+            {QStringLiteral("message"), message},
+        }},
+    };
+    const QByteArray body = QJsonDocument(error).toJson(QJsonDocument::Compact);
+
+    QByteArray response = "HTTP/1.1 " + QByteArray::number(status) + ' ' + reasonPhrase(status) + "\r\n";
+    response += "Content-Type: application/json\r\n";
+    response += "Content-Length: " + QByteArray::number(body.size()) + "\r\n";
+    response += exchange.keepAlive ? "Connection: keep-alive\r\n\r\n" : "Connection: close\r\n\r\n";
+    response += body;
+    socket->write(response);
+
+    finishExchange(socket, exchange);
+}
+
+void UsageProxy::finishExchange(QTcpSocket *socket, Exchange &exchange)
+{
+    recordOverhead(exchange.overheadNs);
+    const bool keepAlive = exchange.keepAlive;
+    exchange.reset();
+    Q_EMIT statsChanged();
+
+    if (!keepAlive) {
+        socket->disconnectFromHost();
+        return;
+    }
+
+    // A request that arrived while this one was answered
+    if (!exchange.buffer.isEmpty()) {
+        QMetaObject::invokeMethod(this, [this, guard = QPointer<QTcpSocket>(socket)]() {
+            if (guard)
+                onClientReadyRead(guard);
+        }, Qt::QueuedConnection);
+    }
+}
+
+// ── Metering ──
+
+void UsageProxy::recordUsage(const Exchange &exchange)
+{
+    const QJsonObject usage = exchange.meter.usage();
+    if (usage.isEmpty())
+        return;
+
+    const QString model = exchange.meter.model();
+    const QJsonObject payload{
+        {QStringLiteral("model"), model},
+        {QStringLiteral("usage"), usage},
+    };
+    // Routes that are not provider keys (a local server, a gateway) are
+    // read as OpenAI-compatible
+    ProviderBackend::ProviderId providerId = ProviderBackend::providerIdFromKey(exchange.route);
+    if (providerId == ProviderBackend::ProviderId::Unknown)
+        providerId = ProviderBackend::ProviderId::OpenAI;
+    const ProviderBackend::NormalizedUsageCost normalized = ProviderBackend::normalizeUsageCost(providerId, payload);
+    if (!normalized.parsed)
+        return;
+
+    ProviderBackend *backend = m_backends.value(exchange.route);
+    const qint64 costMicros = backend
+        ? backend->addMeteredUsage(model, normalized)
+        : CostMicros::fromDollars(normalized.cost);
+
+    if (m_database) {
+        UsageDatabase::LedgerEntry entry;
+        entry.day = QDateTime::currentDateTimeUtc().date();
+        entry.model = model;
+        entry.inputTokens = normalized.inputTokens;
+        entry.outputTokens = normalized.outputTokens;
+        entry.requests = qMax(1, normalized.requestCount);
+        entry.costMicros = costMicros;
+        m_pendingLedger[{backend ? backend->name() : exchange.route, exchange.route}].append(entry);
+        if (!m_flushTimer.isActive())
+            m_flushTimer.start();
+    }
+
+    ++m_meteredRequests;
+    Q_EMIT requestMetered(exchange.route, model, normalized.inputTokens, normalized.outputTokens,
+                          CostMicros::toDollars(costMicros));
+}
+
+void UsageProxy::recordOverhead(qint64 nanoseconds)
+{
+    m_overheadNs.append(nanoseconds);
+    if (m_overheadNs.size() > OVERHEAD_SAMPLES)
+        m_overheadNs.removeFirst();
+}
@@ -0,0 +1,164 @@
+#ifndef USAGEPROXY_H
+#define USAGEPROXY_H
+
+#include <QHash>
+#include <QList>
+#include <QNetworkAccessManager>
+#include <QObject>
+#include <QPointer>
+#include <QTcpServer>
+#include <QTimer>
+#include <QVariantMap>
+
+#include "providerbackend.h"
+#include "usagedatabase.h"
+
+class QNetworkReply;
+class QTcpSocket;
+
+/**
+ * Local metering proxy for OpenAI- and Anthropic-style APIs.
+ *
+ * Listens on 127.0.0.1 only. Each route is a path prefix forwarded to one
+ * upstream base URL; with the default routes, tools are pointed at
+ *
+ *   OPENAI_BASE_URL=http://127.0.0.1:8787/openai/v1
+ *   ANTHROPIC_BASE_URL=http://127.0.0.1:8787/anthropic
+ *
+ * Requests go upstream as sent, with the tool's own credentials; only
+ * hop-by-hop headers are dropped. Response bytes are handed to the tool as
+ * they arrive, streamed (SSE) or not, without waiting for the full body.
+ * On the way through, the `usage` block is picked out (the last chunk of
+ * an OpenAI stream, the message_start / message_delta events of an
+ * Anthropic one, or the JSON body) and normalised with
+ * ProviderBackend::normalizeUsageCost() for the route's provider.
+ *
+ * Each metered request is added to the route's backend (setBackend(),
+ * meteredInputTokens etc.) and, with a `database`, to the billing ledger
+ * under source "proxy", with the route as account, per UTC day and
+ * model. Ledger writes are batched off the request path.
+ *
+ * overheadStats() reports the time the proxy itself spends on a request
+ * (parsing, dispatch, forwarding and metering each chunk), p50 / p99 over
+ * the last 200 requests.
+ *
+ * Usage from QML:
+ *   UsageProxy {
+ *       enabled: plasmoid.configuration.meteringProxyEnabled
+ *       port: plasmoid.configuration.meteringProxyPort
+ *       database: usageDatabase
+ *       Component.onCompleted: {
+ *           setBackend("openai", openaiBackend)
+ *           setBackend("anthropic", anthropicBackend)
+ *       }
+ *   }
+ */
+class UsageProxy : public QObject
+{
+    Q_OBJECT
+    Q_PROPERTY(bool enabled READ isEnabled WRITE setEnabled NOTIFY enabledChanged)
+    Q_PROPERTY(int port READ port WRITE setPort NOTIFY portChanged)
+    Q_PROPERTY(bool listening READ isListening NOTIFY listeningChanged)
+    Q_PROPERTY(int serverPort READ serverPort NOTIFY listeningChanged)
+    Q_PROPERTY(QVariantMap upstreams READ upstreams WRITE setUpstreams NOTIFY upstreamsChanged)
+    Q_PROPERTY(UsageDatabase *database READ database WRITE setDatabase NOTIFY databaseChanged)
+    Q_PROPERTY(int activeRequests READ activeRequests NOTIFY statsChanged)
+    Q_PROPERTY(int forwardedRequests READ forwardedRequests NOTIFY statsChanged)
+    Q_PROPERTY(int meteredRequests READ meteredRequests NOTIFY statsChanged)
+
+public:
+    explicit UsageProxy(QObject *parent = nullptr);
+    ~UsageProxy() override;
+
+    bool isEnabled() const;
+    void setEnabled(bool enabled);
+
+    /// Port to listen on; 0 picks a free one (see serverPort).
+    int port() const;
+    void setPort(int port);
+
+    bool isListening() const;
+    int serverPort() const;
+
+    /// Route name -> upstream base URL. Route names that are provider keys
+    /// (ProviderBackend::providerIdFromKey()) decide how usage is read;
+    /// others are read as OpenAI-compatible.
+    QVariantMap upstreams() const;
+    void setUpstreams(const QVariantMap &upstreams);
+
+    UsageDatabase *database() const;
+    void setDatabase(UsageDatabase *database);
+
+    int activeRequests() const;
+    int forwardedRequests() const;
+    int meteredRequests() const;
+
+    /// Backend that receives the usage metered on a route; null detaches.
+    /// Without one, only costs the upstream reports itself are recorded.
+    Q_INVOKABLE void setBackend(const QString &route, ProviderBackend *backend);
+
+    /// Base URL of a route for tools, e.g. "http://127.0.0.1:8787/openai".
+    Q_INVOKABLE QString routeUrl(const QString &route) const;
+
+    /// { samples, p50Ms, p99Ms, maxMs } of the time spent in the proxy.
+    Q_INVOKABLE QVariantMap overheadStats() const;
+
+    /// Write pending ledger entries now instead of on the batch timer.
+    Q_INVOKABLE void flush();
+
+Q_SIGNALS:
+    void enabledChanged();
+    void portChanged();
+    void listeningChanged();
+    void upstreamsChanged();
+    void databaseChanged();
+    void statsChanged();
+    void requestMetered(const QString &route, const QString &model,
+                        qint64 inputTokens, qint64 outputTokens, double cost);
+
+private:
+    struct Exchange;
+
+    void updateListening();
+    void onNewConnection();
+    void onClientReadyRead(QTcpSocket *socket);
+    void onClientDisconnected(QTcpSocket *socket);
+    bool readRequest(Exchange &exchange);
+    void forwardRequest(QTcpSocket *socket, Exchange &exchange);
+    void startResponse(QTcpSocket *socket, Exchange &exchange);
+    void onUpstreamReadyRead(QTcpSocket *socket);
+    void onUpstreamFinished(QTcpSocket *socket);
+    void writeBody(QTcpSocket *socket, Exchange &exchange, const QByteArray &data);
+    void sendError(QTcpSocket *socket, Exchange &exchange, int status, const QString &message);
+    void finishExchange(QTcpSocket *socket, Exchange &exchange);
+    void recordUsage(const Exchange &exchange);
+    void recordOverhead(qint64 nanoseconds);
+
+    QTcpServer m_server;
+    // Tool traffic is latency-sensitive and may stream for minutes, so it
+    // gets its own connection pool instead of queueing behind polls in
+    // SharedNetworkManager
+    QNetworkAccessManager m_network;
+    QHash<QTcpSocket *, Exchange *> m_exchanges;
+
+    bool m_enabled = false;
+    int m_port = 8787;
+    QVariantMap m_upstreams;
+    QHash<QString, QPointer<ProviderBackend>> m_backends;
+    QPointer<UsageDatabase> m_database;
+
+    int m_forwardedRequests = 0;
+    int m_meteredRequests = 0;
+    QList<qint64> m_overheadNs; // most recent last
+
+    // Entries not yet written, per ledger provider and account (the route)
+    QHash<QPair<QString, QString>, QList<UsageDatabase::LedgerEntry>> m_pendingLedger;
+    QTimer m_flushTimer;
+
+    static constexpr int MAX_HEADER_BYTES = 64 * 1024;
+    static constexpr qint64 MAX_BODY_BYTES = 64 * 1024 * 1024;
+    static constexpr int OVERHEAD_SAMPLES = 200;
+    static constexpr int LEDGER_FLUSH_MS = 2000;
+};
+
+#endif // USAGEPROXY_H